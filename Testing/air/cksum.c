@@ -0,0 +1,146 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+#include "teem/air.h"
+
+/*
+** Tests:
+** airCRC32, airCRC32Update, airCRC32Combine, airCRC32Finish
+** airXXH64
+*/
+
+#define LEN 10007
+
+/* bit-at-a-time version of the cksum CRC, straight from the polynomial */
+static unsigned int
+refCRC32(const unsigned char *data, size_t len) {
+  unsigned int crc=0, bi;
+  size_t ii, nn;
+
+  for (ii=0; ii<len + sizeof(size_t); ii++) {
+    if (ii < len) {
+      crc ^= AIR_CAST(unsigned int, data[ii]) << 24;
+    } else {
+      /* length of data, least significant byte first */
+      nn = len >> (8*(ii - len));
+      if (!nn) {
+        break;
+      }
+      crc ^= AIR_CAST(unsigned int, nn & 0xff) << 24;
+    }
+    for (bi=0; bi<8; bi++) {
+      crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1;
+    }
+  }
+  return ~crc;
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  /* CRCs from cksum; hashes from xxhsum -H64 */
+  const char *str[] = {"a", "abc",
+                       "Nobody inspects the spammish repetition"};
+  unsigned int strCRC[] = {1220704766u, 1219131554u, 205637097u};
+  airULLong strXXH[] = {AIR_ULLONG(0xd24ec4f1a98c6e5b),
+                        AIR_ULLONG(0x44bc2cf5ad770999),
+                        AIR_ULLONG(0xfbcea83c8a378bf1)};
+  static unsigned char data[LEN], rev[LEN];
+  unsigned int si, crc, crcA, crcB, ref;
+  size_t ii, jj, len, split, unit;
+  airULLong xxh;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+
+  for (si=0; si<3; si++) {
+    len = strlen(str[si]);
+    crc = airCRC32(AIR_CAST(const unsigned char *, str[si]), len, 1, 0);
+    if (strCRC[si] != crc) {
+      fprintf(stderr, "%s: CRC(\"%s\") %u != correct %u\n", me,
+              str[si], crc, strCRC[si]);
+      exit(1);
+    }
+    xxh = airXXH64(AIR_CAST(const unsigned char *, str[si]), len, 1, 0, 0);
+    if (strXXH[si] != xxh) {
+      fprintf(stderr, "%s: XXH64(\"%s\") wrong\n", me, str[si]);
+      exit(1);
+    }
+  }
+  if (AIR_ULLONG(0xef46db3751d8e999) != airXXH64(NULL, 0, 1, 0, 0)) {
+    fprintf(stderr, "%s: XXH64 of nothing wrong\n", me);
+    exit(1);
+  }
+
+  /* deterministic junk */
+  crc = 42;
+  for (ii=0; ii<LEN; ii++) {
+    crc = 1664525*crc + 1013904223;
+    data[ii] = AIR_CAST(unsigned char, crc >> 24);
+  }
+
+  /* lengths that exercise the 8-byte slices and the leftovers */
+  for (len=1; len<=LEN; len += (len < 40 ? 1 : 997)) {
+    ref = refCRC32(data, len);
+    crc = airCRC32(data, len, 1, 0);
+    if (ref != crc) {
+      fprintf(stderr, "%s: len %u: CRC %u != reference %u\n", me,
+              AIR_CAST(unsigned int, len), crc, ref);
+      exit(1);
+    }
+    for (split=0; split<=len; split += 1 + len/7) {
+      crcA = airCRC32Update(0, data, split, 1, 0);
+      crcB = airCRC32Update(0, data + split, len - split, 1, 0);
+      crc = airCRC32Finish(airCRC32Combine(crcA, crcB, len - split), len);
+      if (ref != crc) {
+        fprintf(stderr, "%s: len %u split %u: combined CRC %u != %u\n", me,
+                AIR_CAST(unsigned int, len), AIR_CAST(unsigned int, split),
+                crc, ref);
+        exit(1);
+      }
+    }
+  }
+
+  /* swapping should be the same as working on swapped data */
+  for (unit=2; unit<=8; unit++) {
+    len = LEN - LEN % unit;
+    for (ii=0; ii<len/unit; ii++) {
+      for (jj=0; jj<unit; jj++) {
+        rev[jj + unit*ii] = data[unit-1-jj + unit*ii];
+      }
+    }
+    if (airCRC32(rev, len, unit, 0) != airCRC32(data, len, unit, 1)) {
+      fprintf(stderr, "%s: unit %u: swapped CRC wrong\n", me,
+              AIR_CAST(unsigned int, unit));
+      exit(1);
+    }
+    if (airXXH64(rev, len, unit, 0, 1) != airXXH64(data, len, unit, 1, 1)) {
+      fprintf(stderr, "%s: unit %u: swapped XXH64 wrong\n", me,
+              AIR_CAST(unsigned int, unit));
+      exit(1);
+    }
+  }
+
+  exit(0);
+}
@@ -0,0 +1,179 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageDeconvolveSeparable, with one and with multiple threads, by
+** checking that probing its output with the same kernel reproduces
+** the input values at the samples
+*/
+
+#define THREAD_NUM 3
+
+/* biggest difference between reconstructed and original values */
+static int
+deconvCheck(double *diffP, const Nrrd *nin, const Nrrd *ndcv,
+            const gageKind *kind, const NrrdKernelSpec *ksp) {
+  static const char me[]="deconvCheck";
+  gageContext *gctx;
+  gagePerVolume *pvl;
+  const double *ans, *in;
+  double dd;
+  unsigned int xi, yi, zi, vi, sx, sy, sz, vlen;
+  int item, E;
+  airArray *mop;
+
+  mop = airMopNew();
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  gageParmSet(gctx, gageParmRenormalize, AIR_FALSE);
+  gageParmSet(gctx, gageParmCheckIntegrals, AIR_FALSE);
+  item = (gageKindScl == kind ? gageSclValue : gageVecVector);
+  E = 0;
+  if (!E) E |= !(pvl = gagePerVolumeNew(gctx, ndcv, kind));
+  if (!E) E |= gagePerVolumeAttach(gctx, pvl);
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, ksp->kernel, ksp->parm);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, item);
+  if (!E) E |= gageUpdate(gctx);
+  if (E) {
+    biffAddf(GAGE, "%s: trouble setting up gage", me);
+    airMopError(mop); return 1;
+  }
+  ans = gageAnswerPointer(gctx, pvl, item);
+  vlen = kind->valLen;
+  sx = AIR_UINT(gctx->shape->size[0]);
+  sy = AIR_UINT(gctx->shape->size[1]);
+  sz = AIR_UINT(gctx->shape->size[2]);
+  in = AIR_CAST(const double *, nin->data);
+  *diffP = 0;
+  for (zi=0; zi<sz; zi++) {
+    for (yi=0; yi<sy; yi++) {
+      for (xi=0; xi<sx; xi++) {
+        if (gageProbe(gctx, xi, yi, zi)) {
+          biffAddf(GAGE, "%s: probe error at (%u,%u,%u): %s", me,
+                   xi, yi, zi, gctx->errStr);
+          airMopError(mop); return 1;
+        }
+        for (vi=0; vi<vlen; vi++) {
+          dd = ans[vi] - in[vi + vlen*(xi + sx*(yi + sy*zi))];
+          dd = AIR_ABS(dd);
+          *diffP = AIR_MAX(*diffP, dd);
+        }
+      }
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  Nrrd *nin[2], *nout[2];
+  NrrdKernelSpec *ksp;
+  const NrrdKernel *kern[2];
+  const gageKind *kind[2];
+  double kparm[NRRD_KERNEL_PARMS_NUM], *in, diff;
+  size_t ii, NN;
+  unsigned int ki, ni, ti;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  airSrandMT(4242);
+  kind[0] = gageKindScl;
+  kind[1] = gageKindVec;
+  for (ni=0; ni<2; ni++) {
+    nin[ni] = nrrdNew();
+    airMopAdd(mop, nin[ni], (airMopper)nrrdNuke, airMopAlways);
+    nout[ni] = nrrdNew();
+    airMopAdd(mop, nout[ni], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (nrrdMaybeAlloc_va(nin[0], nrrdTypeDouble, 3,
+                        AIR_CAST(size_t, 19), AIR_CAST(size_t, 14),
+                        AIR_CAST(size_t, 7))
+      || nrrdMaybeAlloc_va(nin[1], nrrdTypeDouble, 4,
+                           AIR_CAST(size_t, 3), AIR_CAST(size_t, 11),
+                           AIR_CAST(size_t, 2), AIR_CAST(size_t, 9))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin[0], nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  nrrdAxisInfoSet_va(nin[1], nrrdAxisInfoSpacing, AIR_NAN, 1.0, 1.0, 1.0);
+  for (ni=0; ni<2; ni++) {
+    in = AIR_CAST(double *, nin[ni]->data);
+    NN = nrrdElementNumber(nin[ni]);
+    for (ii=0; ii<NN; ii++) {
+      in[ii] = airDrandMT() - 0.5;
+    }
+  }
+  ksp = nrrdKernelSpecNew();
+  airMopAdd(mop, ksp, (airMopper)nrrdKernelSpecNix, airMopAlways);
+  kparm[0] = 1;
+  kern[0] = nrrdKernelBSpline3;
+  kern[1] = nrrdKernelBSpline5;
+
+  for (ki=0; ki<2; ki++) {
+    nrrdKernelSpecSet(ksp, kern[ki], kparm);
+    for (ni=0; ni<2; ni++) {
+      for (ti=0; ti<2; ti++) {
+        nrrdStateThreadNum = ti ? THREAD_NUM : 1;
+        if (gageDeconvolveSeparable(nout[ti], nin[ni], kind[ni], ksp,
+                                    nrrdTypeDefault)) {
+          airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+          fprintf(stderr, "%s: trouble deconvolving %s with %s:\n%s",
+                  me, kind[ni]->name, kern[ki]->name, err);
+          airMopError(mop); return 1;
+        }
+      }
+      if (memcmp(nout[0]->data, nout[1]->data,
+                 nrrdElementNumber(nout[0])*sizeof(double))) {
+        fprintf(stderr, "%s: %s with %s: %u threads gave different "
+                "result than 1\n", me, kind[ni]->name, kern[ki]->name,
+                THREAD_NUM);
+        airMopError(mop); return 1;
+      }
+      if (deconvCheck(&diff, nin[ni], nout[0], kind[ni], ksp)) {
+        airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble checking:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      if (diff > 1e-12) {
+        fprintf(stderr, "%s: %s with %s: reconstruction differs from "
+                "input by %g\n", me, kind[ni]->name, kern[ki]->name, diff);
+        airMopError(mop); return 1;
+      }
+      fprintf(stderr, "%s: %s with %s: max diff %g\n", me,
+              kind[ni]->name, kern[ki]->name, diff);
+    }
+  }
+  nrrdStateThreadNum = 1;
+
+  airMopOkay(mop);
+  return 0;
+}
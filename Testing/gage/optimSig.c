@@ -0,0 +1,124 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** gageOptimSigCalculate with multiple threads, and repeated calls
+**   with different numbers of samples
+** gageOptimSigErrorPlot
+*/
+
+#define THREAD_NUM 3
+#define TRUE_NUM 30
+#define SAMPLE_MAX 4
+
+int
+main(int argc, const char **argv) {
+  airArray *mop;
+  char *err;
+  gageOptimSigContext *oscx;
+  NrrdKernelSpec *kss;
+  Nrrd *nplot;
+  double sigma[2][SAMPLE_MAX], finalErr[2], plotErr[TRUE_NUM], perr,
+    kparm[NRRD_KERNEL_PARMS_NUM];
+  const double *plot;
+  unsigned int ti, ii, num;
+
+  AIR_UNUSED(argc);
+  AIR_UNUSED(argv);
+  mop = airMopNew();
+  kss = nrrdKernelSpecNew();
+  airMopAdd(mop, kss, (airMopper)nrrdKernelSpecNix, airMopAlways);
+  kparm[0] = 1; /* not used */
+  nrrdKernelSpecSet(kss, nrrdKernelHermiteScaleSpaceFlag, kparm);
+  nplot = nrrdNew();
+  airMopAdd(mop, nplot, (airMopper)nrrdNuke, airMopAlways);
+  oscx = gageOptimSigContextNew(2, SAMPLE_MAX, TRUE_NUM, 0, 3, 3);
+  if (!oscx) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble making context:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, oscx, (airMopper)gageOptimSigContextNix, airMopAlways);
+
+  /* the optimization has to end up in the same place with one thread
+     and with THREAD_NUM threads, even after a call with fewer samples
+     (which the second call can't re-use errors from) */
+  for (ti=0; ti<2; ti++) {
+    oscx->threadNum = ti ? THREAD_NUM : 1;
+    /* the optimization uses airRandInt() */
+    airSrandMT(4242);
+    for (num=SAMPLE_MAX-1; num<=SAMPLE_MAX; num++) {
+      if (gageOptimSigCalculate(oscx, sigma[ti], num, kss,
+                                nrrdMeasureL2, nrrdMeasureL2,
+                                200, 0.001)) {
+        airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+        fprintf(stderr, "trouble optimizing %u samples with %u threads:\n%s",
+                num, oscx->threadNum, err);
+        airMopError(mop); return 1;
+      }
+    }
+    finalErr[ti] = oscx->finalErr;
+  }
+  for (ii=0; ii<SAMPLE_MAX; ii++) {
+    if (sigma[0][ii] != sigma[1][ii]) {
+      fprintf(stderr, "sigma[%u] %.17g with 1 thread, but %.17g with %u\n",
+              ii, sigma[0][ii], sigma[1][ii], THREAD_NUM);
+      airMopError(mop); return 1;
+    }
+  }
+  if (finalErr[0] != finalErr[1]) {
+    fprintf(stderr, "final error %.17g with 1 thread, but %.17g with %u\n",
+            finalErr[0], finalErr[1], THREAD_NUM);
+    airMopError(mop); return 1;
+  }
+
+  /* with two samples there's no optimization, just a measurement of
+     the errors at all scales, which has to match what the (single
+     threaded, not re-using anything) error plot says */
+  if (gageOptimSigCalculate(oscx, sigma[0], 2, kss,
+                            nrrdMeasureL2, nrrdMeasureL2, 0, 0.001)
+      || gageOptimSigErrorPlot(oscx, nplot, sigma[0], 2, kss,
+                               nrrdMeasureL2)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "trouble with two samples:\n%s", err);
+    airMopError(mop); return 1;
+  }
+  plot = AIR_CAST(const double *, nplot->data);
+  for (ii=0; ii<TRUE_NUM; ii++) {
+    plotErr[ii] = plot[1 + 2*ii];
+  }
+  nrrdMeasureLine[nrrdMeasureL2](&perr, nrrdTypeDouble,
+                                 plotErr, nrrdTypeDouble, TRUE_NUM,
+                                 AIR_NAN, AIR_NAN);
+  if (perr != oscx->finalErr) {
+    fprintf(stderr, "two-sample error %.17g, but plotted errors give %.17g\n",
+            oscx->finalErr, perr);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,188 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageProbeBatch, against gageProbeSpace at the same (randomly ordered,
+** partly outside the volume) positions, in index and world space
+*/
+
+#define POS_NUM 20000
+#define ANS_LEN (1 + 3 + 9)
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  Nrrd *nscl;
+  gageContext *gctx;
+  gagePerVolume *gpvl;
+  const gagePerVolume *bpvl[3];
+  const double *valAns, *grdAns, *hesAns;
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 0.0, 0.5},
+    *ipos, *wpos, *bans, sans[ANS_LEN], ww[4], sz[3];
+  int E, item[3], pret, bret, indexSpace;
+  unsigned int ii, ai, si, badNum;
+  size_t errIdx, firstBad;
+  airRandMTState *rng;
+  airArray *mop;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nscl = nrrdNew();
+  airMopAdd(mop, nscl, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nscl, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  gageParmSet(gctx, gageParmRenormalize, AIR_FALSE);
+  gageParmSet(gctx, gageParmCheckIntegrals, AIR_TRUE);
+  E = 0;
+  if (!E) E |= !(gpvl = gagePerVolumeNew(gctx, nscl, gageKindScl));
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, nrrdKernelBCCubic, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel11, nrrdKernelBCCubicD, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel22, nrrdKernelBCCubicDD, kparm);
+  if (!E) E |= gagePerVolumeAttach(gctx, gpvl);
+  if (!E) E |= gageQueryItemOn(gctx, gpvl, gageSclValue);
+  if (!E) E |= gageQueryItemOn(gctx, gpvl, gageSclGradVec);
+  if (!E) E |= gageQueryItemOn(gctx, gpvl, gageSclHessian);
+  if (!E) E |= gageUpdate(gctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+  valAns = gageAnswerPointer(gctx, gpvl, gageSclValue);
+  grdAns = gageAnswerPointer(gctx, gpvl, gageSclGradVec);
+  hesAns = gageAnswerPointer(gctx, gpvl, gageSclHessian);
+  bpvl[0] = bpvl[1] = bpvl[2] = gpvl;
+  item[0] = gageSclValue;
+  item[1] = gageSclGradVec;
+  item[2] = gageSclHessian;
+
+  ipos = AIR_CALLOC(3*POS_NUM, double);
+  airMopAdd(mop, ipos, airFree, airMopAlways);
+  wpos = AIR_CALLOC(3*POS_NUM, double);
+  airMopAdd(mop, wpos, airFree, airMopAlways);
+  bans = AIR_CALLOC(ANS_LEN*POS_NUM, double);
+  airMopAdd(mop, bans, airFree, airMopAlways);
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  if (!( ipos && wpos && bans && rng )) {
+    fprintf(stderr, "%s: couldn't allocate buffers\n", me);
+    airMopError(mop); return 1;
+  }
+  /* random index-space positions, a few percent of which are outside
+     (for either centering) */
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = AIR_CAST(double, gctx->shape->size[ai]);
+  }
+  for (ii=0; ii<POS_NUM; ii++) {
+    for (ai=0; ai<3; ai++) {
+      ipos[ai + 3*ii] = AIR_AFFINE(0, airDrandMT_r(rng), 1,
+                                   -0.6 - 0.01*sz[ai],
+                                   sz[ai] - 0.4 + 0.01*sz[ai]);
+    }
+    ELL_4V_SET(ww, ipos[0 + 3*ii], ipos[1 + 3*ii], ipos[2 + 3*ii], 1.0);
+    ELL_4MV_MUL(sans, gctx->shape->ItoW, ww);
+    ELL_4V_HOMOG(sans, sans);
+    ELL_3V_COPY(wpos + 3*ii, sans);
+  }
+
+  for (si=0; si<2; si++) {
+    indexSpace = !si;
+    bret = gageProbeBatch(gctx, bans, 0, bpvl, item, 3,
+                          indexSpace ? ipos : wpos, 3, POS_NUM,
+                          indexSpace, AIR_FALSE /* clamp */, &errIdx);
+    badNum = 0;
+    firstBad = POS_NUM;
+    for (ii=0; ii<POS_NUM; ii++) {
+      pret = (indexSpace
+              ? gageProbeSpace(gctx, ipos[0 + 3*ii], ipos[1 + 3*ii],
+                               ipos[2 + 3*ii], AIR_TRUE, AIR_FALSE)
+              : gageProbeSpace(gctx, wpos[0 + 3*ii], wpos[1 + 3*ii],
+                               wpos[2 + 3*ii], AIR_FALSE, AIR_FALSE));
+      if (pret) {
+        if (!badNum) {
+          firstBad = ii;
+        }
+        badNum++;
+        if (AIR_EXISTS(bans[ANS_LEN*ii])) {
+          fprintf(stderr, "%s: %s: batch answer at bad pos %u exists\n",
+                  me, indexSpace ? "index" : "world", ii);
+          airMopError(mop); return 1;
+        }
+        continue;
+      }
+      sans[0] = valAns[0];
+      ELL_3V_COPY(sans + 1, grdAns);
+      ELL_9V_COPY(sans + 4, hesAns);
+      for (ai=0; ai<ANS_LEN; ai++) {
+        /* the same computation, in a different order: must be equal */
+        if (sans[ai] != bans[ai + ANS_LEN*ii]) {
+          fprintf(stderr, "%s: %s: pos %u answer[%u]: batch %.17g != "
+                  "single %.17g\n", me, indexSpace ? "index" : "world",
+                  ii, ai, bans[ai + ANS_LEN*ii], sans[ai]);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+    if (!badNum || !bret || errIdx != firstBad) {
+      fprintf(stderr, "%s: %s: %u bad positions (first %u), but batch "
+              "returned %d (errIdx %u)\n", me,
+              indexSpace ? "index" : "world", badNum,
+              AIR_UINT(firstBad), bret, AIR_UINT(errIdx));
+      airMopError(mop); return 1;
+    }
+    fprintf(stderr, "%s: %s: %u positions, %u outside; all good\n", me,
+            indexSpace ? "index" : "world", POS_NUM, badNum);
+  }
+
+  /* a posStride too small for a position: nothing is probed */
+  errIdx = POS_NUM;
+  bans[0] = 42;
+  bret = gageProbeBatch(gctx, bans, 0, bpvl, item, 3, ipos, 2, POS_NUM,
+                        AIR_TRUE, AIR_FALSE, &errIdx);
+  if (!( bret && 0 == errIdx && gageErrUnknown == gctx->errNum
+         && 42 == bans[0] )) {
+    fprintf(stderr, "%s: with posStride 2, batch returned %d (errIdx %u, "
+            "errNum %d, out[0] %g)\n", me, bret, AIR_UINT(errIdx),
+            gctx->errNum, bans[0]);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
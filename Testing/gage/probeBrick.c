@@ -0,0 +1,369 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageParmBrick: probing along random rays, and at random points
+** (including near and past the edges), in a bricked copy of a volume
+** gives exactly the same answers as in the raster volume, for various
+** brick and kernel sizes, for scalar and vector kinds, and also in a
+** gageContextCopy of a context with bricked volumes.
+** gagePerVolumeDataChanged: after changing the data in place, probing
+** sees the new values
+*/
+
+#define RAY_NUM 30
+#define STEP_NUM 200
+
+typedef struct {
+  const gageKind *kind;
+  int item[3];
+} probeSpec;
+
+static gageContext *
+setup(airArray *mop, gagePerVolume **pvlP, const Nrrd *nin,
+      const probeSpec *spec, const NrrdKernel *const kern[3],
+      unsigned int brick) {
+  static const char me[]="setup";
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 1.0, 0.0};
+  gageContext *gctx;
+  gagePerVolume *pvl;
+  char *err;
+  int E;
+
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  gageParmSet(gctx, gageParmRenormalize, AIR_FALSE);
+  gageParmSet(gctx, gageParmCheckIntegrals, AIR_TRUE);
+  E = 0;
+  if (!E) E |= !(pvl = gagePerVolumeNew(gctx, nin, spec->kind));
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, kern[0], kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel11, kern[1], kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel22, kern[2], kparm);
+  if (!E) E |= gagePerVolumeAttach(gctx, pvl);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, spec->item[0]);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, spec->item[1]);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, spec->item[2]);
+  /* set after attaching, to make sure that gageUpdate does the work */
+  gageParmSet(gctx, gageParmBrick, brick);
+  if (!E) E |= gageUpdate(gctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+    return NULL;
+  }
+  if (!brick != !pvl->brickData) {
+    fprintf(stderr, "%s: brick %u but brickData %p\n", me, brick,
+            pvl->brickData);
+    return NULL;
+  }
+  *pvlP = pvl;
+  return gctx;
+}
+
+/* probes gctx[0] and gctx[1] at pos, and compares all answers */
+static int
+probeCompare(gageContext *gctx[2], gagePerVolume *gpvl[2],
+             const probeSpec *spec, const double pos[3], int clamp) {
+  static const char me[]="probeCompare";
+  const double *ans[2];
+  unsigned int ci, ii, ai, alen;
+
+  for (ci=0; ci<2; ci++) {
+    if (gageProbeSpace(gctx[ci], pos[0], pos[1], pos[2],
+                       AIR_TRUE /* indexSpace */, clamp)) {
+      fprintf(stderr, "%s: probe (%g,%g,%g) failed:\n%s\n", me,
+              pos[0], pos[1], pos[2], gctx[ci]->errStr);
+      return 1;
+    }
+  }
+  for (ii=0; ii<3; ii++) {
+    ans[0] = gageAnswerPointer(gctx[0], gpvl[0], spec->item[ii]);
+    ans[1] = gageAnswerPointer(gctx[1], gpvl[1], spec->item[ii]);
+    alen = gageAnswerLength(gctx[0], gpvl[0], spec->item[ii]);
+    for (ai=0; ai<alen; ai++) {
+      if (ans[0][ai] != ans[1][ai]) {
+        fprintf(stderr, "%s: at (%g,%g,%g): %s item %d[%u] bricked %.17g "
+                "!= raster %.17g\n", me, pos[0], pos[1], pos[2],
+                spec->kind->name, spec->item[ii], ai, ans[1][ai],
+                ans[0][ai]);
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static int
+brickCheck(const Nrrd *nin, const probeSpec *spec,
+           const NrrdKernel *const kern[3], unsigned int brick,
+           airRandMTState *rng) {
+  static const char me[]="brickCheck";
+  gageContext *gctx[2], *gcopy;
+  gagePerVolume *gpvl[2];
+  double pos[3], dir[3], len, sz[3];
+  unsigned int ri, si, ai;
+  airArray *mop;
+
+  mop = airMopNew();
+  /* gctx[0] uses the raster volume, gctx[1] the bricked copy */
+  if (!( (gctx[0] = setup(mop, gpvl + 0, nin, spec, kern, 0))
+         && (gctx[1] = setup(mop, gpvl + 1, nin, spec, kern, brick)) )) {
+    airMopError(mop); return 1;
+  }
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = AIR_CAST(double, gctx[0]->shape->size[ai]);
+  }
+  for (ri=0; ri<RAY_NUM; ri++) {
+    /* rays as in probeShift.c, which also exercise _gageIv3Shift */
+    for (ai=0; ai<3; ai++) {
+      pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, sz[ai]-1);
+    }
+    airNormalRand_r(dir + 0, dir + 1, rng);
+    airNormalRand_r(dir + 2, NULL, rng);
+    if (ri % 4) {
+      dir[(ri % 4) - 1] *= 30;
+    }
+    ELL_3V_NORM(dir, dir, len);
+    ELL_3V_SCALE(dir, 0.33, dir);
+    for (si=0; si<STEP_NUM; si++) {
+      if (probeCompare(gctx, gpvl, spec, pos, AIR_FALSE)) {
+        fprintf(stderr, "%s: (ray %u step %u)\n", me, ri, si);
+        airMopError(mop); return 1;
+      }
+      for (ai=0; ai<3; ai++) {
+        pos[ai] += dir[ai];
+        if (pos[ai] < 0 || pos[ai] > sz[ai]-1) {
+          dir[ai] *= -1;
+          pos[ai] += 2*dir[ai];
+        }
+      }
+    }
+  }
+  /* random points, with clamping from a bit outside the volume */
+  for (ri=0; ri<RAY_NUM*STEP_NUM/4; ri++) {
+    for (ai=0; ai<3; ai++) {
+      pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -2, sz[ai]+1);
+    }
+    if (probeCompare(gctx, gpvl, spec, pos, AIR_TRUE)) {
+      airMopError(mop); return 1;
+    }
+  }
+  /* a copy of the bricked context has its own bricked copy */
+  gcopy = gageContextCopy(gctx[1]);
+  if (!gcopy) {
+    char *err;
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble copying:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+  airMopAdd(mop, gcopy, (airMopper)gageContextNix, airMopAlways);
+  if (!( gcopy->pvl[0]->brickData
+         && gcopy->pvl[0]->brickData != gpvl[1]->brickData )) {
+    fprintf(stderr, "%s: copy's brickData %p not its own (orig %p)\n", me,
+            gcopy->pvl[0]->brickData, gpvl[1]->brickData);
+    airMopError(mop); return 1;
+  }
+  gctx[1] = gcopy;
+  gpvl[1] = gcopy->pvl[0];
+  for (ri=0; ri<RAY_NUM*STEP_NUM/4; ri++) {
+    for (ai=0; ai<3; ai++) {
+      pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -2, sz[ai]+1);
+    }
+    if (probeCompare(gctx, gpvl, spec, pos, AIR_TRUE)) {
+      airMopError(mop); return 1;
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** probes a bricked copy of nin, doubles the values of the copy in
+** place, and checks that (after gagePerVolumeDataChanged and
+** gageUpdate) the answers double too
+*/
+static int
+changeCheck(const Nrrd *nin, const probeSpec *spec,
+            const NrrdKernel *const kern[3]) {
+  static const char me[]="changeCheck";
+  gageContext *gctx;
+  gagePerVolume *gpvl;
+  Nrrd *ncopy;
+  double pos[3] = {10.3, 11.7, 7.2}, *data, prev[3][9];
+  const double *ans;
+  unsigned int ii, ai, alen;
+  size_t NN;
+  char *err;
+  airArray *mop;
+
+  mop = airMopNew();
+  ncopy = nrrdNew();
+  airMopAdd(mop, ncopy, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdConvert(ncopy, nin, nrrdTypeDouble)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble copying:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (!(gctx = setup(mop, &gpvl, ncopy, spec, kern, 4))) {
+    airMopError(mop); return 1;
+  }
+  if (gageProbeSpace(gctx, pos[0], pos[1], pos[2], AIR_TRUE, AIR_FALSE)) {
+    fprintf(stderr, "%s: probe failed:\n%s\n", me, gctx->errStr);
+    airMopError(mop); return 1;
+  }
+  for (ii=0; ii<3; ii++) {
+    ans = gageAnswerPointer(gctx, gpvl, spec->item[ii]);
+    alen = gageAnswerLength(gctx, gpvl, spec->item[ii]);
+    for (ai=0; ai<alen; ai++) {
+      prev[ii][ai] = ans[ai];
+    }
+  }
+  data = AIR_CAST(double *, ncopy->data);
+  NN = nrrdElementNumber(ncopy);
+  while (NN--) {
+    data[NN] *= 2;
+  }
+  if (gagePerVolumeDataChanged(gpvl)
+      || gageUpdate(gctx)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble updating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (!gpvl->brickData) {
+    fprintf(stderr, "%s: bricked copy not re-made\n", me);
+    airMopError(mop); return 1;
+  }
+  if (gageProbeSpace(gctx, pos[0], pos[1], pos[2], AIR_TRUE, AIR_FALSE)) {
+    fprintf(stderr, "%s: probe failed:\n%s\n", me, gctx->errStr);
+    airMopError(mop); return 1;
+  }
+  for (ii=0; ii<3; ii++) {
+    ans = gageAnswerPointer(gctx, gpvl, spec->item[ii]);
+    alen = gageAnswerLength(gctx, gpvl, spec->item[ii]);
+    for (ai=0; ai<alen; ai++) {
+      if (ans[ai] != 2*prev[ii][ai]) {
+        fprintf(stderr, "%s: item %d[%u] %.17g after doubling data, "
+                "not 2*%.17g\n", me, spec->item[ii], ai, ans[ai],
+                prev[ii][ai]);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  Nrrd *nscl, *ncmp[3], *nvec;
+  const Nrrd *nin[2];
+  const NrrdKernel *kern[4][3] = {
+    {nrrdKernelTent, nrrdKernelForwDiff, nrrdKernelForwDiff},
+    {nrrdKernelBCCubic, nrrdKernelBCCubicD, nrrdKernelBCCubicDD},
+    {nrrdKernelC4Hexic, nrrdKernelC4HexicD, nrrdKernelC4HexicDD},
+    {nrrdKernelC5Septic, nrrdKernelC5SepticD, nrrdKernelC5SepticDD}};
+  probeSpec spec[2] = {
+    {NULL, {gageSclValue, gageSclGradVec, gageSclHessian}},
+    {NULL, {gageVecVector, gageVecJacobian, gageVecHessian}}};
+  unsigned int brick[4] = {2, 4, 8, 16}, ki, bi, vi, ci;
+  int axmap[4] = {-1, 0, 1, 2};
+  airRandMTState *rng;
+  airArray *mop;
+  int E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nscl = nrrdNew();
+  airMopAdd(mop, nscl, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nscl, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+  /* a float vector volume with components f, sin(f), cos(f) */
+  for (ci=0; ci<3; ci++) {
+    ncmp[ci] = nrrdNew();
+    airMopAdd(mop, ncmp[ci], (airMopper)nrrdNuke, airMopAlways);
+  }
+  nvec = nrrdNew();
+  airMopAdd(mop, nvec, (airMopper)nrrdNuke, airMopAlways);
+  E = 0;
+  if (!E) E |= nrrdConvert(ncmp[0], nscl, nrrdTypeFloat);
+  if (!E) E |= nrrdArithUnaryOp(ncmp[1], nrrdUnaryOpSin, ncmp[0]);
+  if (!E) E |= nrrdArithUnaryOp(ncmp[2], nrrdUnaryOpCos, ncmp[0]);
+  if (!E) E |= nrrdJoin(nvec, AIR_CAST(const Nrrd *const *, ncmp), 3, 0,
+                        AIR_TRUE);
+  if (!E) E |= nrrdAxisInfoCopy(nvec, nscl, axmap, NRRD_AXIS_INFO_NONE);
+  if (!E) E |= nrrdBasicInfoCopy(nvec, nscl,
+                                 NRRD_BASIC_INFO_DATA_BIT
+                                 | NRRD_BASIC_INFO_TYPE_BIT
+                                 | NRRD_BASIC_INFO_BLOCKSIZE_BIT
+                                 | NRRD_BASIC_INFO_DIMENSION_BIT
+                                 | NRRD_BASIC_INFO_CONTENT_BIT
+                                 | NRRD_BASIC_INFO_COMMENTS_BIT
+                                 | NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making vector volume:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nvec->axis[0].kind = nrrdKind3Vector;
+  nin[0] = nscl;
+  nin[1] = nvec;
+  spec[0].kind = gageKindScl;
+  spec[1].kind = gageKindVec;
+
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  for (vi=0; vi<2; vi++) {
+    for (ki=0; ki<4; ki++) {
+      for (bi=0; bi<4; bi++) {
+        if (brickCheck(nin[vi], spec + vi, kern[ki], brick[bi], rng)) {
+          fprintf(stderr, "%s: problem with %s kind, fd %u, brick %u\n",
+                  me, spec[vi].kind->name, 2*(ki+1), brick[bi]);
+          airMopError(mop); return 1;
+        }
+      }
+      fprintf(stderr, "%s: %s kind, fd %u: all bricks okay\n", me,
+              spec[vi].kind->name, 2*(ki+1));
+    }
+  }
+  if (changeCheck(nscl, spec + 0, kern[1])) {
+    fprintf(stderr, "%s: problem after changing data\n", me);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
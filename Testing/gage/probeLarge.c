@@ -0,0 +1,185 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+
+/*
+** Tests:
+** probing in a volume with more than 2^32 samples: the answers in the
+** far corner of the volume (where the sample indices are beyond 2^32)
+** are exactly the same as those at the same place in a small volume
+** cropped out of that corner, both inside and near the edge of the
+** volume, and with and without iv3 shifting.
+**
+** The large volume is allocated but only the corner is touched, so
+** this needs virtual memory more than physical memory; if allocation
+** fails, the test is skipped (passes).
+*/
+
+/* 2048*2048*1040 > 2^32 */
+#define SX 2048
+#define SY 2048
+#define SZ 1040
+/* size of the corner that is set and cropped */
+#define CC 16
+#define POS_NUM 2000
+#define ANS_LEN (1 + 3 + 9)
+
+static int
+contextSetup(gageContext **gctxP, airArray *mop, const Nrrd *nin) {
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 0.0, 0.5};
+  gagePerVolume *gpvl;
+  int E;
+
+  *gctxP = gageContextNew();
+  airMopAdd(mop, *gctxP, (airMopper)gageContextNix, airMopAlways);
+  gageParmSet(*gctxP, gageParmRenormalize, AIR_FALSE);
+  gageParmSet(*gctxP, gageParmCheckIntegrals, AIR_TRUE);
+  /* else both volumes are crammed into the same bi-unit cube */
+  gageParmSet(*gctxP, gageParmOrientationFromSpacing, AIR_TRUE);
+  E = 0;
+  if (!E) E |= !(gpvl = gagePerVolumeNew(*gctxP, nin, gageKindScl));
+  if (!E) E |= gageKernelSet(*gctxP, gageKernel00, nrrdKernelC4Hexic, kparm);
+  if (!E) E |= gageKernelSet(*gctxP, gageKernel11, nrrdKernelC4HexicD, kparm);
+  if (!E) E |= gageKernelSet(*gctxP, gageKernel22, nrrdKernelC4HexicDD,
+                             kparm);
+  if (!E) E |= gagePerVolumeAttach(*gctxP, gpvl);
+  if (!E) E |= gageQueryItemOn(*gctxP, gpvl, gageSclValue);
+  if (!E) E |= gageQueryItemOn(*gctxP, gpvl, gageSclGradVec);
+  if (!E) E |= gageQueryItemOn(*gctxP, gpvl, gageSclHessian);
+  if (!E) E |= gageUpdate(*gctxP);
+  return E;
+}
+
+static void
+answerCopy(double *out, gageContext *ctx) {
+  const double *vv, *gg, *hh;
+  unsigned int ii;
+
+  vv = gageAnswerPointer(ctx, ctx->pvl[0], gageSclValue);
+  gg = gageAnswerPointer(ctx, ctx->pvl[0], gageSclGradVec);
+  hh = gageAnswerPointer(ctx, ctx->pvl[0], gageSclHessian);
+  out[0] = vv[0];
+  for (ii=0; ii<3; ii++) {
+    out[1 + ii] = gg[ii];
+  }
+  for (ii=0; ii<9; ii++) {
+    out[4 + ii] = hh[ii];
+  }
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  Nrrd *nbig, *nsmall;
+  unsigned char *data;
+  gageContext *gctxBig, *gctxSmall;
+  size_t xi, yi, zi, cmin[3], cmax[3];
+  double pos[3], ansBig[ANS_LEN], ansSmall[ANS_LEN];
+  unsigned int pi, ai, ii, shift;
+  airRandMTState *rng;
+  airArray *mop;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nbig = nrrdNew();
+  airMopAdd(mop, nbig, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdAlloc_va(nbig, nrrdTypeUChar, 3, AIR_CAST(size_t, SX),
+                   AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: couldn't allocate large volume; skipping test:\n%s",
+            me, err);
+    airMopOkay(mop); return 0;
+  }
+  nrrdAxisInfoSet_va(nbig, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  /* set a pseudo-random corner */
+  data = AIR_CAST(unsigned char *, nbig->data);
+  for (zi=SZ-CC; zi<SZ; zi++) {
+    for (yi=SY-CC; yi<SY; yi++) {
+      for (xi=SX-CC; xi<SX; xi++) {
+        data[xi + SX*(yi + AIR_CAST(size_t, SY)*zi)]
+          = AIR_CAST(unsigned char, (xi*7 + yi*13 + zi*29 + xi*yi*zi) % 251);
+      }
+    }
+  }
+  nsmall = nrrdNew();
+  airMopAdd(mop, nsmall, (airMopper)nrrdNuke, airMopAlways);
+  ELL_3V_SET(cmin, SX-CC, SY-CC, SZ-CC);
+  ELL_3V_SET(cmax, SX-1, SY-1, SZ-1);
+  if (nrrdCrop(nsmall, nbig, cmin, cmax)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble cropping:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (contextSetup(&gctxBig, mop, nbig)
+      || contextSetup(&gctxSmall, mop, nsmall)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  for (shift=0; shift<2; shift++) {
+    gageParmSet(gctxBig, gageParmIv3Shift, shift);
+    gageParmSet(gctxSmall, gageParmIv3Shift, shift);
+    for (pi=0; pi<POS_NUM; pi++) {
+      if (pi % 8) {
+        /* unit steps, so that shifting happens */
+        pos[pi % 3] = AIR_MIN(pos[pi % 3] + 1, CC - 1);
+      } else {
+        /* away from the low edge of the small volume (which is not an
+           edge of the large one), but up to the high edge of both.
+           Positions are multiples of 1/64 so that they are the same
+           fraction of a sample in both volumes */
+        for (ai=0; ai<3; ai++) {
+          pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, 2, CC - 1);
+          pos[ai] = floor(64*pos[ai])/64;
+        }
+      }
+      if (gageProbe(gctxBig, SX-CC + pos[0], SY-CC + pos[1], SZ-CC + pos[2])
+          || gageProbe(gctxSmall, pos[0], pos[1], pos[2])) {
+        fprintf(stderr, "%s: probe %u at (%g,%g,%g) failed:\n%s\n%s\n", me,
+                pi, pos[0], pos[1], pos[2],
+                gctxBig->errStr, gctxSmall->errStr);
+        airMopError(mop); return 1;
+      }
+      answerCopy(ansBig, gctxBig);
+      answerCopy(ansSmall, gctxSmall);
+      for (ii=0; ii<ANS_LEN; ii++) {
+        if (ansBig[ii] != ansSmall[ii]) {
+          fprintf(stderr, "%s: (shift %u) probe %u at (%g,%g,%g) answer[%u]: "
+                  "large %.17g != small %.17g\n", me, shift, pi,
+                  pos[0], pos[1], pos[2], ii, ansBig[ii], ansSmall[ii]);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,234 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageParmMultiScl: with six scalar volumes (of different types, and
+** with different queries) and one vector volume attached, probing along
+** random rays and at random points (including past the edges) gives
+** exactly the same answers with the scalar volumes filtered together as
+** one at a time, for various kernel sizes, and also with a probe state
+*/
+
+#define SCL_NUM 6
+#define RAY_NUM 20
+#define STEP_NUM 100
+#define POINT_NUM 500
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  Nrrd *nin, *ntmp, *nscl[SCL_NUM], *ncmp[3], *nvec;
+  gageContext *gctx[2], *pctx[2];
+  gagePerVolume *pvl;
+  gageProbeState *gps;
+  const double *ans[2];
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 1.0, 0.0},
+    pos[3], dir[3], len, sz[3];
+  const NrrdKernel *kern[4][3] = {
+    {nrrdKernelTent, nrrdKernelForwDiff, nrrdKernelForwDiff},
+    {nrrdKernelBCCubic, nrrdKernelBCCubicD, nrrdKernelBCCubicDD},
+    {nrrdKernelC4Hexic, nrrdKernelC4HexicD, nrrdKernelC4HexicDD},
+    {nrrdKernelC5Septic, nrrdKernelC5SepticD, nrrdKernelC5SepticDD}};
+  int type[SCL_NUM] = {nrrdTypeShort, nrrdTypeDouble, nrrdTypeFloat,
+                       nrrdTypeUChar, nrrdTypeFloat, nrrdTypeDouble};
+  int axmap[4] = {-1, 0, 1, 2};
+  unsigned int ki, si, ci, ai, pi, vi, alen;
+  airRandMTState *rng;
+  airArray *mop;
+  int E, item, clamp;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nin, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+  ntmp = nrrdNew();
+  airMopAdd(mop, ntmp, (airMopper)nrrdNuke, airMopAlways);
+  for (ci=0; ci<3; ci++) {
+    ncmp[ci] = nrrdNew();
+    airMopAdd(mop, ncmp[ci], (airMopper)nrrdNuke, airMopAlways);
+  }
+  nvec = nrrdNew();
+  airMopAdd(mop, nvec, (airMopper)nrrdNuke, airMopAlways);
+  E = 0;
+  /* scalar volumes quantized f, sin(f), cos(f), ... of different types */
+  if (!E) E |= nrrdConvert(ncmp[0], nin, nrrdTypeDouble);
+  if (!E) E |= nrrdArithUnaryOp(ncmp[1], nrrdUnaryOpSin, ncmp[0]);
+  if (!E) E |= nrrdArithUnaryOp(ncmp[2], nrrdUnaryOpCos, ncmp[0]);
+  if (!E) E |= nrrdQuantize(ntmp, ncmp[0], NULL, 8);
+  for (si=0; !E && si<SCL_NUM; si++) {
+    nscl[si] = nrrdNew();
+    airMopAdd(mop, nscl[si], (airMopper)nrrdNuke, airMopAlways);
+    E |= nrrdConvert(nscl[si], si % 3 ? ncmp[si % 3] : ntmp, type[si]);
+  }
+  if (!E) E |= nrrdJoin(nvec, AIR_CAST(const Nrrd *const *, ncmp), 3, 0,
+                        AIR_TRUE);
+  if (!E) E |= nrrdAxisInfoCopy(nvec, nin, axmap, NRRD_AXIS_INFO_NONE);
+  if (!E) E |= nrrdBasicInfoCopy(nvec, nin,
+                                 NRRD_BASIC_INFO_DATA_BIT
+                                 | NRRD_BASIC_INFO_TYPE_BIT
+                                 | NRRD_BASIC_INFO_BLOCKSIZE_BIT
+                                 | NRRD_BASIC_INFO_DIMENSION_BIT
+                                 | NRRD_BASIC_INFO_CONTENT_BIT
+                                 | NRRD_BASIC_INFO_COMMENTS_BIT
+                                 | NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making volumes:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nvec->axis[0].kind = nrrdKind3Vector;
+
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  for (ki=0; ki<4; ki++) {
+    /* gctx[0] filters one at a time, gctx[1] filters together */
+    for (ci=0; ci<2; ci++) {
+      gctx[ci] = gageContextNew();
+      airMopAdd(mop, gctx[ci], (airMopper)gageContextNix, airMopAlways);
+      gageParmSet(gctx[ci], gageParmRenormalize, AIR_FALSE);
+      gageParmSet(gctx[ci], gageParmCheckIntegrals, AIR_TRUE);
+      gageParmSet(gctx[ci], gageParmMultiScl, ci);
+      E = 0;
+      if (!E) E |= gageKernelSet(gctx[ci], gageKernel00, kern[ki][0], kparm);
+      if (!E) E |= gageKernelSet(gctx[ci], gageKernel11, kern[ki][1], kparm);
+      if (!E) E |= gageKernelSet(gctx[ci], gageKernel22, kern[ki][2], kparm);
+      for (si=0; !E && si<SCL_NUM; si++) {
+        if (2 == si) {
+          /* the vector volume goes in the middle of the scalar ones */
+          if (!E) E |= !(pvl = gagePerVolumeNew(gctx[ci], nvec, gageKindVec));
+          if (!E) E |= gagePerVolumeAttach(gctx[ci], pvl);
+          if (!E) E |= gageQueryItemOn(gctx[ci], pvl, gageVecJacobian);
+        }
+        if (!E) E |= !(pvl = gagePerVolumeNew(gctx[ci], nscl[si],
+                                              gageKindScl));
+        if (!E) E |= gagePerVolumeAttach(gctx[ci], pvl);
+        /* different pervolumes need different derivatives */
+        if (!E) E |= gageQueryItemOn(gctx[ci], pvl, (1 == si % 3
+                                                     ? gageSclGradMag
+                                                     : gageSclValue));
+        if (2 == si % 3) {
+          if (!E) E |= gageQueryItemOn(gctx[ci], pvl, gageSclNormal);
+          if (!E) E |= gageQueryItemOn(gctx[ci], pvl, gageSclHessEval);
+        }
+      }
+      if (!E) E |= gageUpdate(gctx[ci]);
+      if (E) {
+        airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+        airMopError(mop); return 1;
+      }
+    }
+    gps = gageProbeStateNew(gctx[1]);
+    if (!gps) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble making probe state:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, gps, (airMopper)gageProbeStateNix, airMopAlways);
+    for (ai=0; ai<3; ai++) {
+      sz[ai] = AIR_CAST(double, gctx[0]->shape->size[ai]);
+    }
+    /* first along random rays (reflected off the volume bounds), then at
+       random points, with clamping from a bit outside the volume, and
+       finally at random points in a probe state of the gctx[1] */
+    pctx[0] = gctx[0];
+    for (pi=0; pi<RAY_NUM*STEP_NUM + 2*POINT_NUM; pi++) {
+      if (pi < RAY_NUM*STEP_NUM) {
+        if (!(pi % STEP_NUM)) {
+          for (ai=0; ai<3; ai++) {
+            pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, sz[ai]-1);
+          }
+          airNormalRand_r(dir + 0, dir + 1, rng);
+          airNormalRand_r(dir + 2, NULL, rng);
+          ELL_3V_NORM(dir, dir, len);
+          ELL_3V_SCALE(dir, 0.33, dir);
+        } else {
+          for (ai=0; ai<3; ai++) {
+            pos[ai] += dir[ai];
+            if (pos[ai] < 0 || pos[ai] > sz[ai]-1) {
+              dir[ai] *= -1;
+              pos[ai] += 2*dir[ai];
+            }
+          }
+        }
+        clamp = AIR_FALSE;
+      } else {
+        for (ai=0; ai<3; ai++) {
+          pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -2, sz[ai]+1);
+        }
+        clamp = AIR_TRUE;
+      }
+      pctx[1] = (pi < RAY_NUM*STEP_NUM + POINT_NUM
+                 ? gctx[1]
+                 : gps->ctx);
+      for (ci=0; ci<2; ci++) {
+        if (gageProbeSpace(pctx[ci], pos[0], pos[1], pos[2],
+                           AIR_TRUE /* indexSpace */, clamp)) {
+          fprintf(stderr, "%s: probe (%g,%g,%g) failed:\n%s\n", me,
+                  pos[0], pos[1], pos[2], pctx[ci]->errStr);
+          airMopError(mop); return 1;
+        }
+      }
+      for (vi=0; vi<pctx[0]->pvlNum; vi++) {
+        pvl = pctx[0]->pvl[vi];
+        for (item=1; item<=pvl->kind->itemMax; item++) {
+          if (!GAGE_QUERY_ITEM_TEST(pvl->query, item)) {
+            continue;
+          }
+          ans[0] = gageAnswerPointer(pctx[0], pctx[0]->pvl[vi], item);
+          ans[1] = gageAnswerPointer(pctx[1], pctx[1]->pvl[vi], item);
+          alen = gageAnswerLength(pctx[0], pctx[0]->pvl[vi], item);
+          for (ai=0; ai<alen; ai++) {
+            if (ans[0][ai] != ans[1][ai]) {
+              fprintf(stderr, "%s: fd %u, probe %u at (%g,%g,%g): pvl[%u] "
+                      "%s item %s[%u] together %.17g != separately %.17g\n",
+                      me, 2*(ki+1), pi, pos[0], pos[1], pos[2], vi,
+                      pvl->kind->name, airEnumStr(pvl->kind->enm, item), ai,
+                      ans[1][ai], ans[0][ai]);
+              airMopError(mop); return 1;
+            }
+          }
+        }
+      }
+    }
+    fprintf(stderr, "%s: fd %u okay\n", me, 2*(ki+1));
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
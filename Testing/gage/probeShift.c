@@ -0,0 +1,163 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageParmIv3Shift: probing along random rays through (and near the
+** edges of) a volume gives exactly the same answers with and without
+** shifting the iv3 cache, and the iv3FillNum and iv3ShiftNum counters
+** add up to the number of times the neighborhood changed
+*/
+
+#define RAY_NUM 200
+#define STEP_NUM 300
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  Nrrd *nscl;
+  gageContext *gctx[2];
+  gagePerVolume *gpvl[2];
+  const double *ans[2][3];
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0},
+    pos[3], dir[3], len, sz[3];
+  int E;
+  unsigned int ri, si, ci, ai, ii, probeNum, ansLen[3] = {1, 3, 9};
+  airRandMTState *rng;
+  airArray *mop;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nscl = nrrdNew();
+  airMopAdd(mop, nscl, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nscl, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+
+  /* gctx[0] shifts iv3, gctx[1] always refills it */
+  for (ci=0; ci<2; ci++) {
+    gctx[ci] = gageContextNew();
+    airMopAdd(mop, gctx[ci], (airMopper)gageContextNix, airMopAlways);
+    gageParmSet(gctx[ci], gageParmRenormalize, AIR_FALSE);
+    gageParmSet(gctx[ci], gageParmCheckIntegrals, AIR_TRUE);
+    gageParmSet(gctx[ci], gageParmIv3Shift, !ci);
+    E = 0;
+    if (!E) E |= !(gpvl[ci] = gagePerVolumeNew(gctx[ci], nscl, gageKindScl));
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel00,
+                               nrrdKernelC4Hexic, kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel11,
+                               nrrdKernelC4HexicD, kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel22,
+                               nrrdKernelC4HexicDD, kparm);
+    if (!E) E |= gagePerVolumeAttach(gctx[ci], gpvl[ci]);
+    if (!E) E |= gageQueryItemOn(gctx[ci], gpvl[ci], gageSclValue);
+    if (!E) E |= gageQueryItemOn(gctx[ci], gpvl[ci], gageSclGradVec);
+    if (!E) E |= gageQueryItemOn(gctx[ci], gpvl[ci], gageSclHessian);
+    if (!E) E |= gageUpdate(gctx[ci]);
+    if (E) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
+    ans[ci][0] = gageAnswerPointer(gctx[ci], gpvl[ci], gageSclValue);
+    ans[ci][1] = gageAnswerPointer(gctx[ci], gpvl[ci], gageSclGradVec);
+    ans[ci][2] = gageAnswerPointer(gctx[ci], gpvl[ci], gageSclHessian);
+  }
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = AIR_CAST(double, gctx[0]->shape->size[ai]);
+  }
+
+  probeNum = 0;
+  for (ri=0; ri<RAY_NUM; ri++) {
+    /* random start, and random direction; each step is about a third
+       of a voxel, and the ray is reflected off the volume bounds */
+    for (ai=0; ai<3; ai++) {
+      pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, 0, sz[ai]-1);
+    }
+    airNormalRand_r(dir + 0, dir + 1, rng);
+    airNormalRand_r(dir + 2, NULL, rng);
+    if (ri % 4) {
+      /* mostly axis-aligned rays, like scanlines */
+      dir[(ri % 4) - 1] *= 30;
+    }
+    ELL_3V_NORM(dir, dir, len);
+    ELL_3V_SCALE(dir, 0.33, dir);
+    for (si=0; si<STEP_NUM; si++) {
+      for (ci=0; ci<2; ci++) {
+        if (gageProbeSpace(gctx[ci], pos[0], pos[1], pos[2],
+                           AIR_TRUE /* indexSpace */, AIR_FALSE)) {
+          fprintf(stderr, "%s: probe (%g,%g,%g) failed:\n%s\n", me,
+                  pos[0], pos[1], pos[2], gctx[ci]->errStr);
+          airMopError(mop); return 1;
+        }
+      }
+      probeNum++;
+      for (ii=0; ii<3; ii++) {
+        for (ai=0; ai<ansLen[ii]; ai++) {
+          if (ans[0][ii][ai] != ans[1][ii][ai]) {
+            fprintf(stderr, "%s: ray %u step %u at (%g,%g,%g): answer %u[%u] "
+                    "with shift %.17g != without %.17g\n", me, ri, si,
+                    pos[0], pos[1], pos[2], ii, ai,
+                    ans[0][ii][ai], ans[1][ii][ai]);
+            airMopError(mop); return 1;
+          }
+        }
+      }
+      for (ai=0; ai<3; ai++) {
+        pos[ai] += dir[ai];
+        if (pos[ai] < 0 || pos[ai] > sz[ai]-1) {
+          dir[ai] *= -1;
+          pos[ai] += 2*dir[ai];
+        }
+      }
+    }
+  }
+  if (!( gctx[0]->iv3ShiftNum > 0
+         && 0 == gctx[1]->iv3ShiftNum
+         && (gctx[0]->iv3FillNum + gctx[0]->iv3ShiftNum
+             == gctx[1]->iv3FillNum) )) {
+    fprintf(stderr, "%s: bad counts: with shift %u fill, %u shift; "
+            "without shift %u fill, %u shift\n", me,
+            AIR_UINT(gctx[0]->iv3FillNum), AIR_UINT(gctx[0]->iv3ShiftNum),
+            AIR_UINT(gctx[1]->iv3FillNum), AIR_UINT(gctx[1]->iv3ShiftNum));
+    airMopError(mop); return 1;
+  }
+  fprintf(stderr, "%s: %u probes: %u full iv3 fills, %u shifts (vs %u)\n",
+          me, probeNum, AIR_UINT(gctx[0]->iv3FillNum),
+          AIR_UINT(gctx[0]->iv3ShiftNum), AIR_UINT(gctx[1]->iv3FillNum));
+
+  airMopOkay(mop);
+  return 0;
+}
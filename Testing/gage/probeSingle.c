@@ -0,0 +1,219 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageParmSinglePrecision: the answers from single-precision filtering are
+** close to those from double-precision filtering, for the scalar kind (in
+** a double volume) and the vector kind (in a float volume), at random
+** positions including those near the edges, for various kernel sizes.
+** This includes gageSclMedian, which reads the value cache directly
+*/
+
+#define POS_NUM 4000
+
+/* the largest error allowed for each item, relative to the largest
+   answer magnitude; observed errors are around 1e-6, mostly from
+   cancellation in the float accumulation of derivative filtering */
+#define REL_ERR_MAX 1e-5
+
+typedef struct {
+  const gageKind *kind;
+  int item[3];
+  const char *itemStr[3];
+} probeSpec;
+
+static int
+probeSingle(const char *me, const Nrrd *nin, const probeSpec *spec,
+            const NrrdKernel *const kern[3], airRandMTState *rng) {
+  gageContext *gctx[2];
+  gagePerVolume *gpvl[2];
+  const double *ans[2][3];
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 0.0, 0.5}, pos[3], sz[3],
+    maxAns[3], maxErr[3], dd;
+  unsigned int ci, ii, pi, ai, alen[3];
+  int E;
+  airArray *mop;
+  char *err;
+
+  mop = airMopNew();
+  /* gctx[0] is double precision, gctx[1] is single */
+  for (ci=0; ci<2; ci++) {
+    gctx[ci] = gageContextNew();
+    airMopAdd(mop, gctx[ci], (airMopper)gageContextNix, airMopAlways);
+    gageParmSet(gctx[ci], gageParmRenormalize, AIR_FALSE);
+    gageParmSet(gctx[ci], gageParmCheckIntegrals, AIR_TRUE);
+    gageParmSet(gctx[ci], gageParmSinglePrecision, ci);
+    E = 0;
+    if (!E) E |= !(gpvl[ci] = gagePerVolumeNew(gctx[ci], nin, spec->kind));
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel00, kern[0], kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel11, kern[1], kparm);
+    if (!E) E |= gageKernelSet(gctx[ci], gageKernel22, kern[2], kparm);
+    if (!E) E |= gagePerVolumeAttach(gctx[ci], gpvl[ci]);
+    for (ii=0; ii<3; ii++) {
+      if (!E) E |= gageQueryItemOn(gctx[ci], gpvl[ci], spec->item[ii]);
+    }
+    if (!E) E |= gageUpdate(gctx[ci]);
+    if (E) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
+    if (gpvl[ci]->singlePrecision != AIR_CAST(int, ci)) {
+      fprintf(stderr, "%s: pvl[%u]->singlePrecision %d != %u\n", me, ci,
+              gpvl[ci]->singlePrecision, ci);
+      airMopError(mop); return 1;
+    }
+    for (ii=0; ii<3; ii++) {
+      ans[ci][ii] = gageAnswerPointer(gctx[ci], gpvl[ci], spec->item[ii]);
+      alen[ii] = gageAnswerLength(gctx[ci], gpvl[ci], spec->item[ii]);
+    }
+  }
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = AIR_CAST(double, gctx[0]->shape->size[ai]);
+  }
+  for (ii=0; ii<3; ii++) {
+    maxAns[ii] = maxErr[ii] = 0;
+  }
+  for (pi=0; pi<POS_NUM; pi++) {
+    /* cell-centered volume: anywhere in [-0.5,sz-0.5] */
+    for (ai=0; ai<3; ai++) {
+      pos[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.5, sz[ai]-0.5);
+    }
+    for (ci=0; ci<2; ci++) {
+      if (gageProbeSpace(gctx[ci], pos[0], pos[1], pos[2],
+                         AIR_TRUE /* indexSpace */, AIR_TRUE /* clamp */)) {
+        fprintf(stderr, "%s: probe (%g,%g,%g) failed:\n%s\n", me,
+                pos[0], pos[1], pos[2], gctx[ci]->errStr);
+        airMopError(mop); return 1;
+      }
+    }
+    for (ii=0; ii<3; ii++) {
+      for (ai=0; ai<alen[ii]; ai++) {
+        dd = AIR_ABS(ans[0][ii][ai] - ans[1][ii][ai]);
+        maxErr[ii] = AIR_MAX(maxErr[ii], dd);
+        dd = AIR_ABS(ans[0][ii][ai]);
+        maxAns[ii] = AIR_MAX(maxAns[ii], dd);
+      }
+    }
+  }
+  for (ii=0; ii<3; ii++) {
+    fprintf(stderr, "%s: %s %s (fd %u): max |ans| %g, max err %g (%g)\n",
+            me, spec->kind->name, spec->itemStr[ii], 2*gctx[0]->radius,
+            maxAns[ii], maxErr[ii], maxErr[ii]/maxAns[ii]);
+    if (!( maxAns[ii] > 0 && maxErr[ii] <= REL_ERR_MAX*maxAns[ii] )) {
+      fprintf(stderr, "%s: error too big (or answers all zero)\n", me);
+      airMopError(mop); return 1;
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  Nrrd *nscl, *ncmp[3], *nvec;
+  const NrrdKernel *kern[4][3] = {
+    {nrrdKernelTent, nrrdKernelForwDiff, nrrdKernelForwDiff},
+    {nrrdKernelBCCubic, nrrdKernelBCCubicD, nrrdKernelBCCubicDD},
+    {nrrdKernelC4Hexic, nrrdKernelC4HexicD, nrrdKernelC4HexicDD},
+    {nrrdKernelC5Septic, nrrdKernelC5SepticD, nrrdKernelC5SepticDD}};
+  probeSpec spec[3] = {
+    {NULL, {gageSclValue, gageSclGradVec, gageSclHessian},
+     {"value", "gradient", "hessian"}},
+    {NULL, {gageSclMedian, gageSclValue, gageSclGradMag},
+     {"median", "value", "gradmag"}},
+    {NULL, {gageVecVector, gageVecJacobian, gageVecHessian},
+     {"vector", "jacobian", "hessian"}}};
+  unsigned int ki, ci;
+  int axmap[4] = {-1, 0, 1, 2};
+  airRandMTState *rng;
+  airArray *mop;
+  int E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nscl = nrrdNew();
+  airMopAdd(mop, nscl, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nscl, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+  /* a float vector volume with components f, sin(f), cos(f) */
+  for (ci=0; ci<3; ci++) {
+    ncmp[ci] = nrrdNew();
+    airMopAdd(mop, ncmp[ci], (airMopper)nrrdNuke, airMopAlways);
+  }
+  nvec = nrrdNew();
+  airMopAdd(mop, nvec, (airMopper)nrrdNuke, airMopAlways);
+  E = 0;
+  if (!E) E |= nrrdConvert(ncmp[0], nscl, nrrdTypeFloat);
+  if (!E) E |= nrrdArithUnaryOp(ncmp[1], nrrdUnaryOpSin, ncmp[0]);
+  if (!E) E |= nrrdArithUnaryOp(ncmp[2], nrrdUnaryOpCos, ncmp[0]);
+  if (!E) E |= nrrdJoin(nvec, AIR_CAST(const Nrrd *const *, ncmp), 3, 0,
+                        AIR_TRUE);
+  /* nrrdJoin doesn't know about the orientation of the new axes */
+  if (!E) E |= nrrdAxisInfoCopy(nvec, nscl, axmap, NRRD_AXIS_INFO_NONE);
+  if (!E) E |= nrrdBasicInfoCopy(nvec, nscl,
+                                 NRRD_BASIC_INFO_DATA_BIT
+                                 | NRRD_BASIC_INFO_TYPE_BIT
+                                 | NRRD_BASIC_INFO_BLOCKSIZE_BIT
+                                 | NRRD_BASIC_INFO_DIMENSION_BIT
+                                 | NRRD_BASIC_INFO_CONTENT_BIT
+                                 | NRRD_BASIC_INFO_COMMENTS_BIT
+                                 | NRRD_BASIC_INFO_KEYVALUEPAIRS_BIT);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making vector volume:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nvec->axis[0].kind = nrrdKind3Vector;
+
+  spec[0].kind = gageKindScl;
+  spec[1].kind = gageKindScl;
+  spec[2].kind = gageKindVec;
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  for (ki=0; ki<4; ki++) {
+    if (probeSingle(me, nscl, spec + 0, kern[ki], rng)
+        || probeSingle(me, nscl, spec + 1, kern[ki], rng)
+        || probeSingle(me, nvec, spec + 2, kern[ki], rng)) {
+      fprintf(stderr, "%s: problem with kernel set %u\n", me, ki);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
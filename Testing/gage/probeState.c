@@ -0,0 +1,248 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageProbeStateNew, gageProbeWith, gageProbeStateNix: probing through
+** several probe states of one context (interleaved, and concurrently
+** in threads when possible) gives exactly the same answers as probing
+** the context itself, and a context that needs gageUpdate() is refused
+*/
+
+#define STATE_NUM 4
+#define POS_NUM 3000
+#define ANS_LEN (1 + 3 + 9)
+
+typedef struct {
+  gageProbeState *gps;
+  const double *pos;         /* POS_NUM 3-vectors */
+  double *out;               /* POS_NUM answers of length ANS_LEN */
+  int bad;
+} probeTask;
+
+static void
+probeAnswerCopy(double *out, gageContext *ctx) {
+  const double *vv, *gg, *hh;
+  unsigned int ii;
+
+  vv = gageAnswerPointer(ctx, ctx->pvl[0], gageSclValue);
+  gg = gageAnswerPointer(ctx, ctx->pvl[0], gageSclGradVec);
+  hh = gageAnswerPointer(ctx, ctx->pvl[0], gageSclHessian);
+  out[0] = vv[0];
+  for (ii=0; ii<3; ii++) {
+    out[1 + ii] = gg[ii];
+  }
+  for (ii=0; ii<9; ii++) {
+    out[4 + ii] = hh[ii];
+  }
+}
+
+static void *
+probeTaskRun(void *_task) {
+  probeTask *task;
+  unsigned int pi;
+
+  task = AIR_CAST(probeTask *, _task);
+  for (pi=0; pi<POS_NUM; pi++) {
+    const double *pp = task->pos + 3*pi;
+    if (gageProbeWith(task->gps, pp[0], pp[1], pp[2])) {
+      task->bad = AIR_TRUE;
+      return _task;
+    }
+    probeAnswerCopy(task->out + ANS_LEN*pi, task->gps->ctx);
+  }
+  return _task;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  Nrrd *nin;
+  gageContext *gctx;
+  gagePerVolume *gpvl;
+  gageProbeState *gps[STATE_NUM];
+  probeTask task[STATE_NUM];
+  airThread *thread[STATE_NUM];
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 0.0, 0.5}, *pos, *want,
+    *got, sz[3];
+  unsigned int si, pi, ai;
+  airRandMTState *rng;
+  airArray *mop;
+  int E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nin, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  gageParmSet(gctx, gageParmRenormalize, AIR_FALSE);
+  gageParmSet(gctx, gageParmCheckIntegrals, AIR_TRUE);
+  E = 0;
+  if (!E) E |= !(gpvl = gagePerVolumeNew(gctx, nin, gageKindScl));
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, nrrdKernelC4Hexic, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel11, nrrdKernelC4HexicD, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel22, nrrdKernelC4HexicDD, kparm);
+  if (!E) E |= gagePerVolumeAttach(gctx, gpvl);
+  if (!E) E |= gageQueryItemOn(gctx, gpvl, gageSclValue);
+  if (!E) E |= gageQueryItemOn(gctx, gpvl, gageSclGradVec);
+  if (!E) E |= gageQueryItemOn(gctx, gpvl, gageSclHessian);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+  /* context hasn't been updated; this should fail */
+  if ((gps[0] = gageProbeStateNew(gctx))) {
+    fprintf(stderr, "%s: gageProbeStateNew didn't notice missing update\n",
+            me);
+    gageProbeStateNix(gps[0]);
+    airMopError(mop); return 1;
+  }
+  free(biffGetDone(GAGE));
+  if (gageUpdate(gctx)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with update:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+  for (si=0; si<STATE_NUM; si++) {
+    if (!(gps[si] = gageProbeStateNew(gctx))) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble making probe state %u:\n%s\n",
+              me, si, err);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, gps[si], (airMopper)gageProbeStateNix, airMopAlways);
+  }
+
+  /* random positions (along short runs, so that caches are re-used and
+     shifted) and the answers from probing the context itself */
+  pos = AIR_CALLOC(3*POS_NUM*STATE_NUM, double);
+  airMopAdd(mop, pos, airFree, airMopAlways);
+  want = AIR_CALLOC(ANS_LEN*POS_NUM*STATE_NUM, double);
+  airMopAdd(mop, want, airFree, airMopAlways);
+  got = AIR_CALLOC(ANS_LEN*POS_NUM*STATE_NUM, double);
+  airMopAdd(mop, got, airFree, airMopAlways);
+  rng = airRandMTStateNew(42);
+  airMopAdd(mop, rng, (airMopper)airRandMTStateNix, airMopAlways);
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = AIR_CAST(double, gctx->shape->size[ai]);
+  }
+  for (pi=0; pi<POS_NUM*STATE_NUM; pi++) {
+    double *pp = pos + 3*pi;
+    if (pi % 10) {
+      ELL_3V_COPY(pp, pp - 3);
+      pp[pi % 3] += 1;
+      pp[pi % 3] = AIR_MIN(pp[pi % 3], sz[pi % 3] - 0.5);
+    } else {
+      for (ai=0; ai<3; ai++) {
+        pp[ai] = AIR_AFFINE(0, airDrandMT_r(rng), 1, -0.5, sz[ai]-0.5);
+      }
+    }
+    if (gageProbe(gctx, pp[0], pp[1], pp[2])) {
+      fprintf(stderr, "%s: probe %u (%g,%g,%g) failed:\n%s\n", me, pi,
+              pp[0], pp[1], pp[2], gctx->errStr);
+      airMopError(mop); return 1;
+    }
+    probeAnswerCopy(want + ANS_LEN*pi, gctx);
+  }
+
+  /* interleaved: probe state si probes position pi when pi%STATE_NUM==si,
+     with some probes of the parent context mixed in */
+  for (pi=0; pi<POS_NUM*STATE_NUM; pi++) {
+    const double *pp = pos + 3*pi;
+    si = pi % STATE_NUM;
+    if (gageProbeWith(gps[si], pp[0], pp[1], pp[2])) {
+      fprintf(stderr, "%s: state %u probe %u failed:\n%s\n", me, si, pi,
+              gps[si]->ctx->errStr);
+      airMopError(mop); return 1;
+    }
+    probeAnswerCopy(got + ANS_LEN*pi, gps[si]->ctx);
+    if (!(pi % 7)) {
+      gageProbe(gctx, pp[2], pp[1], pp[0]);
+    }
+  }
+  for (pi=0; pi<ANS_LEN*POS_NUM*STATE_NUM; pi++) {
+    if (want[pi] != got[pi]) {
+      fprintf(stderr, "%s: interleaved answer %u: got %.17g != want %.17g\n",
+              me, pi, got[pi], want[pi]);
+      airMopError(mop); return 1;
+    }
+  }
+
+  /* concurrently: each probe state probes its own contiguous part */
+  for (si=0; si<STATE_NUM; si++) {
+    task[si].gps = gps[si];
+    task[si].pos = pos + 3*POS_NUM*si;
+    task[si].out = got + ANS_LEN*POS_NUM*si;
+    task[si].bad = AIR_FALSE;
+  }
+  memset(got, 0, ANS_LEN*POS_NUM*STATE_NUM*sizeof(double));
+  if (airThreadCapable) {
+    for (si=0; si<STATE_NUM; si++) {
+      thread[si] = airThreadNew();
+      airMopAdd(mop, thread[si], (airMopper)airThreadNix, airMopAlways);
+      if (airThreadStart(thread[si], probeTaskRun, task + si)) {
+        fprintf(stderr, "%s: couldn't start thread %u\n", me, si);
+        airMopError(mop); return 1;
+      }
+    }
+    for (si=0; si<STATE_NUM; si++) {
+      airThreadJoin(thread[si], NULL);
+    }
+  } else {
+    for (si=0; si<STATE_NUM; si++) {
+      probeTaskRun(task + si);
+    }
+  }
+  for (si=0; si<STATE_NUM; si++) {
+    if (task[si].bad) {
+      fprintf(stderr, "%s: probing in task %u failed\n", me, si);
+      airMopError(mop); return 1;
+    }
+  }
+  for (pi=0; pi<ANS_LEN*POS_NUM*STATE_NUM; pi++) {
+    if (want[pi] != got[pi]) {
+      fprintf(stderr, "%s: concurrent answer %u: got %.17g != want %.17g\n",
+              me, pi, got[pi], want[pi]);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,145 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageParmStats: the counts in ctx->stats, for probes of known kinds
+** (inside, near the edge, outside, and repeated), and that nothing is
+** counted without gageParmStats
+*/
+
+static int
+countCheck(const char *me, const char *what, size_t got, size_t want) {
+  char stmp[2][AIR_STRLEN_SMALL];
+
+  if (got != want) {
+    fprintf(stderr, "%s: %s count %s != expected %s\n", me, what,
+            airSprintSize_t(stmp[0], got), airSprintSize_t(stmp[1], want));
+    return 1;
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  double kparm[NRRD_KERNEL_PARMS_NUM] = {1.0, 1.0, 0.0};
+  airArray *mop;
+  Nrrd *nin;
+  gageContext *gctx;
+  gagePerVolume *gpvl;
+  const gageStats *st;
+  unsigned int pi;
+  int E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nin, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  gageParmSet(gctx, gageParmRenormalize, AIR_FALSE);
+  gageParmSet(gctx, gageParmCheckIntegrals, AIR_TRUE);
+  E = 0;
+  if (!E) E |= !(gpvl = gagePerVolumeNew(gctx, nin, gageKindScl));
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, nrrdKernelC4Hexic, kparm);
+  if (!E) E |= gageKernelSet(gctx, gageKernel11, nrrdKernelC4HexicD, kparm);
+  if (!E) E |= gagePerVolumeAttach(gctx, gpvl);
+  if (!E) E |= gageQueryItemOn(gctx, gpvl, gageSclGradMag);
+  if (!E) E |= gageUpdate(gctx);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with set-up:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+  st = &(gctx->stats);
+
+  /* without parm.stats, nothing is counted */
+  for (pi=0; pi<10; pi++) {
+    gageProbe(gctx, 10.25 + pi, 10.5, 8.5);
+  }
+  if (countCheck(me, "probe (w/out stats)", st->probeNum, 0)
+      || countCheck(me, "weight (w/out stats)", st->weightNum, 0)) {
+    airMopError(mop); return 1;
+  }
+
+  gageParmSet(gctx, gageParmStats, AIR_TRUE);
+  gageContextStatsReset(gctx);
+  /* 10 probes inside, one of which repeats the last probe, all at the
+     same fractional position as the probes above (so no new weights) */
+  for (pi=0; pi<9; pi++) {
+    gageProbe(gctx, 10.25 + pi, 10.5, 8.5);
+  }
+  gageProbe(gctx, 18.25, 10.5, 8.5);
+  /* 3 near the edge, with new fractional positions */
+  gageProbe(gctx, 0.75, 10.5, 8.5);
+  gageProbe(gctx, 10.25, 38.625, 8.5);
+  gageProbe(gctx, 10.25, 10.5, 15.0);
+  /* 2 outside */
+  if (!( gageProbe(gctx, -1.0, 10.5, 8.5)
+         && gageProbe(gctx, 10.25, 10.5, 16.0) )) {
+    fprintf(stderr, "%s: probes outside volume didn't fail\n", me);
+    airMopError(mop); return 1;
+  }
+  if (countCheck(me, "probe", st->probeNum, 15)
+      || countCheck(me, "outside", st->outsideNum, 2)
+      || countCheck(me, "edge", st->edgeNum, 3)
+      || countCheck(me, "weight", st->weightNum, 3)
+      || countCheck(me, "stack", st->stackNum, 0)
+      || countCheck(me, "iv3 fill", gctx->iv3FillNum, 12)) {
+    airMopError(mop); return 1;
+  }
+  if (!( st->locationTick && st->fillTick && st->filterTick
+         && st->answerTick )) {
+    fprintf(stderr, "%s: some phase wasn't timed\n", me);
+    airMopError(mop); return 1;
+  }
+  gageContextStatsPrint(stderr, gctx);
+
+  /* gageUpdate starts over */
+  if (gageUpdate(gctx)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble updating:\n%s\n", me, err);
+    airMopError(mop); return 1;
+  }
+  if (countCheck(me, "probe (after update)", st->probeNum, 0)) {
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,199 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/gage.h"
+#include <testDataPath.h>
+
+/*
+** Tests:
+** gageStackBlurParmThreadNumSet (via "nt=" in gageStackBlurParmParse)
+** gageStackBlur with multiple threads
+** gageStackBlurCacheFormat
+** gageStackBlurCache
+*/
+
+#define THREAD_NUM 3
+
+/* biggest difference between two stacks of blurrings */
+static double
+stackDiff(Nrrd *const na[], Nrrd *const nb[], unsigned int num) {
+  double (*lup)(const void *, size_t), diff, dd;
+  unsigned int si;
+  size_t ii, NN;
+
+  diff = 0;
+  for (si=0; si<num; si++) {
+    lup = nrrdDLookup[na[si]->type];
+    NN = nrrdElementNumber(na[si]);
+    if (nb[si]->type != na[si]->type
+        || nrrdElementNumber(nb[si]) != NN) {
+      return AIR_POS_INF;
+    }
+    for (ii=0; ii<NN; ii++) {
+      dd = lup(na[si]->data, ii) - lup(nb[si]->data, ii);
+      dd = AIR_ABS(dd);
+      if (dd > diff) {
+        diff = dd;
+      }
+    }
+  }
+  return diff;
+}
+
+static Nrrd **
+stackNew(airArray *mop, unsigned int num) {
+  Nrrd **nblur;
+  unsigned int si;
+
+  nblur = AIR_CALLOC(num, Nrrd *);
+  airMopAdd(mop, nblur, airFree, airMopAlways);
+  for (si=0; si<num; si++) {
+    nblur[si] = nrrdNew();
+    airMopAdd(mop, nblur[si], (airMopper)nrrdNuke, airMopAlways);
+  }
+  return nblur;
+}
+
+/*
+** blurs nin according to sbpStr with one thread and with THREAD_NUM
+** threads, and checks that the results differ by at most tol
+*/
+static int
+threadCheck(airArray *mop, const char *sbpStr, double tol, const Nrrd *nin) {
+  static const char me[]="threadCheck";
+  gageStackBlurParm *sbp;
+  Nrrd **nblur[2];
+  char str[AIR_STRLEN_LARGE], *err;
+  unsigned int ti;
+  double diff;
+
+  sbp = gageStackBlurParmNew();
+  airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+  for (ti=0; ti<2; ti++) {
+    sprintf(str, "%s/nt=%u", sbpStr, ti ? THREAD_NUM : 1);
+    nblur[ti] = NULL;
+    if (gageStackBlurParmParse(sbp, NULL, NULL, str)
+        || !(nblur[ti] = stackNew(mop, sbp->num))
+        || gageStackBlur(nblur[ti], sbp, nin, gageKindScl)) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble blurring with \"%s\":\n%s", me, str, err);
+      return 1;
+    }
+  }
+  diff = stackDiff(nblur[0], nblur[1], sbp->num);
+  fprintf(stderr, "%s: \"%s\": 1 vs %u threads: max diff %g\n", me,
+          sbpStr, THREAD_NUM, diff);
+  if (!( diff <= tol )) {
+    fprintf(stderr, "%s: difference %g > tolerance %g\n", me, diff, tol);
+    return 1;
+  }
+  return 0;
+}
+
+static int
+cacheCheck(airArray *mop, const Nrrd *nin) {
+  static const char me[]="cacheCheck";
+  gageStackBlurParm *sbp;
+  Nrrd **nblur[2];
+  char format[AIR_STRLEN_HUGE], fname[AIR_STRLEN_HUGE], *err;
+  unsigned int ti, si;
+  int recomputed[2];
+  double diff;
+
+  sbp = gageStackBlurParmNew();
+  airMopAdd(mop, sbp, (airMopper)gageStackBlurParmNix, airMopAlways);
+  if (gageStackBlurParmParse(sbp, NULL, NULL,
+                             "0.5-4-2/k=gauss:1,3/b=bleed/v=0")
+      || gageStackBlurCacheFormat(format, ".", sbp, nin, gageKindScl)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble setting up:\n%s", me, err);
+    return 1;
+  }
+  /* start with an empty cache */
+  for (si=0; si<sbp->num; si++) {
+    sprintf(fname, format, si);
+    remove(fname);
+  }
+  for (ti=0; ti<2; ti++) {
+    if (gageStackBlurCache(nblur + ti, recomputed + ti, sbp, ".",
+                           nin, gageKindScl)) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with cache (%u):\n%s", me, ti, err);
+      return 1;
+    }
+    airMopAdd(mop, nblur[ti], airFree, airMopAlways);
+    for (si=0; si<sbp->num; si++) {
+      airMopAdd(mop, nblur[ti][si], (airMopper)nrrdNuke, airMopAlways);
+    }
+  }
+  for (si=0; si<sbp->num; si++) {
+    sprintf(fname, format, si);
+    remove(fname);
+  }
+  if (!( recomputed[0] && !recomputed[1] )) {
+    fprintf(stderr, "%s: recomputed %d then %d; wanted 1 then 0\n", me,
+            recomputed[0], recomputed[1]);
+    return 1;
+  }
+  diff = stackDiff(nblur[0], nblur[1], sbp->num);
+  if (diff) {
+    fprintf(stderr, "%s: cached blurrings differ by %g\n", me, diff);
+    return 1;
+  }
+  fprintf(stderr, "%s: re-used \"%s\"\n", me, format);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *fullname, *err;
+  Nrrd *nin;
+  airArray *mop;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  fullname = testDataPathPrefix("fmob-c4h.nrrd");
+  airMopAdd(mop, fullname, airFree, airMopAlways);
+  if (nrrdLoad(nin, fullname, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble reading data \"%s\":\n%s",
+            me, fullname, err);
+    airMopError(mop); return 1;
+  }
+
+  /* one-shot blurring computes each level the same way regardless of
+     threading, and iterative diffusion is never threaded */
+  if (threadCheck(mop, "0.5-5-3/k=gauss:1,3/b=bleed/v=0", 0, nin)
+      || threadCheck(mop, "0-5-3-p/k=dg:1,5/b=wrap/v=0", 0, nin)
+      || cacheCheck(mop, nin)) {
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -154,6 +154,7 @@ main(int argc, const char **argv) {
   parseFailOrDie("0-4-8.3-u/k=dg:1,5/b=pad:0/v=n");
   parseFailOrDie("0-4-8.3-u/k=dg:1,5/b=pad:0/v=1/s=optiL2");
   parseFailOrDie("0-4-8.3/k=dg:1,5/b=pad:0/v=1/s=optiL2/dggsm=bingo");
+  parseFailOrDie("0-4-8.3/k=dg:1,5/nt=bingo");
   printf("\n");
 
   printf("%s: testing various okay strings ---------- \n", me);
@@ -162,6 +163,7 @@ main(int argc, const char **argv) {
   parseOrDie("0-4-8.3-u");
   parseOrDie("0-4-8.3-u1rpn/k=dg:1,5");
   parseOrDie("0-4-8.3-u1rpn/k=dg:1,5/b=pad:42/v=1/dggsm=8");
+  parseOrDie("0-4-8.3-u/k=dg:1,5/b=pad:42/nt=4");
   printf("\n");
 
   airMopOkay(mop);
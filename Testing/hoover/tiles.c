@@ -0,0 +1,407 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/hoover.h"
+
+/*
+** Tests:
+** hooverRender, with different tile sizes, numbers of threads, and
+** packet sizes, by checking that every ray is cast exactly once, and
+** that it takes the same samples as when rendering scanlines with one
+** thread, one sample at a time (rays end, and change their step, after
+** different numbers of samples).  Also, that the hooverStats counts
+** agree with what the callbacks saw, and that when skipping a volume
+** where every block is empty, with or without packets, every ray that
+** gets into the volume still passes its first sample there to sample()
+*/
+
+#define SX 37
+#define SY 23
+#define CONFIG_NUM 7
+
+typedef struct {
+  unsigned int *hits,         /* number of times each ray was cast */
+    *samples,                 /* number of sample() calls per ray */
+    *stopped,                 /* whether sample() ended the ray */
+    *insides,                 /* sample() calls inside the volume */
+    *packets;                 /* packetSample() calls per ray */
+  double *img;                /* sum of (hashed) inside sample positions */
+} tileUser;
+
+typedef struct {
+  unsigned int pix;           /* pixel of the current ray */
+  double step;                /* step last asked for */
+} tileThread;
+
+static int
+tileRenderBegin(void **renderP, void *user) {
+
+  *renderP = user;
+  return 0;
+}
+
+static int
+tileThreadBegin(void **threadP, void *render, void *user,
+                int whichThread) {
+  AIR_UNUSED(render);
+  AIR_UNUSED(user);
+  AIR_UNUSED(whichThread);
+  *threadP = AIR_CALLOC(1, tileThread);
+  return !*threadP;
+}
+
+static int
+tileRayBegin(void *_thread, void *render, void *_user,
+             int uIndex, int vIndex, double rayLen,
+             double rayStartWorld[3], double rayStartIndex[3],
+             double rayDirWorld[3], double rayDirIndex[3]) {
+  tileThread *thread;
+  tileUser *user;
+
+  AIR_UNUSED(render);
+  AIR_UNUSED(rayLen);
+  AIR_UNUSED(rayStartWorld);
+  AIR_UNUSED(rayStartIndex);
+  AIR_UNUSED(rayDirWorld);
+  AIR_UNUSED(rayDirIndex);
+  thread = AIR_CAST(tileThread *, _thread);
+  user = AIR_CAST(tileUser *, _user);
+  thread->pix = uIndex + SX*vIndex;
+  user->hits[thread->pix] += 1;
+  return 0;
+}
+
+static double
+tileSample(void *_thread, void *render, void *_user,
+           int num, double rayT, int inside,
+           double samplePosWorld[3], double samplePosIndex[3]) {
+  tileThread *thread;
+  tileUser *user;
+
+  AIR_UNUSED(render);
+  AIR_UNUSED(rayT);
+  AIR_UNUSED(samplePosWorld);
+  thread = AIR_CAST(tileThread *, _thread);
+  user = AIR_CAST(tileUser *, _user);
+  user->samples[thread->pix] += 1;
+  if (inside) {
+    user->insides[thread->pix] += 1;
+    user->img[thread->pix] += (samplePosIndex[0] + 3*samplePosIndex[1]
+                               + 7*samplePosIndex[2]);
+  }
+  /* rays end on their own after some pixel-dependent number of samples,
+     and take smaller steps a little before that */
+  if (AIR_CAST(unsigned int, num) < 20 + 7*(thread->pix % 11)) {
+    thread->step = (AIR_CAST(unsigned int, num) < 15 + 7*(thread->pix % 5)
+                    ? 0.05 : 0.03);
+  } else {
+    user->stopped[thread->pix] = 1;
+    thread->step = 0.0;
+  }
+  return thread->step;
+}
+
+/* passes the samples of the packet to tileSample(), one at a time */
+static double
+tilePacketSample(void *_thread, void *render, void *_user,
+                 unsigned int packNum, int num,
+                 const double *rayT, const int *inside,
+                 const double *samplePosWorld,
+                 const double *samplePosIndex,
+                 unsigned int *doneNumP) {
+  tileThread *thread;
+  tileUser *user;
+  double step, posW[3], posI[3];
+  unsigned int ii;
+
+  thread = AIR_CAST(tileThread *, _thread);
+  user = AIR_CAST(tileUser *, _user);
+  user->packets[thread->pix] += 1;
+  step = thread->step;
+  for (ii=0; ii<packNum; ii++) {
+    ELL_3V_SET(posW, samplePosWorld[ii],
+               samplePosWorld[ii + HOOVER_PACKET_MAX],
+               samplePosWorld[ii + 2*HOOVER_PACKET_MAX]);
+    ELL_3V_SET(posI, samplePosIndex[ii],
+               samplePosIndex[ii + HOOVER_PACKET_MAX],
+               samplePosIndex[ii + 2*HOOVER_PACKET_MAX]);
+    if (tileSample(_thread, render, _user, num + AIR_CAST(int, ii),
+                   rayT[ii], inside[ii], posW, posI) != step) {
+      *doneNumP = ii + 1;
+      return thread->step;
+    }
+  }
+  *doneNumP = packNum;
+  return step;
+}
+
+static int
+tileThreadEnd(void *thread, void *render, void *user) {
+
+  AIR_UNUSED(render);
+  AIR_UNUSED(user);
+  free(thread);
+  return 0;
+}
+
+/* airMopper for hooverContextNix, which returns void */
+static void *
+tileContextNix(void *ctx) {
+
+  hooverContextNix(AIR_CAST(hooverContext *, ctx));
+  return NULL;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  hooverContext *ctx;
+  tileUser user;
+  hooverStats *stats;
+  hooverSkip *skip;
+  Nrrd *nvol;
+  NrrdKernelSpec *ksp;
+  size_t sampleNum, stopNum, packNum, tsum[5];
+  unsigned int enterNum[2];
+  double kparm[NRRD_KERNEL_PARMS_NUM];
+  double *img0;
+  /* tile sizes, thread numbers, and packet sizes; the first is
+     scanline-at-a-time, one sample at a time */
+  unsigned int tsize[CONFIG_NUM][2] = {{SX, 1}, {1, 1}, {5, 3},
+                                       {16, 16}, {64, 64}, {5, 3},
+                                       {16, 16}},
+    tthr[CONFIG_NUM] = {1, 3, 2, 3, 2, 2, 3},
+    tpack[CONFIG_NUM] = {1, 1, 1, 1, 1, 4, HOOVER_PACKET_MAX}, ci, ii;
+  int E, Ecode, Ethread;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  user.hits = AIR_CALLOC(SX*SY, unsigned int);
+  airMopAdd(mop, user.hits, airFree, airMopAlways);
+  user.samples = AIR_CALLOC(SX*SY, unsigned int);
+  airMopAdd(mop, user.samples, airFree, airMopAlways);
+  user.stopped = AIR_CALLOC(SX*SY, unsigned int);
+  airMopAdd(mop, user.stopped, airFree, airMopAlways);
+  user.insides = AIR_CALLOC(SX*SY, unsigned int);
+  airMopAdd(mop, user.insides, airFree, airMopAlways);
+  user.packets = AIR_CALLOC(SX*SY, unsigned int);
+  airMopAdd(mop, user.packets, airFree, airMopAlways);
+  user.img = AIR_CALLOC(SX*SY, double);
+  airMopAdd(mop, user.img, airFree, airMopAlways);
+  img0 = AIR_CALLOC(SX*SY, double);
+  airMopAdd(mop, img0, airFree, airMopAlways);
+  stats = hooverStatsNew();
+  airMopAdd(mop, stats, (airMopper)hooverStatsNix, airMopAlways);
+  if (!( user.hits && user.samples && user.stopped && user.insides
+         && user.packets && user.img && img0 && stats )) {
+    fprintf(stderr, "%s: couldn't allocate images\n", me);
+    airMopError(mop); return 1;
+  }
+  ctx = hooverContextNew();
+  airMopAdd(mop, ctx, tileContextNix, airMopAlways);
+  ELL_3V_SET(ctx->volSize, 20, 17, 11);
+  ELL_3V_SET(ctx->volSpacing, 1.0, 1.0, 1.3);
+  ctx->imgSize[0] = SX;
+  ctx->imgSize[1] = SY;
+  ctx->user = &user;
+  ctx->renderBegin = tileRenderBegin;
+  ctx->threadBegin = tileThreadBegin;
+  ctx->rayBegin = tileRayBegin;
+  ctx->sample = tileSample;
+  ctx->packetSample = tilePacketSample;
+  ctx->threadEnd = tileThreadEnd;
+  ELL_3V_SET(ctx->cam->from, 4, -3, 5);
+  ELL_3V_SET(ctx->cam->at, 0, 0, 0);
+  ELL_3V_SET(ctx->cam->up, 0, 0, 1);
+  ctx->cam->atRelative = AIR_TRUE;
+  ctx->cam->neer = -2;
+  ctx->cam->faar = 2;
+  ctx->cam->dist = 0;
+  ctx->cam->fov = 30;
+  if (limnCameraAspectSet(ctx->cam, SX, SY, nrrdCenterCell)
+      || limnCameraUpdate(ctx->cam)) {
+    airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with camera:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  for (ci=0; ci<CONFIG_NUM; ci++) {
+    for (ii=0; ii<SX*SY; ii++) {
+      user.hits[ii] = 0;
+      user.samples[ii] = 0;
+      user.stopped[ii] = 0;
+      user.insides[ii] = 0;
+      user.packets[ii] = 0;
+      user.img[ii] = 0;
+    }
+    ctx->tileSize[0] = tsize[ci][0];
+    ctx->tileSize[1] = tsize[ci][1];
+    ctx->numThreads = tthr[ci];
+    ctx->packetSize = tpack[ci];
+    /* the first config renders without stats */
+    ctx->stats = ci ? stats : NULL;
+    E = hooverRender(ctx, &Ecode, &Ethread);
+    if (E) {
+      if (hooverErrInit == E) {
+        airMopAdd(mop, err = biffGetDone(HOOVER), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble starting:\n%s", me, err);
+      } else {
+        fprintf(stderr, "%s: %s error (code %d, thread %d)\n", me,
+                airEnumStr(hooverErr, E), Ecode, Ethread);
+      }
+      airMopError(mop); return 1;
+    }
+    for (ii=0; ii<SX*SY; ii++) {
+      if (1 != user.hits[ii]) {
+        fprintf(stderr, "%s: %ux%u tiles, %u threads: ray (%u,%u) "
+                "cast %u times\n", me, tsize[ci][0], tsize[ci][1],
+                tthr[ci], ii % SX, ii / SX, user.hits[ii]);
+        airMopError(mop); return 1;
+      }
+    }
+    packNum = 0;
+    for (ii=0; ii<SX*SY; ii++) {
+      packNum += user.packets[ii];
+    }
+    if (!(tpack[ci] > 1) != !packNum) {
+      fprintf(stderr, "%s: %ux%u tiles, %u threads, packets of %u: "
+              "%u calls to packetSample()\n", me, tsize[ci][0],
+              tsize[ci][1], tthr[ci], tpack[ci], AIR_UINT(packNum));
+      airMopError(mop); return 1;
+    }
+    if (ctx->stats) {
+      sampleNum = stopNum = 0;
+      for (ii=0; ii<SX*SY; ii++) {
+        sampleNum += user.samples[ii];
+        stopNum += user.stopped[ii];
+      }
+      tsum[0] = tsum[1] = tsum[2] = tsum[3] = tsum[4] = 0;
+      for (ii=0; ii<stats->threadNum; ii++) {
+        tsum[0] += stats->thread[ii].tileNum;
+        tsum[1] += stats->thread[ii].rayNum;
+        tsum[2] += stats->thread[ii].rayStopNum;
+        tsum[3] += stats->thread[ii].sampleNum;
+        tsum[4] += stats->thread[ii].skipNum;
+      }
+      if (!( tthr[ci] == stats->threadNum
+             && ((SX + tsize[ci][0] - 1)/tsize[ci][0]
+                 *((SY + tsize[ci][1] - 1)/tsize[ci][1])
+                 == stats->total.tileNum)
+             && SX*SY == stats->total.rayNum
+             && stopNum == stats->total.rayStopNum
+             && sampleNum == stats->total.sampleNum
+             && 0 == stats->total.skipNum
+             && tsum[0] == stats->total.tileNum
+             && tsum[1] == stats->total.rayNum
+             && tsum[2] == stats->total.rayStopNum
+             && tsum[3] == stats->total.sampleNum
+             && tsum[4] == stats->total.skipNum
+             && stats->time >= 0 && stats->total.idleTime >= 0
+             && stats->total.sampleTime <= stats->total.time )) {
+        fprintf(stderr, "%s: %ux%u tiles, %u threads: stats don't add up "
+                "(%u rays, %u stopped, %u samples):\n",
+                me, tsize[ci][0], tsize[ci][1], tthr[ci],
+                SX*SY, AIR_UINT(stopNum), AIR_UINT(sampleNum));
+        hooverStatsPrint(stderr, stats);
+        airMopError(mop); return 1;
+      }
+    }
+    if (!ci) {
+      enterNum[0] = 0;
+      for (ii=0; ii<SX*SY; ii++) {
+        enterNum[0] += !!user.insides[ii];
+      }
+      memcpy(img0, user.img, SX*SY*sizeof(double));
+    } else if (memcmp(img0, user.img, SX*SY*sizeof(double))) {
+      fprintf(stderr, "%s: %ux%u tiles, %u threads: different samples "
+              "than scanlines\n", me, tsize[ci][0], tsize[ci][1],
+              tthr[ci]);
+      airMopError(mop); return 1;
+    }
+  }
+  /* make sure the volume was seen */
+  for (ii=0; ii<SX*SY && !img0[ii]; ii++);
+  if (ii == SX*SY) {
+    fprintf(stderr, "%s: no samples were inside the volume\n", me);
+    airMopError(mop); return 1;
+  }
+
+  /* skip a volume where every block is empty (no visible values) */
+  nvol = nrrdNew();
+  airMopAdd(mop, nvol, (airMopper)nrrdNuke, airMopAlways);
+  ksp = nrrdKernelSpecNew();
+  airMopAdd(mop, ksp, (airMopper)nrrdKernelSpecNix, airMopAlways);
+  skip = hooverSkipNew();
+  airMopAdd(mop, skip, (airMopper)hooverSkipNix, airMopAlways);
+  kparm[0] = 1.0;
+  nrrdKernelSpecSet(ksp, nrrdKernelTent, kparm);
+  if (nrrdMaybeAlloc_va(nvol, nrrdTypeFloat, 3,
+                        AIR_CAST(size_t, ctx->volSize[0]),
+                        AIR_CAST(size_t, ctx->volSize[1]),
+                        AIR_CAST(size_t, ctx->volSize[2]))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (hooverSkipRangeSet(skip, nvol, 4, ksp)
+      || hooverSkipEmptySet(skip, NULL, 0)) {
+    airMopAdd(mop, err = biffGetDone(HOOVER), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making blocks:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  ctx->skip = skip;
+  for (ci=0; ci<2; ci++) {
+    for (ii=0; ii<SX*SY; ii++) {
+      user.insides[ii] = 0;
+    }
+    ctx->packetSize = ci ? HOOVER_PACKET_MAX : 1;
+    E = hooverRender(ctx, &Ecode, &Ethread);
+    if (E) {
+      if (hooverErrInit == E) {
+        airMopAdd(mop, err = biffGetDone(HOOVER), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble starting with skip:\n%s", me, err);
+      } else {
+        fprintf(stderr, "%s: %s error with skip (code %d, thread %d)\n",
+                me, airEnumStr(hooverErr, E), Ecode, Ethread);
+      }
+      airMopError(mop); return 1;
+    }
+    enterNum[1] = 0;
+    for (ii=0; ii<SX*SY; ii++) {
+      enterNum[1] += !!user.insides[ii];
+    }
+    if (!( enterNum[0] == enterNum[1] && stats->total.skipNum > 0 )) {
+      fprintf(stderr, "%s: with skipping (packets of %u), %u (not %u) "
+              "rays passed a sample inside the volume to sample(), and "
+              "%u were skipped\n", me, ctx->packetSize, enterNum[1],
+              enterNum[0], AIR_UINT(stats->total.skipNum));
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
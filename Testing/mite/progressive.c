@@ -0,0 +1,272 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/mite.h"
+
+/*
+** Tests:
+** miteRenderProgressive (and hoover's rayMask), by checking that it
+**   renders the same image as hooverRender, with every ray cast once,
+**   and that adaptive refinement casts fewer rays for a similar image
+*/
+
+#define SX 24
+#define SY 22
+#define SZ 20
+#define IMG_SX 45
+#define IMG_SY 38
+#define TXF_SIZE 64
+
+typedef struct {
+  unsigned int levelNum, rayNum, stopAt;
+} progInfo;
+
+static int
+progCount(const Nrrd *nimg, unsigned int stride, unsigned int rayNum,
+          void *data) {
+  progInfo *info;
+
+  AIR_UNUSED(nimg);
+  AIR_UNUSED(stride);
+  info = AIR_CAST(progInfo *, data);
+  info->levelNum++;
+  info->rayNum += rayNum;
+  return info->levelNum == info->stopAt;
+}
+
+static void
+userSet(miteUser *muu, Nrrd *nin, Nrrd **ntxfP, Nrrd *nout) {
+  double kparm[NRRD_KERNEL_PARMS_NUM];
+  unsigned int ki;
+
+  muu->nsin = nin;
+  muu->ntxf = ntxfP;
+  muu->ntxfNum = 1;
+  muu->nout = nout;
+  muu->rayStep = 0.03;
+  muu->refStep = 0.05;
+  muu->rangeInit[miteRangeKa] = 0.2;
+  muu->rangeInit[miteRangeKd] = 0.7;
+  muu->rangeInit[miteRangeKs] = 0.3;
+  airStrcpy(muu->shadeStr, AIR_STRLEN_MED, "phong:gage(scalar:n)");
+  kparm[0] = 1;
+  kparm[1] = 0;
+  kparm[2] = 0.5;
+  for (ki=gageKernel00; ki<=gageKernel22; ki++) {
+    muu->ksp[ki] = nrrdKernelSpecNew();
+    airMopAdd(muu->umop, muu->ksp[ki], (airMopper)nrrdKernelSpecNix,
+              airMopAlways);
+  }
+  nrrdKernelSpecSet(muu->ksp[gageKernel00], nrrdKernelBCCubic, kparm);
+  nrrdKernelSpecSet(muu->ksp[gageKernel11], nrrdKernelBCCubicD, kparm);
+  nrrdKernelSpecSet(muu->ksp[gageKernel22], nrrdKernelBCCubicDD, kparm);
+  muu->hctx->cam->atRelative = AIR_TRUE;
+  ELL_3V_SET(muu->hctx->cam->from, 3, -1.8, 4);
+  ELL_3V_SET(muu->hctx->cam->at, 0, 0, 0);
+  ELL_3V_SET(muu->hctx->cam->up, 0, 0, 1);
+  muu->hctx->cam->neer = -2;
+  muu->hctx->cam->faar = 2;
+  muu->hctx->cam->dist = 0;
+  muu->hctx->cam->fov = 28;
+  muu->hctx->imgSize[0] = IMG_SX;
+  muu->hctx->imgSize[1] = IMG_SY;
+  muu->hctx->numThreads = 2;
+  ELL_3V_SET(muu->lit->col[0], 1, 1, 1);
+  ELL_3V_SET(muu->lit->_dir[0], 1, 0, 1);
+  ELL_3V_SET(muu->lit->amb, 1, 1, 1);
+  muu->lit->on[0] = AIR_TRUE;
+  muu->lit->vsp[0] = AIR_TRUE;
+  muu->hctx->user = muu;
+  muu->hctx->renderBegin = (hooverRenderBegin_t *)miteRenderBegin;
+  muu->hctx->threadBegin = (hooverThreadBegin_t *)miteThreadBegin;
+  muu->hctx->rayBegin = (hooverRayBegin_t *)miteRayBegin;
+  muu->hctx->sample = (hooverSample_t *)miteSample;
+  muu->hctx->rayEnd = (hooverRayEnd_t *)miteRayEnd;
+  muu->hctx->threadEnd = (hooverThreadEnd_t *)miteThreadEnd;
+  muu->hctx->renderEnd = (hooverRenderEnd_t *)miteRenderEnd;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  miteUser *muu;
+  Nrrd *nin, *ntxf, *nout, *nfull;
+  progInfo info;
+  double *txf, rr, dd, diff;
+  const mite_t *full, *out;
+  float *in;
+  unsigned int xi, yi, zi, ii, NN;
+  int E, Ecode, Ethread;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  airSrandMT(4242);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  ntxf = nrrdNew();
+  airMopAdd(mop, ntxf, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  nfull = nrrdNew();
+  airMopAdd(mop, nfull, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, SX),
+                        AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))
+      || nrrdMaybeAlloc_va(ntxf, nrrdTypeDouble, 2, AIR_CAST(size_t, 4),
+                           AIR_CAST(size_t, TXF_SIZE))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  /* a blob in low-level noise */
+  in = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        rr = ((xi - 11.0)*(xi - 11.0) + (yi - 10.0)*(yi - 10.0)
+              + (zi - 9.0)*(zi - 9.0))/25;
+        in[xi + SX*(yi + SY*zi)] = AIR_CAST(float, exp(-rr)
+                                            + 0.05*airDrandMT());
+      }
+    }
+  }
+  txf = AIR_CAST(double *, ntxf->data);
+  for (ii=0; ii<TXF_SIZE; ii++) {
+    txf[0 + 4*ii] = AIR_AFFINE(0, ii, TXF_SIZE-1, 0.2, 1);
+    txf[1 + 4*ii] = 0.6;
+    txf[2 + 4*ii] = AIR_AFFINE(0, ii, TXF_SIZE-1, 1, 0.2);
+    txf[3 + 4*ii] = (ii < 0.3*TXF_SIZE ? 0 : 0.3);
+  }
+  ntxf->axis[0].label = airStrdup("RGBA");
+  ntxf->axis[1].label = airStrdup("gage(scalar:v)");
+  ntxf->axis[1].min = 0;
+  ntxf->axis[1].max = 1;
+
+  muu = miteUserNew();
+  airMopAdd(mop, muu, (airMopper)miteUserNix, airMopAlways);
+  userSet(muu, nin, &ntxf, nout);
+  if (limnCameraAspectSet(muu->hctx->cam, IMG_SX, IMG_SY, nrrdCenterCell)
+      || limnCameraUpdate(muu->hctx->cam)
+      || limnLightUpdate(muu->lit, muu->hctx->cam)) {
+    airMopAdd(mop, err = biffGetDone(LIMN), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with camera:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (gageShapeSet(muu->shape, nin, 0)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with shape:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  muu->hctx->shape = muu->shape;
+
+  /* the usual way */
+  E = hooverRender(muu->hctx, &Ecode, &Ethread);
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(E == hooverErrInit ? HOOVER : MITE),
+              airFree, airMopAlways);
+    fprintf(stderr, "%s: %s error (code %d, thread %d):\n%s", me,
+            airEnumStr(hooverErr, E), Ecode, Ethread, err);
+    airMopError(mop); return 1;
+  }
+  if (nrrdCopy(nfull, nout)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble copying:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  full = AIR_CAST(const mite_t *, nfull->data);
+  out = AIR_CAST(const mite_t *, nout->data);
+  NN = IMG_SX*IMG_SY;
+
+  /* progressively, but casting all rays */
+  info.levelNum = info.rayNum = info.stopAt = 0;
+  if (miteRenderProgressive(muu, 4, -1, progCount, &info)) {
+    airMopAdd(mop, err = biffGetDone(MITE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble rendering progressively:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (!( 3 == info.levelNum && NN == info.rayNum )) {
+    fprintf(stderr, "%s: got %u levels and %u rays, not 3 and %u\n", me,
+            info.levelNum, info.rayNum, NN);
+    airMopError(mop); return 1;
+  }
+  if (memcmp(full, out, 5*NN*sizeof(mite_t))) {
+    fprintf(stderr, "%s: progressive image differs from usual one\n", me);
+    airMopError(mop); return 1;
+  }
+  if (muu->hctx->rayMask) {
+    fprintf(stderr, "%s: rayMask still set after rendering\n", me);
+    airMopError(mop); return 1;
+  }
+
+  /* adaptively */
+  info.levelNum = info.rayNum = info.stopAt = 0;
+  if (miteRenderProgressive(muu, 8, 0.02, progCount, &info)) {
+    airMopAdd(mop, err = biffGetDone(MITE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble rendering adaptively:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  diff = 0;
+  for (ii=0; ii<NN; ii++) {
+    for (xi=0; xi<4; xi++) {
+      dd = full[xi + 5*ii] - out[xi + 5*ii];
+      diff += AIR_ABS(dd);
+    }
+  }
+  diff /= 4*NN;
+  fprintf(stderr, "%s: adaptive: %u of %u rays; mean RGBA error %g\n",
+          me, info.rayNum, NN, diff);
+  if (!( 4 == info.levelNum && info.rayNum < 3*(NN/4) )) {
+    fprintf(stderr, "%s: adaptive rendering didn't save enough rays\n",
+            me);
+    airMopError(mop); return 1;
+  }
+  if (!( diff < 0.01 )) {
+    fprintf(stderr, "%s: adaptive rendering too different\n", me);
+    airMopError(mop); return 1;
+  }
+
+  /* stopping after the first level */
+  info.levelNum = info.rayNum = 0;
+  info.stopAt = 1;
+  if (miteRenderProgressive(muu, 8, -1, progCount, &info)) {
+    airMopAdd(mop, err = biffGetDone(MITE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble rendering coarsely:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (!( 1 == info.levelNum && 6*5 == info.rayNum )) {
+    fprintf(stderr, "%s: got %u levels and %u rays, not 1 and %u\n", me,
+            info.levelNum, info.rayNum, 6*5);
+    airMopError(mop); return 1;
+  }
+  /* the image is still filled in, from the rays cast */
+  if (!( full[3] == out[3] && out[3 + 5*(4 + IMG_SX*4)] == out[3] )) {
+    fprintf(stderr, "%s: coarse image wasn't filled in\n", me);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,384 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/mite.h"
+
+/*
+** Tests:
+** hooverSkipRangeSet, by checking that values probed (with a kernel
+**   with negative lobes) are within the range of their block
+** miteNtxfVisible, hooverSkipEmptySet, and skipping in hooverRender,
+**   by checking that mite renders the same image with and without
+**   skipping, but with fewer samples, which hooverStats counts as skipped
+** miteSamplePacket, and packets in hooverRender, by checking that with
+**   packets mite renders the same image, from the same samples
+*/
+
+#define SX 36
+#define SY 30
+#define SZ 26
+#define BLOCK 4
+#define TXF_SIZE 64
+#define PROBE_NUM 20000
+#define THREAD_NUM 2
+#define CONFIG_NUM 4
+
+static unsigned int sampleNum[THREAD_NUM];
+
+/* a miteSample that counts (per thread) its calls inside the volume */
+static double
+countSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
+            int num, double rayT, int inside,
+            double samplePosWorld[3], double samplePosIndex[3]) {
+  sampleNum[mtt->thrid] += !!inside;
+  return miteSample(mtt, mrr, muu, num, rayT, inside,
+                    samplePosWorld, samplePosIndex);
+}
+
+/* a miteSamplePacket that counts (per thread) the samples it did inside
+   the volume */
+static double
+countPacketSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
+                  unsigned int packNum, int num,
+                  const double *rayT, const int *inside,
+                  const double *samplePosWorld,
+                  const double *samplePosIndex,
+                  unsigned int *doneNumP) {
+  double ret;
+  unsigned int ii;
+
+  ret = miteSamplePacket(mtt, mrr, muu, packNum, num, rayT, inside,
+                         samplePosWorld, samplePosIndex, doneNumP);
+  for (ii=0; ii<*doneNumP; ii++) {
+    sampleNum[mtt->thrid] += !!inside[ii];
+  }
+  return ret;
+}
+
+/* checks that probed values are within the ranges of their blocks */
+static int
+rangeCheck(const Nrrd *nin, const NrrdKernelSpec *ksp) {
+  static const char me[]="rangeCheck";
+  gageContext *gctx;
+  gagePerVolume *pvl;
+  hooverSkip *skip;
+  const double *val;
+  double pos[3];
+  unsigned int ii, ai, bi[3], bb;
+  int E;
+  airArray *mop;
+
+  mop = airMopNew();
+  skip = hooverSkipNew();
+  airMopAdd(mop, skip, (airMopper)hooverSkipNix, airMopAlways);
+  if (hooverSkipRangeSet(skip, nin, BLOCK, ksp)) {
+    biffMovef(GAGE, HOOVER, "%s: trouble making blocks", me);
+    airMopError(mop); return 1;
+  }
+  gctx = gageContextNew();
+  airMopAdd(mop, gctx, (airMopper)gageContextNix, airMopAlways);
+  E = 0;
+  if (!E) E |= !(pvl = gagePerVolumeNew(gctx, nin, gageKindScl));
+  if (!E) E |= gagePerVolumeAttach(gctx, pvl);
+  if (!E) E |= gageKernelSet(gctx, gageKernel00, ksp->kernel, ksp->parm);
+  if (!E) E |= gageQueryItemOn(gctx, pvl, gageSclValue);
+  if (!E) E |= gageUpdate(gctx);
+  if (E) {
+    biffAddf(GAGE, "%s: trouble setting up gage", me);
+    airMopError(mop); return 1;
+  }
+  val = gageAnswerPointer(gctx, pvl, gageSclValue);
+  for (ii=0; ii<PROBE_NUM; ii++) {
+    pos[0] = AIR_AFFINE(0, airDrandMT(), 1, 0, SX-1);
+    pos[1] = AIR_AFFINE(0, airDrandMT(), 1, 0, SY-1);
+    pos[2] = AIR_AFFINE(0, airDrandMT(), 1, 0, SZ-1);
+    if (gageProbe(gctx, pos[0], pos[1], pos[2])) {
+      biffAddf(GAGE, "%s: probe error: %s", me, gctx->errStr);
+      airMopError(mop); return 1;
+    }
+    for (ai=0; ai<3; ai++) {
+      bi[ai] = AIR_UINT(floor(pos[ai]))/BLOCK;
+    }
+    bb = bi[0] + skip->size[0]*(bi[1] + skip->size[1]*bi[2]);
+    if (!AIR_IN_CL(skip->range[0 + 2*bb], val[0], skip->range[1 + 2*bb])) {
+      biffAddf(GAGE, "%s: value %g at (%g,%g,%g) outside block [%g,%g]",
+               me, val[0], pos[0], pos[1], pos[2],
+               skip->range[0 + 2*bb], skip->range[1 + 2*bb]);
+      airMopError(mop); return 1;
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* renders nin with ntxf, into nout, with blocks of size skipBlock and
+   packets of packetSize, and learns the number of samples taken inside
+   the volume, and skipped */
+static int
+render(Nrrd *nout, unsigned int *sampleNumP, unsigned int *skipNumP,
+       Nrrd *nin, Nrrd *ntxf, unsigned int skipBlock,
+       unsigned int packetSize, int ortho) {
+  static const char me[]="render";
+  miteUser *muu;
+  double kparm[NRRD_KERNEL_PARMS_NUM];
+  unsigned int ki;
+  int E, Ecode, Ethread;
+  airArray *mop;
+
+  mop = airMopNew();
+  muu = miteUserNew();
+  airMopAdd(mop, muu, (airMopper)miteUserNix, airMopAlways);
+  muu->nsin = nin;
+  muu->ntxf = &ntxf;
+  muu->ntxfNum = 1;
+  muu->nout = nout;
+  muu->skipBlock = skipBlock;
+  muu->hctx->stats = hooverStatsNew();
+  airMopAdd(mop, muu->hctx->stats, (airMopper)hooverStatsNix,
+            airMopAlways);
+  /* the volume is in a [-1,1]^3 cube */
+  muu->rayStep = 0.02;
+  muu->refStep = 0.05;
+  muu->rangeInit[miteRangeKa] = 0.2;
+  muu->rangeInit[miteRangeKd] = 0.7;
+  muu->rangeInit[miteRangeKs] = 0.3;
+  airStrcpy(muu->shadeStr, AIR_STRLEN_MED, "phong:gage(scalar:n)");
+  kparm[0] = 1;
+  kparm[1] = 0;
+  kparm[2] = 0.5;
+  for (ki=gageKernel00; ki<=gageKernel22; ki++) {
+    muu->ksp[ki] = nrrdKernelSpecNew();
+    airMopAdd(mop, muu->ksp[ki], (airMopper)nrrdKernelSpecNix,
+              airMopAlways);
+  }
+  nrrdKernelSpecSet(muu->ksp[gageKernel00], nrrdKernelBCCubic, kparm);
+  nrrdKernelSpecSet(muu->ksp[gageKernel11], nrrdKernelBCCubicD, kparm);
+  nrrdKernelSpecSet(muu->ksp[gageKernel22], nrrdKernelBCCubicDD, kparm);
+  muu->hctx->cam->atRelative = AIR_TRUE;
+  muu->hctx->cam->orthographic = ortho;
+  ELL_3V_SET(muu->hctx->cam->from, 3, -1.8, 4);
+  ELL_3V_SET(muu->hctx->cam->at, 0, 0, 0);
+  ELL_3V_SET(muu->hctx->cam->up, 0, 0, 1);
+  muu->hctx->cam->neer = -2;
+  muu->hctx->cam->faar = 2;
+  muu->hctx->cam->dist = 0;
+  muu->hctx->cam->fov = 28;
+  muu->hctx->imgSize[0] = 40;
+  muu->hctx->imgSize[1] = 34;
+  muu->hctx->numThreads = THREAD_NUM;
+  muu->hctx->packetSize = packetSize;
+  ELL_3V_SET(muu->lit->col[0], 1, 1, 1);
+  ELL_3V_SET(muu->lit->_dir[0], 1, 0, 1);
+  ELL_3V_SET(muu->lit->amb, 1, 1, 1);
+  muu->lit->on[0] = AIR_TRUE;
+  muu->lit->vsp[0] = AIR_TRUE;
+  if (limnCameraAspectSet(muu->hctx->cam, muu->hctx->imgSize[0],
+                          muu->hctx->imgSize[1], nrrdCenterCell)
+      || limnCameraUpdate(muu->hctx->cam)
+      || limnLightUpdate(muu->lit, muu->hctx->cam)) {
+    biffMovef(MITE, LIMN, "%s: trouble with camera or light", me);
+    airMopError(mop); return 1;
+  }
+  if (gageShapeSet(muu->shape, nin, 0)) {
+    biffMovef(MITE, GAGE, "%s: trouble with shape", me);
+    airMopError(mop); return 1;
+  }
+  muu->hctx->shape = muu->shape;
+  muu->hctx->user = muu;
+  muu->hctx->renderBegin = (hooverRenderBegin_t *)miteRenderBegin;
+  muu->hctx->threadBegin = (hooverThreadBegin_t *)miteThreadBegin;
+  muu->hctx->rayBegin = (hooverRayBegin_t *)miteRayBegin;
+  muu->hctx->sample = (hooverSample_t *)countSample;
+  muu->hctx->packetSample = (hooverPacketSample_t *)countPacketSample;
+  muu->hctx->rayEnd = (hooverRayEnd_t *)miteRayEnd;
+  muu->hctx->threadEnd = (hooverThreadEnd_t *)miteThreadEnd;
+  muu->hctx->renderEnd = (hooverRenderEnd_t *)miteRenderEnd;
+  for (ki=0; ki<THREAD_NUM; ki++) {
+    sampleNum[ki] = 0;
+  }
+  E = hooverRender(muu->hctx, &Ecode, &Ethread);
+  if (E) {
+    if (hooverErrInit == E) {
+      biffMovef(MITE, HOOVER, "%s: trouble starting", me);
+    } else {
+      biffAddf(MITE, "%s: %s error (code %d, thread %d)", me,
+               airEnumStr(hooverErr, E), Ecode, Ethread);
+    }
+    airMopError(mop); return 1;
+  }
+  if (muu->hctx->skip) {
+    biffAddf(MITE, "%s: skip blocks still set after rendering", me);
+    airMopError(mop); return 1;
+  }
+  *sampleNumP = 0;
+  for (ki=0; ki<THREAD_NUM; ki++) {
+    *sampleNumP += sampleNum[ki];
+  }
+  *skipNumP = AIR_UINT(muu->hctx->stats->total.skipNum);
+  airMopOkay(mop);
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  Nrrd *nin, *ntxf, *nout[CONFIG_NUM];
+  NrrdKernelSpec *ksp;
+  double kparm[NRRD_KERNEL_PARMS_NUM], *txf, *vis, rr, gg;
+  const double *out;
+  float *in;
+  unsigned int xi, yi, zi, ii, visNum, num[CONFIG_NUM],
+    skipNum[CONFIG_NUM], oi, opaqNum;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  airSrandMT(4242);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  ntxf = nrrdNew();
+  airMopAdd(mop, ntxf, (airMopper)nrrdNuke, airMopAlways);
+  for (oi=0; oi<CONFIG_NUM; oi++) {
+    nout[oi] = nrrdNew();
+    airMopAdd(mop, nout[oi], (airMopper)nrrdNuke, airMopAlways);
+  }
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, SX),
+                        AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ))
+      || nrrdMaybeAlloc_va(ntxf, nrrdTypeDouble, 2, AIR_CAST(size_t, 4),
+                           AIR_CAST(size_t, TXF_SIZE))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  /* two blobs in low-level noise */
+  in = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        rr = ((xi - 12.0)*(xi - 12.0) + (yi - 11.0)*(yi - 11.0)
+              + (zi - 10.0)*(zi - 10.0))/20;
+        gg = ((xi - 24.0)*(xi - 24.0) + (yi - 18.0)*(yi - 18.0)
+              + (zi - 15.0)*(zi - 15.0))/12;
+        in[xi + SX*(yi + SY*zi)] = AIR_CAST(float, exp(-rr) + exp(-gg)
+                                            + 0.05*airDrandMT());
+      }
+    }
+  }
+  /* colors everywhere, opacity only above 0.3 */
+  txf = AIR_CAST(double *, ntxf->data);
+  for (ii=0; ii<TXF_SIZE; ii++) {
+    txf[0 + 4*ii] = AIR_AFFINE(0, ii, TXF_SIZE-1, 0.2, 1);
+    txf[1 + 4*ii] = 0.6;
+    txf[2 + 4*ii] = AIR_AFFINE(0, ii, TXF_SIZE-1, 1, 0.2);
+    txf[3 + 4*ii] = (ii < 0.3*TXF_SIZE ? 0 : 0.3);
+  }
+  ntxf->axis[0].label = airStrdup("RGBA");
+  ntxf->axis[1].label = airStrdup("gage(scalar:v)");
+  ntxf->axis[1].min = 0;
+  ntxf->axis[1].max = 1;
+
+  ksp = nrrdKernelSpecNew();
+  airMopAdd(mop, ksp, (airMopper)nrrdKernelSpecNix, airMopAlways);
+  kparm[0] = 1;
+  kparm[1] = 0;
+  kparm[2] = 0.5;
+  nrrdKernelSpecSet(ksp, nrrdKernelBCCubic, kparm);
+  if (rangeCheck(nin, ksp)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble checking ranges:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  if (miteNtxfVisible(&vis, &visNum, &ntxf, 1)) {
+    airMopAdd(mop, err = biffGetDone(MITE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble learning visible values:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (!( vis && 1 == visNum && vis[0] > 0.3 && vis[0] < 0.32
+         && vis[1] == AIR_POS_INF )) {
+    fprintf(stderr, "%s: didn't get single visible interval [0.31,inf]\n",
+            me);
+    airMopError(mop); return 1;
+  }
+  free(vis);
+
+  for (oi=0; oi<2; oi++) {
+    /* without and with skipping, without and then with packets */
+    for (ii=0; ii<CONFIG_NUM; ii++) {
+      if (render(nout[ii], num + ii, skipNum + ii, nin, ntxf,
+                 ii % 2 ? BLOCK : 0, ii/2 ? HOOVER_PACKET_MAX : 1, oi)) {
+        airMopAdd(mop, err = biffGetDone(MITE), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble rendering:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+    }
+    out = AIR_CAST(const double *, nout[0]->data);
+    opaqNum = 0;
+    for (ii=0; ii<nrrdElementNumber(nout[0])/5; ii++) {
+      opaqNum += (out[3 + 5*ii] > 0.1);
+    }
+    fprintf(stderr, "%s: %s: %u samples without skipping, %u with; "
+            "%u opaque pixels\n", me, oi ? "orthographic" : "perspective",
+            num[0], num[1], opaqNum);
+    if (!( opaqNum > 50 )) {
+      fprintf(stderr, "%s: %s: didn't see enough of the volume\n", me,
+              oi ? "orthographic" : "perspective");
+      airMopError(mop); return 1;
+    }
+    if (memcmp(nout[0]->data, nout[1]->data,
+               nrrdElementNumber(nout[0])*nrrdElementSize(nout[0]))) {
+      fprintf(stderr, "%s: %s: skipping changed the image\n", me,
+              oi ? "orthographic" : "perspective");
+      airMopError(mop); return 1;
+    }
+    if (!( 0 == skipNum[0] && num[0] - num[1] == skipNum[1] )) {
+      fprintf(stderr, "%s: %s: counted %u and %u skipped samples, not "
+              "0 and %u\n", me, oi ? "orthographic" : "perspective",
+              skipNum[0], skipNum[1], num[0] - num[1]);
+      airMopError(mop); return 1;
+    }
+    if (!( num[1] < 3*(num[0]/4) )) {
+      fprintf(stderr, "%s: %s: skipping didn't skip enough\n", me,
+              oi ? "orthographic" : "perspective");
+      airMopError(mop); return 1;
+    }
+    for (ii=2; ii<CONFIG_NUM; ii++) {
+      if (memcmp(nout[ii % 2]->data, nout[ii]->data,
+                 nrrdElementNumber(nout[0])*nrrdElementSize(nout[0]))
+          || num[ii % 2] != num[ii] || skipNum[ii % 2] != skipNum[ii]) {
+        fprintf(stderr, "%s: %s: packets %s skipping changed the image, "
+                "or the %u samples (%u skipped) to %u (%u)\n", me,
+                oi ? "orthographic" : "perspective",
+                ii % 2 ? "with" : "without", num[ii % 2],
+                skipNum[ii % 2], num[ii], skipNum[ii]);
+        airMopError(mop); return 1;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,262 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/mite.h"
+
+/*
+** Tests:
+** the txf lookup table in miteRender (used when all txfs are 1-D over
+**   the same scalar), by checking that it renders the same images as
+**   the general stage-by-stage application of equivalent txfs that
+**   have an extra axis along which they don't change (so they can't be
+**   looked up at once)
+*/
+
+#define SX 24
+#define SY 22
+#define SZ 20
+#define TXF_SIZE 64
+
+/* renders nin with the ntxfNum txfs in ntxf, into nout */
+static int
+render(Nrrd *nout, Nrrd *nin, Nrrd **ntxf, unsigned int ntxfNum,
+       int wantLut) {
+  static const char me[]="render";
+  miteUser *muu;
+  miteRender *mrr;
+  double kparm[NRRD_KERNEL_PARMS_NUM];
+  unsigned int ki;
+  int E, Ecode, Ethread;
+  airArray *mop;
+
+  mop = airMopNew();
+  muu = miteUserNew();
+  airMopAdd(mop, muu, (airMopper)miteUserNix, airMopAlways);
+  muu->nsin = nin;
+  muu->ntxf = ntxf;
+  muu->ntxfNum = ntxfNum;
+  muu->nout = nout;
+  muu->rayStep = 0.03;
+  muu->refStep = 0.05;
+  muu->rangeInit[miteRangeKa] = 0.2;
+  muu->rangeInit[miteRangeKd] = 0.7;
+  muu->rangeInit[miteRangeKs] = 0.3;
+  airStrcpy(muu->shadeStr, AIR_STRLEN_MED, "phong:gage(scalar:n)");
+  kparm[0] = 1;
+  kparm[1] = 0;
+  kparm[2] = 0.5;
+  for (ki=gageKernel00; ki<=gageKernel22; ki++) {
+    muu->ksp[ki] = nrrdKernelSpecNew();
+    airMopAdd(mop, muu->ksp[ki], (airMopper)nrrdKernelSpecNix,
+              airMopAlways);
+  }
+  nrrdKernelSpecSet(muu->ksp[gageKernel00], nrrdKernelBCCubic, kparm);
+  nrrdKernelSpecSet(muu->ksp[gageKernel11], nrrdKernelBCCubicD, kparm);
+  nrrdKernelSpecSet(muu->ksp[gageKernel22], nrrdKernelBCCubicDD, kparm);
+  muu->hctx->cam->atRelative = AIR_TRUE;
+  ELL_3V_SET(muu->hctx->cam->from, 3, -1.8, 4);
+  ELL_3V_SET(muu->hctx->cam->at, 0, 0, 0);
+  ELL_3V_SET(muu->hctx->cam->up, 0, 0, 1);
+  muu->hctx->cam->neer = -2;
+  muu->hctx->cam->faar = 2;
+  muu->hctx->cam->dist = 0;
+  muu->hctx->cam->fov = 28;
+  muu->hctx->imgSize[0] = 40;
+  muu->hctx->imgSize[1] = 34;
+  muu->hctx->numThreads = 2;
+  ELL_3V_SET(muu->lit->col[0], 1, 1, 1);
+  ELL_3V_SET(muu->lit->_dir[0], 1, 0, 1);
+  ELL_3V_SET(muu->lit->amb, 1, 1, 1);
+  muu->lit->on[0] = AIR_TRUE;
+  muu->lit->vsp[0] = AIR_TRUE;
+  if (limnCameraAspectSet(muu->hctx->cam, muu->hctx->imgSize[0],
+                          muu->hctx->imgSize[1], nrrdCenterCell)
+      || limnCameraUpdate(muu->hctx->cam)
+      || limnLightUpdate(muu->lit, muu->hctx->cam)) {
+    biffMovef(MITE, LIMN, "%s: trouble with camera or light", me);
+    airMopError(mop); return 1;
+  }
+  if (gageShapeSet(muu->shape, nin, 0)) {
+    biffMovef(MITE, GAGE, "%s: trouble with shape", me);
+    airMopError(mop); return 1;
+  }
+  muu->hctx->shape = muu->shape;
+  muu->hctx->user = muu;
+  muu->hctx->renderBegin = (hooverRenderBegin_t *)miteRenderBegin;
+  muu->hctx->threadBegin = (hooverThreadBegin_t *)miteThreadBegin;
+  muu->hctx->rayBegin = (hooverRayBegin_t *)miteRayBegin;
+  muu->hctx->sample = (hooverSample_t *)miteSample;
+  muu->hctx->rayEnd = (hooverRayEnd_t *)miteRayEnd;
+  muu->hctx->threadEnd = (hooverThreadEnd_t *)miteThreadEnd;
+  muu->hctx->renderEnd = (hooverRenderEnd_t *)miteRenderEnd;
+
+  /* see if the lookup table is made */
+  if (miteRenderBegin(&mrr, muu)) {
+    biffAddf(MITE, "%s: trouble starting", me);
+    airMopError(mop); return 1;
+  }
+  E = (!mrr->rangeLut != !wantLut);
+  miteRenderEnd(mrr, muu);
+  if (E) {
+    biffAddf(MITE, "%s: %s lookup table", me,
+             wantLut ? "didn't get" : "unexpectedly got");
+    airMopError(mop); return 1;
+  }
+
+  E = hooverRender(muu->hctx, &Ecode, &Ethread);
+  if (E) {
+    if (hooverErrInit == E) {
+      biffMovef(MITE, HOOVER, "%s: trouble starting", me);
+    } else {
+      biffAddf(MITE, "%s: %s error (code %d, thread %d)", me,
+               airEnumStr(hooverErr, E), Ecode, Ethread);
+    }
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/* makes txf (RGBA or A, depending on rgb), with an extra axis of size
+   two (with the same values at both indices) if extra */
+static int
+txfMake(Nrrd *ntxf, int rgb, int extra, const char *op) {
+  double *txf;
+  unsigned int ii, rnum, ei;
+
+  rnum = rgb ? 4 : 1;
+  if (extra
+      ? nrrdMaybeAlloc_va(ntxf, nrrdTypeDouble, 3, AIR_CAST(size_t, rnum),
+                          AIR_CAST(size_t, TXF_SIZE), AIR_CAST(size_t, 2))
+      : nrrdMaybeAlloc_va(ntxf, nrrdTypeDouble, 2, AIR_CAST(size_t, rnum),
+                          AIR_CAST(size_t, TXF_SIZE))) {
+    return 1;
+  }
+  txf = AIR_CAST(double *, ntxf->data);
+  for (ii=0; ii<TXF_SIZE; ii++) {
+    if (rgb) {
+      txf[0 + 4*ii] = AIR_AFFINE(0, ii, TXF_SIZE-1, 0.2, 1);
+      txf[1 + 4*ii] = 0.6;
+      txf[2 + 4*ii] = AIR_AFFINE(0, ii, TXF_SIZE-1, 1, 0.2);
+      txf[3 + 4*ii] = (ii < 0.3*TXF_SIZE ? 0 : 0.3);
+    } else {
+      txf[ii] = (ii < 0.5*TXF_SIZE ? 0 : 0.2*ii/TXF_SIZE);
+    }
+  }
+  if (extra) {
+    for (ei=0; ei<rnum*TXF_SIZE; ei++) {
+      txf[ei + rnum*TXF_SIZE] = txf[ei];
+    }
+  }
+  ntxf->axis[0].label = airStrdup(rgb ? "RGBA" : "A");
+  ntxf->axis[1].label = airStrdup("gage(scalar:v)");
+  ntxf->axis[1].min = 0;
+  ntxf->axis[1].max = 1;
+  if (extra) {
+    ntxf->axis[2].label = airStrdup("gage(scalar:gm)");
+    ntxf->axis[2].min = 0;
+    ntxf->axis[2].max = 1;
+  }
+  if (op) {
+    return nrrdKeyValueAdd(ntxf, "miteStageOp", op);
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  airArray *mop;
+  Nrrd *nin, *ntxf[2][2], *nout[2];
+  double rr;
+  float *in;
+  unsigned int xi, yi, zi, ei, ti, ci;
+  const mite_t *out;
+  int E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  airSrandMT(4242);
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  for (ei=0; ei<2; ei++) {
+    nout[ei] = nrrdNew();
+    airMopAdd(mop, nout[ei], (airMopper)nrrdNuke, airMopAlways);
+    for (ti=0; ti<2; ti++) {
+      ntxf[ei][ti] = nrrdNew();
+      airMopAdd(mop, ntxf[ei][ti], (airMopper)nrrdNuke, airMopAlways);
+    }
+  }
+  E = nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 3, AIR_CAST(size_t, SX),
+                        AIR_CAST(size_t, SY), AIR_CAST(size_t, SZ));
+  /* [ei][0]: colors and opacity; [ei][1]: more opacity, added */
+  for (ei=0; ei<2; ei++) {
+    if (!E) E |= txfMake(ntxf[ei][0], AIR_TRUE, ei, NULL);
+    if (!E) E |= txfMake(ntxf[ei][1], AIR_FALSE, ei, "add");
+  }
+  if (E) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  nrrdAxisInfoSet_va(nin, nrrdAxisInfoSpacing, 1.0, 1.0, 1.0);
+  in = AIR_CAST(float *, nin->data);
+  for (zi=0; zi<SZ; zi++) {
+    for (yi=0; yi<SY; yi++) {
+      for (xi=0; xi<SX; xi++) {
+        rr = ((xi - 11.0)*(xi - 11.0) + (yi - 10.0)*(yi - 10.0)
+              + (zi - 9.0)*(zi - 9.0))/25;
+        in[xi + SX*(yi + SY*zi)] = AIR_CAST(float, exp(-rr)
+                                            + 0.05*airDrandMT());
+      }
+    }
+  }
+
+  for (ti=1; ti<=2; ti++) {
+    for (ei=0; ei<2; ei++) {
+      if (render(nout[ei], nin, ntxf[ei], ti, !ei)) {
+        airMopAdd(mop, err = biffGetDone(MITE), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble rendering %u txfs:\n%s", me, ti, err);
+        airMopError(mop); return 1;
+      }
+    }
+    if (memcmp(nout[0]->data, nout[1]->data,
+               nrrdElementNumber(nout[0])*nrrdElementSize(nout[0]))) {
+      fprintf(stderr, "%s: %u txfs: lookup table changed the image\n",
+              me, ti);
+      airMopError(mop); return 1;
+    }
+    out = AIR_CAST(const mite_t *, nout[0]->data);
+    for (ci=0; ci<nrrdElementNumber(nout[0])/5 && !(out[3+5*ci] > 0.1);
+         ci++);
+    if (ci == nrrdElementNumber(nout[0])/5) {
+      fprintf(stderr, "%s: %u txfs: nothing visible\n", me, ti);
+      airMopError(mop); return 1;
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
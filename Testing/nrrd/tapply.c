@@ -0,0 +1,300 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdApply1DLut, nrrdApply1DRegMap, nrrdApplyMulti1DRegMap,
+** nrrdApply1DIrregMap (with and without an acl), and nrrdApply2DLut,
+** with and without rescaling, on input with non-existent values, by
+** checking that the output is the same with 1, 2, and 5 threads.  Also,
+** that 8-bit input (mapped via a table of all possible values) gives
+** the same output as the same values in float input
+*/
+
+#define SX 113
+#define SY 97
+#define MAP_LEN 23
+#define ENT_LEN 3
+#define CASE_NUM 11
+
+/* applies case ci to nin8 or nin, or nin2 for the 2D lut */
+static int
+apply(Nrrd *nout, unsigned int ci, const Nrrd *nin, const Nrrd *nin8,
+      const Nrrd *nin2, const NrrdRange *range, const NrrdRange *range2[2],
+      const Nrrd *nlut, const Nrrd *nrmap, const Nrrd *nmmap,
+      const Nrrd *nimap, const Nrrd *nacl, const Nrrd *nlut2) {
+  int ret;
+
+  switch (ci) {
+  case 0:
+    ret = nrrdApply1DLut(nout, nin, range, nlut, nrrdTypeFloat, AIR_FALSE);
+    break;
+  case 1:
+    ret = nrrdApply1DLut(nout, nin, range, nlut, nrrdTypeDouble, AIR_TRUE);
+    break;
+  case 2:
+    ret = nrrdApply1DLut(nout, nin8, NULL, nlut, nrrdTypeFloat, AIR_FALSE);
+    break;
+  case 3:
+    ret = nrrdApply1DRegMap(nout, nin, range, nrmap, nrrdTypeFloat,
+                            AIR_FALSE);
+    break;
+  case 4:
+    ret = nrrdApply1DRegMap(nout, nin, range, nrmap, nrrdTypeDouble,
+                            AIR_TRUE);
+    break;
+  case 5:
+    ret = nrrdApply1DRegMap(nout, nin8, NULL, nrmap, nrrdTypeShort,
+                            AIR_FALSE);
+    break;
+  case 6:
+    ret = nrrdApplyMulti1DRegMap(nout, nin, range, nmmap, nrrdTypeDouble,
+                                 AIR_TRUE);
+    break;
+  case 7:
+    ret = nrrdApply1DIrregMap(nout, nin, range, nimap, NULL,
+                              nrrdTypeDouble, AIR_FALSE);
+    break;
+  case 8:
+    ret = nrrdApply1DIrregMap(nout, nin, range, nimap, nacl,
+                              nrrdTypeFloat, AIR_TRUE);
+    break;
+  case 9:
+    ret = nrrdApply2DLut(nout, nin2, 0, range2[0], range2[1], nlut2,
+                         nrrdTypeDouble, AIR_FALSE, AIR_FALSE);
+    break;
+  default:
+    ret = nrrdApply2DLut(nout, nin2, 0, range2[0], range2[1], nlut2,
+                         nrrdTypeFloat, AIR_TRUE, AIR_TRUE);
+    break;
+  }
+  return ret;
+}
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  char *err, explain[AIR_STRLEN_LARGE];
+  Nrrd *nin, *nin8, *nin2, *nlut, *nrmap, *nmmap, *nimap, *nacl, *nlut2,
+    *nout[2], *ninf;
+  NrrdRange *range, *range2[2];
+  airArray *mop;
+  float *in, *in2, *inf, *map;
+  unsigned char *in8;
+  double *imap, pos;
+  size_t ii, num;
+  unsigned int ci, ti, tnum[2] = {2, 5};
+  int differ, E;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nin8 = nrrdNew();
+  airMopAdd(mop, nin8, (airMopper)nrrdNuke, airMopAlways);
+  ninf = nrrdNew();
+  airMopAdd(mop, ninf, (airMopper)nrrdNuke, airMopAlways);
+  nin2 = nrrdNew();
+  airMopAdd(mop, nin2, (airMopper)nrrdNuke, airMopAlways);
+  nlut = nrrdNew();
+  airMopAdd(mop, nlut, (airMopper)nrrdNuke, airMopAlways);
+  nrmap = nrrdNew();
+  airMopAdd(mop, nrmap, (airMopper)nrrdNuke, airMopAlways);
+  nmmap = nrrdNew();
+  airMopAdd(mop, nmmap, (airMopper)nrrdNuke, airMopAlways);
+  nimap = nrrdNew();
+  airMopAdd(mop, nimap, (airMopper)nrrdNuke, airMopAlways);
+  nacl = nrrdNew();
+  airMopAdd(mop, nacl, (airMopper)nrrdNuke, airMopAlways);
+  nlut2 = nrrdNew();
+  airMopAdd(mop, nlut2, (airMopper)nrrdNuke, airMopAlways);
+  nout[0] = nrrdNew();
+  airMopAdd(mop, nout[0], (airMopper)nrrdNuke, airMopAlways);
+  nout[1] = nrrdNew();
+  airMopAdd(mop, nout[1], (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_va(nin, nrrdTypeFloat, 2,
+                        AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nin8, nrrdTypeUChar, 2,
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(ninf, nrrdTypeFloat, 2,
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nin2, nrrdTypeFloat, 3, AIR_CAST(size_t, 2),
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nlut, nrrdTypeFloat, 2,
+                           AIR_CAST(size_t, ENT_LEN),
+                           AIR_CAST(size_t, MAP_LEN))
+      || nrrdMaybeAlloc_va(nrmap, nrrdTypeFloat, 2,
+                           AIR_CAST(size_t, ENT_LEN),
+                           AIR_CAST(size_t, MAP_LEN))
+      || nrrdMaybeAlloc_va(nmmap, nrrdTypeFloat, 3,
+                           AIR_CAST(size_t, 4),
+                           AIR_CAST(size_t, SX), AIR_CAST(size_t, SY))
+      || nrrdMaybeAlloc_va(nimap, nrrdTypeDouble, 2,
+                           AIR_CAST(size_t, ENT_LEN+1),
+                           AIR_CAST(size_t, MAP_LEN))
+      || nrrdMaybeAlloc_va(nlut2, nrrdTypeFloat, 3,
+                           AIR_CAST(size_t, ENT_LEN),
+                           AIR_CAST(size_t, MAP_LEN),
+                           AIR_CAST(size_t, MAP_LEN+4))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  /* inputs: mostly in [-1,2], with some non-existent values */
+  airSrandMT(4242);
+  in = AIR_CAST(float *, nin->data);
+  in8 = AIR_CAST(unsigned char *, nin8->data);
+  inf = AIR_CAST(float *, ninf->data);
+  in2 = AIR_CAST(float *, nin2->data);
+  num = nrrdElementNumber(nin);
+  for (ii=0; ii<num; ii++) {
+    switch (ii % 101) {
+    case 7:
+      in[ii] = AIR_NAN;
+      break;
+    case 37:
+      in[ii] = AIR_POS_INF;
+      break;
+    case 71:
+      in[ii] = AIR_NEG_INF;
+      break;
+    default:
+      in[ii] = AIR_CAST(float, AIR_AFFINE(0, airDrandMT(), 1, -1, 2));
+      break;
+    }
+    in8[ii] = AIR_CAST(unsigned char, airRandInt(256));
+    inf[ii] = in8[ii];
+    in2[0 + 2*ii] = AIR_CAST(float, AIR_AFFINE(0, airDrandMT(), 1, -1, 2));
+    in2[1 + 2*ii] = (ii % 89 == 5
+                     ? AIR_NAN
+                     : AIR_CAST(float, AIR_AFFINE(0, airDrandMT(), 1,
+                                                  -3, 4)));
+  }
+  /* maps, with domains [0,1] (or [-2,3] for the 2nd axis of the 2D lut) */
+  map = AIR_CAST(float *, nlut->data);
+  for (ii=0; ii<nrrdElementNumber(nlut); ii++) {
+    map[ii] = AIR_CAST(float, airDrandMT());
+  }
+  map = AIR_CAST(float *, nrmap->data);
+  for (ii=0; ii<nrrdElementNumber(nrmap); ii++) {
+    map[ii] = AIR_CAST(float, airDrandMT());
+  }
+  map = AIR_CAST(float *, nmmap->data);
+  for (ii=0; ii<nrrdElementNumber(nmmap); ii++) {
+    map[ii] = AIR_CAST(float, airDrandMT());
+  }
+  map = AIR_CAST(float *, nlut2->data);
+  for (ii=0; ii<nrrdElementNumber(nlut2); ii++) {
+    map[ii] = AIR_CAST(float, airDrandMT());
+  }
+  nlut->axis[1].min = nrmap->axis[1].min = nmmap->axis[0].min = 0;
+  nlut->axis[1].max = nrmap->axis[1].max = nmmap->axis[0].max = 1;
+  nlut2->axis[1].min = 0;
+  nlut2->axis[1].max = 1;
+  nlut2->axis[2].min = -2;
+  nlut2->axis[2].max = 3;
+  /* irregular map: first three positions -inf, NaN, +inf, then
+     increasing positions in [0,1] */
+  imap = AIR_CAST(double *, nimap->data);
+  pos = 0;
+  for (ii=0; ii<MAP_LEN; ii++) {
+    switch (ii) {
+    case 0: imap[0 + (ENT_LEN+1)*ii] = AIR_NEG_INF; break;
+    case 1: imap[0 + (ENT_LEN+1)*ii] = AIR_NAN; break;
+    case 2: imap[0 + (ENT_LEN+1)*ii] = AIR_POS_INF; break;
+    default:
+      imap[0 + (ENT_LEN+1)*ii] = pos;
+      pos += (0.5 + airDrandMT())/(MAP_LEN-3);
+      break;
+    }
+    for (ci=1; ci<=ENT_LEN; ci++) {
+      imap[ci + (ENT_LEN+1)*ii] = airDrandMT();
+    }
+  }
+  range = nrrdRangeNewSet(nin, nrrdBlind8BitRangeFalse);
+  airMopAdd(mop, range, (airMopper)nrrdRangeNix, airMopAlways);
+  range2[0] = nrrdRangeNew(-1, 2);
+  airMopAdd(mop, range2[0], (airMopper)nrrdRangeNix, airMopAlways);
+  range2[1] = nrrdRangeNew(-3, 4);
+  airMopAdd(mop, range2[1], (airMopper)nrrdRangeNix, airMopAlways);
+  if (nrrd1DIrregAclGenerate(nacl, nimap, 17)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble making acl:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+
+  for (ci=0; ci<CASE_NUM; ci++) {
+    nrrdStateThreadNum = 1;
+    if (apply(nout[0], ci, nin, nin8, nin2, range,
+              AIR_CAST(const NrrdRange **, range2),
+              nlut, nrmap, nmmap, nimap, nacl, nlut2)) {
+      airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble with case %u:\n%s", me, ci, err);
+      airMopError(mop); return 1;
+    }
+    for (ti=0; ti<2; ti++) {
+      nrrdStateThreadNum = tnum[ti];
+      E = apply(nout[1], ci, nin, nin8, nin2, range,
+                AIR_CAST(const NrrdRange **, range2),
+                nlut, nrmap, nmmap, nimap, nacl, nlut2);
+      if (!E) {
+        E = nrrdCompare(nout[0], nout[1], AIR_TRUE /* onlyData */,
+                        0.0 /* epsilon */, &differ, explain);
+      }
+      if (E) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble with case %u, %u threads:\n%s", me,
+                ci, tnum[ti], err);
+        airMopError(mop); return 1;
+      }
+      if (differ) {
+        fprintf(stderr, "%s: case %u differs with 1 and %u threads: %s\n",
+                me, ci, tnum[ti], explain);
+        airMopError(mop); return 1;
+      }
+    }
+    printf("%s: good: case %u\n", me, ci);
+  }
+
+  /* 8-bit input is mapped via a table of all 256 results; this should
+     be the same as mapping the same values as floats */
+  nrrdStateThreadNum = 1;
+  if (nrrdApply1DLut(nout[0], nin8, NULL, nlut, nrrdTypeFloat, AIR_FALSE)
+      || nrrdApply1DLut(nout[1], ninf, NULL, nlut, nrrdTypeFloat, AIR_FALSE)
+      || nrrdCompare(nout[0], nout[1], AIR_TRUE, 0.0, &differ, explain)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with 8-bit lut:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (differ) {
+    fprintf(stderr, "%s: 8-bit lut differs from float: %s\n", me, explain);
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdKeyValueAdd, nrrdKeyValueGet, nrrdKeyValueErase, nrrdKeyValueIndex
+** with enough keys that they are hashed, and nrrdLoad with skipData
+** of a detached header whose data file is missing
+*/
+
+#define KEY_NUM 3000
+
+static int
+checkKeys(const char *me, const Nrrd *nrrd, unsigned int keyNum,
+          const char *what) {
+  char key[AIR_STRLEN_SMALL], val[AIR_STRLEN_SMALL], *got;
+  unsigned int ki;
+
+  if (keyNum != nrrdKeyValueSize(nrrd)) {
+    fprintf(stderr, "%s: %s: have %u keys, not %u\n", me, what,
+            nrrdKeyValueSize(nrrd), keyNum);
+    return 1;
+  }
+  for (ki=0; ki<KEY_NUM; ki++) {
+    sprintf(key, "DWMRI_gradient_%04u", ki);
+    sprintf(val, "%u %u %u", ki, ki % 7 ? ki : 2*ki, ki + 1);
+    got = nrrdKeyValueGet(nrrd, key);
+    /* every 5th key (other than 0) was erased */
+    if (ki && !(ki % 5)) {
+      if (got) {
+        fprintf(stderr, "%s: %s: erased key \"%s\" still has \"%s\"\n",
+                me, what, key, got);
+        return 1;
+      }
+    } else {
+      if (!got || strcmp(val, got)) {
+        fprintf(stderr, "%s: %s: key \"%s\" has \"%s\", not \"%s\"\n",
+                me, what, key, got ? got : "(NULL)", val);
+        return 1;
+      }
+    }
+    airFree(got);
+  }
+  return 0;
+}
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  Nrrd *nrrd, *nhead;
+  NrrdIoState *nio;
+  airArray *mop;
+  char key[AIR_STRLEN_SMALL], val[AIR_STRLEN_SMALL], *kk, *vv, *err;
+  unsigned int ki, keyNum;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  nrrd = nrrdNew();
+  airMopAdd(mop, nrrd, (airMopper)nrrdNuke, airMopAlways);
+
+  if (nrrdMaybeAlloc_va(nrrd, nrrdTypeFloat, 2,
+                        AIR_CAST(size_t, 4), AIR_CAST(size_t, 5))) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  for (ki=0; ki<KEY_NUM; ki++) {
+    sprintf(key, "DWMRI_gradient_%04u", ki);
+    sprintf(val, "%u %u %u", ki, ki, ki + 1);
+    nrrdKeyValueAdd(nrrd, key, val);
+  }
+  /* over-write some, erase others */
+  for (ki=0; ki<KEY_NUM; ki += 7) {
+    sprintf(key, "DWMRI_gradient_%04u", ki);
+    sprintf(val, "%u %u %u", ki, 2*ki, ki + 1);
+    nrrdKeyValueAdd(nrrd, key, val);
+  }
+  keyNum = KEY_NUM;
+  for (ki=5; ki<KEY_NUM; ki += 5) {
+    sprintf(key, "DWMRI_gradient_%04u", ki);
+    nrrdKeyValueErase(nrrd, key);
+    keyNum--;
+  }
+  if (checkKeys(me, nrrd, keyNum, "in memory")) {
+    airMopError(mop); return 1;
+  }
+  /* order of pairs is order of first addition */
+  nrrdKeyValueIndex(nrrd, &kk, &vv, 5);
+  airMopAdd(mop, kk, airFree, airMopAlways);
+  airMopAdd(mop, vv, airFree, airMopAlways);
+  if (strcmp("DWMRI_gradient_0006", kk)) {
+    fprintf(stderr, "%s: key[5] is \"%s\", not \"DWMRI_gradient_0006\"\n",
+            me, kk);
+    airMopError(mop); return 1;
+  }
+
+  /* header round-trip, without the data file */
+  nhead = nrrdNew();
+  airMopAdd(mop, nhead, (airMopper)nrrdNuke, airMopAlways);
+  nio = nrrdIoStateNew();
+  airMopAdd(mop, nio, (airMopper)nrrdIoStateNix, airMopAlways);
+  nio->skipData = AIR_TRUE;
+  if (nrrdSave("tkvpTest.nhdr", nrrd, NULL)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble saving:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  /* skipData should mean that the data file is never opened */
+  remove("tkvpTest.raw");
+  if (nrrdLoad(nhead, "tkvpTest.nhdr", nio)) {
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble with header-only load:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  if (nhead->data || 2 != nhead->dim || 5 != nhead->axis[1].size) {
+    fprintf(stderr, "%s: header-only load got wrong nrrd\n", me);
+    airMopError(mop); return 1;
+  }
+  if (checkKeys(me, nhead, keyNum, "from header")) {
+    airMopError(mop); return 1;
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,153 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdProject, with various measures, axes, and thread counts,
+** against nrrdMeasureLine applied to each line
+*/
+
+#define SX 37
+#define SY 1100
+#define SZ 5
+
+int
+main(int argc, const char *argv[]) {
+  const char *me;
+  Nrrd *nin, *nout[2], *nline;
+  airArray *mop;
+  float *in;
+  double *line, ans, got;
+  size_t ii, size[3], oi, li, ci, ri, colNum, linLen, rowNum;
+  unsigned int axis, mi, ai;
+  int differ;
+  char explain[AIR_STRLEN_LARGE];
+  static const int measr[] = {nrrdMeasureMin,
+                              nrrdMeasureMax,
+                              nrrdMeasureMean,
+                              nrrdMeasureSum,
+                              nrrdMeasureL2,
+                              nrrdMeasureVariance,
+                              nrrdMeasureSD,
+                              nrrdMeasureMedian,
+                              nrrdMeasureLinf};
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+
+  size[0] = SX; size[1] = SY; size[2] = SZ;
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nout[0] = nrrdNew();
+  airMopAdd(mop, nout[0], (airMopper)nrrdNuke, airMopAlways);
+  nout[1] = nrrdNew();
+  airMopAdd(mop, nout[1], (airMopper)nrrdNuke, airMopAlways);
+  nline = nrrdNew();
+  airMopAdd(mop, nline, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdMaybeAlloc_nva(nin, nrrdTypeFloat, 3, size)
+      || nrrdMaybeAlloc_va(nline, nrrdTypeDouble, 1,
+                           AIR_CAST(size_t, SY))) {
+    char *err;
+    airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+    airMopError(mop); return 1;
+  }
+  in = AIR_CAST(float *, nin->data);
+  line = AIR_CAST(double *, nline->data);
+  airSrandMT(4242);
+  for (ii=0; ii<SX*SY*SZ; ii++) {
+    /* lines with all, some, and no non-existent values */
+    in[ii] = (airDrandMT() < 0.1 || 7 == ii % SX
+              ? AIR_NAN
+              : AIR_CAST(float, 100 + 10*airDrandMT()));
+  }
+
+  for (axis=0; axis<3; axis++) {
+    colNum = rowNum = 1;
+    for (ai=0; ai<3; ai++) {
+      if (ai < axis) {
+        colNum *= size[ai];
+      } else if (ai > axis) {
+        rowNum *= size[ai];
+      }
+    }
+    linLen = size[axis];
+    for (mi=0; mi<AIR_UINT(sizeof(measr)/sizeof(int)); mi++) {
+      nrrdStateThreadNum = 1;
+      if (nrrdProject(nout[0], nin, axis, measr[mi], nrrdTypeDouble)) {
+        char *err;
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble projecting:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      nrrdStateThreadNum = 3;
+      if (nrrdProject(nout[1], nin, axis, measr[mi], nrrdTypeDouble)) {
+        char *err;
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble projecting:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      if (nrrdCompare(nout[0], nout[1], AIR_TRUE /* onlyData */,
+                      0.0 /* epsilon */, &differ, explain)) {
+        char *err;
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble comparing:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      if (differ) {
+        fprintf(stderr, "%s: %s along axis %u differs with 1 and 3 "
+                "threads: %s\n", me, airEnumStr(nrrdMeasure, measr[mi]),
+                axis, explain);
+        airMopError(mop); return 1;
+      }
+      /* compare against measuring each line */
+      for (ri=0; ri<rowNum; ri++) {
+        for (ci=0; ci<colNum; ci++) {
+          oi = ci + colNum*ri;
+          for (li=0; li<linLen; li++) {
+            line[li] = in[ci + colNum*(li + linLen*ri)];
+          }
+          nrrdMeasureLine[measr[mi]](&ans, nrrdTypeDouble,
+                                     line, nrrdTypeDouble, linLen,
+                                     AIR_NAN, AIR_NAN);
+          got = AIR_CAST(double *, nout[0]->data)[oi];
+          if (!( ans == got || (!AIR_EXISTS(ans) && !AIR_EXISTS(got)) )) {
+            fprintf(stderr, "%s: %s along axis %u: output[%u] = %.17g "
+                    "!= %.17g from nrrdMeasureLine\n", me,
+                    airEnumStr(nrrdMeasure, measr[mi]), axis,
+                    AIR_UINT(oi), got, ans);
+            airMopError(mop); return 1;
+          }
+        }
+      }
+      printf("%s: good: %s along axis %u\n", me,
+             airEnumStr(nrrdMeasure, measr[mi]), axis);
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -0,0 +1,139 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "teem/nrrd.h"
+
+/*
+** Tests:
+** nrrdSave and nrrdLoad of VTK files, both BINARY (which is big-endian,
+** and is written in pieces bigger than the swap buffer) and ASCII (for
+** the smaller arrays), for slices and volumes of scalars, multi-component
+** scalars, vectors, and tensors
+*/
+
+#define LAYOUT_NUM 6
+
+static const unsigned int
+sizes[LAYOUT_NUM][4] = {
+  {1, 70, 60, 0},     /* dim 2: scalars */
+  {1, 70, 60, 50},    /* dim 3: scalars */
+  {2, 70, 60, 50},    /* dim 4: "SCALARS name type 2" */
+  {3, 70, 60, 50},    /* dim 4: VECTORS */
+  {4, 70, 60, 50},    /* dim 4: "SCALARS name type 4" */
+  {9, 20, 20, 10}};   /* dim 4: TENSORS */
+
+int
+main(int argc, const char **argv) {
+  const char *me;
+  char *err;
+  static const int type[3] = {nrrdTypeShort, nrrdTypeFloat,
+                              nrrdTypeDouble};
+  Nrrd *nin, *nout;
+  NrrdIoState *nio;
+  airArray *mop;
+  unsigned int li, ti, ei, dim;
+  size_t size[4], ii, nn;
+  int enc;
+  double val;
+
+  AIR_UNUSED(argc);
+  me = argv[0];
+  mop = airMopNew();
+  nin = nrrdNew();
+  airMopAdd(mop, nin, (airMopper)nrrdNuke, airMopAlways);
+  nout = nrrdNew();
+  airMopAdd(mop, nout, (airMopper)nrrdNuke, airMopAlways);
+  nio = nrrdIoStateNew();
+  airMopAdd(mop, nio, (airMopper)nrrdIoStateNix, airMopAlways);
+
+  for (li=0; li<LAYOUT_NUM; li++) {
+    if (!sizes[li][3]) {
+      dim = 2;
+      size[0] = sizes[li][1];
+      size[1] = sizes[li][2];
+    } else if (1 == sizes[li][0]) {
+      dim = 3;
+      size[0] = sizes[li][1];
+      size[1] = sizes[li][2];
+      size[2] = sizes[li][3];
+    } else {
+      dim = 4;
+      size[0] = sizes[li][0];
+      size[1] = sizes[li][1];
+      size[2] = sizes[li][2];
+      size[3] = sizes[li][3];
+    }
+    for (ti=0; ti<3; ti++) {
+      if (nrrdMaybeAlloc_nva(nin, type[ti], dim, size)) {
+        airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+        fprintf(stderr, "%s: trouble allocating:\n%s", me, err);
+        airMopError(mop); return 1;
+      }
+      nn = nrrdElementNumber(nin);
+      for (ii=0; ii<nn; ii++) {
+        /* values that survive the ascii encoding exactly */
+        val = AIR_CAST(double, (ii*7919) % 30011) - 15000.0;
+        nrrdDInsert[nin->type](nin->data, ii,
+                               nrrdTypeShort == nin->type ? val : val/4);
+      }
+      for (ei=0; ei<2; ei++) {
+        if (ei && nn > 100000) {
+          /* ascii is slow, and only the binary writer works in pieces */
+          continue;
+        }
+        enc = ei ? nrrdEncodingTypeAscii : nrrdEncodingTypeRaw;
+        nio->encoding = nrrdEncodingArray[enc];
+        if (nrrdSave("tvtkTest.vtk", nin, nio)
+            || nrrdLoad(nout, "tvtkTest.vtk", NULL)) {
+          airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
+          fprintf(stderr, "%s: trouble with %s %s layout %u:\n%s", me,
+                  airEnumStr(nrrdEncodingType, enc),
+                  airEnumStr(nrrdType, nin->type), li, err);
+          airMopError(mop); return 1;
+        }
+        if (!( nout->type == nin->type
+               && nrrdElementNumber(nout) == nn
+               && nout->dim == (2 == dim ? 3 : dim)
+               && (4 != dim || nout->axis[0].size == size[0]) )) {
+          fprintf(stderr, "%s: %s %s layout %u: read back %u-D %s array "
+                  "(%u values/point) with %u values\n", me,
+                  airEnumStr(nrrdEncodingType, enc),
+                  airEnumStr(nrrdType, nin->type), li, nout->dim,
+                  airEnumStr(nrrdType, nout->type),
+                  AIR_CAST(unsigned int, nout->axis[0].size),
+                  AIR_CAST(unsigned int, nrrdElementNumber(nout)));
+          airMopError(mop); return 1;
+        }
+        if (memcmp(nin->data, nout->data, nn*nrrdElementSize(nin))) {
+          fprintf(stderr, "%s: %s %s layout %u: data didn't survive\n", me,
+                  airEnumStr(nrrdEncodingType, enc),
+                  airEnumStr(nrrdType, nin->type), li);
+          airMopError(mop); return 1;
+        }
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
@@ -355,6 +355,10 @@ AIR_EXPORT airThreadCond *airThreadCondNix(airThreadCond *cond);
 AIR_EXPORT airThreadBarrier *airThreadBarrierNew(unsigned numUsers);
 AIR_EXPORT int airThreadBarrierWait(airThreadBarrier *barrier);
 AIR_EXPORT airThreadBarrier *airThreadBarrierNix(airThreadBarrier *barrier);
+AIR_EXPORT int airThreadRun(unsigned int threadNum,
+                             void *(*threadBody)(void *),
+                             void *arg, size_t argSize,
+                             airThreadMutex **mutexP);
 
 /* ---- END non-NrrdIO */
 
@@ -640,6 +644,14 @@ AIR_EXPORT void airHalton(double *out, unsigned int indx,
 AIR_EXPORT const unsigned int airPrimeList[AIR_PRIME_NUM];
 AIR_EXPORT unsigned int airCRC32(const unsigned char *data, size_t len,
                                  size_t unit, int swap);
+AIR_EXPORT unsigned int airCRC32Update(unsigned int crc,
+                                       const unsigned char *data, size_t len,
+                                       size_t unit, int swap);
+AIR_EXPORT unsigned int airCRC32Combine(unsigned int crcA, unsigned int crcB,
+                                        size_t lenB);
+AIR_EXPORT unsigned int airCRC32Finish(unsigned int crc, size_t len);
+AIR_EXPORT airULLong airXXH64(const unsigned char *data, size_t len,
+                              size_t unit, int swap, airULLong seed);
 /* ---- END non-NrrdIO */
 
 /* dio.c */
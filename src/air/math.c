@@ -1051,12 +1051,223 @@ crcTable[] = {
 /* note "c" is used once */
 #define CRC32(crc, c) (crc) = (((crc) << 8) ^ crcTable[((crc) >> 24) ^ (c)])
 
+/*
+** crcSlice[k][b] is the CRC contribution of byte b followed by k zero
+** bytes, so that 8 bytes can be folded into the CRC with 8 independent
+** table lookups ("slicing-by-8") instead of 8 dependent ones.  The tables
+** are computed from crcTable on first use.  crcSlice[0] is crcTable.
+*/
+static unsigned int
+crcSlice[8][256];
+static int
+crcSliceDone = AIR_FALSE;
+
+static void
+crcSliceInit(void) {
+  unsigned int bi, ki, cc;
+
+  for (bi=0; bi<256; bi++) {
+    crcSlice[0][bi] = crcTable[bi];
+  }
+  for (ki=1; ki<8; ki++) {
+    for (bi=0; bi<256; bi++) {
+      cc = crcSlice[ki-1][bi];
+      crcSlice[ki][bi] = (cc << 8) ^ crcTable[cc >> 24];
+    }
+  }
+  crcSliceDone = AIR_TRUE;
+  return;
+}
+
+static unsigned int
+crcSliceUpdate(unsigned int crc, const unsigned char *cdata, size_t len) {
+
+  for (; len >= 8; len -= 8, cdata += 8) {
+    crc ^= ((AIR_CAST(unsigned int, cdata[0]) << 24)
+            | (AIR_CAST(unsigned int, cdata[1]) << 16)
+            | (AIR_CAST(unsigned int, cdata[2]) << 8)
+            | AIR_CAST(unsigned int, cdata[3]));
+    crc = (crcSlice[7][crc >> 24]
+           ^ crcSlice[6][(crc >> 16) & 0xff]
+           ^ crcSlice[5][(crc >> 8) & 0xff]
+           ^ crcSlice[4][crc & 0xff]
+           ^ crcSlice[3][cdata[4]]
+           ^ crcSlice[2][cdata[5]]
+           ^ crcSlice[1][cdata[6]]
+           ^ crcSlice[0][cdata[7]]);
+  }
+  for (; len; len--) {
+    CRC32(crc, *(cdata++));
+  }
+  return crc;
+}
+
+/*
+** same as crcSliceUpdate, but for byte-swapped 2, 4, or 8-byte units:
+** within each group of 8 bytes, byte pp[ii] is fed ii-th to the CRC.
+** len must be a multiple of 8.
+*/
+static unsigned int
+crcSliceSwapUpdate(unsigned int crc, const unsigned char *cdata, size_t len,
+                   const unsigned int *pp) {
+
+  for (; len; len -= 8, cdata += 8) {
+    crc ^= ((AIR_CAST(unsigned int, cdata[pp[0]]) << 24)
+            | (AIR_CAST(unsigned int, cdata[pp[1]]) << 16)
+            | (AIR_CAST(unsigned int, cdata[pp[2]]) << 8)
+            | AIR_CAST(unsigned int, cdata[pp[3]]));
+    crc = (crcSlice[7][crc >> 24]
+           ^ crcSlice[6][(crc >> 16) & 0xff]
+           ^ crcSlice[5][(crc >> 8) & 0xff]
+           ^ crcSlice[4][crc & 0xff]
+           ^ crcSlice[3][cdata[pp[4]]]
+           ^ crcSlice[2][cdata[pp[5]]]
+           ^ crcSlice[1][cdata[pp[6]]]
+           ^ crcSlice[0][cdata[pp[7]]]);
+  }
+  return crc;
+}
+
+/*
+******** airCRC32Update
+**
+** continues the CRC "crc" (0 to start) with "len" bytes from "cdata",
+** WITHOUT the trailing data length and final inversion that make it
+** the cksum CRC; those are added by airCRC32Finish.  Because the CRC is
+** started at 0, it is linear in the data, which is what allows CRCs of
+** separate blocks to be joined with airCRC32Combine.  If "swap", the
+** bytes within each "unit"-sized piece are reversed as they are fed to
+** the CRC, and "len" should be a multiple of "unit".
+**
+** The lookup tables are set up on the first call; a multi-threaded
+** caller should make one (perhaps zero-length) call before its threads
+** start.
+*/
 unsigned int
-airCRC32(const unsigned char *cdata, size_t len, size_t unit, int swap) {
-  unsigned int crc=0;
-  size_t ii, jj, nn, mm;
+airCRC32Update(unsigned int crc, const unsigned char *cdata, size_t len,
+               size_t unit, int swap) {
+  static const unsigned int
+    perm2[8] = {1, 0, 3, 2, 5, 4, 7, 6},
+    perm4[8] = {3, 2, 1, 0, 7, 6, 5, 4},
+    perm8[8] = {7, 6, 5, 4, 3, 2, 1, 0};
+  unsigned char rev[4096];
+  size_t ii, jj, mm, nn;
   const unsigned char *crev;
 
+  if (!crcSliceDone) {
+    crcSliceInit();
+  }
+  if (!(cdata && len)) {
+    return crc;
+  }
+  if (swap && (2 == unit || 4 == unit || 8 == unit)) {
+    /* the common cases can be permuted in place, in groups of 8 bytes;
+       what remains is a whole number of units, done below */
+    nn = len - len % 8;
+    crc = crcSliceSwapUpdate(crc, cdata, nn,
+                             2 == unit ? perm2 : (4 == unit ? perm4 : perm8));
+    cdata += nn;
+    len -= nn;
+    if (!len) {
+      return crc;
+    }
+  }
+  if (!swap || 1 == unit) {
+    crc = crcSliceUpdate(crc, cdata, len);
+  } else if (unit > sizeof(rev)) {
+    /* have to swap, work "unit" bytes at a time, working down
+       the bytes within each unit */
+    mm = len / unit;
+    for (jj=0; jj<mm; jj++) {
+      crev = cdata + jj*unit + unit-1;
+      for (ii=0; ii<unit; ii++) {
+        CRC32(crc, *(crev--));
+      }
+    }
+  } else {
+    /* same, but reversing a buffer-full of units at a time, so that
+       they can go through crcSliceUpdate */
+    mm = len / unit;
+    nn = sizeof(rev) / unit;
+    while (mm) {
+      nn = AIR_MIN(nn, mm);
+      for (jj=0; jj<nn; jj++) {
+        crev = cdata + jj*unit + unit-1;
+        for (ii=0; ii<unit; ii++) {
+          rev[ii + jj*unit] = *(crev--);
+        }
+      }
+      crc = crcSliceUpdate(crc, rev, nn*unit);
+      cdata += nn*unit;
+      mm -= nn;
+    }
+  }
+  return crc;
+}
+
+/* product of polynomials "aa" and "bb", modulo the CRC polynomial */
+static unsigned int
+crcMulMod(unsigned int aa, unsigned int bb) {
+  unsigned int rr;
+  int ii;
+
+  rr = 0;
+  for (ii=31; ii>=0; ii--) {
+    rr = (rr << 1) ^ ((rr & 0x80000000) ? 0x04c11db7 : 0);
+    if ((bb >> ii) & 1) {
+      rr ^= aa;
+    }
+  }
+  return rr;
+}
+
+/*
+******** airCRC32Combine
+**
+** given airCRC32Update results "crcA" and "crcB" of two blocks of data,
+** the second of which is "lenB" bytes long, returns the airCRC32Update
+** result for the concatenation of the two blocks.  Cost is logarithmic
+** in lenB.
+*/
+unsigned int
+airCRC32Combine(unsigned int crcA, unsigned int crcB, size_t lenB) {
+  unsigned int shift, base;
+
+  /* crcA has to be multiplied by x^(8*lenB) */
+  shift = 1;
+  base = 0x100;
+  while (lenB) {
+    if (lenB & 1) {
+      shift = crcMulMod(shift, base);
+    }
+    base = crcMulMod(base, base);
+    lenB >>= 1;
+  }
+  return crcMulMod(crcA, shift) ^ crcB;
+}
+
+/*
+******** airCRC32Finish
+**
+** turns the airCRC32Update result "crc" over all "len" bytes of data
+** into the final (cksum) CRC value
+*/
+unsigned int
+airCRC32Finish(unsigned int crc, size_t len) {
+
+  if (!crcSliceDone) {
+    crcSliceInit();
+  }
+  /* include length of data in result */
+  for (; len; len >>= 8) {
+    CRC32(crc, (len & 0xff));
+  }
+  return ~crc;
+}
+
+unsigned int
+airCRC32(const unsigned char *cdata, size_t len, size_t unit, int swap) {
+
   if (!(cdata && len)) {
     return 0;
   }
@@ -1067,29 +1278,193 @@ airCRC32(const unsigned char *cdata, size_t len, size_t unit, int swap) {
       return 0;
     }
   }
-  nn = len;
+  return airCRC32Finish(airCRC32Update(0, cdata, len, unit, swap), len);
+}
+
+/*
+** xxHash64, by Yann Collet, following the specification at
+** https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+** so that airXXH64 results match those of "xxhsum -H64" on the same
+** bytes.  Data is consumed in 32-byte stripes by four accumulators.
+*/
+#define XXH_P1 AIR_ULLONG(0x9E3779B185EBCA87)
+#define XXH_P2 AIR_ULLONG(0xC2B2AE3D27D4EB4F)
+#define XXH_P3 AIR_ULLONG(0x165667B19E3779F9)
+#define XXH_P4 AIR_ULLONG(0x85EBCA77C2B2AE63)
+#define XXH_P5 AIR_ULLONG(0x27D4EB2F165667C5)
+#define XXH_ROTL(x, r) (((x) << (r)) | ((x) >> (64 - (r))))
+
+static airULLong
+xxhRead64(const unsigned char *pp) {
+  /* the spec reads little-endian words, regardless of host */
+  return (AIR_CAST(airULLong, pp[0])
+          | (AIR_CAST(airULLong, pp[1]) << 8)
+          | (AIR_CAST(airULLong, pp[2]) << 16)
+          | (AIR_CAST(airULLong, pp[3]) << 24)
+          | (AIR_CAST(airULLong, pp[4]) << 32)
+          | (AIR_CAST(airULLong, pp[5]) << 40)
+          | (AIR_CAST(airULLong, pp[6]) << 48)
+          | (AIR_CAST(airULLong, pp[7]) << 56));
+}
+
+static airULLong
+xxhRound(airULLong acc, airULLong lane) {
+  acc += lane*XXH_P2;
+  acc = XXH_ROTL(acc, 31);
+  return acc*XXH_P1;
+}
+
+static airULLong
+xxhMerge(airULLong hh, airULLong acc) {
+  hh ^= xxhRound(0, acc);
+  return hh*XXH_P1 + XXH_P4;
+}
+
+typedef struct {
+  airULLong acc[4], total;
+  unsigned char buff[32];
+  unsigned int buffLen;
+} xxhState;
+
+static void
+xxhStripes(xxhState *xs, const unsigned char *pp, size_t num) {
+  size_t si;
+
+  for (si=0; si<num; si++, pp += 32) {
+    xs->acc[0] = xxhRound(xs->acc[0], xxhRead64(pp));
+    xs->acc[1] = xxhRound(xs->acc[1], xxhRead64(pp + 8));
+    xs->acc[2] = xxhRound(xs->acc[2], xxhRead64(pp + 16));
+    xs->acc[3] = xxhRound(xs->acc[3], xxhRead64(pp + 24));
+  }
+  return;
+}
 
-  if (!swap) {
-    /* simple case: feed "len" bytes from "cdata" into CRC32 */
-    for (ii=0; ii<nn; ii++) {
-      CRC32(crc, *(cdata++));
+static void
+xxhUpdate(xxhState *xs, const unsigned char *pp, size_t len) {
+  size_t nn;
+
+  xs->total += len;
+  if (xs->buffLen) {
+    nn = AIR_MIN(len, 32 - xs->buffLen);
+    memcpy(xs->buff + xs->buffLen, pp, nn);
+    xs->buffLen += AIR_CAST(unsigned int, nn);
+    pp += nn;
+    len -= nn;
+    if (32 == xs->buffLen) {
+      xxhStripes(xs, xs->buff, 1);
+      xs->buffLen = 0;
     }
+  }
+  if (len >= 32) {
+    xxhStripes(xs, pp, len/32);
+    pp += 32*(len/32);
+    len %= 32;
+  }
+  if (len) {
+    memcpy(xs->buff, pp, len);
+    xs->buffLen = AIR_CAST(unsigned int, len);
+  }
+  return;
+}
+
+static airULLong
+xxhDigest(const xxhState *xs, airULLong seed) {
+  airULLong hh, kk;
+  const unsigned char *pp;
+  unsigned int rem;
+
+  if (xs->total >= 32) {
+    hh = (XXH_ROTL(xs->acc[0], 1) + XXH_ROTL(xs->acc[1], 7)
+          + XXH_ROTL(xs->acc[2], 12) + XXH_ROTL(xs->acc[3], 18));
+    hh = xxhMerge(hh, xs->acc[0]);
+    hh = xxhMerge(hh, xs->acc[1]);
+    hh = xxhMerge(hh, xs->acc[2]);
+    hh = xxhMerge(hh, xs->acc[3]);
   } else {
-    /* have to swap, work "unit" bytes at a time, working down
-       the bytes within each unit */
+    hh = seed + XXH_P5;
+  }
+  hh += xs->total;
+  pp = xs->buff;
+  rem = xs->buffLen;
+  for (; rem >= 8; rem -= 8, pp += 8) {
+    hh ^= xxhRound(0, xxhRead64(pp));
+    hh = XXH_ROTL(hh, 27)*XXH_P1 + XXH_P4;
+  }
+  if (rem >= 4) {
+    kk = (AIR_CAST(airULLong, pp[0])
+          | (AIR_CAST(airULLong, pp[1]) << 8)
+          | (AIR_CAST(airULLong, pp[2]) << 16)
+          | (AIR_CAST(airULLong, pp[3]) << 24));
+    hh ^= kk*XXH_P1;
+    hh = XXH_ROTL(hh, 23)*XXH_P2 + XXH_P3;
+    rem -= 4;
+    pp += 4;
+  }
+  for (; rem; rem--, pp++) {
+    hh ^= AIR_CAST(airULLong, *pp)*XXH_P5;
+    hh = XXH_ROTL(hh, 11)*XXH_P1;
+  }
+  hh ^= hh >> 33;
+  hh *= XXH_P2;
+  hh ^= hh >> 29;
+  hh *= XXH_P3;
+  hh ^= hh >> 32;
+  return hh;
+}
+
+/*
+******** airXXH64
+**
+** 64-bit xxHash (with given "seed") of "len" bytes from "cdata"; "unit"
+** and "swap" have the same meaning as with airCRC32.  This is much faster
+** than the CRC (it is usually limited by memory bandwidth), but it is
+** not a cryptographic hash.
+*/
+airULLong
+airXXH64(const unsigned char *cdata, size_t len, size_t unit, int swap,
+         airULLong seed) {
+  unsigned char rev[4096];
+  size_t ii, jj, mm, nn;
+  const unsigned char *crev;
+  xxhState xs;
+
+  xs.acc[0] = seed + XXH_P1 + XXH_P2;
+  xs.acc[1] = seed + XXH_P2;
+  xs.acc[2] = seed;
+  xs.acc[3] = seed - XXH_P1;
+  xs.total = 0;
+  xs.buffLen = 0;
+  if (!cdata) {
+    len = 0;
+  }
+  if (swap && !(unit && !(len % unit))) {
+    return 0;
+  }
+  if (!swap || 1 == unit || !len) {
+    xxhUpdate(&xs, cdata, len);
+  } else if (unit > sizeof(rev)) {
     mm = len / unit;
     for (jj=0; jj<mm; jj++) {
       crev = cdata + jj*unit + unit-1;
       for (ii=0; ii<unit; ii++) {
-        CRC32(crc, *(crev--));
+        xxhUpdate(&xs, crev--, 1);
       }
     }
+  } else {
+    mm = len / unit;
+    nn = sizeof(rev) / unit;
+    while (mm) {
+      nn = AIR_MIN(nn, mm);
+      for (jj=0; jj<nn; jj++) {
+        crev = cdata + jj*unit + unit-1;
+        for (ii=0; ii<unit; ii++) {
+          rev[ii + jj*unit] = *(crev--);
+        }
+      }
+      xxhUpdate(&xs, rev, nn*unit);
+      cdata += nn*unit;
+      mm -= nn;
+    }
   }
-
-  /* include length of data in result */
-  for (; nn; nn >>= 8) {
-    CRC32(crc, (nn & 0xff));
-  }
-
-  return ~crc;
+  return xxhDigest(&xs, seed);
 }
@@ -593,3 +593,83 @@ airThreadBarrierNix(airThreadBarrier *barrier) {
   airFree(barrier);
   return NULL;
 }
+
+/*
+******** airThreadRun
+**
+** The usual way of doing some work with threadNum threads: calls
+** threadBody(arg) in threadNum different threads, one of which is the
+** calling thread, and returns once they have all finished.  When
+** argSize is non-zero, arg is the first of threadNum structs of that
+** size, and thread ti gets the ti'th; otherwise all get the same arg.
+**
+** If mutexP is non-NULL, *mutexP is set (before any threadBody is
+** called) to a new mutex for the threads to share, or to NULL when
+** there's no need for one (one thread, or no multi-threading), and it
+** is freed (and *mutexP set to NULL) at the end.  So, threadBody has
+** to check for a NULL mutex before locking it.
+**
+** A thread that can't be started has its threadBody called by the
+** calling thread after the others finish, so threadBody shouldn't
+** depend on running concurrently with the others (it won't when
+** dividing up work via a shared queue: the late call just finds the
+** queue empty).
+**
+** Returns non-zero only if allocation failed, in which case no
+** threadBody was called.
+*/
+int
+airThreadRun(unsigned int threadNum, void *(*threadBody)(void *),
+             void *arg, size_t argSize, airThreadMutex **mutexP) {
+  airThread **thread;
+  int *started;
+  void *ret;
+  unsigned int ti;
+
+  threadNum = AIR_MAX(1, threadNum);
+  thread = NULL;
+  started = NULL;
+  if (threadNum > 1) {
+    thread = AIR_CALLOC(threadNum, airThread *);
+    started = AIR_CALLOC(threadNum, int);
+    if (!( thread && started )) {
+      airFree(thread);
+      airFree(started);
+      return 1;
+    }
+  }
+  if (mutexP) {
+    if (threadNum > 1 && airThreadCapable) {
+      if (!(*mutexP = airThreadMutexNew())) {
+        airFree(thread);
+        airFree(started);
+        return 1;
+      }
+    } else {
+      *mutexP = NULL;
+    }
+  }
+  for (ti=1; ti<threadNum; ti++) {
+    if ((thread[ti] = airThreadNew())) {
+      started[ti] = !airThreadStart(thread[ti], threadBody,
+                                    AIR_CAST(char *, arg) + ti*argSize);
+    }
+  }
+  threadBody(arg);
+  for (ti=1; ti<threadNum; ti++) {
+    if (started[ti]) {
+      airThreadJoin(thread[ti], &ret);
+    } else {
+      threadBody(AIR_CAST(char *, arg) + ti*argSize);
+    }
+    if (thread[ti]) {
+      airThreadNix(thread[ti]);
+    }
+  }
+  if (mutexP && *mutexP) {
+    *mutexP = airThreadMutexNix(*mutexP);
+  }
+  airFree(thread);
+  airFree(started);
+  return 0;
+}
@@ -53,7 +53,7 @@ main(int argc, const char *argv[]) {
   hestOpt *hopt = NULL;
   NrrdKernelSpec *ksp;
   int otype, separ, ret;
-  unsigned int maxIter;
+  unsigned int maxIter, threadNum;
   double epsilon, lastDiff, step;
   Nrrd *nin, *nout;
   airArray *mop;
@@ -85,7 +85,17 @@ main(int argc, const char *argv[]) {
              NULL, NULL, &unrrduHestMaybeTypeCB);
   hestOptAdd(&hopt, "sep", "bool", airTypeBool, 1, 1, &separ, "false",
              "use fast separable deconvolution instead of brain-dead "
-             "brute-force iterative method");
+             "brute-force iterative method; this solves directly (without "
+             "iterating) for the exact deconvolution, but is only "
+             "available for some kernels (e.g. bspl3, bspl5)");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &threadNum, "1",
+             (airThreadCapable
+              ? "number of threads to use for separable deconvolution, "
+              "each doing whole scanlines; the output is the same with "
+              "any number"
+              : "if pthreads where enabled in this Teem build, this is how "
+              "you would control the number of threads to use for "
+              "separable deconvolution"));
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
              "output volume");
   hestParseOrDie(hopt, argc-1, argv+1, hparm,
@@ -97,6 +107,7 @@ main(int argc, const char *argv[]) {
   airMopAdd(mop, nout, AIR_CAST(airMopper, nrrdNuke), airMopAlways);
 
   if (separ) {
+    nrrdStateThreadNum = threadNum;
     ret = gageDeconvolveSeparable(nout, nin, kind, ksp, otype);
   } else {
     ret = gageDeconvolve(nout, &lastDiff,
@@ -44,19 +44,228 @@ printans(FILE *file, const double *ans, unsigned int len) {
   }
 }
 
+#define GRID_PROBE_CHUNK 4096
+/* given positions are probed in bigger chunks, so that gageProbeBatch()
+   can re-order more of them for iv3 cache re-use */
+#define LIST_PROBE_CHUNK 65536
+
+/*
+** what is shared by the threads that probe, a chunk at a time, either a
+** list of given positions or the positions of a grid.  Each
+** thread probes with its own gageProbeState of the shared context, and
+** every position is probed the same way regardless of which thread gets
+** it, so the output is the same with any number of threads
+*/
+typedef struct {
+  gageContext *ctx;           /* the shared context */
+  unsigned int pvlIdx,        /* index of the pervolume to query */
+    ansLen;
+  int what, indexSpace, clamp, verbose;
+  const double *pos;          /* positions given, or NULL to use grid */
+  size_t posStride;
+  const double *grid;         /* else, grid (as in gridProbe) */
+  unsigned int gridDim, baseDim;
+  const size_t *sizeOut;
+  Nrrd *nout;                 /* output */
+  double (*ins)(void *v, size_t I, double d);
+  size_t num,                 /* total number of positions */
+    chunk,                    /* how many positions to hand out at once */
+    next;                     /* first position not yet handed out */
+  int stopAtErr;              /* stop handing out chunks after an error */
+  size_t errIdx;              /* lowest index that couldn't be probed,
+                                 or num if there was no such error */
+  int errNum;
+  char errStr[AIR_STRLEN_LARGE];
+  double errPos[4];
+  airThreadMutex *mutex;      /* NULL if only one thread */
+} probeTask;
+
+/* what one thread has to itself */
+typedef struct {
+  probeTask *task;
+  gageContext *gctx;          /* the context, or the probe state's */
+  double *cpos, *cans;        /* buffers for one chunk */
+} probeThread;
+
+static void *
+probeWorker(void *_pth) {
+  probeThread *pth;
+  probeTask *task;
+  const gagePerVolume *cpvl[1];
+  const double *pos;
+  double *cp;
+  size_t II, CI, chunkNum, stride, coordOut[NRRD_DIM_MAX];
+  unsigned int dim, aidx;
+  char stmp[2][AIR_STRLEN_SMALL];
+
+  pth = AIR_CAST(probeThread *, _pth);
+  task = pth->task;
+  cpvl[0] = pth->gctx->pvl[task->pvlIdx];
+  dim = task->baseDim + task->gridDim;
+  coordOut[0] = 0;
+  for (;;) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    II = ((task->stopAtErr && task->errIdx < task->num)
+          ? task->num
+          : task->next);
+    task->next = AIR_MIN(task->num, II + task->chunk);
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (II >= task->num) {
+      break;
+    }
+    chunkNum = AIR_MIN(task->num - II, task->chunk);
+    if (task->pos) {
+      pos = task->pos + II*task->posStride;
+      stride = task->posStride;
+    } else {
+      NRRD_COORD_GEN(coordOut + task->baseDim, task->sizeOut + task->baseDim,
+                     task->gridDim, II);
+      for (CI=0; CI<chunkNum; CI++) {
+        if (task->verbose && 3 == task->gridDim
+            && !coordOut[task->baseDim] && !coordOut[task->baseDim+1]) {
+          if (task->verbose > 1) {
+            fprintf(stderr, "z = ");
+          }
+          fprintf(stderr, " %s/%s",
+                  airSprintSize_t(stmp[0], coordOut[task->baseDim+2]),
+                  airSprintSize_t(stmp[1], task->sizeOut[task->baseDim+2]));
+          fflush(stderr);
+          if (task->verbose > 1) {
+            fprintf(stderr, "\n");
+          }
+        }
+        cp = pth->cpos + 4*CI;
+        ELL_4V_COPY(cp, task->grid + 1 + 5*0);
+        for (aidx=0; aidx<task->gridDim; aidx++) {
+          ELL_4V_SCALE_ADD2(cp, 1, cp,
+                            AIR_CAST(double, coordOut[aidx + task->baseDim]),
+                            task->grid + 1 + 5*(1+aidx));
+        }
+        NRRD_COORD_INCR(coordOut, task->sizeOut, dim, task->baseDim);
+      }
+      pos = pth->cpos;
+      stride = 4;
+    }
+    CI = 0;
+    if (gageProbeBatch(pth->gctx, pth->cans, task->ansLen, cpvl,
+                       &(task->what), 1, pos, stride, chunkNum,
+                       task->indexSpace, task->clamp, &CI)) {
+      if (task->mutex) {
+        airThreadMutexLock(task->mutex);
+      }
+      if (II + CI < task->errIdx) {
+        task->errIdx = II + CI;
+        task->errNum = pth->gctx->errNum;
+        airStrcpy(task->errStr, AIR_STRLEN_LARGE, pth->gctx->errStr);
+        ELL_3V_COPY(task->errPos, pos + stride*CI);
+        task->errPos[3] = stride > 3 ? pos[3 + stride*CI] : AIR_NAN;
+      }
+      if (task->mutex) {
+        airThreadMutexUnlock(task->mutex);
+      }
+      if (gageErrUnknown == pth->gctx->errNum) {
+        /* nothing in the chunk was probed, so there are no answers */
+        continue;
+      }
+    }
+    for (CI=0; CI<task->ansLen*chunkNum; CI++) {
+      task->ins(task->nout->data, CI + task->ansLen*II, pth->cans[CI]);
+    }
+  }
+  return _pth;
+}
+
+/*
+** probes all task->num positions with threadNum threads (including
+** the calling one).  Biff errors are only for problems setting up;
+** probing errors are described by task->errIdx et al.
+*/
+static int
+probeRun(probeTask *task, unsigned int threadNum) {
+  static const char me[]="probeRun";
+  probeThread *pth;
+  gageProbeState **gps;
+  unsigned int ti;
+  airArray *mop;
+
+  mop = airMopNew();
+  threadNum = AIR_MAX(1, threadNum);
+  pth = AIR_CALLOC(threadNum, probeThread);
+  airMopAdd(mop, pth, airFree, airMopAlways);
+  gps = AIR_CALLOC(threadNum, gageProbeState *);
+  airMopAdd(mop, gps, airFree, airMopAlways);
+  if (!( pth && gps )) {
+    biffAddf(GAGE, "%s: couldn't allocate thread state", me);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    pth[ti].task = task;
+    if (threadNum > 1) {
+      if (!(gps[ti] = gageProbeStateNew(task->ctx))) {
+        biffAddf(GAGE, "%s: couldn't make probe state %u", me, ti);
+        airMopError(mop); return 1;
+      }
+      airMopAdd(mop, gps[ti], (airMopper)gageProbeStateNix, airMopAlways);
+      pth[ti].gctx = gps[ti]->ctx;
+    } else {
+      pth[ti].gctx = task->ctx;
+    }
+    pth[ti].cpos = (task->pos
+                    ? NULL
+                    : AIR_CALLOC(4*task->chunk, double));
+    airMopAdd(mop, pth[ti].cpos, airFree, airMopAlways);
+    pth[ti].cans = AIR_CALLOC(task->ansLen*task->chunk, double);
+    airMopAdd(mop, pth[ti].cans, airFree, airMopAlways);
+    if (!( (task->pos || pth[ti].cpos) && pth[ti].cans )) {
+      biffAddf(GAGE, "%s: couldn't allocate position and answer buffers",
+               me);
+      airMopError(mop); return 1;
+    }
+  }
+  task->next = 0;
+  task->errIdx = task->num;
+  if (airThreadRun(threadNum, probeWorker, pth, sizeof(probeThread),
+                   &(task->mutex))) {
+    biffAddf(GAGE, "%s: couldn't start threads", me);
+    airMopError(mop); return 1;
+  }
+  if (threadNum > 1) {
+    for (ti=0; ti<threadNum; ti++) {
+      gageContextStatsAdd(task->ctx, gps[ti]->ctx);
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+static unsigned int
+pvlIndex(const gageContext *ctx, const gagePerVolume *pvl) {
+  unsigned int pvlIdx;
+
+  for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+    if (pvl == ctx->pvl[pvlIdx]) {
+      break;
+    }
+  }
+  return pvlIdx;
+}
+
 static int
 gridProbe(gageContext *ctx, gagePerVolume *pvl, int what,
           Nrrd *nout, int typeOut, Nrrd *_ngrid,
-          int indexSpace, int verbose, int clamp) {
+          int indexSpace, int verbose, int clamp, unsigned int threadNum) {
   char me[]="gridProbe";
   Nrrd *ngrid;
   airArray *mop;
-  double *grid, pos[4];
-  const double *answer;
+  double *grid;
+  probeTask task;
   unsigned int ansLen, dim, aidx, baseDim, gridDim;
-  size_t sizeOut[NRRD_DIM_MAX], coordOut[NRRD_DIM_MAX], II, NN;
-  double (*ins)(void *v, size_t I, double d);
-  char stmp[2][AIR_STRLEN_SMALL];
+  size_t sizeOut[NRRD_DIM_MAX], NN;
+  char stmp[1][AIR_STRLEN_SMALL];
 
   if (!(ctx && pvl && nout && _ngrid)) {
     biffAddf(GAGE, "%s: got NULL pointer", me);
@@ -115,7 +324,6 @@ gridProbe(gageContext *ctx, gagePerVolume *pvl, int what,
              1 + gridDim, gridDim);
     airMopError(mop); return 1;
   }
-  answer = gageAnswerPointer(ctx, pvl, what);
   ansLen = pvl->kind->table[what].answerLength;
   baseDim = 1 == ansLen ? 0 : 1;
   dim = baseDim + gridDim;
@@ -125,67 +333,45 @@ gridProbe(gageContext *ctx, gagePerVolume *pvl, int what,
   }
   if (ansLen > 1) {
     sizeOut[0] = ansLen;
-    coordOut[0] = 0;
   }
   NN = 1;
   for (aidx=0; aidx<gridDim; aidx++) {
     sizeOut[aidx + baseDim] = AIR_ROUNDUP_UI(grid[0 + 5*(aidx+1)]);
     NN *= sizeOut[aidx + baseDim];
-    coordOut[aidx + baseDim] = 0;
   }
   if (nrrdMaybeAlloc_nva(nout, typeOut, dim, sizeOut)) {
     biffMovef(GAGE, NRRD, "%s: couldn't allocate output", me);
     airMopError(mop); return 1;
   }
-  ins = nrrdDInsert[nout->type];
-  for (II=0; II<NN; II++) {
-    int E;
-    if (verbose && 3 == gridDim && !coordOut[0] && !coordOut[1]) {
-      if (verbose > 1) {
-        fprintf(stderr, "z = ");
-      }
-      fprintf(stderr, " %s/%s",
-              airSprintSize_t(stmp[0], coordOut[2]),
-              airSprintSize_t(stmp[1], sizeOut[2]));
-      fflush(stderr);
-      if (verbose > 1) {
-        fprintf(stderr, "\n");
-      }
-    }
-    ELL_4V_COPY(pos, grid + 1 + 5*0);
-    for (aidx=0; aidx<gridDim; aidx++) {
-      ELL_4V_SCALE_ADD2(pos, 1, pos,
-                        AIR_CAST(double, coordOut[aidx + baseDim]),
-                        grid + 1 + 5*(1+aidx));
-    }
-    /*
-    printf("%s: %u -> (%u %u) -> %g %g %g %g (%s)\n", me,
-           AIR_UINT(II),
-           AIR_UINT(coordOut[0+baseDim]),
-           AIR_UINT(coordOut[1+baseDim]),
-           pos[0], pos[1], pos[2], pos[3],
-           indexSpace ? "index" : "world");
-    */
-    E = (ctx->stackPos
-         ? gageStackProbeSpace(ctx, pos[0], pos[1], pos[2], pos[3],
-                               indexSpace, clamp)
-         : gageProbeSpace(ctx, pos[0], pos[1], pos[2],
-                          indexSpace, clamp));
-    if (E) {
-      biffAddf(GAGE, "%s: trouble at II=%s =(%g,%g,%g,%g):\n%s\n(%d)\n", me,
-               airSprintSize_t(stmp[0], II),
-               pos[0], pos[1], pos[2], pos[3],
-               ctx->errStr, ctx->errNum);
-      airMopError(mop); return 1;
-    }
-    if (1 == ansLen) {
-      ins(nout->data, II, *answer);
-    } else {
-      for (aidx=0; aidx<ansLen; aidx++) {
-        ins(nout->data, aidx + ansLen*II, answer[aidx]);
-      }
-    }
-    NRRD_COORD_INCR(coordOut, sizeOut, dim, baseDim);
+  /* positions are generated and probed GRID_PROBE_CHUNK at a time */
+  task.ctx = ctx;
+  task.pvlIdx = pvlIndex(ctx, pvl);
+  task.ansLen = ansLen;
+  task.what = what;
+  task.indexSpace = indexSpace;
+  task.clamp = clamp;
+  task.verbose = verbose;
+  task.pos = NULL;
+  task.posStride = 0;
+  task.grid = grid;
+  task.gridDim = gridDim;
+  task.baseDim = baseDim;
+  task.sizeOut = sizeOut;
+  task.nout = nout;
+  task.ins = nrrdDInsert[nout->type];
+  task.num = NN;
+  task.chunk = GRID_PROBE_CHUNK;
+  task.stopAtErr = AIR_TRUE;
+  if (probeRun(&task, threadNum)) {
+    biffAddf(GAGE, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  if (task.errIdx < NN) {
+    biffAddf(GAGE, "%s: trouble at II=%s =(%g,%g,%g,%g):\n%s\n(%d)\n", me,
+             airSprintSize_t(stmp[0], task.errIdx),
+             task.errPos[0], task.errPos[1], task.errPos[2], task.errPos[3],
+             task.errStr, task.errNum);
+    airMopError(mop); return 1;
   }
   if (verbose && verbose <= 1) {
     fprintf(stderr, "\n");
@@ -218,13 +404,13 @@ int
 main(int argc, const char *argv[]) {
   gageKind *kind;
   const char *me;
-  char *whatS, *err, *outS, *stackFnameFormat;
+  char *whatS, *err, *outS, *stackFnameFormat, *stackCacheDir;
   hestParm *hparm;
   hestOpt *hopt = NULL;
   NrrdKernelSpec *k00, *k11, *k22, *kSS, *kSSblur;
   int what, E=0, renorm, uniformSS, optimSS, verbose, zeroZ,
-    orientationFromSpacing, probeSpaceIndex, normdSS;
-  unsigned int iBaseDim, oBaseDim, axi, numSS, seed;
+    orientationFromSpacing, probeSpaceIndex, normdSS, stats;
+  unsigned int iBaseDim, oBaseDim, axi, numSS, seed, threadNum;
   const double *answer;
   Nrrd *nin, *_npos, *npos, *_ngrid, *ngrid, *nout, **ninSS=NULL;
   Nrrd *ngrad=NULL, *nbmat=NULL;
@@ -354,6 +540,14 @@ main(int argc, const char *argv[]) {
              "exist and match the stack parameters, and where to save "
              "them if they had to be re-computed.  Leave this as empty "
              "string to disable this.");
+  hestOptAdd(&hopt, "ssc", "SS cache dir", airTypeString, 1, 1,
+             &stackCacheDir, "",
+             "directory in which to cache pre-blurred volumes, with "
+             "filenames determined by a hash of the input volume and "
+             "the stack parameters, so that later runs with the same "
+             "input and parameters can re-use them (instead of naming "
+             "the files with -ssf).  Leave this as empty string to "
+             "disable this.");
 
   hestOptAdd(&hopt, "kssr", "kernel", airTypeOther, 1, 1, &kSS,
              "hermite", "kernel for reconstructing from scale space samples",
@@ -386,6 +580,16 @@ main(int argc, const char *argv[]) {
              "whether the probe location specification (by any of "
              "the four previous flags) are in index space");
 
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &threadNum, "1",
+             (airThreadCapable
+              ? "number of threads to probe with (with \"-pi\" or on a "
+              "grid), each with its own gageProbeState; the output is "
+              "the same with any number"
+              : "if pthreads where enabled in this Teem build, this is how "
+              "you would control the number of threads to probe with"));
+  hestOptAdd(&hopt, "stats", NULL, airTypeInt, 0, 0, &stats, NULL,
+             "count and time the phases of probing, and print a summary "
+             "of this afterwards");
   hestOptAdd(&hopt, "t", "type", airTypeEnum, 1, 1, &otype, "float",
              "type of output volume", NULL, nrrdType);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -395,6 +599,14 @@ main(int argc, const char *argv[]) {
   airMopAdd(mop, hopt, AIR_CAST(airMopper, hestOptFree), airMopAlways);
   airMopAdd(mop, hopt, AIR_CAST(airMopper, hestParseFree), airMopAlways);
 
+  if (!airThreadCapable && 1 != threadNum) {
+    fprintf(stderr, "%s: This Teem not compiled with "
+            "multi-threading support.\n", me);
+    fprintf(stderr, "%s: ==> can't use %u threads; only using 1\n",
+            me, threadNum);
+    threadNum = 1;
+  }
+
   what = airEnumVal(kind->enm, whatS);
   if (!what) {
     /* 0 indeed always means "unknown" for any gageKind */
@@ -431,6 +643,11 @@ main(int argc, const char *argv[]) {
     unsigned int vi;
     int recompute, gotOld;
 
+    if (airStrlen(stackFnameFormat) && airStrlen(stackCacheDir)) {
+      fprintf(stderr, "%s: can't use both -ssf and -ssc\n", me);
+      airMopError(mop); return 1;
+    }
+
     if (sbpCL) {
       /* we got the whole stack blar parm here */
       gotOld = AIR_FALSE;
@@ -448,9 +665,12 @@ main(int argc, const char *argv[]) {
         fprintf(stderr, ")\n");
         airMopError(mop); return 1;
       }
-      if (gageStackBlurManage(&ninSS, &recompute, sbpCL,
-                              stackFnameFormat, AIR_TRUE, NULL,
-                              nin, kind)) {
+      if (airStrlen(stackCacheDir)
+          ? gageStackBlurCache(&ninSS, &recompute, sbpCL,
+                               stackCacheDir, nin, kind)
+          : gageStackBlurManage(&ninSS, &recompute, sbpCL,
+                                stackFnameFormat, AIR_TRUE, NULL,
+                                nin, kind)) {
         airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
         fprintf(stderr, "%s: trouble getting volume stack:\n%s\n", me, err);
         airMopError(mop); return 1;
@@ -475,9 +695,12 @@ main(int argc, const char *argv[]) {
           || gageStackBlurParmKernelSet(sbpIN, kSSblur)
           || gageStackBlurParmRenormalizeSet(sbpIN, AIR_TRUE)
           || gageStackBlurParmBoundarySet(sbpIN, nrrdBoundaryBleed, AIR_NAN)
-          || gageStackBlurManage(&ninSS, &recompute, sbpIN,
-                                 stackFnameFormat, AIR_TRUE, NULL,
-                                 nin, kind)) {
+          || (airStrlen(stackCacheDir)
+              ? gageStackBlurCache(&ninSS, &recompute, sbpIN,
+                                   stackCacheDir, nin, kind)
+              : gageStackBlurManage(&ninSS, &recompute, sbpIN,
+                                    stackFnameFormat, AIR_TRUE, NULL,
+                                    nin, kind))) {
         airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
         fprintf(stderr, "%s: trouble getting volume stack:\n%s\n", me, err);
         airMopError(mop); return 1;
@@ -511,6 +734,7 @@ main(int argc, const char *argv[]) {
   gageParmSet(ctx, gageParmRenormalize, renorm ? AIR_TRUE : AIR_FALSE);
   gageParmSet(ctx, gageParmCheckIntegrals, AIR_TRUE);
   gageParmSet(ctx, gageParmOrientationFromSpacing, orientationFromSpacing);
+  gageParmSet(ctx, gageParmStats, stats);
   E = 0;
   if (!E) E |= !(pvl = gagePerVolumeNew(ctx, nin, kind));
   if (!E) E |= gageKernelSet(ctx, gageKernel00, k00->kernel, k00->parm);
@@ -636,9 +860,8 @@ main(int argc, const char *argv[]) {
 
   if (_npos) {
     /* given a nrrd of probe locations */
-    double *pos, (*ins)(void *v, size_t I, double d);
-    size_t II, NN;
-    unsigned int aidx;
+    probeTask task;
+    size_t NN;
     if (!(2 == _npos->dim
           && (3 == _npos->axis[0].size || 4 == _npos->axis[0].size))) {
       fprintf(stderr, "%s: need npos 2-D 3-by-N or 4-by-N "
@@ -667,37 +890,36 @@ main(int argc, const char *argv[]) {
       airMopError(mop); return 1;
     }
 
-    pos = AIR_CAST(double *, npos->data);
-    ins = nrrdDInsert[nout->type];
-    for (II=0; II<NN; II++) {
-      if (sbp) {
-        gageStackProbeSpace(ctx, pos[0], pos[1], pos[2], pos[3],
-                            probeSpaceIndex, clamp);
-      } else {
-        gageProbeSpace(ctx, pos[0], pos[1], pos[2],
-                       probeSpaceIndex, clamp);
-      }
-      if (1 == ansLen) {
-        ins(nout->data, II, *answer);
-      } else {
-        for (aidx=0; aidx<ansLen; aidx++) {
-          ins(nout->data, aidx + ansLen*II, answer[aidx]);
-        }
-      }
-      /*
-      if (sbp) {
-        printf("%s: %s(%s:%g,%g,%g,%g) = ", me, airEnumStr(kind->enm, what),
-               probeSpaceIndex ? "index" : "world",
-               pos[0], pos[1], pos[2], pos[3]);
-      } else {
-        printf("%s: %s(%s:%g,%g,%g) = ", me, airEnumStr(kind->enm, what),
-               probeSpaceIndex ? "index" : "world",
-               pos[0], pos[1], pos[2]);
-      }
-      printans(stdout, answer, ansLen);
-      printf("\n");
-      */
-      pos += _npos->axis[0].size;
+    task.ctx = ctx;
+    task.pvlIdx = pvlIndex(ctx, pvl);
+    task.ansLen = ansLen;
+    task.what = what;
+    task.indexSpace = probeSpaceIndex;
+    task.clamp = clamp;
+    task.verbose = verbose;
+    task.pos = AIR_CAST(const double *, npos->data);
+    task.posStride = _npos->axis[0].size;
+    task.grid = NULL;
+    task.gridDim = task.baseDim = 0;
+    task.sizeOut = NULL;
+    task.nout = nout;
+    task.ins = nrrdDInsert[nout->type];
+    task.num = NN;
+    task.chunk = LIST_PROBE_CHUNK;
+    task.stopAtErr = AIR_FALSE;
+    if (probeRun(&task, threadNum)) {
+      airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble probing:\n%s\n", me, err);
+      airMopError(mop); return 1;
+    }
+    if (task.errIdx < NN) {
+      fprintf(stderr, "%s: WARNING: couldn't probe all positions (answers "
+              "are NaN); first at II=%s:\n%s\n(%d)\n", me,
+              airSprintSize_t(stmp[0], task.errIdx), task.errStr,
+              task.errNum);
+    }
+    if (stats) {
+      gageContextStatsPrint(stderr, ctx);
     }
     if (nrrdSave(outS, nout, NULL)) {
       airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
@@ -837,7 +1059,7 @@ main(int argc, const char *argv[]) {
                 (_ngrid
                  ? probeSpaceIndex  /* user specifies grid space */
                  : AIR_TRUE),       /* copying vprobe index-space behavior */
-                verbose, clamp)) {
+                verbose, clamp, threadNum)) {
     /* note hijacking of GAGE key */
     airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble probing on grid:\n%s\n", me, err);
@@ -849,6 +1071,9 @@ main(int argc, const char *argv[]) {
             AIR_CAST(double, nrrdElementNumber(nout)/ansLen)
             / (1000.0*(t1-t0)));
   }
+  if (stats) {
+    gageContextStatsPrint(stderr, ctx);
+  }
 
   /* massage output some */
   nrrdContentSet_va(nout, "gprobe", nin, "%s", airEnumStr(kind->enm, what));
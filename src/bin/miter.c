@@ -32,6 +32,19 @@
 static const char *miteInfo =
   ("A simple but effective little volume renderer.");
 
+/* for progressive rendering: reports on each level */
+static int
+progressReport(const Nrrd *nimg, unsigned int stride, unsigned int rayNum,
+               void *data) {
+  double *time0;
+
+  AIR_UNUSED(nimg);
+  time0 = AIR_CAST(double *, data);
+  fprintf(stderr, "\n    (every %u pixels: %u rays, %g secs so far) ",
+          stride, rayNum, airTime() - *time0);
+  return 0;
+}
+
 int
 main(int argc, const char *argv[]) {
   airArray *mop;
@@ -40,10 +53,11 @@ main(int argc, const char *argv[]) {
   miteUser *muu;
   const char *me;
   char *errS, *outS, *shadeStr, *normalStr, debugStr[AIR_STRLEN_MED];
-  int renorm, baseDim, verbPix[2], offfr;
+  int renorm, baseDim, verbPix[2], offfr, stats;
   int E, Ecode, Ethread;
   float ads[3], isScale;
-  double turn, eye[3], eyedist, gmc;
+  double turn, eye[3], eyedist, gmc, progThresh, time0;
+  unsigned int progStride;
   double v[NRRD_SPACE_DIM_MAX];
   Nrrd *nin;
 
@@ -133,12 +147,37 @@ main(int argc, const char *argv[]) {
              "-1 -1", "pixel for which to turn on verbose messages");
   hestOptAdd(&hopt, "n1", "near1", airTypeDouble, 1, 1, &(muu->opacNear1),
              "0.99", "opacity close enough to 1.0 to terminate ray");
+  hestOptAdd(&hopt, "skip", "block", airTypeUInt, 1, 1, &(muu->skipBlock),
+             "0", "if non-zero, skip over empty space (where opacity is "
+             "zero, when that is set by a transfer function of scalar "
+             "value), with blocks of this many voxels on edge");
+  hestOptAdd(&hopt, "prog", "stride", airTypeUInt, 1, 1, &progStride,
+             "1", "if greater than 1 (and a power of two), render "
+             "progressively: first every stride-th ray, then every "
+             "stride/2-th, and so on");
+  hestOptAdd(&hopt, "pthr", "thresh", airTypeDouble, 1, 1, &progThresh,
+             "-1", "with \"-prog\", if non-negative: don't cast rays in "
+             "between rays of the previous level that differ (in RGBA) by "
+             "at most this; interpolate instead");
+  hestOptAdd(&hopt, "tile", "sx sy", airTypeUInt, 2, 2,
+             muu->hctx->tileSize, "16 16",
+             "size (in pixels) of the image tiles that are the units "
+             "of work handed out to threads");
+  hestOptAdd(&hopt, "pk", "size", airTypeUInt, 1, 1,
+             &(muu->hctx->packetSize), "1",
+             "if greater than 1, sample the volume in packets of this "
+             "many consecutive samples along each ray (at most 8)");
   hestOptAdd(&hopt, "nt", "# threads", airTypeInt, 1, 1,
              &(muu->hctx->numThreads), "1",
              (airThreadCapable
               ? "number of threads hoover should use"
               : "if pthreads where enabled in this Teem build, this is how "
               "you would control the number of threads hoover should use"));
+  hestOptAdd(&hopt, "stats", NULL, airTypeInt, 0, 0, &stats, NULL,
+             "after rendering, print per-thread counts (of rays, early "
+             "terminated rays, samples, skipped samples) and times "
+             "(probing, shading, waiting); with \"-prog\", these are for "
+             "the last level of rays");
   hestOptAdd(&hopt, "o", "filename", airTypeString, 1, 1, &outS,
              NULL, "file to write output nrrd to");
   hestParseOrDie(hopt, argc-1, argv+1, hparm,
@@ -249,6 +288,7 @@ main(int argc, const char *argv[]) {
   muu->hctx->threadBegin = (hooverThreadBegin_t *)miteThreadBegin;
   muu->hctx->rayBegin = (hooverRayBegin_t *)miteRayBegin;
   muu->hctx->sample = (hooverSample_t *)miteSample;
+  muu->hctx->packetSample = (hooverPacketSample_t *)miteSamplePacket;
   muu->hctx->rayEnd = (hooverRayEnd_t *)miteRayEnd;
   muu->hctx->threadEnd = (hooverThreadEnd_t *)miteThreadEnd;
   muu->hctx->renderEnd = (hooverRenderEnd_t *)miteRenderEnd;
@@ -261,9 +301,27 @@ main(int argc, const char *argv[]) {
     muu->hctx->numThreads = 1;
   }
 
+  if (stats) {
+    muu->hctx->stats = hooverStatsNew();
+    airMopAdd(mop, muu->hctx->stats, (airMopper)hooverStatsNix,
+              airMopAlways);
+  }
+
   fprintf(stderr, "%s: rendering ... ", me); fflush(stderr);
 
-  E = hooverRender(muu->hctx, &Ecode, &Ethread);
+  if (progStride > 1) {
+    time0 = airTime();
+    if (miteRenderProgressive(muu, progStride, progThresh,
+                              progressReport, &time0)) {
+      airMopAdd(mop, errS = biffGetDone(MITE), airFree, airMopAlways);
+      fprintf(stderr, "%s: trouble rendering:\n%s\n", me, errS);
+      airMopError(mop);
+      return 1;
+    }
+    E = 0;
+  } else {
+    E = hooverRender(muu->hctx, &Ecode, &Ethread);
+  }
   if (E) {
     if (hooverErrInit == E) {
       errS = biffGetDone(HOOVER);
@@ -279,6 +337,9 @@ main(int argc, const char *argv[]) {
   fprintf(stderr, "\n");
   fprintf(stderr, "%s: rendering time = %g secs\n", me, muu->rendTime);
   fprintf(stderr, "%s: sampling rate = %g Khz\n", me, muu->sampRate);
+  if (stats) {
+    hooverStatsPrint(stderr, muu->hctx->stats);
+  }
   if (muu->ndebug) {
     /* if its been generated, we should save it */
     sprintf(debugStr, "%04d-%04d-debug.nrrd", verbPix[0], verbPix[1]);
@@ -157,8 +157,11 @@ typedef struct mrendThread_t {
     ui, vi,             /* image coords */
     numSamples,         /* total number of samples this thread has done */
     verbose;            /* blah blah blah blah */
-  gageContext *gctx;    /* thread-specific gage context (or copy of uu->gctx0
-                           for the first thread) */
+  double probeTime;     /* time spent in gageProbe(), only measured with
+                           uu->hctx->stats */
+  gageContext *gctx;    /* thread-specific gage context (uu->gctx0 for the
+                           first thread, or gps->ctx for the others) */
+  gageProbeState *gps;  /* per-thread probe state of uu->gctx0 */
   const double *answer; /* pointer to the SINGLE answer we care about */
 } mrendThread;
 
@@ -251,6 +254,7 @@ mrendRenderEnd(mrendRender *rr, mrendUser *uu) {
 int
 mrendThreadBegin(mrendThread **ttP,
                  mrendRender *rr, mrendUser *uu, int whichThread) {
+  static const char me[]="mrendThreadBegin";
 
   /* allocating the mrendThreads should be part of the thread body,
      but as long as there isn't a mutex around registering them with
@@ -259,10 +263,16 @@ mrendThreadBegin(mrendThread **ttP,
   (*ttP) = rr->tinfo[whichThread];
   if (!whichThread) {
     /* this is the first thread- it just points to the parent gageContext */
+    (*ttP)->gps = NULL;
     (*ttP)->gctx = uu->gctx0;
   } else {
-    /* we have to generate a new gageContext */
-    (*ttP)->gctx = gageContextCopy(uu->gctx0);
+    /* we need per-thread probe state for the shared gageContext */
+    if (!((*ttP)->gps = gageProbeStateNew(uu->gctx0))) {
+      biffMovef(MREND, GAGE, "%s: couldn't set up thread %d",
+                me, whichThread);
+      return 1;
+    }
+    (*ttP)->gctx = (*ttP)->gps->ctx;
   }
   (*ttP)->answer = gageAnswerPointer((*ttP)->gctx,
                                      (*ttP)->gctx->pvl[0], uu->whatq);
@@ -273,6 +283,7 @@ mrendThreadBegin(mrendThread **ttP,
   (*ttP)->thrid = whichThread;
   (*ttP)->numSamples = 0;
   (*ttP)->verbose = 0;
+  (*ttP)->probeTime = 0;
   return 0;
 }
 
@@ -280,9 +291,13 @@ int
 mrendThreadEnd(mrendThread *tt, mrendRender *rr, mrendUser *uu) {
 
   AIR_UNUSED(rr);
-  AIR_UNUSED(uu);
-  if (tt->thrid) {
-    tt->gctx = gageContextNix(tt->gctx);
+  if (uu->hctx->stats) {
+    /* this is only ever called by hoover thread thrid */
+    uu->hctx->stats->thread[tt->thrid].probeTime += tt->probeTime;
+  }
+  if (tt->gps) {
+    tt->gps = gageProbeStateNix(tt->gps);
+    tt->gctx = NULL;
   }
   tt->val = AIR_CAST(double*, airFree(tt->val));
 
@@ -376,9 +391,9 @@ mrendSample(mrendThread *tt, mrendRender *rr, mrendUser *uu,
             double samplePosWorld[3],
             double samplePosIndex[3]) {
   static const char me[]="mrendSample";
+  double probeTime;
 
   AIR_UNUSED(rr);
-  AIR_UNUSED(uu);
   AIR_UNUSED(num);
   AIR_UNUSED(rayT);
   AIR_UNUSED(samplePosWorld);
@@ -390,6 +405,7 @@ mrendSample(mrendThread *tt, mrendRender *rr, mrendUser *uu,
             inside ? "INSIDE" : "(outside)");
   }
   if (inside) {
+    probeTime = uu->hctx->stats ? airTime() : 0;
     if (gageProbe(tt->gctx,
                   samplePosIndex[0],
                   samplePosIndex[1],
@@ -398,6 +414,9 @@ mrendSample(mrendThread *tt, mrendRender *rr, mrendUser *uu,
                tt->gctx->errStr, tt->gctx->errNum);
       return AIR_NAN;
     }
+    if (uu->hctx->stats) {
+      tt->probeTime += airTime() - probeTime;
+    }
     if (tt->verbose) {
       fprintf(stderr, "%s: val[%d] = %g\n", me,
               tt->valNum, *(tt->answer));
@@ -464,7 +483,7 @@ int
 main(int argc, const char *argv[]) {
   hestOpt *hopt=NULL;
   hestParm *hparm;
-  int E, Ecode, Ethread, renorm, offfr;
+  int E, Ecode, Ethread, renorm, offfr, stats;
   const char *me;
   char *errS, *whatS;
   mrendUser *uu;
@@ -531,9 +550,17 @@ main(int argc, const char *argv[]) {
              "value that should be substituted for NaN.");
   hestOptAdd(&hopt, "step", "size", airTypeDouble, 1, 1, &(uu->rayStep),
              "0.01", "step size along ray in world space");
+  hestOptAdd(&hopt, "tile", "sx sy", airTypeUInt, 2, 2,
+             uu->hctx->tileSize, "16 16",
+             "size (in pixels) of the image tiles that are the units "
+             "of work handed out to threads");
   hestOptAdd(&hopt, "nt", "# threads", airTypeInt, 1, 1,
              &(uu->hctx->numThreads),
              "1", "number of threads hoover should use");
+  hestOptAdd(&hopt, "stats", NULL, airTypeInt, 0, 0, &stats, NULL,
+             "after rendering, print per-thread counts (of rays, samples, "
+             "etc.) and times (probing, shading, waiting), to see where "
+             "the time went and how evenly it was spread over threads");
   hestOptAdd(&hopt, "vp", "img coords", airTypeInt, 2, 2, &(uu->verbPixel),
              "-1 -1", "pixel coordinates for which to turn on all verbose "
              "debugging messages, or \"-1 -1\" to disable this.");
@@ -655,6 +682,11 @@ main(int argc, const char *argv[]) {
             me, uu->hctx->numThreads);
     uu->hctx->numThreads = 1;
   }
+  if (stats) {
+    uu->hctx->stats = hooverStatsNew();
+    airMopAdd(mop, uu->hctx->stats, (airMopper)hooverStatsNix,
+              airMopAlways);
+  }
 
   E = hooverRender(uu->hctx, &Ecode, &Ethread);
   if (E) {
@@ -670,6 +702,9 @@ main(int argc, const char *argv[]) {
     airMopError(mop);
     return 1;
   }
+  if (stats) {
+    hooverStatsPrint(stderr, uu->hctx->stats);
+  }
 
   if (1) {
     ELL_3V_SUB(uu->imgU, uu->imgU, uu->imgOrig);
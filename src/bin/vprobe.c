@@ -31,6 +31,186 @@
 #include <teem/ten.h>
 #include <teem/meet.h>
 
+/*
+** what is shared by the threads that probe the output, one z slice at
+** a time.  Each thread probes with its own gageProbeState of the shared
+** context (unless there is only one thread), and every output sample is
+** probed the same way regardless of which thread gets it, so the output
+** is the same with any number of threads
+*/
+typedef struct {
+  gageContext *ctx;           /* the shared context */
+  unsigned int pvlIdx;        /* index of the pervolume to query */
+  int what, verbose, hackSet;
+  unsigned int hackZi;
+  size_t ansLen, sox, soy, soz;
+  double min[3], maxOut[3], maxIn[3], idxSS;
+  Nrrd *nout;                 /* output */
+  double (*ins)(void *v, size_t I, double d);
+  size_t zNext;               /* first slice not yet handed out */
+  int errNum;                 /* gageErrNone if there was no error, else
+                                 the error at the lowest position */
+  size_t errIdx[3];
+  double errPos[3];
+  char errStr[AIR_STRLEN_LARGE];
+  airThreadMutex *mutex;      /* NULL if only one thread */
+} probeTask;
+
+/* what one thread has to itself */
+typedef struct {
+  probeTask *task;
+  gageContext *gctx;          /* the context, or the probe state's */
+  double *rowPos, *rowAns;    /* scanline buffers */
+} probeThread;
+
+static void *
+probeWorker(void *_pth) {
+  probeThread *pth;
+  probeTask *task;
+  const gagePerVolume *cpvl[1];
+  size_t ai, idx, xi, yi, zi;
+  double x, y, z;
+  char stmp[2][AIR_STRLEN_SMALL];
+
+  pth = AIR_CAST(probeThread *, _pth);
+  task = pth->task;
+  cpvl[0] = pth->gctx->pvl[task->pvlIdx];
+  for (;;) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    zi = (gageErrNone == task->errNum
+          ? task->zNext
+          : task->soz);
+    task->zNext = AIR_MIN(task->soz, zi + 1);
+    if (task->verbose && zi < task->soz) {
+      if (task->verbose > 1) {
+        fprintf(stderr, "z = ");
+      }
+      fprintf(stderr, " %s/%s",
+              airSprintSize_t(stmp[0], zi),
+              airSprintSize_t(stmp[1], task->soz-1));
+      fflush(stderr);
+      if (task->verbose > 1) {
+        fprintf(stderr, "\n");
+      }
+    }
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (zi >= task->soz) {
+      break;
+    }
+    if (AIR_TRUE == task->hackSet) {
+      if (task->hackZi != zi) {
+        continue;
+      }
+    }
+
+    z = AIR_AFFINE(task->min[2], zi, task->maxOut[2],
+                   task->min[2], task->maxIn[2]);
+    for (yi=0; yi<task->soy; yi++) {
+      y = AIR_AFFINE(task->min[1], yi, task->maxOut[1],
+                     task->min[1], task->maxIn[1]);
+      if (2 == task->verbose) {
+        fprintf(stderr, " %u/%u", AIR_UINT(yi),
+                AIR_UINT(task->soy));
+        fflush(stderr);
+      }
+      /* probe a whole scanline at once */
+      for (xi=0; xi<task->sox; xi++) {
+        x = AIR_AFFINE(task->min[0], xi, task->maxOut[0],
+                       task->min[0], task->maxIn[0]);
+        ELL_4V_SET(pth->rowPos + 4*xi, x, y, z, task->idxSS);
+      }
+      if (gageProbeBatch(pth->gctx, pth->rowAns, task->ansLen, cpvl,
+                         &(task->what), 1, pth->rowPos, 4, task->sox,
+                         AIR_TRUE, AIR_FALSE, &xi)) {
+        if (task->mutex) {
+          airThreadMutexLock(task->mutex);
+        }
+        if (gageErrNone == task->errNum
+            || zi < task->errIdx[2]
+            || (zi == task->errIdx[2] && yi < task->errIdx[1])) {
+          ELL_3V_SET(task->errIdx, xi, yi, zi);
+          ELL_3V_SET(task->errPos, pth->rowPos[0 + 4*xi], y, z);
+          task->errNum = pth->gctx->errNum;
+          airStrcpy(task->errStr, AIR_STRLEN_LARGE, pth->gctx->errStr);
+        }
+        if (task->mutex) {
+          airThreadMutexUnlock(task->mutex);
+        }
+        break;
+      }
+      idx = task->sox*(yi + task->soy*zi);
+      for (ai=0; ai<task->ansLen*task->sox; ai++) {
+        task->ins(task->nout->data, ai + task->ansLen*idx, pth->rowAns[ai]);
+      }
+    }
+  }
+  return _pth;
+}
+
+/*
+** probes all the output slices with threadNum threads (including the
+** calling one).  Biff errors are only for problems setting up; probing
+** errors are described by task->errNum et al.
+*/
+static int
+probeRun(probeTask *task, unsigned int threadNum) {
+  static const char me[]="probeRun";
+  probeThread *pth;
+  gageProbeState **gps;
+  unsigned int ti;
+  airArray *mop;
+
+  mop = airMopNew();
+  threadNum = AIR_MAX(1, threadNum);
+  pth = AIR_CALLOC(threadNum, probeThread);
+  airMopAdd(mop, pth, airFree, airMopAlways);
+  gps = AIR_CALLOC(threadNum, gageProbeState *);
+  airMopAdd(mop, gps, airFree, airMopAlways);
+  if (!( pth && gps )) {
+    biffAddf(GAGE, "%s: couldn't allocate thread state", me);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    pth[ti].task = task;
+    if (threadNum > 1) {
+      if (!(gps[ti] = gageProbeStateNew(task->ctx))) {
+        biffAddf(GAGE, "%s: couldn't make probe state %u", me, ti);
+        airMopError(mop); return 1;
+      }
+      airMopAdd(mop, gps[ti], (airMopper)gageProbeStateNix, airMopAlways);
+      pth[ti].gctx = gps[ti]->ctx;
+    } else {
+      pth[ti].gctx = task->ctx;
+    }
+    pth[ti].rowPos = AIR_CALLOC(4*task->sox, double);
+    airMopAdd(mop, pth[ti].rowPos, airFree, airMopAlways);
+    pth[ti].rowAns = AIR_CALLOC(task->ansLen*task->sox, double);
+    airMopAdd(mop, pth[ti].rowAns, airFree, airMopAlways);
+    if (!( pth[ti].rowPos && pth[ti].rowAns )) {
+      biffAddf(GAGE, "%s: couldn't allocate scanline buffers", me);
+      airMopError(mop); return 1;
+    }
+  }
+  task->zNext = 0;
+  task->errNum = gageErrNone;
+  if (airThreadRun(threadNum, probeWorker, pth, sizeof(probeThread),
+                   &(task->mutex))) {
+    biffAddf(GAGE, "%s: couldn't start threads", me);
+    airMopError(mop); return 1;
+  }
+  if (threadNum > 1) {
+    for (ti=0; ti<threadNum; ti++) {
+      gageContextStatsAdd(task->ctx, gps[ti]->ctx);
+    }
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
 static const char *probeInfo =
   ("Shows off the functionality of the gage library. "
    "Uses gageProbe() to query various kinds of volumes "
@@ -47,20 +227,19 @@ main(int argc, const char *argv[]) {
   hestOpt *hopt = NULL;
   NrrdKernelSpec *k00, *k11, *k22, *kSS, *kSSblur;
   int what, E=0, renorm, SSuniform, SSoptim, verbose, zeroZ,
-    orientationFromSpacing, SSnormd;
-  unsigned int iBaseDim, oBaseDim, axi, numSS, ninSSIdx, seed;
-  const double *answer;
+    orientationFromSpacing, SSnormd, stats;
+  unsigned int iBaseDim, oBaseDim, axi, numSS, ninSSIdx, seed, threadNum;
+  probeTask task;
   Nrrd *nin, *nout, **ninSS=NULL;
   Nrrd *ngrad=NULL, *nbmat=NULL;
-  size_t ai, ansLen, idx, xi, yi, zi, six, siy, siz, sox, soy, soz;
+  size_t ansLen, six, siy, siz, sox, soy, soz;
   double bval=0, gmc, rangeSS[2], wrlSS, idxSS=AIR_NAN,
     dsix, dsiy, dsiz, dsox, dsoy, dsoz;
   gageContext *ctx;
   gagePerVolume *pvl=NULL;
-  double t0, t1, x, y, z, scale[3], rscl[3], min[3], maxOut[3], maxIn[3];
+  double t0, t1, z, scale[3], rscl[3], min[3], maxOut[3], maxIn[3];
   airArray *mop;
   unsigned int hackZi, *skip, skipNum;
-  double (*ins)(void *v, size_t I, double d);
   gageStackBlurParm *sbp;
 
   char hackKeyStr[]="TEEM_VPROBE_HACK_ZI", *hackValStr;
@@ -169,6 +348,16 @@ main(int argc, const char *argv[]) {
   hestOptAdd(&hopt, "ofs", "ofs", airTypeInt, 0, 0, &orientationFromSpacing,
              NULL, "If only per-axis spacing is available, use that to "
              "contrive full orientation info");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &threadNum, "1",
+             (airThreadCapable
+              ? "number of threads to probe with, each doing whole z "
+              "slices with its own gageProbeState; the output is the "
+              "same with any number"
+              : "if pthreads where enabled in this Teem build, this is how "
+              "you would control the number of threads to probe with"));
+  hestOptAdd(&hopt, "stats", NULL, airTypeInt, 0, 0, &stats, NULL,
+             "count and time the phases of probing, and print a summary "
+             "of this afterwards");
   hestOptAdd(&hopt, "t", "type", airTypeEnum, 1, 1, &otype, "float",
              "type of output volume", NULL, nrrdType);
   hestOptAdd(&hopt, "o", "nout", airTypeString, 1, 1, &outS, "-",
@@ -178,6 +367,14 @@ main(int argc, const char *argv[]) {
   airMopAdd(mop, hopt, AIR_CAST(airMopper, hestOptFree), airMopAlways);
   airMopAdd(mop, hopt, AIR_CAST(airMopper, hestParseFree), airMopAlways);
 
+  if (!airThreadCapable && 1 != threadNum) {
+    fprintf(stderr, "%s: This Teem not compiled with "
+            "multi-threading support.\n", me);
+    fprintf(stderr, "%s: ==> can't use %u threads; only using 1\n",
+            me, threadNum);
+    threadNum = 1;
+  }
+
   what = airEnumVal(kind->enm, whatS);
   if (!what) {
     /* 0 indeed always means "unknown" for any gageKind */
@@ -294,7 +491,7 @@ main(int argc, const char *argv[]) {
   }
 
   /***
-  **** Except for the gageProbe() call in the inner loop below,
+  **** Except for the gageProbeBatch() call in the inner loop below,
   **** and the gageContextNix() call at the very end, all the gage
   **** calls which set up (and take down) the context and state are here.
   ***/
@@ -306,6 +503,7 @@ main(int argc, const char *argv[]) {
   gageParmSet(ctx, gageParmRenormalize, renorm ? AIR_TRUE : AIR_FALSE);
   gageParmSet(ctx, gageParmCheckIntegrals, AIR_TRUE);
   gageParmSet(ctx, gageParmOrientationFromSpacing, orientationFromSpacing);
+  gageParmSet(ctx, gageParmStats, stats);
   E = 0;
   if (!E) E |= !(pvl = gagePerVolumeNew(ctx, nin, kind));
   if (!E) E |= gageKernelSet(ctx, gageKernel00, k00->kernel, k00->parm);
@@ -334,7 +532,6 @@ main(int argc, const char *argv[]) {
     airMopError(mop);
     return 1;
   }
-  answer = gageAnswerPointer(ctx, pvl, what);
   /***
   **** end gage setup.
   ***/
@@ -424,67 +621,44 @@ main(int argc, const char *argv[]) {
     ELL_3V_SET(maxOut, dsox-1, dsoy-1, dsoz-1);
     ELL_3V_SET(maxIn, dsix-1, dsiy-1, dsiz-1);
   }
+  task.ctx = ctx;
+  for (task.pvlIdx=0; task.pvlIdx<ctx->pvlNum; task.pvlIdx++) {
+    if (pvl == ctx->pvl[task.pvlIdx]) {
+      break;
+    }
+  }
+  task.what = what;
+  task.verbose = verbose;
+  task.hackSet = hackSet;
+  task.hackZi = hackZi;
+  task.ansLen = ansLen;
+  task.sox = sox;
+  task.soy = soy;
+  task.soz = soz;
+  ELL_3V_COPY(task.min, min);
+  ELL_3V_COPY(task.maxOut, maxOut);
+  ELL_3V_COPY(task.maxIn, maxIn);
+  task.idxSS = idxSS;
+  task.nout = nout;
+  task.ins = nrrdDInsert[nout->type];
   t0 = airTime();
-  ins = nrrdDInsert[nout->type];
   gageParmSet(ctx, gageParmVerbose, verbose/10);
-  for (zi=0; zi<soz; zi++) {
-    if (verbose) {
-      if (verbose > 1) {
-        fprintf(stderr, "z = ");
-      }
-      fprintf(stderr, " %s/%s",
-              airSprintSize_t(stmp[0], zi),
-              airSprintSize_t(stmp[1], soz-1));
-      fflush(stderr);
-      if (verbose > 1) {
-        fprintf(stderr, "\n");
-      }
-    }
-    if (AIR_TRUE == hackSet) {
-      if (hackZi != zi) {
-        continue;
-      }
-    }
-
-    z = AIR_AFFINE(min[2], zi, maxOut[2], min[2], maxIn[2]);
-    for (yi=0; yi<soy; yi++) {
-      y = AIR_AFFINE(min[1], yi, maxOut[1], min[1], maxIn[1]);
-      if (2 == verbose) {
-        fprintf(stderr, " %u/%u", AIR_UINT(yi),
-                AIR_UINT(soy));
-        fflush(stderr);
-      }
-      for (xi=0; xi<sox; xi++) {
-        if (verbose > 2) {
-          fprintf(stderr, " (%u,%u)/(%u,%u)",
-                  AIR_UINT(xi), AIR_UINT(yi),
-                  AIR_UINT(sox), AIR_UINT(soy));
-          fflush(stderr);
-        }
-        x = AIR_AFFINE(min[0], xi, maxOut[0], min[0], maxIn[0]);
-        idx = xi + sox*(yi + soy*zi);
-        E = (numSS
-             ? gageStackProbe(ctx, x, y, z, idxSS)
-             : gageProbe(ctx, x, y, z));
-        if (E) {
-          fprintf(stderr,
-                  "%s: trouble at i=(%s,%s,%s) -> f=(%g,%g,%g):\n%s\n(%d)\n",
-                  me, airSprintSize_t(stmp[0], xi),
-                  airSprintSize_t(stmp[1], yi),
-                  airSprintSize_t(stmp[2], zi), x, y, z,
-                  ctx->errStr, ctx->errNum);
-          airMopError(mop);
-          return 1;
-        }
-        if (1 == ansLen) {
-          ins(nout->data, idx, *answer);
-        } else {
-          for (ai=0; ai<=ansLen-1; ai++) {
-            ins(nout->data, ai + ansLen*idx, answer[ai]);
-          }
-        }
-      }
-    }
+  if (probeRun(&task, threadNum)) {
+    airMopAdd(mop, err = biffGetDone(GAGE), airFree, airMopAlways);
+    fprintf(stderr, "%s: trouble probing:\n%s\n", me, err);
+    airMopError(mop);
+    return 1;
+  }
+  if (gageErrNone != task.errNum) {
+    fprintf(stderr,
+            "%s: trouble at i=(%s,%s,%s) -> f=(%g,%g,%g):\n%s\n(%d)\n",
+            me, airSprintSize_t(stmp[0], task.errIdx[0]),
+            airSprintSize_t(stmp[1], task.errIdx[1]),
+            airSprintSize_t(stmp[2], task.errIdx[2]),
+            task.errPos[0], task.errPos[1], task.errPos[2],
+            task.errStr, task.errNum);
+    airMopError(mop);
+    return 1;
   }
 
   /* HEY: this isn't actually correct in general, but is true
@@ -534,6 +708,9 @@ main(int argc, const char *argv[]) {
   fprintf(stderr, "\n");
   t1 = airTime();
   fprintf(stderr, "probe rate = %g KHz\n", dsox*dsoy*dsoz/(1000.0*(t1-t0)));
+  if (stats) {
+    gageContextStatsPrint(stderr, ctx);
+  }
   if (nrrdSave(outS, nout, NULL)) {
     airMopAdd(mop, err = biffGetDone(NRRD), airFree, airMopAlways);
     fprintf(stderr, "%s: trouble saving output:\n%s\n", me, err);
@@ -0,0 +1,273 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "gage.h"
+#include "privateGage.h"
+
+/*
+** positions are converted to index space, and (if needed) re-ordered,
+** this many at a time; this bounds the memory used by gageProbeBatch
+** regardless of how many positions it is given
+*/
+#define _GAGE_BATCH_BLOCK 65536
+
+/* key for positions that couldn't be converted to index space */
+#define _GAGE_BATCH_KEY_BAD (~AIR_CAST(size_t, 0))
+
+typedef struct {
+  size_t key,   /* linear index of voxel containing the position */
+    idx;        /* index of position in the caller's array */
+} _gageBatchOrder;
+
+static int
+_gageBatchOrderCompare(const void *_a, const void *_b) {
+  const _gageBatchOrder *a, *b;
+
+  a = AIR_CAST(const _gageBatchOrder *, _a);
+  b = AIR_CAST(const _gageBatchOrder *, _b);
+  return (a->key < b->key
+          ? -1
+          : (a->key > b->key
+             ? 1
+             : (a->idx < b->idx
+                ? -1
+                : (a->idx > b->idx))));
+}
+
+/*
+** the key is computed the same way as _gageLocationSet computes
+** point.idx, so that consecutive probes with the same key re-use the
+** same iv3 caches.  Positions outside the volume are clamped, since
+** they will just generate errors anyway.
+*/
+static size_t
+_gageBatchKey(const gageContext *ctx, const double ipos[4]) {
+  double sz[3];
+  size_t ki[3];
+  unsigned int ai;
+
+  for (ai=0; ai<3; ai++) {
+    sz[ai] = AIR_CAST(double, ctx->shape->size[ai]);
+    ki[ai] = (AIR_EXISTS(ipos[ai])
+              ? AIR_CAST(size_t, AIR_CLAMP(0, ipos[ai]+1, sz[ai]))
+              : 0);
+  }
+  return ki[0] + (ctx->shape->size[0]+1)*(ki[1]
+                                           + (ctx->shape->size[1]+1)*ki[2]);
+}
+
+/*
+******** gageProbeBatch()
+**
+** probes at "num" positions, and copies the answers for "itemNum" items
+** (item[ii] in pervolume pvl[ii], all of which must be attached to ctx
+** and have had item[ii] turned on in their query) into "out": the
+** answers for position pi start at out + pi*outStride, with the items'
+** answers one after the other in the order given.  If outStride is 0,
+** the sum of the answer lengths is used.
+**
+** Position pi is pos[0,1,2] + pi*posStride, interpreted as in
+** gageProbeSpace() (according to indexSpace and clamp); when the
+** context is using the stack (parm.stackUse), pos[3] + pi*posStride
+** is the scale position, as in gageStackProbeSpace(), so posStride
+** must be at least 4.
+**
+** Compared to calling gageProbeSpace() and gageAnswerPointer() for
+** each point, this converts blocks of positions to index space at once,
+** visits the positions of each block in order of the voxel containing
+** them (unless they are already in that order) so that neighboring
+** probes share iv3 caches and touch nearby memory, and copies answers
+** directly into the caller's array.  The answers are the same
+** regardless of the order in which the positions are visited.
+**
+** Like gageProbe, this does not use biff. Positions that can't be
+** probed (e.g. outside the volume without clamping) get AIR_NAN
+** answers, and all other positions are still probed. The return is 0
+** if all positions were probed, otherwise 1, with ctx->errNum and
+** ctx->errStr describing the error at the lowest-indexed such position,
+** whose index is saved in *errIdx (if errIdx is non-NULL).  Problems
+** that stop anything from being probed (bad arguments, allocation
+** failure) also return 1, but with ctx->errNum set to gageErrUnknown,
+** *errIdx set to 0, and nothing written to out.
+*/
+int
+gageProbeBatch(gageContext *ctx, double *out, size_t outStride,
+               const gagePerVolume *const *pvl, const int *item,
+               unsigned int itemNum,
+               const double *pos, size_t posStride, size_t num,
+               int indexSpace, int clamp, size_t *errIdx) {
+  static const char me[]="gageProbeBatch";
+  const double **ans;
+  unsigned int *ansLen, ii, ai, totalLen;
+  _gageBatchOrder *order;
+  double *ipos, *oo;
+  const double *pp, *aa;
+  size_t bi, blockNum, oi, pi, firstBad;
+  int sorted, ret, firstErrNum;
+  char *firstErrStr;
+  airArray *mop;
+
+  if (errIdx) {
+    /* for the errors that happen before any probing */
+    *errIdx = 0;
+  }
+  if (!ctx) {
+    return 1;
+  }
+  if (!( out && pvl && item && itemNum && pos )) {
+    if (ctx->parm.generateErrStr) {
+      sprintf(ctx->errStr, "%s: got NULL pointer or zero items", me);
+    } else {
+      strcpy(ctx->errStr, _GAGE_NON_ERR_STR);
+    }
+    ctx->errNum = gageErrUnknown;
+    return 1;
+  }
+  if (posStride < (ctx->parm.stackUse ? 4u : 3u)) {
+    if (ctx->parm.generateErrStr) {
+      sprintf(ctx->errStr, "%s: posStride %u too small (%s stack)", me,
+              AIR_UINT(posStride),
+              ctx->parm.stackUse ? "using" : "not using");
+    } else {
+      strcpy(ctx->errStr, _GAGE_NON_ERR_STR);
+    }
+    ctx->errNum = gageErrUnknown;
+    return 1;
+  }
+  if (!num) {
+    return 0;
+  }
+  mop = airMopNew();
+  ans = AIR_CALLOC(itemNum, const double *);
+  airMopAdd(mop, AIR_CAST(void *, ans), airFree, airMopAlways);
+  ansLen = AIR_CALLOC(itemNum, unsigned int);
+  airMopAdd(mop, ansLen, airFree, airMopAlways);
+  blockNum = AIR_MIN(num, _GAGE_BATCH_BLOCK);
+  ipos = AIR_CALLOC(4*blockNum, double);
+  airMopAdd(mop, ipos, airFree, airMopAlways);
+  order = AIR_CALLOC(blockNum, _gageBatchOrder);
+  airMopAdd(mop, order, airFree, airMopAlways);
+  firstErrStr = AIR_CALLOC(AIR_STRLEN_LARGE, char);
+  airMopAdd(mop, firstErrStr, airFree, airMopAlways);
+  if (!( ans && ansLen && ipos && order && firstErrStr )) {
+    if (ctx->parm.generateErrStr) {
+      sprintf(ctx->errStr, "%s: couldn't allocate buffers", me);
+    } else {
+      strcpy(ctx->errStr, _GAGE_NON_ERR_STR);
+    }
+    ctx->errNum = gageErrUnknown;
+    airMopError(mop); return 1;
+  }
+  totalLen = 0;
+  for (ii=0; ii<itemNum; ii++) {
+    ans[ii] = gageAnswerPointer(ctx, pvl[ii], item[ii]);
+    ansLen[ii] = gageAnswerLength(ctx, pvl[ii], item[ii]);
+    if (!( ans[ii] && ansLen[ii]
+           && GAGE_QUERY_ITEM_TEST(pvl[ii]->query, item[ii]) )) {
+      if (ctx->parm.generateErrStr) {
+        sprintf(ctx->errStr, "%s: item[%u] %d not in query of pvl[%u]",
+                me, ii, item[ii], ii);
+      } else {
+        strcpy(ctx->errStr, _GAGE_NON_ERR_STR);
+      }
+      ctx->errNum = gageErrUnknown;
+      airMopError(mop); return 1;
+    }
+    totalLen += ansLen[ii];
+  }
+  if (!outStride) {
+    outStride = totalLen;
+  }
+
+  firstBad = num;
+  firstErrNum = gageErrNone;
+  for (bi=0; bi<num; bi+=blockNum) {
+    blockNum = AIR_MIN(num - bi, _GAGE_BATCH_BLOCK);
+    sorted = AIR_TRUE;
+    for (oi=0; oi<blockNum; oi++) {
+      pp = pos + (bi + oi)*posStride;
+      order[oi].idx = bi + oi;
+      if (indexSpace && !clamp) {
+        /* the common case needs no conversion */
+        ELL_4V_SET(ipos + 4*oi, pp[0], pp[1], pp[2],
+                   ctx->parm.stackUse ? pp[3] : 0);
+        order[oi].key = _gageBatchKey(ctx, ipos + 4*oi);
+      } else if (_gageProbeSpaceIndex(ctx, ipos + 4*oi, pp[0], pp[1], pp[2],
+                                      ctx->parm.stackUse ? pp[3] : AIR_NAN,
+                                      indexSpace, clamp)) {
+        /* only happens with a failed search along scale; this is
+           visited last, and not probed */
+        order[oi].key = _GAGE_BATCH_KEY_BAD;
+        if (bi + oi < firstBad) {
+          firstBad = bi + oi;
+          firstErrNum = ctx->errNum;
+          strcpy(firstErrStr, ctx->errStr);
+        }
+      } else {
+        order[oi].key = _gageBatchKey(ctx, ipos + 4*oi);
+      }
+      sorted &= !oi || order[oi-1].key <= order[oi].key;
+    }
+    if (!sorted) {
+      qsort(order, blockNum, sizeof(_gageBatchOrder),
+            _gageBatchOrderCompare);
+    }
+    for (oi=0; oi<blockNum; oi++) {
+      pi = order[oi].idx;
+      pp = ipos + 4*(pi - bi);
+      oo = out + pi*outStride;
+      ret = (_GAGE_BATCH_KEY_BAD == order[oi].key
+             || _gageProbe(ctx, pp[0], pp[1], pp[2], pp[3]));
+      if (ret) {
+        for (ai=0; ai<totalLen; ai++) {
+          oo[ai] = AIR_NAN;
+        }
+        if (pi < firstBad) {
+          firstBad = pi;
+          firstErrNum = ctx->errNum;
+          strcpy(firstErrStr, ctx->errStr);
+        }
+        continue;
+      }
+      for (ii=0; ii<itemNum; ii++) {
+        aa = ans[ii];
+        for (ai=0; ai<ansLen[ii]; ai++) {
+          oo[ai] = aa[ai];
+        }
+        oo += ansLen[ii];
+      }
+    }
+  }
+  if (firstBad < num) {
+    ctx->errNum = firstErrNum;
+    strcpy(ctx->errStr, firstErrStr);
+    if (errIdx) {
+      *errIdx = firstBad;
+    }
+    ret = 1;
+  } else {
+    ret = 0;
+  }
+  airMopOkay(mop);
+  return ret;
+}
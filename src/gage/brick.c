@@ -0,0 +1,206 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "gage.h"
+#include "privateGage.h"
+
+/*
+** The bricked copies of volumes made according to parm.brick.  With
+** the raster layout of nin, the fd^3 neighborhood of a probe spans
+** fd^2 scanlines which (for big volumes) are in as many different
+** cache lines, and fd different slices, which may be in different
+** pages.  In a bricked copy, the samples are re-ordered so that each
+** (small, cubical) brick of samples is contiguous, and most
+** neighborhoods lie within one or a few bricks.  Within a brick the
+** samples are still in raster order, so _gageIv3FillBox can use the
+** same scanline copies (pvl->iv3Fill), with the brick's strides.
+**
+** Brick sizes are powers of two (along each axis, the smaller of
+** parm.brick and the axis size rounded up to a power of two, so that
+** 2-D images aren't padded out along Z), so finding a sample is only
+** shifts and masks.  The bricks along the high end of each axis may
+** extend past the volume; those samples are never read.
+*/
+
+/*
+** _gageBrickIndex
+**
+** the index (of the sample, not the value) of volume sample (xx,yy,zz)
+** in pvl->brickData
+*/
+size_t
+_gageBrickIndex(const gagePerVolume *pvl, unsigned int xx,
+                unsigned int yy, unsigned int zz) {
+  const unsigned int *bs;
+  size_t bidx;
+
+  bs = pvl->brickShift;
+  bidx = ((AIR_CAST(size_t, zz >> bs[2])*pvl->brickNum[1] + (yy >> bs[1]))
+          *pvl->brickNum[0] + (xx >> bs[0]));
+  return ((bidx << (bs[0] + bs[1] + bs[2]))
+          + (AIR_CAST(size_t, zz & ((1u << bs[2]) - 1)) << (bs[0] + bs[1]))
+          + ((yy & ((1u << bs[1]) - 1)) << bs[0])
+          + (xx & ((1u << bs[0]) - 1)));
+}
+
+/*
+** _gageBrickDataSize
+**
+** number of bytes in pvl->brickData, as determined by brickShift and
+** brickNum
+*/
+size_t
+_gageBrickDataSize(const gagePerVolume *pvl) {
+
+  return ((AIR_CAST(size_t, pvl->brickNum[0])*pvl->brickNum[1]
+           *pvl->brickNum[2])
+          << (pvl->brickShift[0] + pvl->brickShift[1] + pvl->brickShift[2]))
+    *pvl->kind->valLen*nrrdTypeSize[pvl->nin->type];
+}
+
+/*
+** log2 of the brick size along an axis with "size" samples
+*/
+static unsigned int
+_gageBrickShift(unsigned int brick, unsigned int size) {
+  unsigned int shift;
+
+  shift = 0;
+  while ((1u << shift) < brick && (1u << shift) < size) {
+    shift++;
+  }
+  return shift;
+}
+
+void
+_gageBrickNix(gagePerVolume *pvl) {
+
+  pvl->brickData = airFree(pvl->brickData);
+  pvl->brickSrc = NULL;
+  ELL_3V_SET(pvl->brickShift, 0, 0, 0);
+  ELL_3V_SET(pvl->brickNum, 0, 0, 0);
+  return;
+}
+
+/*
+** _gageBrickMake
+**
+** makes pvl->brickData from pvl->nin->data, with bricks of (at most)
+** "brick" samples along each axis
+*/
+static int
+_gageBrickMake(gagePerVolume *pvl, const gageShape *shape,
+               unsigned int brick) {
+  static const char me[]="_gageBrickMake";
+  unsigned int ai, xi, yi, zi, bx, len, shift;
+  size_t elSize, sx, sxy;
+  const char *src;
+  char *dst;
+
+  _gageBrickNix(pvl);
+  for (ai=0; ai<3; ai++) {
+    shift = _gageBrickShift(brick, shape->size[ai]);
+    pvl->brickShift[ai] = shift;
+    pvl->brickNum[ai] = (shape->size[ai] + (1u << shift) - 1) >> shift;
+  }
+  pvl->brickData = calloc(_gageBrickDataSize(pvl), 1);
+  if (!pvl->brickData) {
+    biffAddf(GAGE, "%s: couldn't allocate bricked copy of %u x %u x %u "
+             "volume", me, shape->size[0], shape->size[1], shape->size[2]);
+    _gageBrickNix(pvl);
+    return 1;
+  }
+  elSize = pvl->kind->valLen*nrrdTypeSize[pvl->nin->type];
+  sx = shape->size[0];
+  sxy = sx*shape->size[1];
+  src = AIR_CAST(const char *, pvl->nin->data);
+  dst = AIR_CAST(char *, pvl->brickData);
+  /* each scanline is copied in brick-wide pieces */
+  for (zi=0; zi<shape->size[2]; zi++) {
+    for (yi=0; yi<shape->size[1]; yi++) {
+      for (bx=0; bx<pvl->brickNum[0]; bx++) {
+        xi = bx << pvl->brickShift[0];
+        len = AIR_MIN(1u << pvl->brickShift[0], shape->size[0] - xi);
+        memcpy(dst + _gageBrickIndex(pvl, xi, yi, zi)*elSize,
+               src + (xi + sx*yi + sxy*zi)*elSize, len*elSize);
+      }
+    }
+  }
+  pvl->brickSrc = pvl->nin->data;
+  return 0;
+}
+
+/*
+** _gageBrickUpdate
+**
+** makes (or frees) the bricked copies of the pervolumes' data, according
+** to ctx->parm.brick.  A copy is re-made if the brick size changed, or
+** if the nin->data it was made from is different.  Only volumes that
+** have a specialized iv3Fill (see iv3.c) are bricked, so this has to
+** come after _gageIv3FillSelect.
+*/
+int
+_gageBrickUpdate(gageContext *ctx) {
+  static const char me[]="_gageBrickUpdate";
+  gagePerVolume *pvl;
+  unsigned int pvlIdx, ai;
+  int redo;
+
+  if (ctx->parm.brick
+      && !( ctx->parm.brick >= 2
+            && !(ctx->parm.brick & (ctx->parm.brick - 1)) )) {
+    biffAddf(GAGE, "%s: parm.brick %u not a power of two >= 2", me,
+             ctx->parm.brick);
+    return 1;
+  }
+  for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+    pvl = ctx->pvl[pvlIdx];
+    if (!( ctx->parm.brick && pvl->iv3Fill )) {
+      _gageBrickNix(pvl);
+      continue;
+    }
+    if (pvl->brickData && pvl->brickSrc == pvl->nin->data) {
+      /* see if the brick size is still right */
+      redo = AIR_FALSE;
+      for (ai=0; ai<3; ai++) {
+        redo |= (pvl->brickShift[ai]
+                 != _gageBrickShift(ctx->parm.brick, ctx->shape->size[ai]));
+        redo |= (pvl->brickNum[ai]
+                 != ((ctx->shape->size[ai] + (1u << pvl->brickShift[ai]) - 1)
+                     >> pvl->brickShift[ai]));
+      }
+      if (!redo) {
+        continue;
+      }
+    }
+    if (ctx->verbose) {
+      fprintf(stderr, "%s: bricking pvl[%u] with brick %u\n", me, pvlIdx,
+              ctx->parm.brick);
+    }
+    if (_gageBrickMake(pvl, ctx->shape, ctx->parm.brick)) {
+      biffAddf(GAGE, "%s: trouble with pvl[%u]", me, pvlIdx);
+      return 1;
+    }
+  }
+  return 0;
+}
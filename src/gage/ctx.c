@@ -70,11 +70,13 @@ gageContextNew() {
     }
     ctx->radius = 0;
     ctx->fsl = ctx->fw = NULL;
+    ctx->fwf = NULL;
     ctx->off = NULL;
     gagePointReset(&ctx->point);
     strcpy(ctx->errStr, "");
     ctx->errNum = gageErrNone;
     ctx->edgeFrac = 0;
+    gageContextStatsReset(ctx);
   }
   return ctx;
 }
@@ -148,18 +150,20 @@ gageContextCopy(gageContext *ctx) {
   fd = 2*ntx->radius;
   ntx->fsl = AIR_CALLOC(fd*3, double);
   ntx->fw = AIR_CALLOC(fd*3*(GAGE_KERNEL_MAX+1), double);
-  ntx->off = AIR_CALLOC(fd*fd*fd, unsigned int);
-  if (!( ntx->fsl && ntx->fw && ntx->off )) {
+  ntx->fwf = AIR_CALLOC(fd*3*(GAGE_KERNEL_MAX+1), float);
+  ntx->off = AIR_CALLOC(fd*fd*fd, size_t);
+  if (!( ntx->fsl && ntx->fw && ntx->fwf && ntx->off )) {
     biffAddf(GAGE, "%s: couldn't allocate new filter caches for fd=%d",
              me, fd);
     return NULL;
   }
   /* the content of the offset array needs to be copied because
      it won't be refilled simply by calls to gageProbe() */
-  memcpy(ntx->off, ctx->off, fd*fd*fd*sizeof(unsigned int));
+  memcpy(ntx->off, ctx->off, fd*fd*fd*sizeof(size_t));
 
   /* make sure gageProbe() has to refill caches */
   gagePointReset(&ntx->point);
+  gageContextStatsReset(ntx);
 
   return ntx;
 }
@@ -190,8 +194,9 @@ gageContextNix(gageContext *ctx) {
     ctx->stackFsl = AIR_CAST(double *, airFree(ctx->stackFsl));
     ctx->stackFw = AIR_CAST(double *, airFree(ctx->stackFw));
     ctx->fw = AIR_CAST(double *, airFree(ctx->fw));
+    ctx->fwf = AIR_CAST(float *, airFree(ctx->fwf));
     ctx->fsl = AIR_CAST(double *, airFree(ctx->fsl));
-    ctx->off = AIR_CAST(unsigned int *, airFree(ctx->off));
+    ctx->off = AIR_CAST(size_t *, airFree(ctx->off));
   }
   airFree(ctx);
   return NULL;
@@ -378,6 +383,28 @@ gageParmSet(gageContext *ctx, int which, double val) {
   case gageParmTwoDimZeroZ:
     ctx->parm.twoDimZeroZ = AIR_CAST(int, val);
     break;
+  case gageParmIv3Shift:
+    ctx->parm.iv3Shift = val ? AIR_TRUE : AIR_FALSE;
+    /* no flag to set, simply affects future calls to gageProbe() */
+    break;
+  case gageParmSinglePrecision:
+    ctx->parm.singlePrecision = val ? AIR_TRUE : AIR_FALSE;
+    /* as with renormalize, the caches and filter weights for the last
+       probe location can't be re-used */
+    _gageSinglePrecisionUpdate(ctx);
+    gagePointReset(&ctx->point);
+    break;
+  case gageParmBrick:
+    ctx->parm.brick = AIR_CAST(unsigned int, val);
+    /* the bricked copies are made (or freed) by the next gageUpdate() */
+    break;
+  case gageParmStats:
+    ctx->parm.stats = val ? AIR_TRUE : AIR_FALSE;
+    break;
+  case gageParmMultiScl:
+    ctx->parm.multiScl = val ? AIR_TRUE : AIR_FALSE;
+    /* no flag to set, simply affects future calls to gageProbe() */
+    break;
   default:
     fprintf(stderr, "\n%s: sorry, which = %d not valid\n\n", me, which);
     break;
@@ -508,7 +535,10 @@ gagePerVolumeDetach(gageContext *ctx, gagePerVolume *pvl) {
 ** the verbose comments seems like one way of trying to speed it up.
 ** However, temporarily if-def'ing out unused branches of the
 ** "switch(pvl->kind->valLen)", and #define'ing fddd to 64 (for 4x4x4
-** neighborhoods) did not noticeably speed anything up.
+** neighborhoods) did not noticeably speed anything up.  What did help
+** was getting rid of the per-sample pvl->lup() calls: when the whole
+** neighborhood is inside the volume, pvl->iv3Fill (see iv3.c) copies
+** it scanline by scanline.
 **
 */
 void
@@ -516,14 +546,18 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
   static const char me[]="gageIv3Fill";
   int lx, ly, lz, hx, hy, hz, _xx, _yy, _zz;
   unsigned int xx, yy, zz,
-    fr, cacheIdx, dataIdx, fddd;
+    fr, cacheIdx, fddd;
   unsigned int sx, sy, sz;
-  char *data, *here;
+  size_t dataIdx, sxy;
+  char *data, *here, stmp[AIR_STRLEN_SMALL];
   unsigned int tup;
 
   sx = ctx->shape->size[0];
   sy = ctx->shape->size[1];
   sz = ctx->shape->size[2];
+  /* all index arithmetic is done in size_t, since there may be more
+     than 2^32 samples in the volume */
+  sxy = AIR_CAST(size_t, sx)*sy;
   fr = ctx->radius;
   /* idx[0]-1: see Thu Jan 14 comment in filter.c */
   lx = ctx->point.idx[0]-1 - (fr - 1);
@@ -547,7 +581,7 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
       && hy < AIR_CAST(int, sy)
       && hz < AIR_CAST(int, sz)) {
     /* all the samples we need are inside the existing volume */
-    dataIdx = lx + sx*(ly + sy*(lz));
+    dataIdx = lx + AIR_CAST(size_t, sx)*ly + sxy*lz;
     if (ctx->verbose > 1) {
       fprintf(stderr, "%s:     hello, valLen = %d, pvl->nin = %p, data = %p\n",
               me, pvl->kind->valLen,
@@ -556,52 +590,40 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
     here = data + dataIdx*pvl->kind->valLen*nrrdTypeSize[pvl->nin->type];
     if (ctx->verbose > 1) {
       fprintf(stderr, "%s:     size = (%u,%u,%u);\n"
-              "%s:     fd = %d; coord = (%u,%u,%u) --> dataIdx = %d\n",
+              "%s:     fd = %d; coord = (%u,%u,%u) --> dataIdx = %s\n",
               me, sx, sy, sz, me, 2*fr,
               ctx->point.idx[0], ctx->point.idx[1], ctx->point.idx[2],
-              dataIdx);
+              airSprintSize_t(stmp, dataIdx));
       fprintf(stderr, "%s:     here = %p; iv3 = %p; off[0,1,2,3,4,5,6,7] = "
-              "%d,%d,%d,%d,%d,%d,%d,%d\n",
+              "%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
               me, here, AIR_CAST(void*, pvl->iv3),
-              ctx->off[0], ctx->off[1], ctx->off[2], ctx->off[3],
-              ctx->off[4], ctx->off[5], ctx->off[6], ctx->off[7]);
+              AIR_CAST(unsigned long, ctx->off[0]),
+              AIR_CAST(unsigned long, ctx->off[1]),
+              AIR_CAST(unsigned long, ctx->off[2]),
+              AIR_CAST(unsigned long, ctx->off[3]),
+              AIR_CAST(unsigned long, ctx->off[4]),
+              AIR_CAST(unsigned long, ctx->off[5]),
+              AIR_CAST(unsigned long, ctx->off[6]),
+              AIR_CAST(unsigned long, ctx->off[7]));
     }
-    switch(pvl->kind->valLen) {
-    case 1:
-      for (cacheIdx=0; cacheIdx<fddd; cacheIdx++) {
-        pvl->iv3[cacheIdx] = pvl->lup(here, ctx->off[cacheIdx]);
-      }
-      break;
-      /* NOTE: the tuple axis is being shifted from the fastest to
-         the slowest axis, to anticipate component-wise filtering
-         operations */
-    case 3:
-      for (cacheIdx=0; cacheIdx<fddd; cacheIdx++) {
-        pvl->iv3[cacheIdx + fddd*0] = pvl->lup(here, 0 + 3*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*1] = pvl->lup(here, 1 + 3*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*2] = pvl->lup(here, 2 + 3*ctx->off[cacheIdx]);
-      }
-      break;
-    case 7:
-      /* this might come in handy for tenGage . . . */
-      for (cacheIdx=0; cacheIdx<fddd; cacheIdx++) {
-        pvl->iv3[cacheIdx + fddd*0] = pvl->lup(here, 0 + 7*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*1] = pvl->lup(here, 1 + 7*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*2] = pvl->lup(here, 2 + 7*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*3] = pvl->lup(here, 3 + 7*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*4] = pvl->lup(here, 4 + 7*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*5] = pvl->lup(here, 5 + 7*ctx->off[cacheIdx]);
-        pvl->iv3[cacheIdx + fddd*6] = pvl->lup(here, 6 + 7*ctx->off[cacheIdx]);
-      }
-      break;
-    default:
+    if (pvl->singlePrecision || pvl->iv3Fill) {
+      unsigned int lo[3], bmin[3], bmax[3];
+      /* type- and valLen-specialized copy of contiguous scanlines
+         (singlePrecision implies iv3FillF), from nin or its bricked copy */
+      ELL_3V_SET(lo, AIR_UINT(lx), AIR_UINT(ly), AIR_UINT(lz));
+      ELL_3V_SET(bmin, 0, 0, 0);
+      ELL_3V_SET(bmax, 2*fr-1, 2*fr-1, 2*fr-1);
+      _gageIv3FillBox(ctx, pvl, lo, bmin, bmax);
+    } else {
+      /* no specialized fill (as with block types); NOTE: the tuple axis
+         is being shifted from the fastest to the slowest axis, to
+         anticipate component-wise filtering operations */
       for (cacheIdx=0; cacheIdx<fddd; cacheIdx++) {
         for (tup=0; tup<pvl->kind->valLen; tup++) {
           pvl->iv3[cacheIdx + fddd*tup] =
             pvl->lup(here, tup + pvl->kind->valLen*ctx->off[cacheIdx]);
         }
       }
-      break;
     }
     ctx->edgeFrac = 0;
   } else {
@@ -614,6 +636,9 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
     valLen = pvl->kind->valLen;
     dataStride = AIR_UINT(valLen*nrrdTypeSize[pvl->nin->type]);
     iv3 = pvl->iv3;
+    if (pvl->brickData) {
+      data = AIR_CAST(char *, pvl->brickData);
+    }
     if (1 == sz) {
       /* working with 2D images is now common enough that we try to make
          simplifications for that (HEY copy and paste). We first do the
@@ -624,7 +649,9 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
           xx = AIR_CLAMP(0, _xx, AIR_CAST(int, sx-1));
           edgeNum += ((AIR_CAST(int, yy) != _yy)
                       || (AIR_CAST(int, xx) != _xx));
-          dataIdx = xx + sx*yy;
+          dataIdx = (pvl->brickData
+                     ? _gageBrickIndex(pvl, xx, yy, 0)
+                     : xx + AIR_CAST(size_t, sx)*yy);
           here = data+dataIdx*dataStride;
           for (tup=0; tup<valLen; tup++) {
             iv3[cacheIdx + fddd*tup] = pvl->lup(here, tup);
@@ -660,13 +687,15 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
             edgeNum += ((AIR_CAST(int, zz) != _zz)
                         || (AIR_CAST(int, yy) != _yy)
                         || (AIR_CAST(int, xx) != _xx));
-            dataIdx = xx + sx*(yy + sy*zz);
-            here = data+dataIdx*pvl->kind->valLen*nrrdTypeSize[pvl->nin->type];
+            dataIdx = (pvl->brickData
+                       ? _gageBrickIndex(pvl, xx, yy, zz)
+                       : xx + AIR_CAST(size_t, sx)*yy + sxy*zz);
+            here = data+dataIdx*dataStride;
             if (ctx->verbose > 2) {
               fprintf(stderr, "%s:    (%d,%d,%d) --clamp--> (%u,%u,%u)\n", me,
                       _xx, _yy, _zz, xx, yy, zz);
-              fprintf(stderr, "    --> dataIdx = %d; data = %p -> here = %p\n",
-                      dataIdx, data, here);
+              fprintf(stderr, "    --> dataIdx = %s; data = %p -> here = %p\n",
+                      airSprintSize_t(stmp, dataIdx), data, here);
             }
             for (tup=0; tup<pvl->kind->valLen; tup++) {
               iv3[cacheIdx + fddd*tup] = pvl->lup(here, tup);
@@ -682,6 +711,11 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
       }
     }
     ctx->edgeFrac = AIR_CAST(double, edgeNum)/fddd;
+    if (pvl->singlePrecision) {
+      for (cacheIdx=0; cacheIdx<fddd*valLen; cacheIdx++) {
+        pvl->iv3f[cacheIdx] = AIR_CAST(float, iv3[cacheIdx]);
+      }
+    }
   }
   if (ctx->verbose > 1) {
     fprintf(stderr, "%s: ^^^ bye\n", me);
@@ -689,6 +723,67 @@ gageIv3Fill(gageContext *ctx, gagePerVolume *pvl) {
   return;
 }
 
+/*
+** _gageIv3ShiftAxis
+**
+** when the neighborhood around ctx->point.idx is the one around oldIdx
+** moved by one sample along one axis, and the new neighborhood is
+** entirely inside the volume, returns the axis, and sets *dir to the
+** direction (+1 or -1) of motion. Otherwise returns -1, and the iv3
+** caches have to be completely refilled.
+**
+** Motion along the fastest axis (0) is not shifted: the new plane then
+** needs one sample from each of the fd^2 scanlines of the neighborhood,
+** which touches the same memory as refilling all of it with the
+** contiguous scanline copies of pvl->iv3Fill, and timing showed that
+** shifting the other (fd-1) samples in each line was a net loss.
+*/
+static int
+_gageIv3ShiftAxis(const gageContext *ctx, const unsigned int oldIdx[4],
+                  int *dir) {
+  unsigned int ai, fr;
+  int axis, diff;
+
+  fr = ctx->radius;
+  axis = -1;
+  for (ai=0; ai<3; ai++) {
+    /* the new neighborhood [idx-fr,idx+fr-1] has to be inside the
+       volume, and the old oldIdx has to be valid (not as reset by
+       gagePointReset) */
+    if (!( ctx->point.idx[ai] >= fr
+           && ctx->point.idx[ai] + fr - 1 < ctx->shape->size[ai]
+           && oldIdx[ai] <= ctx->shape->size[ai] )) {
+      return -1;
+    }
+    diff = AIR_CAST(int, ctx->point.idx[ai]) - AIR_CAST(int, oldIdx[ai]);
+    if (diff) {
+      if (-1 != axis || !( 1 == diff || -1 == diff )) {
+        return -1;
+      }
+      if (!ai) {
+        return -1;
+      }
+      axis = AIR_CAST(int, ai);
+      *dir = diff;
+    }
+  }
+  return axis;
+}
+
+/*
+** adds to *tick the ticks since *tick0, and resets *tick0, for
+** timing the phases of _gageProbe when parm.stats
+*/
+static void
+_gageStatsLap(airULLong *tick, airULLong *tick0) {
+  airULLong tick1;
+
+  tick1 = _gageStatsTick();
+  *tick += tick1 - *tick0;
+  *tick0 = tick1;
+  return;
+}
+
 /*
 ** _gageProbe
 **
@@ -706,11 +801,17 @@ int
 _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
   static const char me[]="_gageProbe";
   unsigned int oldIdx[4], oldNnz=0, pvlIdx;
-  int idxChanged;
+  int idxChanged, shiftAxis, shiftDir, stats;
+  airULLong tick0=0;
 
   if (!ctx) {
     return 1;
   }
+  stats = ctx->parm.stats;
+  if (stats) {
+    ctx->stats.probeNum++;
+    tick0 = _gageStatsTick();
+  }
   if (ctx->verbose > 3) {
     fprintf(stderr, "%s: hello(%g,%g,%g,%g) _____________ \n", me,
             _xi, _yi, _zi, _si);
@@ -723,8 +824,15 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
     /* GLK had added but not checked in the following line;
        the logic of this has to be studied further */
     /* ctx->edgeFrac = 0.666; */
+    if (stats) {
+      ctx->stats.outsideNum++;
+      _gageStatsLap(&ctx->stats.locationTick, &tick0);
+    }
     return 1;
   }
+  if (stats) {
+    _gageStatsLap(&ctx->stats.locationTick, &tick0);
+  }
 
   /* if necessary, refill the iv3 cache */
   idxChanged = (oldIdx[0] != ctx->point.idx[0]
@@ -751,12 +859,29 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
   }
   if (idxChanged) {
     if (!ctx->parm.stackUse) {
+      shiftAxis = (ctx->parm.iv3Shift
+                   ? _gageIv3ShiftAxis(ctx, oldIdx, &shiftDir)
+                   : -1);
       for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
-        if (ctx->verbose > 3) {
-          fprintf(stderr, "%s: gageIv3Fill(pvl[%u/%u] %s): .......\n", me,
-                  pvlIdx, ctx->pvlNum, ctx->pvl[pvlIdx]->kind->name);
+        if (shiftAxis >= 0) {
+          if (ctx->verbose > 3) {
+            fprintf(stderr, "%s: _gageIv3Shift(pvl[%u/%u] %s, %d, %d)\n", me,
+                    pvlIdx, ctx->pvlNum, ctx->pvl[pvlIdx]->kind->name,
+                    shiftAxis, shiftDir);
+          }
+          _gageIv3Shift(ctx, ctx->pvl[pvlIdx], shiftAxis, shiftDir);
+          ctx->iv3ShiftNum++;
+        } else {
+          if (ctx->verbose > 3) {
+            fprintf(stderr, "%s: gageIv3Fill(pvl[%u/%u] %s): .......\n", me,
+                    pvlIdx, ctx->pvlNum, ctx->pvl[pvlIdx]->kind->name);
+          }
+          gageIv3Fill(ctx, ctx->pvl[pvlIdx]);
+          ctx->iv3FillNum++;
         }
-        gageIv3Fill(ctx, ctx->pvl[pvlIdx]);
+      }
+      if (shiftAxis >= 0) {
+        ctx->edgeFrac = 0;
       }
     } else {
       for (pvlIdx=0; pvlIdx<ctx->pvlNum-1; pvlIdx++) {
@@ -771,6 +896,7 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
                     pvlIdx, ctx->stackFw[pvlIdx]);
           }
           gageIv3Fill(ctx, ctx->pvl[pvlIdx]);
+          ctx->iv3FillNum++;
         } else {
           if (ctx->verbose > 3) {
             fprintf(stderr, "%s: stackFw[%u] == %g -> NO iv3fill\n", me,
@@ -792,6 +918,11 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
       }
     }
     _gageStackBaseIv3Fill(ctx);
+    if (stats) {
+      ctx->stats.stackNum++;
+      ctx->stats.edgeNum += (ctx->edgeFrac > 0);
+      _gageStatsLap(&ctx->stats.fillTick, &tick0);
+    }
     if (ctx->verbose > 3) {
       fprintf(stderr, "%s: (stack) base pvl's value cache at "
               "coords = %u,%u,%u:\n", me,
@@ -799,8 +930,25 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
       ctx->pvl[baseIdx]->kind->iv3Print(stderr, ctx, ctx->pvl[baseIdx]);
     }
     ctx->pvl[baseIdx]->kind->filter(ctx, ctx->pvl[baseIdx]);
+    if (stats) {
+      _gageStatsLap(&ctx->stats.filterTick, &tick0);
+    }
     ctx->pvl[baseIdx]->kind->answer(ctx, ctx->pvl[baseIdx]);
+    if (stats) {
+      _gageStatsLap(&ctx->stats.answerTick, &tick0);
+    }
   } else {
+    unsigned int multiNum;
+    if (stats) {
+      ctx->stats.edgeNum += (ctx->edgeFrac > 0);
+      _gageStatsLap(&ctx->stats.fillTick, &tick0);
+    }
+    /* with parm.multiScl, the scalar pervolumes are all filtered here,
+       and skipped by the per-pervolume filtering below */
+    multiNum = (ctx->parm.multiScl ? _gageSclFilterMulti(ctx) : 0);
+    if (stats && multiNum) {
+      _gageStatsLap(&ctx->stats.filterTick, &tick0);
+    }
     for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
       if (ctx->verbose > 3) {
         fprintf(stderr, "%s: pvl[%u/%u %s]'s value cache at "
@@ -809,8 +957,16 @@ _gageProbe(gageContext *ctx, double _xi, double _yi, double _zi, double _si) {
                 ctx->point.idx[0], ctx->point.idx[1], ctx->point.idx[2]);
         ctx->pvl[pvlIdx]->kind->iv3Print(stderr, ctx, ctx->pvl[pvlIdx]);
       }
-      ctx->pvl[pvlIdx]->kind->filter(ctx, ctx->pvl[pvlIdx]);
+      if (!( multiNum && _gageSclFilterMultiCan(ctx->pvl[pvlIdx]) )) {
+        ctx->pvl[pvlIdx]->kind->filter(ctx, ctx->pvl[pvlIdx]);
+        if (stats) {
+          _gageStatsLap(&ctx->stats.filterTick, &tick0);
+        }
+      }
       ctx->pvl[pvlIdx]->kind->answer(ctx, ctx->pvl[pvlIdx]);
+      if (stats) {
+        _gageStatsLap(&ctx->stats.answerTick, &tick0);
+      }
     }
   }
 
@@ -832,9 +988,19 @@ gageProbe(gageContext *ctx, double xi, double yi, double zi) {
   return _gageProbe(ctx, xi, yi, zi, 0.0);
 }
 
+/*
+** _gageProbeSpaceIndex
+**
+** the part of _gageProbeSpace that converts a (possibly world-space)
+** position (xx,yy,zz,ss) to the index-space position ipos[0,1,2,3]
+** that is passed to _gageProbe, with clamping if requested.  Like
+** gageProbe, this returns 1 (with ctx->errNum and ctx->errStr set) on
+** error, without using biff.
+*/
 int
-_gageProbeSpace(gageContext *ctx, double xx, double yy, double zz, double ss,
-               int indexSpace, int clamp) {
+_gageProbeSpaceIndex(gageContext *ctx, double ipos[4],
+                     double xx, double yy, double zz, double ss,
+                     int indexSpace, int clamp) {
   static const char me[]="_gageProbeSpace";
   unsigned int *size;
   double xi, yi, zi, si;
@@ -931,7 +1097,19 @@ _gageProbeSpace(gageContext *ctx, double xx, double yy, double zz, double ss,
               xi, yi, zi);
     }
   }
-  return _gageProbe(ctx, xi, yi, zi, si);
+  ELL_4V_SET(ipos, xi, yi, zi, si);
+  return 0;
+}
+
+int
+_gageProbeSpace(gageContext *ctx, double xx, double yy, double zz, double ss,
+               int indexSpace, int clamp) {
+  double ipos[4];
+
+  if (_gageProbeSpaceIndex(ctx, ipos, xx, yy, zz, ss, indexSpace, clamp)) {
+    return 1;
+  }
+  return _gageProbe(ctx, ipos[0], ipos[1], ipos[2], ipos[3]);
 }
 
 int
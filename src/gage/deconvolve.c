@@ -37,7 +37,8 @@ gageDeconvolve(Nrrd *_nout, double *lastDiffP,
   const double *ans[2];
   Nrrd *nout[2];
   airArray *mop;
-  unsigned int sx, sy, sz, xi, yi, zi, anslen, thiz=0, last, inIdx, iter;
+  unsigned int sx, sy, sz, xi, yi, zi, anslen, thiz=0, last, iter;
+  size_t inIdx;
   int E, valItem;
 
   if (!(_nout && lastDiffP && nin && kind && ksp)) {
@@ -120,7 +121,7 @@ gageDeconvolve(Nrrd *_nout, double *lastDiffP,
         }
       }
     }
-    meandiff /= sx*sy*sz;
+    meandiff /= AIR_CAST(double, sx)*sy*sz;
     if (verbose) {
       fprintf(stderr, "%s: iter %u meandiff = %g\n", me, iter, meandiff);
     }
@@ -160,19 +161,112 @@ gageDeconvolve(Nrrd *_nout, double *lastDiffP,
 ** pushed down to nrrd . . .
 */
 
-static void
-deconvLine(double *line, size_t llen, const NrrdKernelSpec *ksp) {
+/*
+** With gage's handling of the volume boundary (sample indices are
+** clamped), convolving a line of length len with a kernel of integer
+** support radius "radius" is multiplication by a banded len-by-len
+** matrix, with the weights that fall outside the line added onto the
+** first or last sample.  Deconvolution is solving that system, which
+** is done directly by LU factorization (without pivoting, which is
+** fine for the diagonally dominant matrices of the kernels that
+** gageDeconvolveSeparableKnown() accepts).  The factorization depends
+** only on the line length, so it is done once per axis.
+*/
+typedef struct {
+  size_t len;
+  unsigned int radius;
+  double *lu;         /* len rows of 2*radius+1 values; for row ii,
+                         lu[jj + (2*radius+1)*ii] is for column
+                         ii + jj - radius */
+} deconvBand;
 
-  /* Add as many other parameters to this as you want,
-     like number and location of poles, or whatever other
-     buffers you think you need (they should be passed,
-     not allocated and freed on a per-line basis) */
+#define BAND(bnd, ii, cc) \
+  ((bnd)->lu[(cc) + (bnd)->radius - (ii) + (2*(bnd)->radius + 1)*(ii)])
+
+static deconvBand *
+deconvBandNix(deconvBand *bnd) {
+
+  if (bnd) {
+    airFree(bnd->lu);
+    airFree(bnd);
+  }
+  return NULL;
+}
+
+static deconvBand *
+deconvBandNew(size_t len, const NrrdKernelSpec *ksp) {
+  deconvBand *bnd;
+  unsigned int radius;
+  size_t ii, cc, rr, rlast, clast;
+  int kk, ci;
+
+  radius = AIR_UINT(ceil(ksp->kernel->support(ksp->parm)));
+  while (radius
+         && !ksp->kernel->eval1_d(radius, ksp->parm)
+         && !ksp->kernel->eval1_d(-AIR_CAST(double, radius), ksp->parm)) {
+    radius--;
+  }
+  bnd = AIR_CALLOC(1, deconvBand);
+  if (!bnd) {
+    return NULL;
+  }
+  bnd->len = len;
+  bnd->radius = radius;
+  bnd->lu = AIR_CALLOC(len*(2*radius + 1), double);
+  if (!bnd->lu) {
+    return deconvBandNix(bnd);
+  }
+  /* the value reconstructed at sample ii is the sum over kk of
+     kernel(-kk) times the coefficient at (clamped) ii + kk */
+  for (ii=0; ii<len; ii++) {
+    for (kk=-AIR_CAST(int, radius); kk<=AIR_CAST(int, radius); kk++) {
+      ci = AIR_CAST(int, ii) + kk;
+      ci = AIR_CLAMP(0, ci, AIR_CAST(int, len)-1);
+      BAND(bnd, ii, AIR_CAST(size_t, ci))
+        += ksp->kernel->eval1_d(-kk, ksp->parm);
+    }
+  }
+  /* LU factorization in place */
+  for (ii=0; ii<len; ii++) {
+    rlast = AIR_MIN(len-1, ii + radius);
+    clast = rlast;
+    for (rr=ii+1; rr<=rlast; rr++) {
+      double mm;
+      mm = BAND(bnd, rr, ii)/BAND(bnd, ii, ii);
+      BAND(bnd, rr, ii) = mm;
+      for (cc=ii+1; cc<=clast; cc++) {
+        BAND(bnd, rr, cc) -= mm*BAND(bnd, ii, cc);
+      }
+    }
+  }
+  return bnd;
+}
 
-  /* comment these out when there is a real function body */
-  AIR_UNUSED(line);
-  AIR_UNUSED(llen);
-  AIR_UNUSED(ksp);
+/*
+** deconvolves one line, in place, with the factorization for its length
+*/
+static void
+deconvLine(double *line, const deconvBand *bnd) {
+  size_t ii, cc, len, first, last;
+  double sum;
 
+  len = bnd->len;
+  for (ii=0; ii<len; ii++) {
+    first = ii > bnd->radius ? ii - bnd->radius : 0;
+    sum = line[ii];
+    for (cc=first; cc<ii; cc++) {
+      sum -= BAND(bnd, ii, cc)*line[cc];
+    }
+    line[ii] = sum;
+  }
+  for (ii=len; ii>0; ii--) {
+    last = AIR_MIN(len-1, ii-1 + bnd->radius);
+    sum = line[ii-1];
+    for (cc=ii; cc<=last; cc++) {
+      sum -= BAND(bnd, ii-1, cc)*line[cc];
+    }
+    line[ii-1] = sum/BAND(bnd, ii-1, ii-1);
+  }
   return;
 }
 
@@ -211,17 +305,149 @@ gageDeconvolveSeparableKnown(const NrrdKernelSpec *ksp) {
   return ret;
 }
 
+/* how many lines to hand out to a thread at once */
+#define DECONV_LINE_CHUNK 64
+
+/*
+** what is shared by the threads of one deconvolution pass (along one
+** axis); all the lines are independent, so they're deconvolved in
+** place, a chunk of lines at a time
+*/
+typedef struct {
+  double *data;               /* all the values, as doubles */
+  const deconvBand *bnd;      /* factorization for this axis */
+  unsigned int valLen,
+    axis;                     /* which (spatial) axis */
+  size_t size[3],             /* spatial sizes */
+    lineNum,                  /* number of lines along this axis */
+    lineNext;                 /* first line not yet handed out */
+  airThreadMutex *mutex;      /* NULL if only one thread */
+} deconvTask;
+
+typedef struct {
+  deconvTask *task;
+  double *line;               /* buffer for one line */
+} deconvThread;
+
+static void *
+deconvWorker(void *_dth) {
+  deconvThread *dth;
+  deconvTask *task;
+  double *data;
+  size_t jj, jlast, ii, len, idx, stride, sx, sy;
+  unsigned int vi;
+
+  dth = AIR_CAST(deconvThread *, _dth);
+  task = dth->task;
+  sx = task->size[0];
+  sy = task->size[1];
+  len = task->size[task->axis];
+  for (;;) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    jj = task->lineNext;
+    task->lineNext = AIR_MIN(task->lineNum, jj + DECONV_LINE_CHUNK);
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (jj >= task->lineNum) {
+      break;
+    }
+    jlast = AIR_MIN(task->lineNum, jj + DECONV_LINE_CHUNK);
+    for (; jj<jlast; jj++) {
+      switch (task->axis) {
+      case 0:
+        /* xi = 0, yi = jj%sy, zi = jj/sy
+           ==> xi + sx*(yi + sy*zi) == sx*jj */
+        idx = sx*jj;
+        stride = 1;
+        break;
+      case 1:
+        /* xi = jj%sx, yi = 0, zi = jj/sx */
+        idx = jj%sx + sx*sy*(jj/sx);
+        stride = sx;
+        break;
+      default:
+        /* xi = jj%sx, yi = jj/sx, zi = 0 ==> jj */
+        idx = jj;
+        stride = sx*sy;
+        break;
+      }
+      data = task->data + task->valLen*idx;
+      stride *= task->valLen;
+      for (vi=0; vi<task->valLen; vi++) {
+        for (ii=0; ii<len; ii++) {
+          dth->line[ii] = data[vi + stride*ii];
+        }
+        deconvLine(dth->line, task->bnd);
+        for (ii=0; ii<len; ii++) {
+          data[vi + stride*ii] = dth->line[ii];
+        }
+      }
+    }
+  }
+  return _dth;
+}
+
+/*
+** deconvolves all the lines along one axis, with threadNum threads
+** (including the calling one)
+*/
+static int
+deconvAxis(deconvTask *task, unsigned int threadNum) {
+  static const char me[]="deconvAxis";
+  deconvThread *dth;
+  unsigned int ti;
+  airArray *mop;
+
+  mop = airMopNew();
+  dth = AIR_CALLOC(threadNum, deconvThread);
+  airMopAdd(mop, dth, airFree, airMopAlways);
+  if (!dth) {
+    biffAddf(GAGE, "%s: couldn't allocate thread state", me);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    dth[ti].task = task;
+    dth[ti].line = AIR_CALLOC(task->size[task->axis], double);
+    airMopAdd(mop, dth[ti].line, airFree, airMopAlways);
+    if (!dth[ti].line) {
+      biffAddf(GAGE, "%s: couldn't allocate line buffer %u", me, ti);
+      airMopError(mop); return 1;
+    }
+  }
+  task->lineNext = 0;
+  if (airThreadRun(threadNum, deconvWorker, dth, sizeof(deconvThread),
+                   &(task->mutex))) {
+    biffAddf(GAGE, "%s: couldn't start threads", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** gageDeconvolveSeparable
+**
+** Computes directly (without iterating, as gageDeconvolve does) the
+** volume that, when probed by gage with kernel ksp, reproduces the
+** values of nin at the samples, by solving along each axis in turn
+** the banded linear system for each line.  The lines along an axis
+** are deconvolved with nrrdStateThreadNum threads; the result is the
+** same with any number of threads.
+*/
 int
 gageDeconvolveSeparable(Nrrd *nout, const Nrrd *nin,
                         const gageKind *kind,
                         const NrrdKernelSpec *ksp,
                         int typeOut) {
   static const char me[]="gageDeconvolveSeparable";
-  double *line, (*lup)(const void *, size_t),
-    (*ins)(void *, size_t, double);
+  Nrrd *ntmp;
+  deconvBand *bnd;
+  deconvTask task;
   airArray *mop;
-  size_t lineLen, sx, sy, sz, idx, ii, jj;
-  unsigned int vi, valLen;
+  unsigned int axi, threadNum;
 
   if (!(nout && nin && kind && ksp)) {
     biffAddf(GAGE, "%s: got NULL pointer", me);
@@ -242,94 +468,56 @@ gageDeconvolveSeparable(Nrrd *nout, const Nrrd *nin,
              me, kind->name);
     return 1;
   }
-  if (nrrdTypeDefault == typeOut
-      ? nrrdCopy(nout, nin)
-      : nrrdConvert(nout, nin, typeOut)) {
-    biffMovef(GAGE, NRRD, "%s: problem allocating output", me);
-    return 1;
-  }
   if (deconvTrivial(ksp)) {
     /* if there's no real work for the deconvolution, then by
        copying the values we're already done; bye */
+    if (nrrdTypeDefault == typeOut
+        ? nrrdCopy(nout, nin)
+        : nrrdConvert(nout, nin, typeOut)) {
+      biffMovef(GAGE, NRRD, "%s: problem allocating output", me);
+      return 1;
+    }
     return 0;
   }
 
-  valLen = kind->valLen;
-  sx = nin->axis[kind->baseDim + 0].size;
-  sy = nin->axis[kind->baseDim + 1].size;
-  sz = nin->axis[kind->baseDim + 2].size;
-  lineLen = sx;
-  lineLen = AIR_MAX(lineLen, sy);
-  lineLen = AIR_MAX(lineLen, sz);
-  lup = nrrdDLookup[nin->type];
-  ins = nrrdDInsert[nout->type];
-
   mop = airMopNew();
-  line = AIR_CALLOC(lineLen*valLen, double);
-  airMopAdd(mop, line, airFree, airMopAlways);
-
-  /* process along X scanlines */
-  for (jj=0; jj<sy*sz; jj++) {
-    /* xi = 0, yi = jj%sy, zi = jj/sy
-       ==> xi + sx*(yi + sy*zi)
-       == 0 + sx*(jj%sy + sy*(jj/sy)) == 0 + sx*jj */
-    idx = 0 + valLen*(0 + sx*jj);
-    for (ii=0; ii<sx; ii++) {
-      for (vi=0; vi<valLen; vi++) {
-        line[ii + sx*vi] = lup(nin->data, idx + vi + valLen*ii);
-      }
-    }
-    for (vi=0; vi<valLen; vi++) {
-      deconvLine(line + sx*vi, sx, ksp);
-    }
-    for (ii=0; ii<sx; ii++) {
-      for (vi=0; vi<valLen; vi++) {
-        ins(nout->data, idx + vi + valLen*ii, line[ii + sx*vi]);
-      }
-    }
+  ntmp = nrrdNew();
+  airMopAdd(mop, ntmp, (airMopper)nrrdNuke, airMopAlways);
+  if (nrrdConvert(ntmp, nin, nrrdTypeDouble)) {
+    biffMovef(GAGE, NRRD, "%s: couldn't allocate working buffer", me);
+    airMopError(mop); return 1;
   }
-
-  /* process along Y scanlines */
-  for (jj=0; jj<sx*sz; jj++) {
-    /* xi = jj%sx, yi = 0, zi = jj/sx
-       ==> xi + sx*(yi + sy*zi)
-       == jj%sx + sx*(0 + sy*jj/sx) */
-    idx = 0 + valLen*((jj%sx) + sx*(0 + sy*(jj/sx)));
-    for (ii=0; ii<sy; ii++) {
-      for (vi=0; vi<valLen; vi++) {
-        line[ii + sy*vi] = lup(nin->data, idx + vi + valLen*sx*ii);
-      }
-    }
-    for (vi=0; vi<valLen; vi++) {
-      deconvLine(line + sy*vi, sy, ksp);
+  task.data = AIR_CAST(double *, ntmp->data);
+  task.valLen = kind->valLen;
+  task.size[0] = nin->axis[kind->baseDim + 0].size;
+  task.size[1] = nin->axis[kind->baseDim + 1].size;
+  task.size[2] = nin->axis[kind->baseDim + 2].size;
+  for (axi=0; axi<3; axi++) {
+    task.axis = axi;
+    task.lineNum = task.size[0]*task.size[1]*task.size[2]/task.size[axi];
+    bnd = deconvBandNew(task.size[axi], ksp);
+    if (!bnd) {
+      biffAddf(GAGE, "%s: couldn't set up axis %u", me, axi);
+      airMopError(mop); return 1;
     }
-    for (ii=0; ii<sx; ii++) {
-      for (vi=0; vi<valLen; vi++) {
-        ins(nout->data, idx + vi + valLen*sx*ii, line[ii + sy*vi]);
-      }
+    airMopAdd(mop, bnd, (airMopper)deconvBandNix, airMopAlways);
+    task.bnd = bnd;
+    threadNum = (airThreadCapable
+                 ? AIR_MAX(1, nrrdStateThreadNum)
+                 : 1);
+    threadNum = AIR_UINT(AIR_MIN(threadNum, (task.lineNum
+                                             + DECONV_LINE_CHUNK - 1)
+                                 /DECONV_LINE_CHUNK));
+    if (deconvAxis(&task, threadNum)) {
+      biffAddf(GAGE, "%s: trouble on axis %u", me, axi);
+      airMopError(mop); return 1;
     }
   }
-
-  /* process along Z scanlines */
-  for (jj=0; jj<sx*sy; jj++) {
-    /* xi = jj%sx, yi = jj/sx, zi = 0
-       ==> xi + sx*(yi + sy*zi)
-       == jj%sx + sx*(jj/sx + sy*0)
-       == jj%sx + sx*(jj/sx) == jj */
-    idx = 0 + valLen*jj;
-    for (ii=0; ii<sz; ii++) {
-      for (vi=0; vi<valLen; vi++) {
-        line[ii + sz*vi] = lup(nin->data, idx + vi + valLen*sx*sy*ii);
-      }
-    }
-    for (vi=0; vi<valLen; vi++) {
-      deconvLine(line + sz*vi, sz, ksp);
-    }
-    for (ii=0; ii<sx; ii++) {
-      for (vi=0; vi<valLen; vi++) {
-        ins(nout->data, idx + vi + valLen*sx*sy*ii, line[ii + sz*vi]);
-      }
-    }
+  if (nrrdClampConvert(nout, ntmp, (nrrdTypeDefault == typeOut
+                                    ? nin->type
+                                    : typeOut))) {
+    biffMovef(GAGE, NRRD, "%s: couldn't create output", me);
+    airMopError(mop); return 1;
   }
 
   airMopOkay(mop);
@@ -80,3 +80,24 @@ gageDefGenerateErrStr = AIR_TRUE;
 
 int
 gageDefTwoDimZeroZ = AIR_FALSE; /* no way this can default to true */
+
+int
+gageDefIv3Shift = AIR_TRUE;
+/* the values in the iv3 caches are the same either way, so there's no
+   reason not to do this, other than debugging */
+
+int
+gageDefSinglePrecision = AIR_FALSE;
+/* answers differ (slightly) from those computed in double precision, so
+   this has to be asked for */
+
+unsigned int
+gageDefBrick = 0;
+/* the answers are the same either way, but the bricked copy doubles the
+   memory used for the volumes, so this has to be asked for */
+
+int
+gageDefStats = AIR_FALSE;
+
+int
+gageDefMultiScl = AIR_FALSE;
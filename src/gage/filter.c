@@ -224,6 +224,18 @@ _gageFwSet(gageContext *ctx, unsigned int sidx, double sfrac) {
     }
   }
 
+  if (ctx->parm.singlePrecision) {
+    unsigned int ii;
+    for (kidx=gageKernelUnknown+1; kidx<gageKernelLast; kidx++) {
+      if (!ctx->needK[kidx] || kidx==gageKernelStack) {
+        continue;
+      }
+      for (ii=0; ii<fd*3; ii++) {
+        ctx->fwf[ii + fd*3*kidx] = AIR_CAST(float, ctx->fw[ii + fd*3*kidx]);
+      }
+    }
+  }
+
   return;
 }
 
@@ -365,6 +377,9 @@ _gageLocationSet(gageContext *ctx,
        hence the conditional above */
     _gageFslSet(ctx);
     _gageFwSet(ctx, idx[3], frac[3]);
+    if (ctx->parm.stats) {
+      ctx->stats.weightNum++;
+    }
   }
 
   /* **** compute *stack* fsl and fw ****  */
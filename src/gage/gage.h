@@ -132,6 +132,11 @@ enum {
   gageParmOrientationFromSpacing,  /* int */
   gageParmGenerateErrStr,          /* int */
   gageParmTwoDimZeroZ,             /* int */
+  gageParmIv3Shift,                /* int */
+  gageParmSinglePrecision,         /* int */
+  gageParmBrick,                   /* unsigned int */
+  gageParmStats,                   /* int */
+  gageParmMultiScl,                /* int */
   gageParmLast
 };
 
@@ -540,7 +545,7 @@ typedef struct gageParm_t {
     generateErrStr,           /* when errors happen, biff is never used, but
                                  a descriptive error is sprintf into
                                  gctx->errStr as long as this is non-zero. */
-    twoDimZeroZ;              /* a limited way of supporting queries on
+    twoDimZeroZ,              /* a limited way of supporting queries on
                                  two-dimensional images. If this is non-zero,
                                  then *some* answers will only involve the 1st
                                  ("X") and 2nd ("Y") coordinates of world
@@ -552,6 +557,52 @@ typedef struct gageParm_t {
                                  correctly handling it ultimately falls to the
                                  "answer" functions of the various
                                  gageKinds */
+    iv3Shift,                 /* if non-zero, when the neighborhood needed by
+                                 gageProbe() has moved by exactly one sample
+                                 along the Y or Z axis (common with rays and
+                                 fiber tracts), the (fd-1) planes of the iv3
+                                 caches that are still needed are shifted
+                                 over, and only the one new plane is read
+                                 from the volume. Not done along X (where it
+                                 doesn't save memory access), or when using
+                                 the stack (stackUse) */
+    singlePrecision;          /* if non-zero, pervolumes of the scalar and
+                                 vector kinds are filtered in single precision:
+                                 the value caches (iv3f, iv2f, iv1f) and the
+                                 filter weights (fwf) are float, which halves
+                                 their size and memory traffic.  Answers are
+                                 still stored (and later computed) as double.
+                                 Not done when using the stack (stackUse).
+                                 Beware that data values below FLT_MIN in
+                                 magnitude become (slow) denormals */
+  unsigned int brick;         /* if non-zero, a power of two: gageUpdate()
+                                 makes a copy of each volume (of a non-block
+                                 type) re-laid out as cubes of this many
+                                 samples on edge (or fewer, along short
+                                 axes), and probing reads from that instead
+                                 of nin, so that the samples of a
+                                 neighborhood are in fewer cache lines and
+                                 pages.  Worth the memory (and the time for
+                                 the copy) when probing far from raster
+                                 order, as along rays or tracts that aren't
+                                 along X.  The answers are the same.  The
+                                 copy is re-made only when nin->data (the
+                                 pointer) or the brick size changes, so after
+                                 changing the values in nin->data in place,
+                                 call gagePerVolumeDataChanged() */
+  int stats;                  /* if non-zero, gageProbe() counts what it
+                                 does, and times its phases, in ctx->stats
+                                 (see gageContextStatsPrint()).  Costs a
+                                 few reads of the cycle counter per probe */
+  int multiScl;               /* if non-zero, and there are two or more
+                                 pervolumes of the scalar kind (filtered in
+                                 double precision, without the stack),
+                                 their value caches are interleaved into
+                                 short vectors (one value per volume) and
+                                 filtered together, so that each filter
+                                 weight is applied once per sample to a
+                                 vector, instead of once per volume.  The
+                                 answers are the same */
 } gageParm;
 
 /*
@@ -679,6 +730,36 @@ typedef unsigned char gageQuery[GAGE_QUERY_BYTES_NUM];
 #define GAGE_OPTIMSIG_SIGMA_MAX 11
 #define GAGE_OPTIMSIG_SAMPLES_MAXNUM 11
 
+/*
+******** gageStats struct
+**
+** what gageProbe() (and everything built on it) has done since the last
+** gageUpdate() or gageContextStatsReset(), maintained only when
+** parm.stats is set.  The iv3 cache fills are counted (always) by
+** ctx->iv3FillNum and ctx->iv3ShiftNum.  The times spent in each phase
+** of probing are in "ticks": CPU cycles (from the time-stamp counter) on
+** x86 with GCC, clang, or MSVC, otherwise microseconds.
+*/
+typedef struct {
+  size_t probeNum,            /* all probes, including failed ones */
+    outsideNum,               /* probes that failed for being outside */
+    edgeNum,                  /* probes with edgeFrac > 0: the kernel
+                                 support needed samples outside the volume,
+                                 which were filled the slow way */
+    weightNum,                /* (re-)computations of the filter sample
+                                 locations and weights, needed whenever
+                                 the fractional position changes */
+    stackNum;                 /* probes in a scale-space stack */
+  airULLong locationTick,     /* in _gageLocationSet(), including the
+                                 kernel weights */
+    fillTick,                 /* filling the iv3 caches */
+    filterTick,               /* in the kinds' filter methods */
+    answerTick,               /* in the kinds' answer methods */
+    tickStart;                /* tick when the stats were reset */
+  double timeStart;           /* airTime() when the stats were reset, to
+                                 convert ticks to seconds */
+} gageStats;
+
 /*
 ******** gageContext struct
 **
@@ -752,13 +833,14 @@ typedef struct gageContext_t {
      fd x 3 x GAGE_KERNEL_MAX+1 (fast-to-slow) array */
   double *fw;
 
+  /* same as fw, but float, and only set when parm.singlePrecision */
+  float *fwf;
+
   /* offsets to other fd^3 samples needed to fill 3D intermediate
      value cache. Allocated size is dependent on kernels, values
-     inside are dependent on the dimensions of the volume. It may be
-     more correct to be using size_t instead of uint, but the X and Y
-     dimensions of the volume would have to be super-outrageous for
-     that to be a problem */
-  unsigned int *off;
+     inside are dependent on the dimensions of the volume. These are
+     size_t so that volumes with more than 2^32 samples can be probed */
+  size_t *off;
 
   /* last probe location */
   gagePoint point;
@@ -778,6 +860,16 @@ typedef struct gageContext_t {
      value is NOT meaningfully set if there is no clamping, and the probe
      location as fallen outside the volume */
   double edgeFrac;
+
+  /* how many times the iv3 caches (summed over pervolumes) were filled by
+     gageProbe() since the last gageUpdate() (or gageContextStatsReset()):
+     iv3FillNum counts complete refills of all fd^3 samples, and
+     iv3ShiftNum counts partial refills in which only one new plane was
+     read (see parm.iv3Shift) */
+  size_t iv3FillNum, iv3ShiftNum;
+
+  /* counts and times of probing, if parm.stats */
+  gageStats stats;
 } gageContext;
 
 /*
@@ -803,9 +895,38 @@ typedef struct gagePerVolume_t {
                                  length valLen) always slowest.  However, use
                                  of iv2 and iv1 is entirely up the kind's
                                  filter method. */
+  float *iv3f, *iv2f, *iv1f;  /* single-precision versions of iv3, iv2, iv1,
+                                 used instead of them (which are then not
+                                 kept up to date) when singlePrecision */
+  int singlePrecision;        /* set by gageUpdate(): non-zero if this
+                                 pervolume is being filtered in single
+                                 precision, as per ctx->parm.singlePrecision
+                                 and whether the kind supports it */
   double (*lup)(const void *ptr, size_t I);
                               /* nrrd{F,D}Lookup[] element, according to
                                  nin->type and double */
+  void (*iv3Fill)(double *iv3, const void *here, unsigned int fd,
+                  size_t sx, size_t sxy, unsigned int valLen,
+                  const unsigned int bmin[3], const unsigned int bmax[3]);
+                              /* fills iv3 (all of it, or the box from bmin
+                                 to bmax) when the neighborhood is inside
+                                 the volume, specialized for nin->type and
+                                 kind->valLen; set by gageUpdate() */
+  void (*iv3FillF)(float *iv3f, const void *here, unsigned int fd,
+                   size_t sx, size_t sxy, unsigned int valLen,
+                   const unsigned int bmin[3], const unsigned int bmax[3]);
+                              /* same as iv3Fill, but for iv3f */
+  void *brickData;            /* set by gageUpdate(): if non-NULL, a copy of
+                                 nin->data, made according to parm.brick,
+                                 in which each brick of samples is
+                                 contiguous, with the bricks and the
+                                 samples within a brick in raster order.
+                                 gageIv3Fill() reads from this instead of
+                                 nin->data */
+  const void *brickSrc;       /* the nin->data that brickData was copied
+                                 from, to know when to copy again */
+  unsigned int brickShift[3], /* log2 of the brick size along each axis */
+    brickNum[3];              /* number of bricks along each axis */
   double *answer;             /* main buffer to hold all the answers */
   double **directAnswer;      /* array of pointers into answer */
   void *data;                 /* extra data, parameters, buffers, etc.
@@ -818,6 +939,26 @@ typedef struct gagePerVolume_t {
                                  was put into kind->data */
 } gagePerVolume;
 
+/*
+******** gageProbeState struct
+**
+** the per-thread state needed for probing a context that is otherwise
+** shared (read-only) between threads; created by gageProbeStateNew().
+** "ctx" is a private shallow copy of the shared context, in which only
+** the things that change with probing (the filter sample locations and
+** weights, the last probe location, the error description, and the
+** pervolumes' value caches, answers, and kind-specific data) are owned
+** by the probe state; everything else (kernels, shape, volumes and their
+** bricked copies, queries, offsets) points into the shared context.  So,
+** gageProbe(), gageProbeSpace(), gageAnswerPointer(), etc. can all be used
+** on state->ctx and state->ctx->pvl[], but the shared context must not be
+** modified (or gageUpdate()d, or nixed) while the probe state exists.
+*/
+typedef struct {
+  const gageContext *parent;  /* the shared context */
+  gageContext *ctx;           /* private shallow copy of parent */
+} gageProbeState;
+
 /*
 ******** gageKind struct
 **
@@ -946,6 +1087,14 @@ typedef struct {
                             doing spatial as opposed to frequency-space
                             blurring), the diffusion is done iteratively, with
                             steps in diffusion time of goodSigmaMax^2 */
+  unsigned int threadNum; /* how many threads to use for spatial-domain
+                            one-shot blurring, with each thread computing
+                            whole blur levels; 0 means use
+                            nrrdStateThreadNum. Iterative diffusion (in
+                            which each level continues from the previous
+                            one) is always done by one thread. The results
+                            are the same for any number of threads, so this
+                            isn't part of gageStackBlurParmCompare */
 } gageStackBlurParm;
 
 /*
@@ -998,6 +1147,13 @@ typedef struct {
     allMeasr;              /* how to summarize errors across all scales */
   double convEps;          /* convergence threshold */
 
+  /* this can be set any time before gageOptimSigCalculate */
+  unsigned int threadNum;  /* how many threads to use for measuring the
+                              errors at the trueImgNum scales, with each
+                              thread measuring whole scales; 0 means use
+                              nrrdStateThreadNum. The results are the same
+                              for any number of threads */
+
   /* INTERNAL ------------------------- */
   /* NOTE: all internal computations are parameterized by a tau-like
      quantity termed rho, rather than sigma */
@@ -1028,6 +1184,19 @@ typedef struct {
     *sampleTmp,            /* buffer for sample location info */
     *sampleErrMax,         /* for tracking per-sample-pair errors in Linf */
     *step;                 /* per-point stepsize for gradient descent */
+  double *trueKern;        /* trueImgNum x sx: the 1-D kernels giving the
+                              correct blurring at each of the trueImgNum
+                              scales; these don't change during the
+                              optimization, so they're computed once */
+  unsigned int errSupport; /* support (in samples) of the kernel used to
+                              reconstruct along scale */
+  int *errKnown;           /* per true scale: nerr holds its current error */
+  unsigned int *errRange;  /* 2 x trueImgNum: per true scale, the lowest and
+                              highest samples that can affect its error */
+  double *errRho;          /* trueImgNum x sampleNumMax: per true scale, the
+                              sampleRho of errRange samples when its error
+                              was measured; the error isn't re-measured
+                              unless one of these has changed */
 
   /* OUTPUT ------------------------- */
   double finalErr;         /* error of converged points */
@@ -1050,6 +1219,11 @@ GAGE_EXPORT double gageDefStackNormalizeDerivBias;
 GAGE_EXPORT int gageDefOrientationFromSpacing;
 GAGE_EXPORT int gageDefGenerateErrStr;
 GAGE_EXPORT int gageDefTwoDimZeroZ;
+GAGE_EXPORT int gageDefIv3Shift;
+GAGE_EXPORT int gageDefSinglePrecision;
+GAGE_EXPORT unsigned int gageDefBrick;
+GAGE_EXPORT int gageDefStats;
+GAGE_EXPORT int gageDefMultiScl;
 
 /* miscGage.c */
 GAGE_EXPORT const int gagePresent;
@@ -1130,6 +1304,7 @@ GAGE_EXPORT gagePerVolume *gagePerVolumeNew(gageContext *ctx,
                                             const Nrrd *nin,
                                             const gageKind *kind);
 GAGE_EXPORT gagePerVolume *gagePerVolumeNix(gagePerVolume *pvl);
+GAGE_EXPORT int gagePerVolumeDataChanged(gagePerVolume *pvl);
 GAGE_EXPORT const double *gageAnswerPointer(const gageContext *ctx,
                                             const gagePerVolume *pvl,
                                             int item);
@@ -1240,6 +1415,8 @@ GAGE_EXPORT int gageStackBlurParmVerboseSet(gageStackBlurParm *sbp,
                                             int verbose);
 GAGE_EXPORT int gageStackBlurParmOneDimSet(gageStackBlurParm *sbp,
                                            int oneDim);
+GAGE_EXPORT int gageStackBlurParmThreadNumSet(gageStackBlurParm *sbp,
+                                              unsigned int threadNum);
 GAGE_EXPORT int gageStackBlurParmCheck(const gageStackBlurParm *sbp);
 GAGE_EXPORT int gageStackBlurParmParse(gageStackBlurParm *sbp,
                                        int extraFlags[256],
@@ -1264,6 +1441,15 @@ GAGE_EXPORT int gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
                                     const char *format,
                                     int saveIfComputed, NrrdEncoding *enc,
                                     const Nrrd *nin, const gageKind *kind);
+GAGE_EXPORT int gageStackBlurCacheFormat(char format[AIR_STRLEN_HUGE],
+                                         const char *cacheDir,
+                                         const gageStackBlurParm *sbp,
+                                         const Nrrd *nin,
+                                         const gageKind *kind);
+GAGE_EXPORT int gageStackBlurCache(Nrrd ***nblurP, int *recomputedP,
+                                   gageStackBlurParm *sbp,
+                                   const char *cacheDir,
+                                   const Nrrd *nin, const gageKind *kind);
 
 /* ctx.c */
 GAGE_EXPORT gageContext *gageContextNew(void);
@@ -1281,6 +1467,26 @@ GAGE_EXPORT int gageProbe(gageContext *ctx, double xi, double yi, double zi);
 GAGE_EXPORT int gageProbeSpace(gageContext *ctx, double x, double y, double z,
                                int indexSpace, int clamp);
 
+/* stats.c */
+GAGE_EXPORT void gageContextStatsReset(gageContext *ctx);
+GAGE_EXPORT void gageContextStatsAdd(gageContext *ctx,
+                                     const gageContext *from);
+GAGE_EXPORT void gageContextStatsPrint(FILE *file, const gageContext *ctx);
+
+/* state.c */
+GAGE_EXPORT gageProbeState *gageProbeStateNew(const gageContext *ctx);
+GAGE_EXPORT gageProbeState *gageProbeStateNix(gageProbeState *gps);
+GAGE_EXPORT int gageProbeWith(gageProbeState *gps,
+                              double xi, double yi, double zi);
+
+/* batch.c */
+GAGE_EXPORT int gageProbeBatch(gageContext *ctx, double *out, size_t outStride,
+                               const gagePerVolume *const *pvl,
+                               const int *item, unsigned int itemNum,
+                               const double *pos, size_t posStride,
+                               size_t num, int indexSpace, int clamp,
+                               size_t *errIdx);
+
 /* update.c */
 GAGE_EXPORT int gageUpdate(gageContext *ctx);
 
@@ -0,0 +1,323 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "gage.h"
+#include "privateGage.h"
+
+/*
+** The functions here fill the iv3 cache from a neighborhood that lies
+** entirely inside the volume (the common case in gageIv3Fill), with one
+** version for each combination of volume type and value length of 1, 3,
+** 7, or anything else.  Instead of calling pvl->lup() (through a function
+** pointer, with a type switch inside) for each of the fd^3*valLen samples
+** at ctx->off[] offsets, each version walks the fd*fd contiguous runs of
+** fd samples along the fastest spatial axis, so that the innermost loop
+** is a plain strided copy with a conversion to double, which compilers
+** can unroll and vectorize.  The tuple axis is still shifted from fastest
+** (in the volume) to slowest (in iv3).  The values are the same as those
+** from pvl->lup(), since that is also just a cast to double.
+*/
+
+/* same trick as nrrd/accessors.c: one token for the type and name */
+typedef signed char CH;
+typedef unsigned char UC;
+typedef signed short SH;
+typedef unsigned short US;
+typedef signed int JN;
+typedef unsigned int UI;
+typedef airLLong LL;
+#if _MSC_VER < 1300
+typedef airLLong UL;
+#else
+typedef airULLong UL;
+#endif
+typedef float FL;
+typedef double DB;
+
+#define MAP(F, A) \
+F(A, CH) \
+F(A, UC) \
+F(A, SH) \
+F(A, US) \
+F(A, JN) \
+F(A, UI) \
+F(A, LL) \
+F(A, UL) \
+F(A, FL) \
+F(A, DB)
+
+/*
+** _gageIv3Fill<OT><VN><TT>: fills the part of iv3 (of fd^3 samples, of
+** type OT) from bmin[] to bmax[] (inclusive, per axis), which is the
+** whole thing for gageIv3Fill, or a single plane for _gageIv3Shift, or
+** the part of either in one brick (see _gageIv3FillBox).  "here" points
+** to the first value of the sample that goes in iv3 at bmin[], sx and
+** sxy are the number of samples per scanline and per slice (of the
+** volume, or of the brick), and VL (either a constant or the valLen
+** argument) is the value length
+*/
+#define IV3_FILL_DEF(OT, VN, VL, TT)                                    \
+static void                                                             \
+_gageIv3Fill##OT##VN##TT(OT *iv3, const void *_here, unsigned int fd,   \
+                         size_t sx, size_t sxy, unsigned int valLen,    \
+                         const unsigned int bmin[3],                    \
+                         const unsigned int bmax[3]) {                  \
+  const TT *here, *row;                                                 \
+  unsigned int xi, yi, zi, vi, fddd;                                    \
+  OT *line;                                                             \
+                                                                        \
+  AIR_UNUSED(valLen);                                                   \
+  here = AIR_CAST(const TT *, _here);                                   \
+  fddd = fd*fd*fd;                                                      \
+  for (zi=bmin[2]; zi<=bmax[2]; zi++) {                                 \
+    for (yi=bmin[1]; yi<=bmax[1]; yi++) {                               \
+      row = here + (VL)*(sx*(yi - bmin[1]) + sxy*(zi - bmin[2]));       \
+      line = iv3 + fd*(yi + fd*zi) + bmin[0];                           \
+      for (vi=0; vi<(VL); vi++) {                                       \
+        for (xi=0; xi<=bmax[0]-bmin[0]; xi++) {                         \
+          line[xi + fddd*vi] = AIR_CAST(OT, row[vi + (VL)*xi]);         \
+        }                                                               \
+      }                                                                 \
+    }                                                                   \
+  }                                                                     \
+}
+
+#define IV3_FILL_DEF_1(OT, TT) IV3_FILL_DEF(OT, 1, 1, TT)
+#define IV3_FILL_DEF_3(OT, TT) IV3_FILL_DEF(OT, 3, 3, TT)
+#define IV3_FILL_DEF_7(OT, TT) IV3_FILL_DEF(OT, 7, 7, TT)
+#define IV3_FILL_DEF_N(OT, TT) IV3_FILL_DEF(OT, N, valLen, TT)
+
+MAP(IV3_FILL_DEF_1, DB)
+MAP(IV3_FILL_DEF_3, DB)
+MAP(IV3_FILL_DEF_7, DB)
+MAP(IV3_FILL_DEF_N, DB)
+MAP(IV3_FILL_DEF_1, FL)
+MAP(IV3_FILL_DEF_3, FL)
+MAP(IV3_FILL_DEF_7, FL)
+MAP(IV3_FILL_DEF_N, FL)
+
+#define IV3_FILL_LIST_DB(VN, TT) _gageIv3FillDB##VN##TT,
+#define IV3_FILL_LIST_FL(VN, TT) _gageIv3FillFL##VN##TT,
+
+static void (*
+_gageIv3FillTable[4][NRRD_TYPE_MAX+1])(double *, const void *, unsigned int,
+                                       size_t, size_t, unsigned int,
+                                       const unsigned int *,
+                                       const unsigned int *) = {
+  {NULL, MAP(IV3_FILL_LIST_DB, 1) NULL},
+  {NULL, MAP(IV3_FILL_LIST_DB, 3) NULL},
+  {NULL, MAP(IV3_FILL_LIST_DB, 7) NULL},
+  {NULL, MAP(IV3_FILL_LIST_DB, N) NULL}
+};
+
+static void (*
+_gageIv3FillFTable[4][NRRD_TYPE_MAX+1])(float *, const void *, unsigned int,
+                                        size_t, size_t, unsigned int,
+                                        const unsigned int *,
+                                        const unsigned int *) = {
+  {NULL, MAP(IV3_FILL_LIST_FL, 1) NULL},
+  {NULL, MAP(IV3_FILL_LIST_FL, 3) NULL},
+  {NULL, MAP(IV3_FILL_LIST_FL, 7) NULL},
+  {NULL, MAP(IV3_FILL_LIST_FL, N) NULL}
+};
+
+/*
+** _gageIv3FillSelect
+**
+** sets pvl->iv3Fill and pvl->iv3FillF according to the type of pvl->nin
+** and the valLen of pvl->kind; these are NULL for block types, in which
+** case gageIv3Fill falls back on pvl->lup()
+*/
+void
+_gageIv3FillSelect(gagePerVolume *pvl) {
+  unsigned int vi;
+
+  switch (pvl->kind->valLen) {
+  case 1: vi = 0; break;
+  case 3: vi = 1; break;
+  case 7: vi = 2; break;
+  default: vi = 3; break;
+  }
+  if (airEnumValCheck(nrrdType, pvl->nin->type)) {
+    pvl->iv3Fill = NULL;
+    pvl->iv3FillF = NULL;
+  } else {
+    pvl->iv3Fill = _gageIv3FillTable[vi][pvl->nin->type];
+    pvl->iv3FillF = _gageIv3FillFTable[vi][pvl->nin->type];
+  }
+  return;
+}
+
+/*
+** _gageIv3FillBox
+**
+** fills the box from bmin to bmax (inclusive, per axis) of pvl's iv3
+** cache (or iv3f when singlePrecision), where iv3 sample (0,0,0) is
+** volume sample lo[], and all the samples are inside the volume.  Uses
+** pvl->iv3Fill (or pvl->iv3FillF), so the caller has to make sure those
+** are available.  When the volume has been bricked (see brick.c), the
+** box is split at brick boundaries, and each piece is copied from its
+** brick, within which the scanlines are contiguous.
+*/
+void
+_gageIv3FillBox(const gageContext *ctx, gagePerVolume *pvl,
+                const unsigned int lo[3],
+                const unsigned int bmin[3], const unsigned int bmax[3]) {
+  unsigned int pmin[3], pmax[3], mask[3], fd, ai;
+  size_t elSize, sx, sxy, dataIdx;
+  const char *here;
+
+  fd = 2*ctx->radius;
+  elSize = pvl->kind->valLen*nrrdTypeSize[pvl->nin->type];
+  if (!pvl->brickData) {
+    sx = ctx->shape->size[0];
+    sxy = sx*ctx->shape->size[1];
+    dataIdx = ((lo[0] + bmin[0])
+               + sx*(lo[1] + bmin[1])
+               + sxy*(lo[2] + bmin[2]));
+    here = AIR_CAST(const char *, pvl->nin->data) + dataIdx*elSize;
+    if (pvl->singlePrecision) {
+      pvl->iv3FillF(pvl->iv3f, here, fd, sx, sxy,
+                    pvl->kind->valLen, bmin, bmax);
+    } else {
+      pvl->iv3Fill(pvl->iv3, here, fd, sx, sxy,
+                   pvl->kind->valLen, bmin, bmax);
+    }
+    return;
+  }
+  for (ai=0; ai<3; ai++) {
+    mask[ai] = (1u << pvl->brickShift[ai]) - 1;
+  }
+  sx = AIR_CAST(size_t, 1) << pvl->brickShift[0];
+  sxy = sx << pvl->brickShift[1];
+  /* the pieces along each axis end at the last sample of a brick */
+  for (pmin[2]=bmin[2]; pmin[2]<=bmax[2]; pmin[2]=pmax[2]+1) {
+    pmax[2] = AIR_MIN(bmax[2], ((lo[2] + pmin[2]) | mask[2]) - lo[2]);
+    for (pmin[1]=bmin[1]; pmin[1]<=bmax[1]; pmin[1]=pmax[1]+1) {
+      pmax[1] = AIR_MIN(bmax[1], ((lo[1] + pmin[1]) | mask[1]) - lo[1]);
+      for (pmin[0]=bmin[0]; pmin[0]<=bmax[0]; pmin[0]=pmax[0]+1) {
+        pmax[0] = AIR_MIN(bmax[0], ((lo[0] + pmin[0]) | mask[0]) - lo[0]);
+        dataIdx = _gageBrickIndex(pvl, lo[0] + pmin[0], lo[1] + pmin[1],
+                                  lo[2] + pmin[2]);
+        here = AIR_CAST(const char *, pvl->brickData) + dataIdx*elSize;
+        if (pvl->singlePrecision) {
+          pvl->iv3FillF(pvl->iv3f, here, fd, sx, sxy,
+                        pvl->kind->valLen, pmin, pmax);
+        } else {
+          pvl->iv3Fill(pvl->iv3, here, fd, sx, sxy,
+                       pvl->kind->valLen, pmin, pmax);
+        }
+      }
+    }
+  }
+  return;
+}
+
+/*
+** _gageIv3Shift
+**
+** updates pvl->iv3 after the neighborhood (based on ctx->point.idx) has
+** moved by one sample along "axis", in direction "dir" (+1 or -1), and
+** when the new neighborhood is entirely inside the volume (as checked
+** by the caller).  The (fd-1) planes shared with the old neighborhood
+** are shifted over, and only the new plane is read from the volume.
+** Because the shared planes are inside the volume, their values are the
+** same as gageIv3Fill would have computed, even if the old neighborhood
+** had been filled with clamping.
+*/
+void
+_gageIv3Shift(gageContext *ctx, gagePerVolume *pvl,
+              unsigned int axis, int dir) {
+  unsigned int fr, fd, fddd, stride, blockNum, bi, ii, lo[3], li, hi,
+    hiNum, plane, ci, vi, valLen, bmin[3], bmax[3];
+  size_t sx, sxy, dataIdx;
+  const char *here;
+  double *iv3, *block;
+  float *iv3f, *blockf;
+
+  fr = ctx->radius;
+  fd = 2*fr;
+  fddd = fd*fd*fd;
+  valLen = pvl->kind->valLen;
+  iv3 = pvl->iv3;
+  iv3f = pvl->iv3f;
+  /* stride in iv3 between samples along axis */
+  stride = (0 == axis ? 1 : (1 == axis ? fd : fd*fd));
+  /* each block of fd*stride values holds one line (or plane) of fd
+     samples along axis; the block is moved over by one sample */
+  blockNum = fddd*valLen/(fd*stride);
+  for (bi=0; bi<blockNum; bi++) {
+    if (pvl->singlePrecision) {
+      blockf = iv3f + bi*fd*stride;
+      if (dir > 0) {
+        for (ii=0; ii<(fd-1)*stride; ii++) {
+          blockf[ii] = blockf[ii + stride];
+        }
+      } else {
+        for (ii=(fd-1)*stride; ii>0; ii--) {
+          blockf[ii - 1 + stride] = blockf[ii - 1];
+        }
+      }
+    } else {
+      block = iv3 + bi*fd*stride;
+      if (dir > 0) {
+        for (ii=0; ii<(fd-1)*stride; ii++) {
+          block[ii] = block[ii + stride];
+        }
+      } else {
+        for (ii=(fd-1)*stride; ii>0; ii--) {
+          block[ii - 1 + stride] = block[ii - 1];
+        }
+      }
+    }
+  }
+  /* fetch the new plane: lowest corner of neighborhood as in gageIv3Fill */
+  lo[0] = ctx->point.idx[0]-1 - (fr - 1);
+  lo[1] = ctx->point.idx[1]-1 - (fr - 1);
+  lo[2] = ctx->point.idx[2]-1 - (fr - 1);
+  plane = (dir > 0 ? fd-1 : 0);
+  ELL_3V_SET(bmin, 0, 0, 0);
+  ELL_3V_SET(bmax, fd-1, fd-1, fd-1);
+  bmin[axis] = bmax[axis] = plane;
+  if (pvl->singlePrecision || pvl->iv3Fill) {
+    /* singlePrecision implies iv3FillF */
+    _gageIv3FillBox(ctx, pvl, lo, bmin, bmax);
+  } else {
+    /* no specialized fill means no bricking (see brick.c) */
+    sx = ctx->shape->size[0];
+    sxy = sx*ctx->shape->size[1];
+    dataIdx = lo[0] + sx*lo[1] + sxy*lo[2];
+    here = (AIR_CAST(const char *, pvl->nin->data)
+            + dataIdx*valLen*nrrdTypeSize[pvl->nin->type]);
+    hiNum = fd*fd/stride;
+    for (hi=0; hi<hiNum; hi++) {
+      for (li=0; li<stride; li++) {
+        ci = li + stride*(plane + fd*hi);
+        for (vi=0; vi<valLen; vi++) {
+          iv3[ci + fddd*vi] = pvl->lup(here, vi + valLen*ctx->off[ci]);
+        }
+      }
+    }
+  }
+  return;
+}
@@ -123,6 +123,11 @@ gageParmReset(gageParm *parm) {
     parm->orientationFromSpacing = gageDefOrientationFromSpacing;
     parm->generateErrStr = gageDefGenerateErrStr;
     parm->twoDimZeroZ = gageDefTwoDimZeroZ;
+    parm->iv3Shift = gageDefIv3Shift;
+    parm->singlePrecision = gageDefSinglePrecision;
+    parm->brick = gageDefBrick;
+    parm->stats = gageDefStats;
+    parm->multiScl = gageDefMultiScl;
   }
   return;
 }
@@ -356,6 +356,7 @@ gageOptimSigContext *gageOptimSigContextNew(unsigned int dim,
   oscx->imgMeasr = nrrdMeasureUnknown;
   oscx->allMeasr = nrrdMeasureUnknown;
   oscx->convEps = AIR_NAN;
+  oscx->threadNum = 0;
 
   /* allocate internal buffers based on arguments */
   kparm[0] = oscx->sigmaRange[1];
@@ -447,6 +448,16 @@ gageOptimSigContext *gageOptimSigContextNew(unsigned int dim,
     biffAddf(GAGE, "%s: couldn't allocate per-sample arrays", me);
     return NULL;
   }
+  oscx->trueKern = AIR_CALLOC(oscx->trueImgNum*oscx->sx, double);
+  oscx->errSupport = 0;
+  oscx->errKnown = AIR_CALLOC(oscx->trueImgNum, int);
+  oscx->errRange = AIR_CALLOC(2*oscx->trueImgNum, unsigned int);
+  oscx->errRho = AIR_CALLOC(oscx->trueImgNum*oscx->sampleNumMax, double);
+  if (!(oscx->trueKern && oscx->errKnown
+        && oscx->errRange && oscx->errRho)) {
+    biffAddf(GAGE, "%s: couldn't allocate per-true-scale arrays", me);
+    return NULL;
+  }
   for (ii=0; ii<oscx->sampleNumMax; ii++) {
     oscx->nsampleImg[ii] = nrrdNew();
     if (nrrdMaybeAlloc_va(oscx->nsampleImg[ii], nrrdTypeDouble, 3,
@@ -481,7 +492,7 @@ gageOptimSigContextNix(gageOptimSigContext *oscx) {
     airFree(oscx->ktmp1);
     airFree(oscx->ktmp2);
     gageContextNix(oscx->gctx);
-    /* airFree(oscx->pvlSS); needed? */
+    airFree(oscx->pvlSS);
     for (si=0; si<oscx->sampleNumMax; si++) {
       nrrdNuke(oscx->nsampleImg[si]);
     }
@@ -491,42 +502,50 @@ gageOptimSigContextNix(gageOptimSigContext *oscx) {
     airFree(oscx->sampleTmp);
     airFree(oscx->sampleErrMax);
     airFree(oscx->step);
+    airFree(oscx->trueKern);
+    airFree(oscx->errKnown);
+    airFree(oscx->errRange);
+    airFree(oscx->errRho);
     /* nrrdNuke(oscx->nsampleHist); */
     airFree(oscx);
   }
   return NULL;
 }
 
+/*
+** reconstructs, with gctx (the context or a probe state of it), the
+** scale rho.  Does not use biff, so that it can be called by multiple
+** threads; a probe error is described in err[]
+*/
 static int
-_volInterp(Nrrd *ninterp, double rho, gageOptimSigContext *oscx) {
+_volInterp(double *interp, char err[AIR_STRLEN_LARGE],
+           gageContext *gctx, const double *answer,
+           gageOptimSigContext *oscx, double rho) {
   static const char me[]="_volInterp";
-  double *interp, scaleIdx, sigma;
-  const double *answer;
+  double scaleIdx, sigma;
   unsigned int xi, yi, zi;
   int outside;
 
   /*
   debugging = rho > 1.197;
-  gageParmSet(oscx->gctx, gageParmVerbose, 2*debugging);
+  gageParmSet(gctx, gageParmVerbose, 2*debugging);
   */
   sigma = _SigOfRho(rho);
-  scaleIdx = gageStackWtoI(oscx->gctx, sigma, &outside);
+  scaleIdx = gageStackWtoI(gctx, sigma, &outside);
   /* Because of limited numerical precision, _SigOfRho(rhoRange[1])
      can end up "outside" stack, which should really be a bug.
      However, since the use of gage is pretty straight-forward here,
      we're okay with ignoring the "outside" here, and also clamping
      the probe below */
-  answer = gageAnswerPointer(oscx->gctx, oscx->pvlBase, gageSclValue);
-  interp = AIR_CAST(double *, ninterp->data);
   for (zi=0; zi<oscx->sz; zi++) {
     for (yi=0; yi<oscx->sy; yi++) {
       for (xi=0; xi<oscx->sx; xi++) {
-        if (gageStackProbeSpace(oscx->gctx, xi, yi, zi, scaleIdx,
+        if (gageStackProbeSpace(gctx, xi, yi, zi, scaleIdx,
                                 AIR_TRUE /* index space */,
                                 AIR_TRUE /* clamping */)) {
-          biffAddf(GAGE, "%s: probe error at (%u,%u,%u,%.17g): %s (%d)", me,
-                   xi, yi, zi, scaleIdx,
-                   oscx->gctx->errStr, oscx->gctx->errNum);
+          sprintf(err, "%s: probe error at (%u,%u,%u,%.17g): %.*s (%d)", me,
+                  xi, yi, zi, scaleIdx, AIR_STRLEN_MED, gctx->errStr,
+                  gctx->errNum);
           return 1;
         }
         interp[xi + oscx->sx*(yi + oscx->sy*zi)] = answer[0];
@@ -534,14 +553,7 @@ _volInterp(Nrrd *ninterp, double rho, gageOptimSigContext *oscx) {
     }
   }
   /*
-  gageParmSet(oscx->gctx, gageParmVerbose, 0);
-  */
-  /*
-  if (debugging) {
-    char fname[AIR_STRLEN_SMALL];
-    sprintf(fname, "interp-%04u.nrrd", debugii);
-    nrrdSave(fname, ninterp, NULL);
-  }
+  gageParmSet(gctx, gageParmVerbose, 0);
   */
   return 0;
 }
@@ -632,15 +644,20 @@ _sampleSet(gageOptimSigContext *oscx, unsigned int si, double rho) {
   return;
 }
 
+/*
+** measures the error of reconstructing scale rho (with gctx, into
+** interp), relative to the correct blurring given by kernels kz, ky,
+** kx.  Like _volInterp, doesn't use biff
+*/
 static int
-_errSingle(double *retP, gageOptimSigContext *oscx, double rho) {
-  static const char me[]="_errSingle";
-  double *diff, *kx, *ky, *kz;
-  const double *interp;
+_errSingle(double *retP, char err[AIR_STRLEN_LARGE],
+           gageContext *gctx, const double *answer,
+           double *interp, double *diff,
+           const double *kz, const double *ky, const double *kx,
+           gageOptimSigContext *oscx, double rho) {
   unsigned int ii, xi, yi, zi;
 
-  if (_volInterp(oscx->ninterp, rho, oscx)) {
-    biffAddf(GAGE, "%s: trouble at rho %.17g\n", me, rho);
+  if (_volInterp(interp, err, gctx, answer, oscx, rho)) {
     return 1;
   }
   /*
@@ -650,9 +667,6 @@ _errSingle(double *retP, gageOptimSigContext *oscx, double rho) {
     nrrdSave(fname, oscx->ninterp, NULL);
   }
   */
-  interp = AIR_CAST(const double *, oscx->ninterp->data);
-  diff = AIR_CAST(double *, oscx->ndiff->data);
-  _kernset(&kz, &ky, &kx, oscx, rho);
   ii = 0;
   for (zi=0; zi<oscx->sz; zi++) {
     for (yi=0; yi<oscx->sy; yi++) {
@@ -676,21 +690,268 @@ _errSingle(double *retP, gageOptimSigContext *oscx, double rho) {
   return 0;
 }
 
+/*
+** _errSingle for any rho, with the context itself
+*/
+static int
+_errSingleRho(double *retP, gageOptimSigContext *oscx, double rho) {
+  static const char me[]="_errSingleRho";
+  char err[AIR_STRLEN_LARGE];
+  double *kx, *ky, *kz;
+
+  _kernset(&kz, &ky, &kx, oscx, rho);
+  if (_errSingle(retP, err, oscx->gctx,
+                 gageAnswerPointer(oscx->gctx, oscx->pvlBase, gageSclValue),
+                 AIR_CAST(double *, oscx->ninterp->data),
+                 AIR_CAST(double *, oscx->ndiff->data),
+                 kz, ky, kx, oscx, rho)) {
+    biffAddf(GAGE, "%s: trouble at rho %.17g: %s", me, rho, err);
+    return 1;
+  }
+  return 0;
+}
+
+/*
+** the samples that can affect the error at scale rho: the two
+** samples around it, and the others within the support of the
+** kernel used to reconstruct along scale
+*/
+static void
+_errReach(unsigned int range[2], gageOptimSigContext *oscx, double rho) {
+  double sidx;
+  unsigned int bi, sn;
+  int outside;
+
+  sn = oscx->sampleNum;
+  sidx = gageStackWtoI(oscx->gctx, _SigOfRho(rho), &outside);
+  if (!AIR_EXISTS(sidx)) {
+    /* (search failure) could be affected by anything */
+    range[0] = 0;
+    range[1] = sn-1;
+    return;
+  }
+  sidx = AIR_CLAMP(0, floor(sidx), sn-2);
+  bi = AIR_CAST(unsigned int, sidx);
+  range[0] = bi + 1 > oscx->errSupport ? bi + 1 - oscx->errSupport : 0;
+  range[1] = AIR_MIN(sn-1, bi + oscx->errSupport);
+  return;
+}
+
+/*
+** what is shared by the threads of _errMeasure; the true scales to
+** measure are handed out one at a time (under the mutex)
+*/
+typedef struct {
+  gageOptimSigContext *oscx;
+  const unsigned int *todo;  /* indices of true scales to measure */
+  unsigned int todoNum,      /* length of todo */
+    todoNext,                /* first todo not yet handed out */
+    errIdx;                  /* lowest true scale index that had an error,
+                                or UINT_MAX if there was no error */
+  char errStr[AIR_STRLEN_LARGE];
+  airThreadMutex *mutex;     /* NULL if only one thread */
+} _errTask;
+
+/* what one thread has to itself */
+typedef struct {
+  _errTask *task;
+  gageContext *gctx;         /* the context, or the probe state's */
+  const double *answer;
+  double *interp, *diff;
+  char err[AIR_STRLEN_LARGE];
+} _errThread;
+
+static void *
+_errWorker(void *_eth) {
+  _errThread *eth;
+  _errTask *task;
+  gageOptimSigContext *oscx;
+  const double *kern, *kz, *ky;
+  double *err, rho;
+  unsigned int ti, ii;
+
+  eth = AIR_CAST(_errThread *, _eth);
+  task = eth->task;
+  oscx = task->oscx;
+  err = AIR_CAST(double *, oscx->nerr->data);
+  for (;;) {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    ti = (UINT_MAX == task->errIdx
+          ? task->todoNext
+          : task->todoNum);
+    task->todoNext = AIR_MIN(task->todoNum, ti + 1);
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (ti >= task->todoNum) {
+      break;
+    }
+    ii = task->todo[ti];
+    kern = oscx->trueKern + oscx->sx*ii;
+    kz = oscx->dim >= 3 ? kern : oscx->kone;
+    ky = oscx->dim >= 2 ? kern : oscx->kone;
+    rho = AIR_AFFINE(0, ii, oscx->trueImgNum-1,
+                     oscx->rhoRange[0], oscx->rhoRange[1]);
+    if (_errSingle(err + ii, eth->err, eth->gctx, eth->answer,
+                   eth->interp, eth->diff, kz, ky, kern, oscx, rho)) {
+      if (task->mutex) {
+        airThreadMutexLock(task->mutex);
+      }
+      if (ii < task->errIdx) {
+        task->errIdx = ii;
+        strcpy(task->errStr, eth->err);
+      }
+      if (task->mutex) {
+        airThreadMutexUnlock(task->mutex);
+      }
+    }
+  }
+  return _eth;
+}
+
+/*
+** measures the errors at the given true scales with threadNum threads
+** (including the calling one), each with its own gageProbeState of the
+** context
+*/
+static int
+_errMeasure(gageOptimSigContext *oscx, const unsigned int *todo,
+            unsigned int todoNum, unsigned int threadNum) {
+  static const char me[]="_errMeasure";
+  _errTask task;
+  _errThread *eth;
+  gageProbeState **gps;
+  unsigned int ti, pvlIdx, len;
+  airArray *mop;
+
+  mop = airMopNew();
+  eth = AIR_CALLOC(threadNum, _errThread);
+  airMopAdd(mop, eth, airFree, airMopAlways);
+  gps = AIR_CALLOC(threadNum, gageProbeState *);
+  airMopAdd(mop, gps, airFree, airMopAlways);
+  if (!( eth && gps )) {
+    biffAddf(GAGE, "%s: couldn't allocate thread state", me);
+    airMopError(mop); return 1;
+  }
+  for (pvlIdx=0; pvlIdx<oscx->gctx->pvlNum; pvlIdx++) {
+    if (oscx->pvlBase == oscx->gctx->pvl[pvlIdx]) {
+      break;
+    }
+  }
+  len = oscx->sx*oscx->sy*oscx->sz;
+  for (ti=0; ti<threadNum; ti++) {
+    eth[ti].task = &task;
+    if (ti) {
+      if (!(gps[ti] = gageProbeStateNew(oscx->gctx))) {
+        biffAddf(GAGE, "%s: couldn't make probe state %u", me, ti);
+        airMopError(mop); return 1;
+      }
+      airMopAdd(mop, gps[ti], (airMopper)gageProbeStateNix, airMopAlways);
+      eth[ti].gctx = gps[ti]->ctx;
+      eth[ti].interp = AIR_CALLOC(len, double);
+      airMopAdd(mop, eth[ti].interp, airFree, airMopAlways);
+      eth[ti].diff = AIR_CALLOC(len, double);
+      airMopAdd(mop, eth[ti].diff, airFree, airMopAlways);
+      if (!( eth[ti].interp && eth[ti].diff )) {
+        biffAddf(GAGE, "%s: couldn't allocate buffers %u", me, ti);
+        airMopError(mop); return 1;
+      }
+    } else {
+      eth[ti].gctx = oscx->gctx;
+      eth[ti].interp = AIR_CAST(double *, oscx->ninterp->data);
+      eth[ti].diff = AIR_CAST(double *, oscx->ndiff->data);
+    }
+    eth[ti].answer = gageAnswerPointer(eth[ti].gctx,
+                                       eth[ti].gctx->pvl[pvlIdx],
+                                       gageSclValue);
+  }
+  task.oscx = oscx;
+  task.todo = todo;
+  task.todoNum = todoNum;
+  task.todoNext = 0;
+  task.errIdx = UINT_MAX;
+  if (airThreadRun(threadNum, _errWorker, eth, sizeof(_errThread),
+                   &(task.mutex))) {
+    biffAddf(GAGE, "%s: couldn't start threads", me);
+    airMopError(mop); return 1;
+  }
+  if (UINT_MAX != task.errIdx) {
+    biffAddf(GAGE, "%s: trouble at ii %u: %s", me, task.errIdx, task.errStr);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+** sets nerr[ii] to the error at true scale ii, for ii in [0,num).  An
+** error isn't re-measured if none of the samples that can affect it
+** (as given by _errReach) have moved since it was last measured
+*/
+static int
+_errAll(gageOptimSigContext *oscx, unsigned int num) {
+  static const char me[]="_errAll";
+  unsigned int ii, si, *todo, todoNum, range[2], *erng, threadNum;
+  double *erho;
+  int known;
+
+  todo = AIR_CALLOC(num, unsigned int);
+  if (!todo) {
+    biffAddf(GAGE, "%s: couldn't allocate todo list", me);
+    return 1;
+  }
+  todoNum = 0;
+  for (ii=0; ii<num; ii++) {
+    _errReach(range, oscx, AIR_AFFINE(0, ii, oscx->trueImgNum-1,
+                                      oscx->rhoRange[0],
+                                      oscx->rhoRange[1]));
+    erng = oscx->errRange + 2*ii;
+    erho = oscx->errRho + oscx->sampleNumMax*ii;
+    /* with the TEEM_OPTSIG_RECONERR hack, everything has to be
+       measured, in order */
+    known = (!debugReconErrArr
+             && oscx->errKnown[ii]
+             && range[0] == erng[0]
+             && range[1] == erng[1]);
+    for (si=range[0]; known && si<=range[1]; si++) {
+      known = (erho[si] == oscx->sampleRho[si]);
+    }
+    if (!known) {
+      oscx->errKnown[ii] = AIR_FALSE;
+      erng[0] = range[0];
+      erng[1] = range[1];
+      for (si=range[0]; si<=range[1]; si++) {
+        erho[si] = oscx->sampleRho[si];
+      }
+      todo[todoNum++] = ii;
+    }
+  }
+  threadNum = oscx->threadNum ? oscx->threadNum : nrrdStateThreadNum;
+  threadNum = (airThreadCapable && !debugReconErrArr
+               ? AIR_MAX(1, AIR_MIN(threadNum, todoNum))
+               : 1);
+  if (todoNum && _errMeasure(oscx, todo, todoNum, threadNum)) {
+    biffAddf(GAGE, "%s: trouble measuring %u errors", me, todoNum);
+    airFree(todo); return 1;
+  }
+  for (ii=0; ii<todoNum; ii++) {
+    oscx->errKnown[todo[ii]] = AIR_TRUE;
+  }
+  airFree(todo);
+  return 0;
+}
+
 static int
 _errTotal(double *retP, gageOptimSigContext *oscx) {
   static const char me[]="_errTotal";
-  unsigned int ii;
   double *err;
 
   err = AIR_CAST(double *, oscx->nerr->data);
-  for (ii=0; ii<oscx->trueImgNum; ii++) {
-    /* debugii = ii; */
-    if (_errSingle(err + ii, oscx, AIR_AFFINE(0, ii, oscx->trueImgNum-1,
-                                              oscx->rhoRange[0],
-                                              oscx->rhoRange[1]))) {
-      biffAddf(GAGE, "%s: trouble at ii %u", me, ii);
-      return 1;
-    }
+  if (_errAll(oscx, oscx->trueImgNum)) {
+    biffAddf(GAGE, "%s: trouble", me);
+    return 1;
   }
   nrrdMeasureLine[oscx->allMeasr](retP, nrrdTypeDouble,
                                   err, nrrdTypeDouble,
@@ -732,13 +993,12 @@ _errTotalLinf(double *retP, gageOptimSigContext *oscx,
   }
   /* NOTE: we don't bother with last "true image": it will always be a
      low error, and not meaningfully associated with a gap */
+  if (_errAll(oscx, oscx->trueImgNum-1)) {
+    biffAddf(GAGE, "%s: trouble", me);
+    return 1;
+  }
   for (ii=0; ii<oscx->trueImgNum-1; ii++) {
-    /* debugii = ii; */
     rho = AIR_AFFINE(0, ii, oscx->trueImgNum-1, rr[0], rr[1]);
-    if (_errSingle(err + ii, oscx, rho)) {
-      biffAddf(GAGE, "%s: trouble at ii %u", me, ii);
-      return 1;
-    }
     sig = _SigOfRho(rho);
     pid = gageStackWtoI(oscx->gctx, sig, &outside);
     pi = AIR_CAST(unsigned int, pid);
@@ -781,6 +1041,7 @@ static int
 _gageSetup(gageOptimSigContext *oscx) {
   static const char me[]="_gageSetup";
   double kparm[NRRD_KERNEL_PARMS_NUM];
+  unsigned int ii;
   int E;
 
   if (oscx->gctx) {
@@ -814,6 +1075,19 @@ _gageSetup(gageOptimSigContext *oscx) {
     biffAddf(GAGE, "%s: problem setting up gage", me);
     return 1;
   }
+  /* the stack kernel, sample number, or imgMeasr may have changed,
+     so no errors from before are still known */
+  oscx->errSupport = AIR_UINT(ceil(oscx->kssSpec->kernel->support(
+                                        oscx->kssSpec->parm)));
+  oscx->errSupport = AIR_MAX(1, oscx->errSupport);
+  for (ii=0; ii<oscx->trueImgNum; ii++) {
+    double *kz, *ky, *kx;
+    oscx->errKnown[ii] = AIR_FALSE;
+    _kernset(&kz, &ky, &kx, oscx, AIR_AFFINE(0, ii, oscx->trueImgNum-1,
+                                             oscx->rhoRange[0],
+                                             oscx->rhoRange[1]));
+    memcpy(oscx->trueKern + oscx->sx*ii, kx, oscx->sx*sizeof(double));
+  }
   return 0;
 }
 
@@ -1141,6 +1415,9 @@ gageOptimSigCalculate(gageOptimSigContext *oscx,
     return 1;
   }
 
+  /* the context from a previous call was set up for its sampleNum,
+     and _sampleSet() would update its stackPos */
+  oscx->gctx = gageContextNix(oscx->gctx);
   /* initialize to uniform samples in rho */
   oscx->sampleNum = sigmaNum;
   fprintf(stderr, "%s: initializing %u samples ... ", me, oscx->sampleNum);
@@ -1237,7 +1514,8 @@ gageOptimSigErrorPlot(gageOptimSigContext *oscx, Nrrd *nout,
   }
   out = AIR_CAST(double *, nout->data);
 
-  /* set up requested samples */
+  /* set up requested samples (as in gageOptimSigCalculate) */
+  oscx->gctx = gageContextNix(oscx->gctx);
   for (ii=0; ii<oscx->sampleNum; ii++) {
     _sampleSet(oscx, ii, _RhoOfSig(sigma[ii]));
   }
@@ -1254,7 +1532,7 @@ gageOptimSigErrorPlot(gageOptimSigContext *oscx, Nrrd *nout,
                      oscx->rhoRange[0], oscx->rhoRange[1]);
     out[0 + 2*ii] = rho;
     /* debugii = ii; */
-    if (_errSingle(&err, oscx, rho)) {
+    if (_errSingleRho(&err, oscx, rho)) {
       biffAddf(GAGE, "%s: plotting %u", me, ii);
       return 1;
     }
@@ -1369,7 +1647,7 @@ gageOptimSigErrorPlotSliding(gageOptimSigContext *oscx, Nrrd *nout,
     /* required samples will slide along with plotting */
     _sampleSet(oscx, 0, rlo);
     _sampleSet(oscx, 1, rhi);
-    if (_errSingle(&err, oscx, rho)) {
+    if (_errSingleRho(&err, oscx, rho)) {
       biffAddf(GAGE, "%s: plotting/sliding %u", me, ii);
       return 1;
     }
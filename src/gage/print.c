@@ -24,49 +24,54 @@
 #include "gage.h"
 #include "privateGage.h"
 
+/* the offsets are size_t, but unsigned long is good enough for printing */
+#define OFF(ii) AIR_CAST(unsigned long, off[ii])
+
 void
 _gagePrint_off(FILE *file, gageContext *ctx) {
   int i, fd;
-  unsigned int *off;
+  size_t *off;
 
   fd = 2*ctx->radius;
   off = ctx->off;
   fprintf(file, "off[]:\n");
   switch(fd) {
   case 2:
-    fprintf(file, "% 6d   % 6d\n", off[6], off[7]);
-    fprintf(file, "   % 6d   % 6d\n\n", off[4], off[5]);
-    fprintf(file, "% 6d   % 6d\n", off[2], off[3]);
-    fprintf(file, "   % 6d   % 6d\n", off[0], off[1]);
+    fprintf(file, "%6lu   %6lu\n", OFF(6), OFF(7));
+    fprintf(file, "   %6lu   %6lu\n\n", OFF(4), OFF(5));
+    fprintf(file, "%6lu   %6lu\n", OFF(2), OFF(3));
+    fprintf(file, "   %6lu   %6lu\n", OFF(0), OFF(1));
     break;
   case 4:
     for (i=3; i>=0; i--) {
-      fprintf(file, "% 6d   % 6d   % 6d   % 6d\n",
-              off[12+16*i], off[13+16*i],
-              off[14+16*i], off[15+16*i]);
-      fprintf(file, "   % 6d  %c% 6d   % 6d%c   % 6d\n",
-              off[ 8+16*i], (i==1||i==2)?'\\':' ',
-              off[ 9+16*i], off[10+16*i], (i==1||i==2)?'\\':' ',
-              off[11+16*i]);
-      fprintf(file, "      % 6d  %c% 6d   % 6d%c   % 6d\n",
-              off[ 4+16*i], (i==1||i==2)?'\\':' ',
-              off[ 5+16*i], off[ 6+16*i], (i==1||i==2)?'\\':' ',
-              off[ 7+16*i]);
-      fprintf(file, "         % 6d   % 6d   % 6d   % 6d\n",
-              off[ 0+16*i], off[ 1+16*i],
-              off[ 2+16*i], off[ 3+16*i]);
+      fprintf(file, "%6lu   %6lu   %6lu   %6lu\n",
+              OFF(12+16*i), OFF(13+16*i),
+              OFF(14+16*i), OFF(15+16*i));
+      fprintf(file, "   %6lu  %c%6lu   %6lu%c   %6lu\n",
+              OFF( 8+16*i), (i==1||i==2)?'\\':' ',
+              OFF( 9+16*i), OFF(10+16*i), (i==1||i==2)?'\\':' ',
+              OFF(11+16*i));
+      fprintf(file, "      %6lu  %c%6lu   %6lu%c   %6lu\n",
+              OFF( 4+16*i), (i==1||i==2)?'\\':' ',
+              OFF( 5+16*i), OFF( 6+16*i), (i==1||i==2)?'\\':' ',
+              OFF( 7+16*i));
+      fprintf(file, "         %6lu   %6lu   %6lu   %6lu\n",
+              OFF( 0+16*i), OFF( 1+16*i),
+              OFF( 2+16*i), OFF( 3+16*i));
       if (i) fprintf(file, "\n");
     }
     break;
   default:
     for (i=0; i<fd*fd*fd; i++) {
-      fprintf(file, "  off[% 3d,% 3d,% 3d] = % 6d\n",
-              i%fd, (i/fd)%fd, i/(fd*fd), off[i]);
+      fprintf(file, "  off[% 3d,% 3d,% 3d] = %6lu\n",
+              i%fd, (i/fd)%fd, i/(fd*fd), OFF(i));
     }
     break;
   }
 }
 
+#undef OFF
+
 #define PRINT_2(NN,C)                                  \
    fw = fw##NN##C;                                     \
    fprintf(file, " --" #NN "-->% 15.7f   % 15.7f\n", \
@@ -46,9 +46,31 @@ extern int _gageShapeSet(const gageContext *ctx, gageShape *shape,
 /* ctx.c */
 extern int _gageProbe(gageContext *ctx, double xi, double yi, double zi,
                       double stackIdx);
+extern int _gageProbeSpaceIndex(gageContext *ctx, double ipos[4],
+                                double xx, double yy, double zz, double ss,
+                                int indexSpace, int clamp);
 extern int _gageProbeSpace(gageContext *ctx, double xx, double yy, double zz,
                            double ss, int indexSpace, int clamp);
 
+/* iv3.c */
+extern void _gageIv3FillSelect(gagePerVolume *pvl);
+extern void _gageIv3Shift(gageContext *ctx, gagePerVolume *pvl,
+                          unsigned int axis, int dir);
+extern void _gageIv3FillBox(const gageContext *ctx, gagePerVolume *pvl,
+                            const unsigned int lo[3],
+                            const unsigned int bmin[3],
+                            const unsigned int bmax[3]);
+
+/* brick.c */
+extern size_t _gageBrickIndex(const gagePerVolume *pvl, unsigned int xx,
+                              unsigned int yy, unsigned int zz);
+extern size_t _gageBrickDataSize(const gagePerVolume *pvl);
+extern int _gageBrickUpdate(gageContext *ctx);
+extern void _gageBrickNix(gagePerVolume *pvl);
+
+/* stats.c */
+extern airULLong _gageStatsTick(void);
+
 /* pvl.c */
 extern gagePerVolume *_gagePerVolumeCopy(gagePerVolume *pvl, unsigned int fd);
 extern double *_gageAnswerPointer(const gageContext *ctx,
@@ -68,12 +90,34 @@ extern int _gageStackBaseIv3Fill(gageContext *ctx);
 /* sclprint.c */
 extern void _gageSclIv3Print(FILE *, gageContext *ctx, gagePerVolume *pvl);
 
+/* update.c */
+extern void _gageSinglePrecisionUpdate(gageContext *ctx);
+
 /* sclfilter.c */
+typedef void (_gageScl3PFilterF_t)(gageShape *shape,
+                                   float *iv3, float *iv2, float *iv1,
+                                   float *fw00, float *fw11, float *fw22,
+                                   double *val, double *gvec, double *hess,
+                                   const int *needD);
+extern _gageScl3PFilterF_t _gageScl3PFilterF2;
+extern _gageScl3PFilterF_t _gageScl3PFilterF4;
+extern _gageScl3PFilterF_t _gageScl3PFilterF6;
+extern _gageScl3PFilterF_t _gageScl3PFilterF8;
+extern void _gageScl3PFilterFN(gageShape *shape, int fd,
+                               float *iv3, float *iv2, float *iv1,
+                               float *fw00, float *fw11, float *fw22,
+                               double *val, double *gvec, double *hess,
+                               const int *needD);
 extern void _gageSclFilter(gageContext *ctx, gagePerVolume *pvl);
+extern int _gageSclFilterMultiCan(const gagePerVolume *pvl);
+extern unsigned int _gageSclFilterMulti(gageContext *ctx);
 
 /* sclanswer.c */
 extern void _gageSclAnswer(gageContext *ctx, gagePerVolume *pvl);
 
+/* vecGage.c */
+extern void _gageVecFilter(gageContext *ctx, gagePerVolume *pvl);
+
 /* vecprint.c */
 extern void _gageVecIv3Print(FILE *, gageContext *ctx, gagePerVolume *pvl);
 
@@ -96,6 +96,12 @@ gagePerVolumeNew(gageContext *ctx, const Nrrd *nin, const gageKind *kind) {
     pvl->flag[ii] = AIR_FALSE;
   }
   pvl->iv3 = pvl->iv2 = pvl->iv1 = NULL;
+  pvl->iv3f = pvl->iv2f = pvl->iv1f = NULL;
+  pvl->singlePrecision = AIR_FALSE;
+  pvl->brickData = NULL;
+  pvl->brickSrc = NULL;
+  ELL_3V_SET(pvl->brickShift, 0, 0, 0);
+  ELL_3V_SET(pvl->brickNum, 0, 0, 0);
   pvl->lup = nrrdDLookup[nin->type];
   pvl->answer = AIR_CALLOC(gageKindTotalAnswerLength(kind), double);
   airMopAdd(mop, pvl->answer, airFree, airMopOnError);
@@ -152,12 +158,29 @@ _gagePerVolumeCopy(gagePerVolume *pvl, unsigned int fd) {
   airMopAdd(mop, nvl->iv3, airFree, airMopOnError);
   airMopAdd(mop, nvl->iv2, airFree, airMopOnError);
   airMopAdd(mop, nvl->iv1, airFree, airMopOnError);
+  nvl->iv3f = AIR_CALLOC(fd*fd*fd*nvl->kind->valLen, float);
+  nvl->iv2f = AIR_CALLOC(fd*fd*nvl->kind->valLen, float);
+  nvl->iv1f = AIR_CALLOC(fd*nvl->kind->valLen, float);
+  airMopAdd(mop, nvl->iv3f, airFree, airMopOnError);
+  airMopAdd(mop, nvl->iv2f, airFree, airMopOnError);
+  airMopAdd(mop, nvl->iv1f, airFree, airMopOnError);
   nvl->answer = AIR_CALLOC(gageKindTotalAnswerLength(nvl->kind), double);
   airMopAdd(mop, nvl->answer, airFree, airMopOnError);
   nvl->directAnswer = AIR_CALLOC(nvl->kind->itemMax+1, double*);
   airMopAdd(mop, nvl->directAnswer, airFree, airMopOnError);
+  if (pvl->brickData) {
+    /* the copy gets its own bricked copy, so that it doesn't depend
+       on the original context staying around */
+    nvl->brickData = malloc(_gageBrickDataSize(pvl));
+    airMopAdd(mop, nvl->brickData, airFree, airMopOnError);
+    if (nvl->brickData) {
+      memcpy(nvl->brickData, pvl->brickData, _gageBrickDataSize(pvl));
+    }
+  }
   if (!( nvl->iv3 && nvl->iv2 && nvl->iv1
-         && nvl->answer && nvl->directAnswer )) {
+         && nvl->iv3f && nvl->iv2f && nvl->iv1f
+         && nvl->answer && nvl->directAnswer
+         && (!pvl->brickData || nvl->brickData) )) {
     biffAddf(GAGE, "%s: couldn't allocate all caches "
              "(fd=%u, valLen=%u, totAnsLen=%u, itemMax=%u)", me,
              fd, nvl->kind->valLen, gageKindTotalAnswerLength(nvl->kind),
@@ -199,13 +222,38 @@ gagePerVolumeNix(gagePerVolume *pvl) {
     pvl->iv3 = (double *)airFree(pvl->iv3);
     pvl->iv2 = (double *)airFree(pvl->iv2);
     pvl->iv1 = (double *)airFree(pvl->iv1);
+    pvl->iv3f = (float *)airFree(pvl->iv3f);
+    pvl->iv2f = (float *)airFree(pvl->iv2f);
+    pvl->iv1f = (float *)airFree(pvl->iv1f);
     pvl->answer = (double *)airFree(pvl->answer);
     pvl->directAnswer = (double **)airFree(pvl->directAnswer);
+    _gageBrickNix(pvl);
     airFree(pvl);
   }
   return NULL;
 }
 
+/*
+******** gagePerVolumeDataChanged()
+**
+** tells gage that the values in pvl->nin->data were changed in place,
+** which it can't otherwise notice.  Any bricked copy of the data (see
+** gageParmBrick) is freed, so that probing reads nin->data directly
+** until the next gageUpdate() makes the copy again.  Like gageUpdate(),
+** this must not be called while there are probe states of the context.
+*/
+int
+gagePerVolumeDataChanged(gagePerVolume *pvl) {
+  static const char me[]="gagePerVolumeDataChanged";
+
+  if (!pvl) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  _gageBrickNix(pvl);
+  return 0;
+}
+
 /*
 ******** gageAnswerPointer()
 **
@@ -0,0 +1,159 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+
+/*********** THIS IS A HACK !!!
+ *********** THIS ISN'T REALLY A SOURCE FILE !!!
+ *********** ITS JUST A MACRO (sorry) */
+
+  /* Same results as scl3pfilterbody.c (same fw?, ivX, and needD
+     semantics), but each scanline of ivX and of the intermediate
+     results is read once, and filtered with all the kernels (value,
+     1st, and 2nd derivative) needed from it, instead of once per
+     kernel.  The intermediate results go into local arrays, so "fd"
+     has to be a compile-time constant; the includer defines "fd" and
+     "fT" (the type of ivX and fw?), and declares "int i, j;".  With
+     constant fd, the dot products are fixed-length loops that the
+     compiler can unroll and vectorize (the same sum order as in
+     scl3pfilterbody.c is kept, so the results are bit-identical).
+     ivY and ivZ are not used.
+
+     yv, yd, ydd: 2D fd x fd (Y fast) results of filtering along X with
+       fw0, fw1, fw2
+     z??: 1D (along Z) results of then filtering along Y; the first digit
+       is the X kernel and the second is the Y kernel, e.g. z10 is from
+       filtering yd with fw0
+  */
+  {
+    fT yv[fd*fd], yd[fd*fd], ydd[fd*fd],
+      z00[fd], z01[fd], z02[fd], z10[fd], z11[fd], z20[fd], tv, td, tdd;
+    const fT *ll, *w0, *w1, *w2;
+
+    AIR_UNUSED(ivY);
+    AIR_UNUSED(ivZ);
+#define DOT_F(ANS, w, l) \
+    ANS = (w)[0]*(l)[0]; for (i=1; i<fd; i++) { ANS += (w)[i]*(l)[i]; }
+/* three dot products of l, with w0, w1, and w2 */
+#define DOT3_F(A0, A1, A2, l)                   \
+    tv = w0[0]*(l)[0];                          \
+    td = w1[0]*(l)[0];                          \
+    tdd = w2[0]*(l)[0];                         \
+    for (i=1; i<fd; i++) {                      \
+      tv += w0[i]*(l)[i];                       \
+      td += w1[i]*(l)[i];                       \
+      tdd += w2[i]*(l)[i];                      \
+    }                                           \
+    A0 = tv; A1 = td; A2 = tdd
+#define DOT2_F(A0, A1, l)                       \
+    tv = w0[0]*(l)[0];                          \
+    td = w1[0]*(l)[0];                          \
+    for (i=1; i<fd; i++) {                      \
+      tv += w0[i]*(l)[i];                       \
+      td += w1[i]*(l)[i];                       \
+    }                                           \
+    A0 = tv; A1 = td
+
+    /* ---- along X */
+    w0 = fw0 + X*fd;
+    w1 = fw1 + X*fd;
+    w2 = fw2 + X*fd;
+    if (doD2) {
+      for (j=0; j<fd*fd; j++) {
+        ll = ivX + j*fd;
+        DOT3_F(yv[j], yd[j], ydd[j], ll);
+      }
+    } else if (doD1) {
+      for (j=0; j<fd*fd; j++) {
+        ll = ivX + j*fd;
+        DOT2_F(yv[j], yd[j], ll);
+      }
+    } else {
+      for (j=0; j<fd*fd; j++) {
+        DOT_F(yv[j], w0, ivX + j*fd);
+      }
+    }
+
+    /* ---- along Y */
+    w0 = fw0 + Y*fd;
+    w1 = fw1 + Y*fd;
+    w2 = fw2 + Y*fd;
+    if (doD2) {
+      for (j=0; j<fd; j++) {
+        ll = yv + j*fd;
+        DOT3_F(z00[j], z01[j], z02[j], ll);
+        ll = yd + j*fd;
+        DOT2_F(z10[j], z11[j], ll);
+        DOT_F(z20[j], w0, ydd + j*fd);
+      }
+    } else if (doD1) {
+      for (j=0; j<fd; j++) {
+        ll = yv + j*fd;
+        DOT2_F(z00[j], z01[j], ll);
+        DOT_F(z10[j], w0, yd + j*fd);
+      }
+    } else {
+      for (j=0; j<fd; j++) {
+        DOT_F(z00[j], w0, yv + j*fd);
+      }
+    }
+
+    /* ---- along Z */
+    w0 = fw0 + Z*fd;
+    w1 = fw1 + Z*fd;
+    w2 = fw2 + Z*fd;
+    if (doV) {
+      DOT_F(tv, w0, z00);
+      *val = tv;                                /* f */
+    }
+    if (doD1 || doD2) {
+      if (doD1) {
+        DOT_F(tv, w1, z00);
+        gvec[2] = tv;                           /* g_z */
+        DOT_F(tv, w0, z01);
+        gvec[1] = tv;                           /* g_y */
+        DOT_F(tv, w0, z10);
+        gvec[0] = tv;                           /* g_x */
+      }
+      ell_3mv_mul_d(gvec, shape->ItoWSubInvTransp, gvec);
+      if (doD2) {
+        double matA[9];
+        DOT_F(tv, w2, z00);
+        hess[8] = tv;                           /* h_zz */
+        DOT_F(tv, w1, z01);
+        hess[5] = hess[7] = tv;                 /* h_yz */
+        DOT_F(tv, w0, z02);
+        hess[4] = tv;                           /* h_yy */
+        DOT_F(tv, w1, z10);
+        hess[2] = hess[6] = tv;                 /* h_xz */
+        DOT_F(tv, w0, z11);
+        hess[1] = hess[3] = tv;                 /* h_xy */
+        DOT_F(tv, w0, z20);
+        hess[0] = tv;                           /* h_xx */
+        ELL_3M_MUL(matA, shape->ItoWSubInvTransp, hess);
+        ELL_3M_MUL(hess, matA, shape->ItoWSubInv);
+      }
+    }
+#undef DOT_F
+#undef DOT2_F
+#undef DOT3_F
+  }
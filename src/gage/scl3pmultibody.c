@@ -0,0 +1,173 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+/*********** THIS IS A HACK !!!
+ *********** THIS ISN'T REALLY A SOURCE FILE !!!
+ *********** ITS JUST A MACRO (sorry) */
+
+  /* The same filtering as in scl3pfusedbody.c, but of GAGE_MSCL_CHAN
+     scalar volumes ("channels") at once: every value in the caches
+     here is a vector of GAGE_MSCL_CHAN values, one per channel, with
+     channel as the fastest axis.  The includer defines "fd" (a
+     compile-time constant), declares "unsigned int i, j, ci;", sets
+     doV, doD1, doD2 (for all channels) and fw0, fw1, fw2, and fills
+     ivX (fd^3 vectors) from the channels' iv3 caches.  Results are
+     left in val, grad[3], and hess[9] (each a vector), without the
+     index-to-world transforms.  Each channel gets the same sequence of
+     operations as in scl3pfusedbody.c (the sums are in the same order),
+     so the results are bit-identical.  The innermost loops are over the
+     constant number of channels, with the sums in local arrays and the
+     branches outside the loops, so that compilers can do them with
+     SIMD instructions (the values of all channels in one register).
+
+     yv, yd, ydd: 2D fd x fd (Y fast) results of filtering along X with
+       fw0, fw1, fw2
+     z??: 1D (along Z) results of then filtering along Y; the first digit
+       is the X kernel and the second is the Y kernel
+  */
+  {
+    double yv[fd*fd*GAGE_MSCL_CHAN], yd[fd*fd*GAGE_MSCL_CHAN],
+      ydd[fd*fd*GAGE_MSCL_CHAN],
+      z00[fd*GAGE_MSCL_CHAN], z01[fd*GAGE_MSCL_CHAN], z02[fd*GAGE_MSCL_CHAN],
+      z10[fd*GAGE_MSCL_CHAN], z11[fd*GAGE_MSCL_CHAN], z20[fd*GAGE_MSCL_CHAN];
+    double tv[GAGE_MSCL_CHAN], td[GAGE_MSCL_CHAN], tdd[GAGE_MSCL_CHAN];
+    const double *ll, *w0, *w1, *w2;
+
+/* ANS = dot product of w and the fd vectors at l */
+#define DOT_M(ANS, w, l)                                        \
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                       \
+      tv[ci] = (w)[0]*(l)[ci];                                  \
+    }                                                           \
+    for (i=1; i<fd; i++) {                                      \
+      for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                     \
+        tv[ci] += (w)[i]*(l)[ci + GAGE_MSCL_CHAN*i];            \
+      }                                                         \
+    }                                                           \
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                       \
+      (ANS)[ci] = tv[ci];                                       \
+    }
+/* dot products of l with w0, w1, (and w2) */
+#define DOT2_M(A0, A1, l)                                       \
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                       \
+      tv[ci] = w0[0]*(l)[ci];                                   \
+      td[ci] = w1[0]*(l)[ci];                                   \
+    }                                                           \
+    for (i=1; i<fd; i++) {                                      \
+      for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                     \
+        tv[ci] += w0[i]*(l)[ci + GAGE_MSCL_CHAN*i];             \
+        td[ci] += w1[i]*(l)[ci + GAGE_MSCL_CHAN*i];             \
+      }                                                         \
+    }                                                           \
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                       \
+      (A0)[ci] = tv[ci];                                        \
+      (A1)[ci] = td[ci];                                        \
+    }
+#define DOT3_M(A0, A1, A2, l)                                   \
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                       \
+      tv[ci] = w0[0]*(l)[ci];                                   \
+      td[ci] = w1[0]*(l)[ci];                                   \
+      tdd[ci] = w2[0]*(l)[ci];                                  \
+    }                                                           \
+    for (i=1; i<fd; i++) {                                      \
+      for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                     \
+        tv[ci] += w0[i]*(l)[ci + GAGE_MSCL_CHAN*i];             \
+        td[ci] += w1[i]*(l)[ci + GAGE_MSCL_CHAN*i];             \
+        tdd[ci] += w2[i]*(l)[ci + GAGE_MSCL_CHAN*i];            \
+      }                                                         \
+    }                                                           \
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {                       \
+      (A0)[ci] = tv[ci];                                        \
+      (A1)[ci] = td[ci];                                        \
+      (A2)[ci] = tdd[ci];                                       \
+    }
+
+    /* ---- along X */
+    w0 = fw0 + X*fd;
+    w1 = fw1 + X*fd;
+    w2 = fw2 + X*fd;
+    if (doD2) {
+      for (j=0; j<fd*fd; j++) {
+        ll = ivX + GAGE_MSCL_CHAN*fd*j;
+        DOT3_M(yv + GAGE_MSCL_CHAN*j, yd + GAGE_MSCL_CHAN*j,
+               ydd + GAGE_MSCL_CHAN*j, ll);
+      }
+    } else if (doD1) {
+      for (j=0; j<fd*fd; j++) {
+        ll = ivX + GAGE_MSCL_CHAN*fd*j;
+        DOT2_M(yv + GAGE_MSCL_CHAN*j, yd + GAGE_MSCL_CHAN*j, ll);
+      }
+    } else {
+      for (j=0; j<fd*fd; j++) {
+        DOT_M(yv + GAGE_MSCL_CHAN*j, w0, ivX + GAGE_MSCL_CHAN*fd*j);
+      }
+    }
+
+    /* ---- along Y */
+    w0 = fw0 + Y*fd;
+    w1 = fw1 + Y*fd;
+    w2 = fw2 + Y*fd;
+    if (doD2) {
+      for (j=0; j<fd; j++) {
+        ll = yv + GAGE_MSCL_CHAN*fd*j;
+        DOT3_M(z00 + GAGE_MSCL_CHAN*j, z01 + GAGE_MSCL_CHAN*j,
+               z02 + GAGE_MSCL_CHAN*j, ll);
+        ll = yd + GAGE_MSCL_CHAN*fd*j;
+        DOT2_M(z10 + GAGE_MSCL_CHAN*j, z11 + GAGE_MSCL_CHAN*j, ll);
+        DOT_M(z20 + GAGE_MSCL_CHAN*j, w0, ydd + GAGE_MSCL_CHAN*fd*j);
+      }
+    } else if (doD1) {
+      for (j=0; j<fd; j++) {
+        ll = yv + GAGE_MSCL_CHAN*fd*j;
+        DOT2_M(z00 + GAGE_MSCL_CHAN*j, z01 + GAGE_MSCL_CHAN*j, ll);
+        DOT_M(z10 + GAGE_MSCL_CHAN*j, w0, yd + GAGE_MSCL_CHAN*fd*j);
+      }
+    } else {
+      for (j=0; j<fd; j++) {
+        DOT_M(z00 + GAGE_MSCL_CHAN*j, w0, yv + GAGE_MSCL_CHAN*fd*j);
+      }
+    }
+
+    /* ---- along Z */
+    w0 = fw0 + Z*fd;
+    w1 = fw1 + Z*fd;
+    w2 = fw2 + Z*fd;
+    if (doV) {
+      DOT_M(val, w0, z00);                      /* f */
+    }
+    if (doD1) {
+      DOT_M(grad[2], w1, z00);                  /* g_z */
+      DOT_M(grad[1], w0, z01);                  /* g_y */
+      DOT_M(grad[0], w0, z10);                  /* g_x */
+    }
+    if (doD2) {
+      DOT_M(hess[8], w2, z00);                  /* h_zz */
+      DOT_M(hess[5], w1, z01);                  /* h_yz */
+      DOT_M(hess[4], w0, z02);                  /* h_yy */
+      DOT_M(hess[2], w1, z10);                  /* h_xz */
+      DOT_M(hess[1], w0, z11);                  /* h_xy */
+      DOT_M(hess[0], w0, z20);                  /* h_xx */
+    }
+#undef DOT_M
+#undef DOT2_M
+#undef DOT3_M
+  }
@@ -47,6 +47,13 @@
 #define Y 1
 #define Z 2
 
+/*
+** fd=4 and fd=6 (as with the commonly used cubic, C4 hexic, and
+** quintic kernels) are done with scl3pfusedbody.c, which traverses
+** the value cache once for all the needed derivatives; the others use
+** scl3pfilterbody.c (or, for fd=2, an unrolled version of it)
+*/
+
 void
 gageScl3PFilter2(gageShape *shape,
                  double *ivX, double *ivY, double *ivZ,
@@ -172,161 +179,17 @@ gageScl3PFilter4(gageShape *shape,
                  double *fw0, double *fw1, double *fw2,
                  double *val, double *gvec, double *hess,
                  const int *needD) {
+  int i, j;
   int doV, doD1, doD2;
   doV = needD[0];
   doD1 = needD[1];
   doD2 = needD[2];
 
-  /* fw? + 4*?
-       |     |
-       |     +- along which axis (0:x, 1:y, 2:z)
-       |
-       + what information (0:value, 1:1st deriv, 2:2nd deriv)
-
-     ivX: 3D cube cache of original volume values
-          (its scanlines are along the X axis)
-     ivY: 2D square cache of intermediate filter results
-          (its scanlines are along the Y axis)
-     ivZ: 1D linear cache of intermediate filter results
-          (it is a scanline along the Z axis)
-  */
-
-#define DOT_4(a,b) ((a)[0]*(b)[0]+(a)[1]*(b)[1]+(a)[2]*(b)[2]+(a)[3]*(b)[3])
-#define VL_4(i, axis) DOT_4(fw0 + (axis)*4, iv##axis + i*4)
-#define D1_4(i, axis) DOT_4(fw1 + (axis)*4, iv##axis + i*4)
-#define D2_4(i, axis) DOT_4(fw2 + (axis)*4, iv##axis + i*4)
-
-  /* x0 */
-  ivY[ 0] = VL_4( 0,X);
-  ivY[ 1] = VL_4( 1,X);
-  ivY[ 2] = VL_4( 2,X);
-  ivY[ 3] = VL_4( 3,X);
-  ivY[ 4] = VL_4( 4,X);
-  ivY[ 5] = VL_4( 5,X);
-  ivY[ 6] = VL_4( 6,X);
-  ivY[ 7] = VL_4( 7,X);
-  ivY[ 8] = VL_4( 8,X);
-  ivY[ 9] = VL_4( 9,X);
-  ivY[10] = VL_4(10,X);
-  ivY[11] = VL_4(11,X);
-  ivY[12] = VL_4(12,X);
-  ivY[13] = VL_4(13,X);
-  ivY[14] = VL_4(14,X);
-  ivY[15] = VL_4(15,X);
-  /*
-  */
-  /* x0y0 */
-  ivZ[ 0] = VL_4( 0,Y);
-  ivZ[ 1] = VL_4( 1,Y);
-  ivZ[ 2] = VL_4( 2,Y);
-  ivZ[ 3] = VL_4( 3,Y);
-  /* x0y0z0 */
-  if (doV) {
-    *val = VL_4( 0,Z);                          /* f */
-  }
-
-  if (!( doD1 || doD2 ))
-    return;
-
-  /* x0y0z1 */
-  if (doD1) {
-    gvec[2] = D1_4( 0,Z);                       /* g_z */
-  }
-  if (doD2) {
-    /* x0y0z2 */
-    hess[8] = D2_4( 0,Z);                       /* h_zz */
-  }
-  /* x0y1 */
-  ivZ[ 0] = D1_4( 0,Y);
-  ivZ[ 1] = D1_4( 1,Y);
-  ivZ[ 2] = D1_4( 2,Y);
-  ivZ[ 3] = D1_4( 3,Y);
-  /* x0y1z0 */
-  if (doD1) {
-    gvec[1] = VL_4( 0,Z);                       /* g_y */
-  }
-  if (doD2) {
-    /* x0y1z1 */
-    hess[5] = hess[7] = D1_4( 0,Z);             /* h_yz */
-    /* x0y2 */
-    ivZ[ 0] = D2_4( 0,Y);
-    ivZ[ 1] = D2_4( 1,Y);
-    ivZ[ 2] = D2_4( 2,Y);
-    ivZ[ 3] = D2_4( 3,Y);
-    /* x0y2z0 */
-    hess[4] = VL_4( 0,Z);                       /* h_yy */
-  }
-  /* x1 */
-  ivY[ 0] = D1_4( 0,X);
-  ivY[ 1] = D1_4( 1,X);
-  ivY[ 2] = D1_4( 2,X);
-  ivY[ 3] = D1_4( 3,X);
-  ivY[ 4] = D1_4( 4,X);
-  ivY[ 5] = D1_4( 5,X);
-  ivY[ 6] = D1_4( 6,X);
-  ivY[ 7] = D1_4( 7,X);
-  ivY[ 8] = D1_4( 8,X);
-  ivY[ 9] = D1_4( 9,X);
-  ivY[10] = D1_4(10,X);
-  ivY[11] = D1_4(11,X);
-  ivY[12] = D1_4(12,X);
-  ivY[13] = D1_4(13,X);
-  ivY[14] = D1_4(14,X);
-  ivY[15] = D1_4(15,X);
-  /* x1y0 */
-  ivZ[ 0] = VL_4( 0,Y);
-  ivZ[ 1] = VL_4( 1,Y);
-  ivZ[ 2] = VL_4( 2,Y);
-  ivZ[ 3] = VL_4( 3,Y);
-  /* x1y0z0 */
-  if (doD1) {
-    gvec[0] = VL_4( 0,Z);                       /* g_x */
-  }
-
-  ell_3mv_mul_d(gvec, shape->ItoWSubInvTransp, gvec);
-
-  if (!doD2)
-    return;
-
-  /* x1y0z1 */
-  hess[2] = hess[6] = D1_4( 0,Z);               /* h_xz */
-  /* x1y1 */
-  ivZ[ 0] = D1_4( 0,Y);
-  ivZ[ 1] = D1_4( 1,Y);
-  ivZ[ 2] = D1_4( 2,Y);
-  ivZ[ 3] = D1_4( 3,Y);
-  /* x1y1z0 */
-  hess[1] = hess[3] = VL_4( 0,Z);               /* h_xy */
-  /* x2 */
-  ivY[ 0] = D2_4( 0,X);
-  ivY[ 1] = D2_4( 1,X);
-  ivY[ 2] = D2_4( 2,X);
-  ivY[ 3] = D2_4( 3,X);
-  ivY[ 4] = D2_4( 4,X);
-  ivY[ 5] = D2_4( 5,X);
-  ivY[ 6] = D2_4( 6,X);
-  ivY[ 7] = D2_4( 7,X);
-  ivY[ 8] = D2_4( 8,X);
-  ivY[ 9] = D2_4( 9,X);
-  ivY[10] = D2_4(10,X);
-  ivY[11] = D2_4(11,X);
-  ivY[12] = D2_4(12,X);
-  ivY[13] = D2_4(13,X);
-  ivY[14] = D2_4(14,X);
-  ivY[15] = D2_4(15,X);
-  /* x2y0 */
-  ivZ[ 0] = VL_4( 0,Y);
-  ivZ[ 1] = VL_4( 1,Y);
-  ivZ[ 2] = VL_4( 2,Y);
-  ivZ[ 3] = VL_4( 3,Y);
-  /* x2y0z0 */
-  hess[0] = VL_4( 0,Z);                         /* h_xx */
-
-  if (1) {
-    double matA[9];
-    ELL_3M_MUL(matA, shape->ItoWSubInvTransp, hess);
-    ELL_3M_MUL(hess, matA, shape->ItoWSubInv);
-  }
+#define fd 4
+#define fT double
+#include "scl3pfusedbody.c"
+#undef fT
+#undef fd
 
   return;
 }
@@ -338,14 +201,15 @@ gageScl3PFilter6(gageShape *shape,
                  double *val, double *gvec, double *hess,
                  const int *needD) {
   int i, j;
-  double T;
   int doV, doD1, doD2;
   doV = needD[0];
   doD1 = needD[1];
   doD2 = needD[2];
 
 #define fd 6
-#include "scl3pfilterbody.c"
+#define fT double
+#include "scl3pfusedbody.c"
+#undef fT
 #undef fd
 
   return;
@@ -389,6 +253,114 @@ gageScl3PFilterN(gageShape *shape, int fd,
   return;
 }
 
+/*
+** single-precision versions of the above, used by _gageSclFilter and
+** _gageVecFilter when pvl->singlePrecision: the value caches and filter
+** weights are float (as is the accumulation of the dot products), but
+** the results are still stored as double in the answer buffers. All
+** of these use scl3pfilterbody.c, with a compile-time constant fd when
+** possible.
+*/
+void
+_gageScl3PFilterF2(gageShape *shape,
+                   float *ivX, float *ivY, float *ivZ,
+                   float *fw0, float *fw1, float *fw2,
+                   double *val, double *gvec, double *hess,
+                   const int *needD) {
+  int i, j;
+  float T;
+  int doV, doD1, doD2;
+  doV = needD[0];
+  doD1 = needD[1];
+  doD2 = needD[2];
+
+#define fd 2
+#include "scl3pfilterbody.c"
+#undef fd
+
+  return;
+}
+
+void
+_gageScl3PFilterF4(gageShape *shape,
+                   float *ivX, float *ivY, float *ivZ,
+                   float *fw0, float *fw1, float *fw2,
+                   double *val, double *gvec, double *hess,
+                   const int *needD) {
+  int i, j;
+  int doV, doD1, doD2;
+  doV = needD[0];
+  doD1 = needD[1];
+  doD2 = needD[2];
+
+#define fd 4
+#define fT float
+#include "scl3pfusedbody.c"
+#undef fT
+#undef fd
+
+  return;
+}
+
+void
+_gageScl3PFilterF6(gageShape *shape,
+                   float *ivX, float *ivY, float *ivZ,
+                   float *fw0, float *fw1, float *fw2,
+                   double *val, double *gvec, double *hess,
+                   const int *needD) {
+  int i, j;
+  int doV, doD1, doD2;
+  doV = needD[0];
+  doD1 = needD[1];
+  doD2 = needD[2];
+
+#define fd 6
+#define fT float
+#include "scl3pfusedbody.c"
+#undef fT
+#undef fd
+
+  return;
+}
+
+void
+_gageScl3PFilterF8(gageShape *shape,
+                   float *ivX, float *ivY, float *ivZ,
+                   float *fw0, float *fw1, float *fw2,
+                   double *val, double *gvec, double *hess,
+                   const int *needD) {
+  int i, j;
+  float T;
+  int doV, doD1, doD2;
+  doV = needD[0];
+  doD1 = needD[1];
+  doD2 = needD[2];
+
+#define fd 8
+#include "scl3pfilterbody.c"
+#undef fd
+
+  return;
+}
+
+void
+_gageScl3PFilterFN(gageShape *shape, int fd,
+                   float *ivX, float *ivY, float *ivZ,
+                   float *fw0, float *fw1, float *fw2,
+                   double *val, double *gvec, double *hess,
+                   const int *needD) {
+  int i, j;
+  float T;
+  int doV, doD1, doD2;
+  doV = needD[0];
+  doD1 = needD[1];
+  doD2 = needD[2];
+
+#include "scl3pfilterbody.c"
+
+  return;
+}
+
 void
 _gageSclFilter(gageContext *ctx, gagePerVolume *pvl) {
   char me[]="_gageSclFilter";
@@ -402,6 +374,32 @@ _gageSclFilter(gageContext *ctx, gagePerVolume *pvl) {
     fprintf(stderr, "!%s: sorry, 6-pack filtering not implemented\n", me);
     return;
   }
+  if (pvl->singlePrecision) {
+    float *fwf00, *fwf11, *fwf22;
+    _gageScl3PFilterF_t *filterF[5] = {NULL,
+                                       _gageScl3PFilterF2, _gageScl3PFilterF4,
+                                       _gageScl3PFilterF6, _gageScl3PFilterF8};
+    fwf00 = ctx->fwf + fd*3*gageKernel00;
+    fwf11 = ctx->fwf + fd*3*gageKernel11;
+    fwf22 = ctx->fwf + fd*3*gageKernel22;
+    if (fd <= 8) {
+      filterF[ctx->radius](ctx->shape, pvl->iv3f, pvl->iv2f, pvl->iv1f,
+                           fwf00, fwf11, fwf22,
+                           pvl->directAnswer[gageSclValue],
+                           pvl->directAnswer[gageSclGradVec],
+                           pvl->directAnswer[gageSclHessian],
+                           pvl->needD);
+    } else {
+      _gageScl3PFilterFN(ctx->shape, fd,
+                         pvl->iv3f, pvl->iv2f, pvl->iv1f,
+                         fwf00, fwf11, fwf22,
+                         pvl->directAnswer[gageSclValue],
+                         pvl->directAnswer[gageSclGradVec],
+                         pvl->directAnswer[gageSclHessian],
+                         pvl->needD);
+    }
+    return;
+  }
   fw00 = ctx->fw + fd*3*gageKernel00;
   fw11 = ctx->fw + fd*3*gageKernel11;
   fw22 = ctx->fw + fd*3*gageKernel22;
@@ -426,6 +424,212 @@ _gageSclFilter(gageContext *ctx, gagePerVolume *pvl) {
   return;
 }
 
+/*
+** The filtering for parm.multiScl: the scalar pervolumes are filtered
+** together, GAGE_MSCL_CHAN at a time, by scl3pmultibody.c (so only for
+** fd <= 8).  Their iv3 caches (filled as usual, per pervolume) are
+** interleaved into one cache of short vectors, with the pervolume
+** ("channel") as the fastest axis.  Two channels of doubles is the
+** width of the SIMD registers that compilers can assume on x86-64
+** (SSE2); groups of four were slower (too many registers needed).
+*/
+#define GAGE_MSCL_CHAN 2
+
+static void
+_gageSclFilterChan2(gagePerVolume **pvl,
+                    const double *fw0, const double *fw1, const double *fw2,
+                    int doV, int doD1, int doD2, double *val,
+                    double grad[3][GAGE_MSCL_CHAN],
+                    double hess[9][GAGE_MSCL_CHAN]) {
+  double ivX[2*2*2*GAGE_MSCL_CHAN];
+  unsigned int i, j, ci;
+
+  for (j=0; j<2*2*2; j++) {
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {
+      ivX[ci + GAGE_MSCL_CHAN*j] = pvl[ci]->iv3[j];
+    }
+  }
+#define fd 2
+#include "scl3pmultibody.c"
+#undef fd
+
+  return;
+}
+
+static void
+_gageSclFilterChan4(gagePerVolume **pvl,
+                    const double *fw0, const double *fw1, const double *fw2,
+                    int doV, int doD1, int doD2, double *val,
+                    double grad[3][GAGE_MSCL_CHAN],
+                    double hess[9][GAGE_MSCL_CHAN]) {
+  double ivX[4*4*4*GAGE_MSCL_CHAN];
+  unsigned int i, j, ci;
+
+  for (j=0; j<4*4*4; j++) {
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {
+      ivX[ci + GAGE_MSCL_CHAN*j] = pvl[ci]->iv3[j];
+    }
+  }
+#define fd 4
+#include "scl3pmultibody.c"
+#undef fd
+
+  return;
+}
+
+static void
+_gageSclFilterChan6(gagePerVolume **pvl,
+                    const double *fw0, const double *fw1, const double *fw2,
+                    int doV, int doD1, int doD2, double *val,
+                    double grad[3][GAGE_MSCL_CHAN],
+                    double hess[9][GAGE_MSCL_CHAN]) {
+  double ivX[6*6*6*GAGE_MSCL_CHAN];
+  unsigned int i, j, ci;
+
+  for (j=0; j<6*6*6; j++) {
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {
+      ivX[ci + GAGE_MSCL_CHAN*j] = pvl[ci]->iv3[j];
+    }
+  }
+#define fd 6
+#include "scl3pmultibody.c"
+#undef fd
+
+  return;
+}
+
+static void
+_gageSclFilterChan8(gagePerVolume **pvl,
+                    const double *fw0, const double *fw1, const double *fw2,
+                    int doV, int doD1, int doD2, double *val,
+                    double grad[3][GAGE_MSCL_CHAN],
+                    double hess[9][GAGE_MSCL_CHAN]) {
+  double ivX[8*8*8*GAGE_MSCL_CHAN];
+  unsigned int i, j, ci;
+
+  for (j=0; j<8*8*8; j++) {
+    for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {
+      ivX[ci + GAGE_MSCL_CHAN*j] = pvl[ci]->iv3[j];
+    }
+  }
+#define fd 8
+#include "scl3pmultibody.c"
+#undef fd
+
+  return;
+}
+
+typedef void (_gageSclFilterChan_t)(gagePerVolume **pvl,
+                                   const double *fw0, const double *fw1,
+                                   const double *fw2,
+                                   int doV, int doD1, int doD2, double *val,
+                                   double grad[3][GAGE_MSCL_CHAN],
+                                   double hess[9][GAGE_MSCL_CHAN]);
+
+/*
+** filters GAGE_MSCL_CHAN scalar pervolumes together, and puts the
+** results in their answers
+*/
+static void
+_gageSclFilterChan(gageContext *ctx, gagePerVolume **pvl) {
+  _gageSclFilterChan_t *filter[5] = {NULL,
+                                     _gageSclFilterChan2, _gageSclFilterChan4,
+                                     _gageSclFilterChan6, _gageSclFilterChan8};
+  double val[GAGE_MSCL_CHAN], grad[3][GAGE_MSCL_CHAN],
+    hess[9][GAGE_MSCL_CHAN], *gvec, *hans, matA[9];
+  unsigned int fd, ci;
+  int doV, doD1, doD2;
+
+  fd = 2*ctx->radius;
+  doV = doD1 = doD2 = AIR_FALSE;
+  for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {
+    doV |= pvl[ci]->needD[0];
+    doD1 |= pvl[ci]->needD[1];
+    doD2 |= pvl[ci]->needD[2];
+  }
+  filter[ctx->radius](pvl,
+                      ctx->fw + fd*3*gageKernel00,
+                      ctx->fw + fd*3*gageKernel11,
+                      ctx->fw + fd*3*gageKernel22,
+                      doV, doD1, doD2, val, grad, hess);
+  /* de-interleave into the answers, as needed per pervolume */
+  for (ci=0; ci<GAGE_MSCL_CHAN; ci++) {
+    if (pvl[ci]->needD[0]) {
+      pvl[ci]->directAnswer[gageSclValue][0] = val[ci];
+    }
+    if (pvl[ci]->needD[1]) {
+      gvec = pvl[ci]->directAnswer[gageSclGradVec];
+      ELL_3V_SET(gvec, grad[0][ci], grad[1][ci], grad[2][ci]);
+      ell_3mv_mul_d(gvec, ctx->shape->ItoWSubInvTransp, gvec);
+    }
+    if (pvl[ci]->needD[2]) {
+      hans = pvl[ci]->directAnswer[gageSclHessian];
+      ELL_3M_SET(hans,
+                 hess[0][ci], hess[1][ci], hess[2][ci],
+                 hess[1][ci], hess[4][ci], hess[5][ci],
+                 hess[2][ci], hess[5][ci], hess[8][ci]);
+      ELL_3M_MUL(matA, ctx->shape->ItoWSubInvTransp, hans);
+      ELL_3M_MUL(hans, matA, ctx->shape->ItoWSubInv);
+    }
+  }
+  return;
+}
+
+/*
+** _gageSclFilterMultiCan
+**
+** whether pvl can be filtered by _gageSclFilterMulti
+*/
+int
+_gageSclFilterMultiCan(const gagePerVolume *pvl) {
+
+  return (gageKindScl == pvl->kind && !pvl->singlePrecision);
+}
+
+/*
+** _gageSclFilterMulti
+**
+** for parm.multiScl: filters all the pervolumes for which
+** _gageSclFilterMultiCan() is true (GAGE_MSCL_CHAN at a time, and
+** any remaining one by itself), and returns how many there were.
+** Returns 0 (having done nothing) when there are fewer than two, or
+** when the kernels are too wide, in which case the pervolumes have to
+** be filtered one at a time as usual.
+*/
+unsigned int
+_gageSclFilterMulti(gageContext *ctx) {
+  gagePerVolume *pvl[GAGE_MSCL_CHAN];
+  unsigned int pvlIdx, chanNum, num;
+
+  if (!( ctx->parm.k3pack
+         && !ctx->parm.stackUse
+         && 2*ctx->radius <= 8 )) {
+    return 0;
+  }
+  num = 0;
+  for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+    num += !!_gageSclFilterMultiCan(ctx->pvl[pvlIdx]);
+  }
+  if (num < 2) {
+    return 0;
+  }
+  chanNum = 0;
+  for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+    if (_gageSclFilterMultiCan(ctx->pvl[pvlIdx])) {
+      pvl[chanNum++] = ctx->pvl[pvlIdx];
+      if (GAGE_MSCL_CHAN == chanNum) {
+        _gageSclFilterChan(ctx, pvl);
+        chanNum = 0;
+      }
+    }
+  }
+  for (pvlIdx=0; pvlIdx<chanNum; pvlIdx++) {
+    /* the remainder is filtered as usual */
+    _gageSclFilter(ctx, pvl[pvlIdx]);
+  }
+  return num;
+}
+
 #undef X
 #undef Y
 #undef Z
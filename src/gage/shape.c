@@ -261,6 +261,17 @@ _gageShapeSet(const gageContext *ctx, gageShape *shape,
                       : shape->defaultCenter));
 
   /* ------ find sizes (set shape->size[0,1,2]) */
+  for (ai=0; ai<3; ai++) {
+    /* the total number of samples can be more than 2^32 (gage indexes
+       into the data with size_t), but gageIv3Fill() works with the
+       (signed int) lowest and highest index along each axis */
+    if (!( ax[ai]->size <= INT_MAX )) {
+      char stmp[AIR_STRLEN_SMALL];
+      biffAddf(GAGE, "%s: axis %d size %s > INT_MAX %d", me, ai,
+               airSprintSize_t(stmp, ax[ai]->size), INT_MAX);
+      airMopError(mop); return 1;
+    }
+  }
   shape->size[0] = ax[0]->size;
   shape->size[1] = ax[1]->size;
   shape->size[2] = ax[2]->size;
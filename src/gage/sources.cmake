@@ -1,11 +1,14 @@
 # This variable will help provide a master list of all the sources.
 # Add new source files here.
 set(GAGE_SOURCES
+  batch.c
+  brick.c
   ctx.c
   deconvolve.c
   defaultsGage.c
   filter.c
   gage.h
+  iv3.c
   kind.c
   miscGage.c
   print.c
@@ -16,6 +19,8 @@ set(GAGE_SOURCES
   sclfilter.c
   sclprint.c
   shape.c
+  state.c
+  stats.c
   st.c
   stack.c
   stackBlur.c
@@ -91,6 +91,7 @@ gageStackBlurParmInit(gageStackBlurParm *parm) {
     parm->needSpatialBlur = AIR_FALSE;
     parm->verbose = 1; /* HEY: this may be revisited */
     parm->dgGoodSigmaMax = nrrdKernelDiscreteGaussianGoodSigmaMax;
+    parm->threadNum = 0;
   }
   return;
 }
@@ -250,7 +251,8 @@ gageStackBlurParmCopy(gageStackBlurParm *dst,
       || gageStackBlurParmBoundarySpecSet(dst, src->bspec)
       || gageStackBlurParmNeedSpatialBlurSet(dst, src->needSpatialBlur)
       || gageStackBlurParmVerboseSet(dst, src->verbose)
-      || gageStackBlurParmOneDimSet(dst, src->oneDim)) {
+      || gageStackBlurParmOneDimSet(dst, src->oneDim)
+      || gageStackBlurParmThreadNumSet(dst, src->threadNum)) {
     biffAddf(GAGE, "%s: problem setting dst parm", me);
     return 1;
   }
@@ -468,6 +470,19 @@ gageStackBlurParmOneDimSet(gageStackBlurParm *sbp, int oneDim) {
   return 0;
 }
 
+int
+gageStackBlurParmThreadNumSet(gageStackBlurParm *sbp,
+                              unsigned int threadNum) {
+  static const char me[]="gageStackBlurParmThreadNumSet";
+
+  if (!sbp) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  sbp->threadNum = threadNum;
+  return 0;
+}
+
 int
 gageStackBlurParmNeedSpatialBlurSet(gageStackBlurParm *sbp,
                                     int needSpatialBlur) {
@@ -567,8 +582,9 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
   char *str, *mnmfS, *stok, *slast=NULL, *parmS, *eps;
   int flagSeen[256];
   double sigmaMin, sigmaMax, dggsm;
-  unsigned int sigmaNum, parmNum;
+  unsigned int sigmaNum, parmNum, threadNum;
   int haveFlags, verbose, verboseGot=AIR_FALSE, dggsmGot=AIR_FALSE,
+    threadNumGot=AIR_FALSE,
     sampling = AIR_FALSE, samplingGot=AIR_FALSE, E;
   airArray *mop, *epsArr;
   NrrdKernelSpec *kspec=NULL;
@@ -720,6 +736,14 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
           airMopError(mop); return 1;
         }
         dggsmGot = AIR_TRUE;
+      } else if (strcpy(xeq, "nt=") && strstr(stok, xeq) == stok) {
+        pval = stok + strlen(xeq);
+        if (1 != sscanf(pval, "%u", &threadNum)) {
+          biffAddf(GAGE, "%s: couldn't parse \"%s\" as thread number",
+                   me, pval);
+          airMopError(mop); return 1;
+        }
+        threadNumGot = AIR_TRUE;
       } else {
         /* doesn't match any of the parms we know how to parse */
         if (extraParmsP) {
@@ -781,6 +805,9 @@ gageStackBlurParmParse(gageStackBlurParm *sbp,
   if (flagSeen['1']) {
     if (!E) E |= gageStackBlurParmOneDimSet(sbp, AIR_TRUE);
   }
+  if (threadNumGot) {
+    if (!E) E |= gageStackBlurParmThreadNumSet(sbp, threadNum);
+  }
   /* NOT doing the final check, because if this is being called from
      hest, the caller won't have had time to set the default info in
      the sbp (like the default kernel), so it will probably look
@@ -880,6 +907,11 @@ gageStackBlurParmSprint(char str[AIR_STRLEN_LARGE],
     strcat(out, stmp);
   }
 
+  if (sbp->threadNum) {
+    sprintf(stmp, "/nt=%u", sbp->threadNum);
+    strcat(out, stmp);
+  }
+
   if (extraParm) {
     strcat(out, "/");
     strcat(out, extraParm);
@@ -1196,36 +1228,15 @@ _stackBlurDiscreteGaussFFT(Nrrd *const nblur[], gageStackBlurParm *sbp,
   return 0;
 }
 
+/*
+** sets up rsmc for blurring nin, except for the kernels on the
+** spatial axes, which are set by _stackBlurLevel
+*/
 static int
-_stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
-                  NrrdKernelSpec *kssb,
-                  const Nrrd *nin, const gageKind *kind) {
-  static const char me[]="_stackBlurSpatial";
-  NrrdResampleContext *rsmc;
-  Nrrd *niter;
-  unsigned int axi, blIdx;
-  int E, iterative, rsmpType;
-  double timeStepMax, /* max length of diffusion time allowed per blur,
-                         as determined by sbp->dgGoodSigmaMax */
-    timeDone,         /* amount of diffusion time just applied */
-    timeLeft;         /* amount of diffusion time left to do */
-  airArray *mop;
-
-  mop = airMopNew();
-  rsmc = nrrdResampleContextNew();
-  airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
-  if (nrrdKernelDiscreteGaussian == kssb->kernel) {
-    iterative = AIR_TRUE;
-    /* we don't want to lose precision when iterating */
-    rsmpType = nrrdResample_nt;
-    /* may be used with iterative diffusion */
-    niter = nrrdNew();
-    airMopAdd(mop, niter, (airMopper)nrrdNuke, airMopAlways);
-  } else {
-    iterative = AIR_FALSE;
-    rsmpType = nrrdTypeDefault;
-    niter = NULL;
-  }
+_stackBlurRsmcSetup(NrrdResampleContext *rsmc, const gageStackBlurParm *sbp,
+                    int rsmpType, const Nrrd *nin, const gageKind *kind) {
+  unsigned int axi;
+  int E;
 
   E = 0;
   if (!E) E |= nrrdResampleDefaultCenterSet(rsmc, nrrdDefaultCenter);
@@ -1247,115 +1258,311 @@ _stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
   if (!E) E |= nrrdResampleTypeOutSet(rsmc, rsmpType);
   if (!E) E |= nrrdResampleClampSet(rsmc, AIR_TRUE); /* probably moot */
   if (!E) E |= nrrdResampleRenormalizeSet(rsmc, sbp->renormalize);
-  if (E) {
-    biffAddf(GAGE, "%s: trouble setting up resampling", me);
+  return E;
+}
+
+/*
+** computes blur level blIdx into nout, using rsmc as set up by
+** _stackBlurRsmcSetup.  With iterative diffusion (non-NULL niter), this
+** continues from the previous level, whose un-rounded result is in
+** niter, and which already applied diffusion time timeDone.
+**
+** Returns non-zero (with nrrd's biff) on error
+*/
+static int
+_stackBlurLevel(Nrrd *nout, NrrdResampleContext *rsmc, Nrrd *niter,
+                NrrdKernelSpec *kssb, const gageStackBlurParm *sbp,
+                unsigned int blIdx, double timeDone, int verbose,
+                const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurLevel";
+  unsigned int axi;
+  int E;
+  double timeStepMax, /* max length of diffusion time allowed per blur,
+                         as determined by sbp->dgGoodSigmaMax */
+    timeLeft;         /* amount of diffusion time left to do */
+
+  E = 0;
+  timeStepMax = (sbp->dgGoodSigmaMax)*(sbp->dgGoodSigmaMax);
+  if (niter) {
+    double timeNow = sbp->sigma[blIdx]*sbp->sigma[blIdx];
+    unsigned int passIdx = 0;
+    timeLeft = timeNow - timeDone;
+    if (verbose) {
+      fprintf(stderr, "\n");
+      fprintf(stderr, "%s: scale %g == time %g (tau %g);\n"
+              "               timeLeft %g = %g - %g\n",
+              me, sbp->sigma[blIdx], timeNow, gageTauOfTee(timeNow),
+              timeLeft, timeNow, timeDone);
+      if (timeLeft > timeStepMax) {
+        fprintf(stderr, "%s: diffusing for time %g in steps of %g\n", me,
+                timeLeft, timeStepMax);
+      }
+      fflush(stderr);
+    }
+    do {
+      double timeDo;
+      if (blIdx || passIdx) {
+        /* either we're past the first scale (blIdx >= 1), or
+           (unlikely) we're on the first scale but after the first
+           pass of a multi-pass blurring, so we have to feed the
+           previous result back in as input.
+           AND: the way that niter is being used is very sneaky,
+           and probably too clever: the resampling happens in
+           multiple passes, among buffers internal to nrrdResample;
+           so its okay have the output and input nrrds be the same:
+           they're never used at the same time. */
+        if (!E) E |= nrrdResampleInputSet(rsmc, niter);
+      }
+      timeDo = (timeLeft > timeStepMax
+                ? timeStepMax
+                : timeLeft);
+      /* it is the repeated re-setting of this parm[0] which motivated
+         copying to our own kernel spec, so that the given one in the
+         gageStackBlurParm can stay untouched */
+      kssb->parm[0] = sqrt(timeDo);
+      for (axi=0; axi<3; axi++) {
+        if (!sbp->oneDim || !axi) {
+          /* we set the blurring kernel on this axis if
+             we are NOT doing oneDim, or, we are,
+             but this is axi == 0 */
+          if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
+                                             kssb->kernel,
+                                             kssb->parm);
+        } else {
+          /* what to do with oneDom on axi 1, 2 */
+          /* you might think that we should just do no resampling at all
+             on this axis, but that would undermine the in==out==niter
+             trick described above; and produce the mysterious behavior
+             that the second scale-space volume is all 0.0 */
+          double boxparm[NRRD_KERNEL_PARMS_NUM] = {1.0};
+          if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
+                                             nrrdKernelBox, boxparm);
+        }
+      }
+      if (verbose) {
+        fprintf(stderr, "  pass %u (timeLeft=%g => "
+                "time=%g, sigma=%g) ...\n",
+                passIdx, timeLeft, timeDo, kssb->parm[0]);
+      }
+      if (!E) E |= nrrdResampleExecute(rsmc, niter);
+      timeLeft -= timeDo;
+      passIdx++;
+    } while (!E && timeLeft > 0.0);
+    /* at this point we have to replicate the behavior of the
+       last stage of resampling (e.g. _nrrdResampleOutputUpdate
+       in nrrd/resampleContext.c), since we've gently hijacked
+       the resampling to access the nrrdResample_t blurring
+       result (for further blurring) */
+    if (!E) E |= nrrdCastClampRound(nout, niter, nin->type,
+                                    AIR_TRUE,
+                                    nrrdTypeIsIntegral[nin->type]);
+    if (!E) E |= nrrdContentSet_va(nout, "blur", nin, "");
+  } else { /* do blurring in one shot */
+    kssb->parm[0] = sbp->sigma[blIdx];
+    for (axi=0; axi<(sbp->oneDim ? 1u : 3u); axi++) {
+      if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
+                                         kssb->kernel,
+                                         kssb->parm);
+    }
+    if (!E) E |= nrrdResampleExecute(rsmc, nout);
+  }
+  return E;
+}
+
+/*
+** what is shared by the threads of _stackBlurSpatialThreaded; the
+** levels are handed out one at a time (under the mutex, if there is
+** one) starting from the last, since the biggest kernels take longest.
+** biff isn't thread-safe, so the workers don't use it: a level that
+** fails gets an error string in levelErr, which is turned into a biff
+** message after the threads are done
+*/
+typedef struct {
+  Nrrd *const *nblur;
+  const gageStackBlurParm *sbp;
+  const Nrrd *nin;
+  const gageKind *kind;
+  airThreadMutex *mutex;
+  unsigned int levelLeft;  /* # levels not yet handed out */
+  char *levelErr;          /* per-level error string (AIR_STRLEN_MED
+                              each), empty if there was no error */
+} _stackBlurTask;
+
+/* what one thread has to itself, all set up by the calling thread */
+typedef struct {
+  _stackBlurTask *task;
+  NrrdResampleContext *rsmc;
+  NrrdKernelSpec *kssb;    /* own copy, since parm[0] is set per level */
+} _stackBlurThread;
+
+static void *
+_stackBlurWorker(void *_sbt) {
+  _stackBlurThread *sbt;
+  _stackBlurTask *task;
+  unsigned int blIdx;
+
+  sbt = AIR_CAST(_stackBlurThread *, _sbt);
+  task = sbt->task;
+  do {
+    if (task->mutex) {
+      airThreadMutexLock(task->mutex);
+    }
+    blIdx = (task->levelLeft
+             ? --(task->levelLeft)
+             : UINT_MAX);
+    if (task->mutex) {
+      airThreadMutexUnlock(task->mutex);
+    }
+    if (UINT_MAX != blIdx
+        && _stackBlurLevel(task->nblur[blIdx], sbt->rsmc, NULL, sbt->kssb,
+                           task->sbp, blIdx, 0.0, AIR_FALSE,
+                           task->nin, task->kind)) {
+      sprintf(task->levelErr + AIR_STRLEN_MED*blIdx,
+              "couldn't blur level %u of %u (scale %g)",
+              blIdx, task->sbp->num, task->sbp->sigma[blIdx]);
+    }
+  } while (UINT_MAX != blIdx);
+  return _sbt;
+}
+
+/*
+** blurs the levels (all with one-shot blurring) on threadNum threads
+** (including the calling thread), each with its own resample context.
+** The contexts are set up here, so that in the threads, only
+** nrrdResampleExecute's own allocations can fail
+*/
+static int
+_stackBlurSpatialThreaded(Nrrd *const nblur[], gageStackBlurParm *sbp,
+                          NrrdKernelSpec *kssb, int rsmpType,
+                          unsigned int threadNum,
+                          const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurSpatialThreaded";
+  _stackBlurTask task;
+  _stackBlurThread *sbt;
+  unsigned int blIdx, ti;
+  airArray *mop;
+
+  mop = airMopNew();
+  task.levelErr = AIR_CALLOC(AIR_STRLEN_MED*sbp->num, char);
+  airMopAdd(mop, task.levelErr, airFree, airMopAlways);
+  sbt = AIR_CALLOC(threadNum, _stackBlurThread);
+  airMopAdd(mop, sbt, airFree, airMopAlways);
+  if (!( task.levelErr && sbt )) {
+    biffAddf(GAGE, "%s: couldn't allocate thread state", me);
+    airMopError(mop); return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    sbt[ti].task = &task;
+    sbt[ti].rsmc = nrrdResampleContextNew();
+    airMopAdd(mop, sbt[ti].rsmc, (airMopper)nrrdResampleContextNix,
+              airMopAlways);
+    sbt[ti].kssb = nrrdKernelSpecCopy(kssb);
+    airMopAdd(mop, sbt[ti].kssb, (airMopper)nrrdKernelSpecNix,
+              airMopAlways);
+    if (!( sbt[ti].rsmc && sbt[ti].kssb )) {
+      biffAddf(GAGE, "%s: couldn't allocate thread %u state", me, ti);
+      airMopError(mop); return 1;
+    }
+    if (_stackBlurRsmcSetup(sbt[ti].rsmc, sbp, rsmpType, nin, kind)) {
+      biffMovef(GAGE, NRRD, "%s: trouble setting up resampling", me);
+      airMopError(mop); return 1;
+    }
+  }
+  task.nblur = nblur;
+  task.sbp = sbp;
+  task.nin = nin;
+  task.kind = kind;
+  task.levelLeft = sbp->num;
+  if (sbp->verbose) {
+    fprintf(stderr, "%s: blurring %u levels with %u threads ... ", me,
+            sbp->num, threadNum);
+    fflush(stderr);
+  }
+  if (airThreadRun(threadNum, _stackBlurWorker, sbt,
+                   sizeof(_stackBlurThread), &task.mutex)) {
+    biffAddf(GAGE, "%s: couldn't start threads", me);
+    airMopError(mop); return 1;
+  }
+  for (blIdx=0; blIdx<sbp->num; blIdx++) {
+    if (task.levelErr[AIR_STRLEN_MED*blIdx]) {
+      if (sbp->verbose) {
+        fprintf(stderr, "problem!\n");
+      }
+      biffMovef(GAGE, NRRD, "%s: %s", me,
+                task.levelErr + AIR_STRLEN_MED*blIdx);
+      airMopError(mop); return 1;
+    }
+  }
+  if (sbp->verbose) {
+    fprintf(stderr, "done.\n");
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
+static int
+_stackBlurSpatial(Nrrd *const nblur[], gageStackBlurParm *sbp,
+                  NrrdKernelSpec *kssb,
+                  const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="_stackBlurSpatial";
+  NrrdResampleContext *rsmc;
+  Nrrd *niter;
+  unsigned int blIdx, threadNum;
+  int E, iterative, rsmpType;
+  double timeDone;    /* amount of diffusion time just applied */
+  airArray *mop;
+
+  if (nrrdKernelDiscreteGaussian == kssb->kernel) {
+    iterative = AIR_TRUE;
+    /* we don't want to lose precision when iterating */
+    rsmpType = nrrdResample_nt;
+  } else {
+    iterative = AIR_FALSE;
+    rsmpType = nrrdTypeDefault;
+  }
+  /* each level of iterative diffusion continues from the previous
+     one, so it is inherently serial; only one-shot blurring, which
+     computes each level from nin, is split among threads */
+  threadNum = (sbp->threadNum ? sbp->threadNum : nrrdStateThreadNum);
+  threadNum = (airThreadCapable && !iterative
+               ? AIR_MIN(threadNum, sbp->num)
+               : 1);
+  if (threadNum > 1) {
+    if (_stackBlurSpatialThreaded(nblur, sbp, kssb, rsmpType,
+                                  threadNum, nin, kind)) {
+      biffAddf(GAGE, "%s: trouble with threaded blurring", me);
+      return 1;
+    }
+    return 0;
+  }
+
+  mop = airMopNew();
+  rsmc = nrrdResampleContextNew();
+  airMopAdd(mop, rsmc, (airMopper)nrrdResampleContextNix, airMopAlways);
+  if (iterative) {
+    /* may be used with iterative diffusion */
+    niter = nrrdNew();
+    airMopAdd(mop, niter, (airMopper)nrrdNuke, airMopAlways);
+  } else {
+    niter = NULL;
+  }
+  if (_stackBlurRsmcSetup(rsmc, sbp, rsmpType, nin, kind)) {
+    biffMovef(GAGE, NRRD, "%s: trouble setting up resampling", me);
     airMopError(mop); return 1;
   }
 
   timeDone = 0;
-  timeStepMax = (sbp->dgGoodSigmaMax)*(sbp->dgGoodSigmaMax);
   for (blIdx=0; blIdx<sbp->num; blIdx++) {
     if (sbp->verbose) {
       fprintf(stderr, "%s: . . . blurring %u / %u (scale %g) . . . ",
               me, blIdx, sbp->num, sbp->sigma[blIdx]);
       fflush(stderr);
     }
+    E = _stackBlurLevel(nblur[blIdx], rsmc, niter, kssb, sbp,
+                        blIdx, timeDone, sbp->verbose,
+                        nin, kind);
     if (iterative) {
-      double timeNow = sbp->sigma[blIdx]*sbp->sigma[blIdx];
-      unsigned int passIdx = 0;
-      timeLeft = timeNow - timeDone;
-      if (sbp->verbose) {
-        fprintf(stderr, "\n");
-        fprintf(stderr, "%s: scale %g == time %g (tau %g);\n"
-                "               timeLeft %g = %g - %g\n",
-                me, sbp->sigma[blIdx], timeNow, gageTauOfTee(timeNow),
-                timeLeft, timeNow, timeDone);
-        if (timeLeft > timeStepMax) {
-          fprintf(stderr, "%s: diffusing for time %g in steps of %g\n", me,
-                  timeLeft, timeStepMax);
-        }
-        fflush(stderr);
-      }
-      do {
-        double timeDo;
-        if (blIdx || passIdx) {
-          /* either we're past the first scale (blIdx >= 1), or
-             (unlikely) we're on the first scale but after the first
-             pass of a multi-pass blurring, so we have to feed the
-             previous result back in as input.
-             AND: the way that niter is being used is very sneaky,
-             and probably too clever: the resampling happens in
-             multiple passes, among buffers internal to nrrdResample;
-             so its okay have the output and input nrrds be the same:
-             they're never used at the same time. */
-          if (!E) E |= nrrdResampleInputSet(rsmc, niter);
-        }
-        timeDo = (timeLeft > timeStepMax
-                  ? timeStepMax
-                  : timeLeft);
-        /* it is the repeated re-setting of this parm[0] which motivated
-           copying to our own kernel spec, so that the given one in the
-           gageStackBlurParm can stay untouched */
-        kssb->parm[0] = sqrt(timeDo);
-        for (axi=0; axi<3; axi++) {
-          if (!sbp->oneDim || !axi) {
-            /* we set the blurring kernel on this axis if
-               we are NOT doing oneDim, or, we are,
-               but this is axi == 0 */
-            if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
-                                               kssb->kernel,
-                                               kssb->parm);
-          } else {
-            /* what to do with oneDom on axi 1, 2 */
-            /* you might think that we should just do no resampling at all
-               on this axis, but that would undermine the in==out==niter
-               trick described above; and produce the mysterious behavior
-               that the second scale-space volume is all 0.0 */
-            double boxparm[NRRD_KERNEL_PARMS_NUM] = {1.0};
-            if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
-                                               nrrdKernelBox, boxparm);
-          }
-        }
-        if (sbp->verbose) {
-          fprintf(stderr, "  pass %u (timeLeft=%g => "
-                  "time=%g, sigma=%g) ...\n",
-                  passIdx, timeLeft, timeDo, kssb->parm[0]);
-        }
-        if (!E) E |= nrrdResampleExecute(rsmc, niter);
-        /* for debugging problem with getting zero output
-        if (!E) {
-          NrrdRange *nrange;
-          nrange = nrrdRangeNewSet(niter, AIR_FALSE);
-          fprintf(stderr, "%s: min/max = %g/%g\n", me,
-                  nrange->min, nrange->max);
-          if (!nrange->min || !nrange->max) {
-            fprintf(stderr, "%s: what? zero zero\n", me);
-            biffAddf(GAGE, "%s: no good", me);
-            airMopError(mop); return 1;
-          }
-        }
-        */
-        timeLeft -= timeDo;
-        passIdx++;
-      } while (!E && timeLeft > 0.0);
-      /* at this point we have to replicate the behavior of the
-         last stage of resampling (e.g. _nrrdResampleOutputUpdate
-         in nrrd/resampleContext.c), since we've gently hijacked
-         the resampling to access the nrrdResample_t blurring
-         result (for further blurring) */
-      if (!E) E |= nrrdCastClampRound(nblur[blIdx], niter, nin->type,
-                                      AIR_TRUE,
-                                      nrrdTypeIsIntegral[nin->type]);
-      if (!E) E |= nrrdContentSet_va(nblur[blIdx], "blur", nin, "");
-      timeDone = timeNow;
-    } else { /* do blurring in one shot */
-      kssb->parm[0] = sbp->sigma[blIdx];
-      for (axi=0; axi<(sbp->oneDim ? 1u : 3u); axi++) {
-        if (!E) E |= nrrdResampleKernelSet(rsmc, kind->baseDim + axi,
-                                           kssb->kernel,
-                                           kssb->parm);
-      }
-      if (!E) E |= nrrdResampleExecute(rsmc, nblur[blIdx]);
+      timeDone = sbp->sigma[blIdx]*sbp->sigma[blIdx];
     }
     if (E) {
       if (sbp->verbose) {
@@ -1731,7 +1938,7 @@ gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
       }
       nio = nrrdIoStateNew();
       airMopAdd(mop, nio, (airMopper)nrrdIoStateNix, airMopAlways);
-      if (!E) E |= nrrdIoStateEncodingSet(nio, nrrdEncodingGzip);
+      if (!E) E |= nrrdIoStateEncodingSet(nio, enc);
     } else {
       nio = NULL;
     }
@@ -1747,3 +1954,122 @@ gageStackBlurManage(Nrrd ***nblurP, int *recomputedP,
   airMopOkay(mop);
   return 0;
 }
+
+/* appends str to key, or returns non-zero if it won't fit */
+static int
+_stackBlurKeyCat(char key[AIR_STRLEN_HUGE], const char *str) {
+
+  if (strlen(key) + strlen(str) + 1 > AIR_STRLEN_HUGE) {
+    return 1;
+  }
+  strcat(key, str);
+  return 0;
+}
+
+/*
+******** gageStackBlurCacheFormat
+**
+** sets in "format" the gageStackBlurManage-style filename format (with
+** a single "%u" for the level) for the blurrings of nin that would be
+** produced by sbp, in directory cacheDir.  The name is a 64-bit xxHash
+** of the data in nin, combined with everything else that determines the
+** blurring: the gageStackBlurParmSprint of sbp (with the verbosity and
+** thread number zeroed, since they don't matter), the kind, the type,
+** and the sizes. Since gageStackBlurCheck also checks the CRC32 of nin
+** recorded in the blurrings, a hash collision causes only a needless
+** recomputation, not wrong blurrings.
+*/
+int
+gageStackBlurCacheFormat(char format[AIR_STRLEN_HUGE],
+                         const char *cacheDir,
+                         const gageStackBlurParm *sbp,
+                         const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="gageStackBlurCacheFormat";
+  char key[AIR_STRLEN_HUGE], sizeS[AIR_STRLEN_SMALL];
+  gageStackBlurParm keyParm;
+  airULLong hash;
+  unsigned int axi;
+  int E;
+
+  if (!( format && cacheDir && sbp && nin && kind )) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!airStrlen(cacheDir)) {
+    biffAddf(GAGE, "%s: got empty cache directory", me);
+    return 1;
+  }
+  /* a shallow copy is enough: Sprint only reads it */
+  keyParm = *sbp;
+  keyParm.verbose = 0;
+  keyParm.threadNum = 0;
+  if (gageStackBlurParmSprint(key, &keyParm, NULL, NULL)) {
+    biffAddf(GAGE, "%s: trouble describing blur parms", me);
+    return 1;
+  }
+  E = 0;
+  if (!E) E |= _stackBlurKeyCat(key, "/");
+  if (!E) E |= _stackBlurKeyCat(key, kind->name);
+  if (!E) E |= _stackBlurKeyCat(key, "/");
+  if (!E) E |= _stackBlurKeyCat(key, airEnumStr(nrrdType, nin->type));
+  for (axi=0; axi<nin->dim; axi++) {
+    if (!E) E |= _stackBlurKeyCat(key, axi ? "x" : "/");
+    if (!E) E |= _stackBlurKeyCat(key, airSprintSize_t(sizeS,
+                                                       nin->axis[axi].size));
+  }
+  if (E) {
+    biffAddf(GAGE, "%s: description of blurring too long", me);
+    return 1;
+  }
+  hash = airXXH64(AIR_CAST(const unsigned char *, key), strlen(key), 1,
+                  AIR_FALSE, nrrdXXH64(nin, airEndianLittle));
+  if (strlen(cacheDir) + AIR_STRLEN_SMALL > AIR_STRLEN_HUGE) {
+    biffAddf(GAGE, "%s: cache directory name too long", me);
+    return 1;
+  }
+  sprintf(format, "%s/gsb-%08x%08x-%%02u.nrrd", cacheDir,
+          AIR_CAST(unsigned int, hash >> 32),
+          AIR_CAST(unsigned int, hash & 0xffffffff));
+  return 0;
+}
+
+/*
+******** gageStackBlurCache
+**
+** gageStackBlurManage, but with the filenames chosen automatically (by
+** gageStackBlurCacheFormat) within cacheDir, so that re-running with the
+** same input and the same blurring parameters reuses the saved
+** blurrings.  Recomputed blurrings are saved gzip-compressed when
+** available, and raw otherwise.
+*/
+int
+gageStackBlurCache(Nrrd ***nblurP, int *recomputedP,
+                   gageStackBlurParm *sbp,
+                   const char *cacheDir,
+                   const Nrrd *nin, const gageKind *kind) {
+  static const char me[]="gageStackBlurCache";
+  char format[AIR_STRLEN_HUGE];
+
+  if (!( nblurP && sbp && cacheDir && nin && kind )) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (gageStackBlurParmCheck(sbp)
+      || gageStackBlurCacheFormat(format, cacheDir, sbp, nin, kind)) {
+    biffAddf(GAGE, "%s: trouble setting up cache", me);
+    return 1;
+  }
+  if (sbp->verbose) {
+    fprintf(stderr, "%s: using cache files \"%s\"\n", me, format);
+  }
+  if (gageStackBlurManage(nblurP, recomputedP, sbp, format, AIR_TRUE,
+                          AIR_CAST(NrrdEncoding *,
+                                   (nrrdEncodingGzip->available()
+                                    ? nrrdEncodingGzip
+                                    : nrrdEncodingRaw)),
+                          nin, kind)) {
+    biffAddf(GAGE, "%s: trouble", me);
+    return 1;
+  }
+  return 0;
+}
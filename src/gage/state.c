@@ -0,0 +1,259 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "gage.h"
+#include "privateGage.h"
+
+/*
+** _gageProbeStatePvlNix
+**
+** frees what the probe state owns in a copied pervolume (but not the
+** things it shares with the pervolume of the parent context)
+*/
+static gagePerVolume *
+_gageProbeStatePvlNix(gagePerVolume *nvl) {
+
+  if (nvl) {
+    if (nvl->data && nvl->kind->pvlDataNix) {
+      nvl->data = nvl->kind->pvlDataNix(nvl->kind, nvl->data);
+    }
+    airFree(nvl->iv3);
+    airFree(nvl->iv2);
+    airFree(nvl->iv1);
+    airFree(nvl->iv3f);
+    airFree(nvl->iv2f);
+    airFree(nvl->iv1f);
+    airFree(nvl->answer);
+    airFree(nvl->directAnswer);
+    airFree(nvl);
+  }
+  return NULL;
+}
+
+/*
+** _gageProbeStatePvlNew
+**
+** like _gagePerVolumeCopy(), but allocates only what is needed for
+** probing: the float caches only if the pervolume is being filtered
+** in single precision
+*/
+static gagePerVolume *
+_gageProbeStatePvlNew(const gagePerVolume *pvl, unsigned int fd) {
+  static const char me[]="_gageProbeStatePvlNew";
+  gagePerVolume *nvl;
+  unsigned int valLen, ii;
+
+  nvl = AIR_CALLOC(1, gagePerVolume);
+  if (!nvl) {
+    biffAddf(GAGE, "%s: couldn't create new pervolume", me);
+    return NULL;
+  }
+  memcpy(nvl, pvl, sizeof(gagePerVolume));
+  /* forget the pointers to what is owned by the original */
+  nvl->iv3 = nvl->iv2 = nvl->iv1 = NULL;
+  nvl->iv3f = nvl->iv2f = nvl->iv1f = NULL;
+  nvl->answer = NULL;
+  nvl->directAnswer = NULL;
+  nvl->data = NULL;
+  valLen = nvl->kind->valLen;
+  nvl->iv3 = AIR_CALLOC(fd*fd*fd*valLen, double);
+  nvl->iv2 = AIR_CALLOC(fd*fd*valLen, double);
+  nvl->iv1 = AIR_CALLOC(fd*valLen, double);
+  if (nvl->singlePrecision) {
+    nvl->iv3f = AIR_CALLOC(fd*fd*fd*valLen, float);
+    nvl->iv2f = AIR_CALLOC(fd*fd*valLen, float);
+    nvl->iv1f = AIR_CALLOC(fd*valLen, float);
+  }
+  nvl->answer = AIR_CALLOC(gageKindTotalAnswerLength(nvl->kind), double);
+  nvl->directAnswer = AIR_CALLOC(nvl->kind->itemMax+1, double*);
+  if (!( nvl->iv3 && nvl->iv2 && nvl->iv1
+         && (!nvl->singlePrecision || (nvl->iv3f && nvl->iv2f && nvl->iv1f))
+         && nvl->answer && nvl->directAnswer )) {
+    biffAddf(GAGE, "%s: couldn't allocate all caches "
+             "(fd=%u, valLen=%u, totAnsLen=%u, itemMax=%u)", me,
+             fd, valLen, gageKindTotalAnswerLength(nvl->kind),
+             nvl->kind->itemMax);
+    _gageProbeStatePvlNix(nvl); return NULL;
+  }
+  for (ii=1; ii<=AIR_UINT(nvl->kind->itemMax); ii++) {
+    nvl->directAnswer[ii] = nvl->answer + gageKindAnswerOffset(nvl->kind, ii);
+  }
+  if (pvl->kind->pvlDataCopy) {
+    if (!(nvl->data = pvl->kind->pvlDataCopy(pvl->kind, pvl->data))) {
+      biffAddf(GAGE, "%s: couldn't copy gagePerVolume data", me);
+      _gageProbeStatePvlNix(nvl); return NULL;
+    }
+  }
+  return nvl;
+}
+
+/*
+******** gageProbeStateNew()
+**
+** creates the per-thread state for probing the given context, which
+** must already have been gageUpdate()d.  Compared to gageContextCopy(),
+** the kernels, shape, offsets, and pervolume queries are not copied,
+** and changes to the parent context can't go unnoticed by getting out
+** of sync with the copies: the parent context must not change at all
+** while there are probe states of it.
+*/
+gageProbeState * /*Teem: biff if (!ret) */
+gageProbeStateNew(const gageContext *ctx) {
+  static const char me[]="gageProbeStateNew";
+  gageProbeState *gps;
+  gageContext *ntx;
+  unsigned int fd, pvlIdx, fi;
+
+  if (!ctx) {
+    biffAddf(GAGE, "%s: got NULL pointer", me);
+    return NULL;
+  }
+  if (!( ctx->pvlNum && ctx->radius && ctx->fsl && ctx->fw )) {
+    biffAddf(GAGE, "%s: context doesn't seem to have been updated", me);
+    return NULL;
+  }
+  for (fi=gageCtxFlagUnknown+1; fi<gageCtxFlagLast; fi++) {
+    if (ctx->flag[fi]) {
+      biffAddf(GAGE, "%s: context flag %u set; need gageUpdate()", me, fi);
+      return NULL;
+    }
+  }
+  for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+    /* gageUpdate() doesn't lower gagePvlFlagVolume */
+    for (fi=gagePvlFlagVolume+1; fi<gagePvlFlagLast; fi++) {
+      if (ctx->pvl[pvlIdx]->flag[fi]) {
+        biffAddf(GAGE, "%s: pvl[%u] flag %u set; need gageUpdate()",
+                 me, pvlIdx, fi);
+        return NULL;
+      }
+    }
+  }
+
+  gps = AIR_CALLOC(1, gageProbeState);
+  ntx = AIR_CALLOC(1, gageContext);
+  if (!( gps && ntx )) {
+    biffAddf(GAGE, "%s: couldn't allocate probe state", me);
+    airFree(gps); airFree(ntx); return NULL;
+  }
+  gps->parent = ctx;
+  gps->ctx = ntx;
+  memcpy(ntx, ctx, sizeof(gageContext));
+  /* forget the pointers to what is owned by the parent; the kernel
+     specs, shape, stackPos, and offsets remain shared */
+  ntx->pvl = NULL;
+  ntx->pvlArr = NULL;
+  ntx->stackFsl = ntx->stackFw = NULL;
+  ntx->fsl = ntx->fw = NULL;
+  ntx->fwf = NULL;
+
+  ntx->pvl = AIR_CALLOC(ctx->pvlNum, gagePerVolume *);
+  if (!ntx->pvl) {
+    biffAddf(GAGE, "%s: couldn't allocate pvl array", me);
+    gageProbeStateNix(gps); return NULL;
+  }
+  fd = 2*ctx->radius;
+  for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+    ntx->pvl[pvlIdx] = _gageProbeStatePvlNew(ctx->pvl[pvlIdx], fd);
+    if (!ntx->pvl[pvlIdx]) {
+      biffAddf(GAGE, "%s: trouble with pervolume %u", me, pvlIdx);
+      gageProbeStateNix(gps); return NULL;
+    }
+  }
+  if (ctx->stackFsl && ctx->stackFw) {
+    ntx->stackFsl = AIR_CALLOC(ctx->pvlNum-1, double);
+    ntx->stackFw = AIR_CALLOC(ctx->pvlNum-1, double);
+    if (!( ntx->stackFsl && ntx->stackFw )) {
+      biffAddf(GAGE, "%s: couldn't allocate stack Fsl, Fw", me);
+      gageProbeStateNix(gps); return NULL;
+    }
+  }
+  ntx->fsl = AIR_CALLOC(fd*3, double);
+  ntx->fw = AIR_CALLOC(fd*3*(GAGE_KERNEL_MAX+1), double);
+  if (ctx->parm.singlePrecision) {
+    ntx->fwf = AIR_CALLOC(fd*3*(GAGE_KERNEL_MAX+1), float);
+  }
+  if (!( ntx->fsl && ntx->fw && (!ctx->parm.singlePrecision || ntx->fwf) )) {
+    biffAddf(GAGE, "%s: couldn't allocate filter caches for fd=%u", me, fd);
+    gageProbeStateNix(gps); return NULL;
+  }
+
+  /* make sure gageProbe() has to fill caches */
+  gagePointReset(&ntx->point);
+  strcpy(ntx->errStr, "");
+  ntx->errNum = gageErrNone;
+  ntx->edgeFrac = 0;
+  gageContextStatsReset(ntx);
+  return gps;
+}
+
+/*
+******** gageProbeStateNix()
+**
+** frees everything owned by the probe state; the parent context is
+** not touched
+**
+** does not use biff
+*/
+gageProbeState *
+gageProbeStateNix(gageProbeState *gps) {
+  gageContext *ntx;
+  unsigned int pvlIdx;
+
+  if (gps) {
+    ntx = gps->ctx;
+    if (ntx) {
+      if (ntx->pvl) {
+        for (pvlIdx=0; pvlIdx<ntx->pvlNum; pvlIdx++) {
+          _gageProbeStatePvlNix(ntx->pvl[pvlIdx]);
+        }
+        airFree(ntx->pvl);
+      }
+      airFree(ntx->stackFsl);
+      airFree(ntx->stackFw);
+      airFree(ntx->fsl);
+      airFree(ntx->fw);
+      airFree(ntx->fwf);
+      airFree(ntx);
+    }
+    airFree(gps);
+  }
+  return NULL;
+}
+
+/*
+******** gageProbeWith()
+**
+** same as gageProbe(), but with a probe state, so that threads can
+** probe the same context at the same time.  Answers are found in the
+** pervolumes of the probe state, via
+** gageAnswerPointer(gps->ctx, gps->ctx->pvl[i], item).  gageProbeSpace(),
+** gageStackProbe(), etc. can also be called on gps->ctx.
+*/
+int
+gageProbeWith(gageProbeState *gps, double xi, double yi, double zi) {
+
+  if (!gps) {
+    return 1;
+  }
+  return _gageProbe(gps->ctx, xi, yi, zi, 0.0);
+}
@@ -0,0 +1,173 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "gage.h"
+#include "privateGage.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  include <intrin.h>
+#endif
+
+/*
+** _gageStatsTick
+**
+** a cheap and fine-grained clock for timing the phases of gageProbe()
+** when parm.stats is set: the x86 time-stamp counter where we know how
+** to read it, otherwise microseconds from airTime()
+*/
+airULLong
+_gageStatsTick(void) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  unsigned int lo, hi;
+
+  __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+  return (AIR_CAST(airULLong, hi) << 32) | lo;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  return __rdtsc();
+#else
+  return AIR_CAST(airULLong, 1000000.0*airTime());
+#endif
+}
+
+/*
+******** gageContextStatsReset
+**
+** zeros the counts and times in ctx->stats, and the iv3 cache fill
+** counts; this is done by gageUpdate(), and can also be done before
+** probing something in particular
+*/
+void
+gageContextStatsReset(gageContext *ctx) {
+
+  if (ctx) {
+    ctx->iv3FillNum = ctx->iv3ShiftNum = 0;
+    ctx->stats.probeNum = 0;
+    ctx->stats.outsideNum = 0;
+    ctx->stats.edgeNum = 0;
+    ctx->stats.weightNum = 0;
+    ctx->stats.stackNum = 0;
+    ctx->stats.locationTick = 0;
+    ctx->stats.fillTick = 0;
+    ctx->stats.filterTick = 0;
+    ctx->stats.answerTick = 0;
+    ctx->stats.timeStart = airTime();
+    ctx->stats.tickStart = _gageStatsTick();
+  }
+  return;
+}
+
+/*
+******** gageContextStatsAdd
+**
+** adds the counts and times in "from" (such as the ctx of a
+** gageProbeState) to those in ctx, and the iv3 cache fill counts,
+** for a summary of probing done on multiple threads (in which the
+** times are then summed over the threads)
+*/
+void
+gageContextStatsAdd(gageContext *ctx, const gageContext *from) {
+
+  if (ctx && from) {
+    ctx->iv3FillNum += from->iv3FillNum;
+    ctx->iv3ShiftNum += from->iv3ShiftNum;
+    ctx->stats.probeNum += from->stats.probeNum;
+    ctx->stats.outsideNum += from->stats.outsideNum;
+    ctx->stats.edgeNum += from->stats.edgeNum;
+    ctx->stats.weightNum += from->stats.weightNum;
+    ctx->stats.stackNum += from->stats.stackNum;
+    ctx->stats.locationTick += from->stats.locationTick;
+    ctx->stats.fillTick += from->stats.fillTick;
+    ctx->stats.filterTick += from->stats.filterTick;
+    ctx->stats.answerTick += from->stats.answerTick;
+  }
+  return;
+}
+
+static void
+_gageStatsPhasePrint(FILE *file, const char *name, airULLong tick,
+                     airULLong total, size_t probeNum, double secPerTick) {
+  double dtick;
+
+  dtick = AIR_CAST(double, tick);
+  fprintf(file, "  %8s: %5.1f%% = %10.1f ticks/probe", name,
+          total ? 100*dtick/AIR_CAST(double, total) : 0.0,
+          probeNum ? dtick/AIR_CAST(double, probeNum) : 0.0);
+  if (secPerTick > 0) {
+    fprintf(file, " = %.4g sec", secPerTick*dtick);
+  }
+  fprintf(file, "\n");
+  return;
+}
+
+/*
+******** gageContextStatsPrint
+**
+** prints a summary of ctx->stats and the iv3 cache fill counts.  The
+** ticks are converted to seconds (assuming they come at a steady rate)
+** by comparing with the time elapsed since the stats were reset.
+*/
+void
+gageContextStatsPrint(FILE *file, const gageContext *ctx) {
+  static const char me[]="gageContextStatsPrint";
+  const gageStats *st;
+  char stmp[5][AIR_STRLEN_SMALL];
+  airULLong total, tickNow;
+  double secPerTick, timeNow;
+
+  if (!( file && ctx )) {
+    return;
+  }
+  st = &(ctx->stats);
+  fprintf(file, "%s: iv3 caches: %s complete fills, %s shifts\n", me,
+          airSprintSize_t(stmp[0], ctx->iv3FillNum),
+          airSprintSize_t(stmp[1], ctx->iv3ShiftNum));
+  if (!ctx->parm.stats) {
+    fprintf(file, "%s: (set gageParmStats for more)\n", me);
+    return;
+  }
+  fprintf(file, "%s: %s probes: %s outside, %s near edge, %s in stack; "
+          "%s weight sets\n", me,
+          airSprintSize_t(stmp[0], st->probeNum),
+          airSprintSize_t(stmp[1], st->outsideNum),
+          airSprintSize_t(stmp[2], st->edgeNum),
+          airSprintSize_t(stmp[3], st->stackNum),
+          airSprintSize_t(stmp[4], st->weightNum));
+  timeNow = airTime();
+  tickNow = _gageStatsTick();
+  secPerTick = (tickNow > st->tickStart && timeNow > st->timeStart
+                ? ((timeNow - st->timeStart)
+                   / AIR_CAST(double, tickNow - st->tickStart))
+                : 0.0);
+  total = st->locationTick + st->fillTick + st->filterTick + st->answerTick;
+  _gageStatsPhasePrint(file, "location", st->locationTick, total,
+                       st->probeNum, secPerTick);
+  _gageStatsPhasePrint(file, "fill", st->fillTick, total,
+                       st->probeNum, secPerTick);
+  _gageStatsPhasePrint(file, "filter", st->filterTick, total,
+                       st->probeNum, secPerTick);
+  _gageStatsPhasePrint(file, "answer", st->answerTick, total,
+                       st->probeNum, secPerTick);
+  _gageStatsPhasePrint(file, "total", total, total,
+                       st->probeNum, secPerTick);
+  return;
+}
@@ -36,7 +36,8 @@ main(int argc, const char *argv[]) {
   char *err, *outS;
   double sigma[2], convEps, cutoff;
   int measr[2], tentRecon;
-  unsigned int sampleNum[2], dim, measrSampleNum, maxIter, num, ii;
+  unsigned int sampleNum[2], dim, measrSampleNum, maxIter, num, ii,
+    threadNum;
   gageOptimSigContext *osctx;
   double *scalePos, *out, info[512];
   Nrrd *nout;
@@ -61,6 +62,9 @@ main(int argc, const char *argv[]) {
              "maximum # iterations");
   hestOptAdd(&hopt, "N", "# samp", airTypeUInt, 1, 1, &measrSampleNum, "300",
              "number of samples in the measurement of error across scales");
+  hestOptAdd(&hopt, "nt", "# threads", airTypeUInt, 1, 1, &threadNum, "1",
+             "number of threads to measure errors across scales with; "
+             "the results are the same with any number");
   hestOptAdd(&hopt, "eps", "eps", airTypeDouble, 1, 1, &convEps, "0.0001",
              "convergence threshold for optimization");
   hestOptAdd(&hopt, "m", "m1 m2", airTypeEnum, 2, 2, measr, "l2 l2",
@@ -98,6 +102,7 @@ main(int argc, const char *argv[]) {
   }
   airMopAdd(mop, osctx, AIR_CAST(airMopper, gageOptimSigContextNix),
             airMopAlways);
+  osctx->threadNum = threadNum;
 
   scalePos = AIR_CALLOC(sampleNum[1], double);
   airMopAdd(mop, scalePos, airFree, airMopAlways);
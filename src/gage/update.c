@@ -255,11 +255,13 @@ _gageCacheSizeUpdate(gageContext *ctx) {
   fd = 2*ctx->radius;
   ctx->fsl = (double *)airFree(ctx->fsl);
   ctx->fw = (double *)airFree(ctx->fw);
-  ctx->off = (unsigned int *)airFree(ctx->off);
+  ctx->fwf = (float *)airFree(ctx->fwf);
+  ctx->off = (size_t *)airFree(ctx->off);
   ctx->fsl = (double *)calloc(fd*3, sizeof(double));
   ctx->fw = (double *)calloc(fd*3*(GAGE_KERNEL_MAX+1), sizeof(double));
-  ctx->off = (unsigned int *)calloc(fd*fd*fd, sizeof(unsigned int));
-  if (!(ctx->fsl && ctx->fw && ctx->off)) {
+  ctx->fwf = (float *)calloc(fd*3*(GAGE_KERNEL_MAX+1), sizeof(float));
+  ctx->off = (size_t *)calloc(fd*fd*fd, sizeof(size_t));
+  if (!(ctx->fsl && ctx->fw && ctx->fwf && ctx->off)) {
     biffAddf(GAGE, "%s: couldn't allocate filter caches for fd=%d", me, fd);
     return 1;
   }
@@ -271,10 +273,17 @@ _gageCacheSizeUpdate(gageContext *ctx) {
     pvl->iv3 = (double *)airFree(pvl->iv3);
     pvl->iv2 = (double *)airFree(pvl->iv2);
     pvl->iv1 = (double *)airFree(pvl->iv1);
+    pvl->iv3f = (float *)airFree(pvl->iv3f);
+    pvl->iv2f = (float *)airFree(pvl->iv2f);
+    pvl->iv1f = (float *)airFree(pvl->iv1f);
     pvl->iv3 = (double *)calloc(fd*fd*fd*pvl->kind->valLen, sizeof(double));
     pvl->iv2 = (double *)calloc(fd*fd*pvl->kind->valLen, sizeof(double));
     pvl->iv1 = (double *)calloc(fd*pvl->kind->valLen, sizeof(double));
-    if (!(pvl->iv3 && pvl->iv2 && pvl->iv1)) {
+    pvl->iv3f = (float *)calloc(fd*fd*fd*pvl->kind->valLen, sizeof(float));
+    pvl->iv2f = (float *)calloc(fd*fd*pvl->kind->valLen, sizeof(float));
+    pvl->iv1f = (float *)calloc(fd*pvl->kind->valLen, sizeof(float));
+    if (!(pvl->iv3 && pvl->iv2 && pvl->iv1
+          && pvl->iv3f && pvl->iv2f && pvl->iv1f)) {
       biffAddf(GAGE, "%s: couldn't allocate pvl[%d]'s value caches for fd=%d",
                me, pvlIdx, fd);
       return 1;
@@ -285,11 +294,35 @@ _gageCacheSizeUpdate(gageContext *ctx) {
   return 0;
 }
 
+/*
+** _gageSinglePrecisionUpdate
+**
+** sets pvl->singlePrecision in all pervolumes, according to
+** ctx->parm.singlePrecision, and whether the pervolume's kind filters with
+** the gageScl3PFilter functions (the scalar and vector kinds), which have
+** single-precision versions
+*/
+void
+_gageSinglePrecisionUpdate(gageContext *ctx) {
+  gagePerVolume *pvl;
+  unsigned int pvlIdx;
+
+  for (pvlIdx=0; pvlIdx<ctx->pvlNum; pvlIdx++) {
+    pvl = ctx->pvl[pvlIdx];
+    pvl->singlePrecision = (ctx->parm.singlePrecision
+                            && !ctx->parm.stackUse
+                            && pvl->iv3FillF
+                            && (_gageSclFilter == pvl->kind->filter
+                                || _gageVecFilter == pvl->kind->filter));
+  }
+  return;
+}
+
 void
 _gageOffValueUpdate(gageContext *ctx) {
   static const char me[]="_gageOffValueUpdate";
   int fd, i, j, k;
-  unsigned int sx, sy;
+  size_t sx, sy;
 
   if (ctx->verbose) fprintf(stderr, "%s: hello\n", me);
 
@@ -416,10 +449,18 @@ gageUpdate(gageContext *ctx) {
     ctx->flag[gageCtxFlagShape] = AIR_FALSE;
   }
   ctx->flag[gageCtxFlagRadius] = AIR_FALSE;
+  for (pi=0; pi<ctx->pvlNum; pi++) {
+    _gageIv3FillSelect(ctx->pvl[pi]);
+  }
+  if (_gageBrickUpdate(ctx)) {
+    biffAddf(GAGE, "%s: trouble", me); return 1;
+  }
+  _gageSinglePrecisionUpdate(ctx);
 
   /* chances are, something above has invalidated the state maintained
      during successive calls to gageProbe() */
   gagePointReset(&ctx->point);
+  gageContextStatsReset(ctx);
 
   for (pi=0; pi<ctx->pvlNum; pi++) {
     if (ctx->pvl[pi]->kind->pvlDataUpdate) {
@@ -115,6 +115,35 @@ _gageVecFilter(gageContext *ctx, gagePerVolume *pvl) {
     fprintf(stderr, "!%s: sorry, 6pack filtering not implemented\n", me);
     return;
   }
+  if (pvl->singlePrecision) {
+    float *fwf00, *fwf11, *fwf22;
+    _gageScl3PFilterF_t *filterF[5] = {NULL,
+                                       _gageScl3PFilterF2, _gageScl3PFilterF4,
+                                       _gageScl3PFilterF6, _gageScl3PFilterF8};
+    fwf00 = ctx->fwf + fd*3*gageKernel00;
+    fwf11 = ctx->fwf + fd*3*gageKernel11;
+    fwf22 = ctx->fwf + fd*3*gageKernel22;
+    for (valIdx=0; valIdx<3; valIdx++) {
+      if (fd <= 8) {
+        filterF[ctx->radius](ctx->shape,
+                             pvl->iv3f + valIdx*fd*fd*fd,
+                             pvl->iv2f + valIdx*fd*fd,
+                             pvl->iv1f + valIdx*fd,
+                             fwf00, fwf11, fwf22,
+                             vec + valIdx, jac + valIdx*3, hes + valIdx*9,
+                             pvl->needD);
+      } else {
+        _gageScl3PFilterFN(ctx->shape, fd,
+                           pvl->iv3f + valIdx*fd*fd*fd,
+                           pvl->iv2f + valIdx*fd*fd,
+                           pvl->iv1f + valIdx*fd,
+                           fwf00, fwf11, fwf22,
+                           vec + valIdx, jac + valIdx*3, hes + valIdx*9,
+                           pvl->needD);
+      }
+    }
+    return;
+  }
   fw00 = ctx->fw + fd*3*gageKernel00;
   fw11 = ctx->fw + fd*3*gageKernel11;
   fw22 = ctx->fw + fd*3*gageKernel22;
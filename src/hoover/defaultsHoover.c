@@ -32,6 +32,8 @@ int
 hooverDefVolCentering = nrrdCenterNode;
 int
 hooverDefImgCentering = nrrdCenterCell;
+unsigned int
+hooverDefTileSize = 16;
 
 const char *
 _hooverErrStr[HOOVER_ERR_MAX+1] = {
@@ -52,6 +52,7 @@ extern "C" {
 #define HOOVER hooverBiffKey
 
 #define HOOVER_THREAD_MAX 512
+#define HOOVER_PACKET_MAX 8
 
 /*
 ******** the mess of typedefs for callbacks used below
@@ -81,6 +82,17 @@ typedef double (hooverSample_t)(void *thread,
                                 int inside, /* sample is inside the volume */
                                 double samplePosWorld[3],
                                 double samplePosIndex[3]);
+typedef double (hooverPacketSample_t)(void *thread,
+                                      void *render,
+                                      void *user,
+                                      unsigned int packNum, /* # samples */
+                                      int num,    /* which sample the first
+                                                     one is, 0-based */
+                                      const double *rayT,
+                                      const int *inside,
+                                      const double *samplePosWorld,
+                                      const double *samplePosIndex,
+                                      unsigned int *doneNumP);
 typedef int (hooverRayEnd_t)(void *thread,
                              void *render,
                              void *user);
@@ -89,17 +101,94 @@ typedef int (hooverThreadEnd_t)(void *thread,
                                 void *user);
 typedef int (hooverRenderEnd_t)(void *rend, void *user);
 
+/*
+******** hooverSkip struct
+**
+** A grid of blocks ("macrocells") over a scalar volume, for skipping
+** empty space.  For each block we store an interval that contains all
+** the values that can be reconstructed (with a given kernel) anywhere
+** in the block, and from that, given the ranges of value for which
+** something is visible (as from the transfer function), whether the
+** block is empty.  Block (bx,by,bz) covers the positions in index space
+** whose floor() is in [bx*blockSize, (bx+1)*blockSize-1] (and
+** similarly for Y and Z), with the positions outside the volume going
+** to the nearest block.  The intervals depend only on the volume and
+** kernel (set by hooverSkipRangeSet) while emptiness also depends on
+** the visible ranges (set by hooverSkipEmptySet), so that the cheaper
+** latter can be re-done when only the transfer function changes.
+*/
+typedef struct {
+  unsigned int blockSize,    /* edge length, in voxels, of the blocks */
+    volSize[3],              /* size of the volume the blocks were made
+                                from, which has to match what hoover is
+                                rendering */
+    size[3];                 /* number of blocks along each axis */
+  double *range;             /* per-block (min,max) of reconstructable
+                                values, 2*size[0]*size[1]*size[2] values */
+  unsigned char *empty;      /* per-block: non-zero if the block is empty,
+                                size[0]*size[1]*size[2] values, or NULL if
+                                emptiness hasn't been set yet */
+  unsigned int emptyNum;     /* number of empty blocks */
+} hooverSkip;
+
+/*
+******** hooverThreadStats struct
+**
+** What one thread did during one hooverRender().  The counts and times
+** are only recorded when the hooverContext has somewhere to put them
+** (its "stats"), since timing every sample isn't free.  All times are
+** in seconds.
+*/
+typedef struct {
+  size_t tileNum,            /* work assignments (tiles) taken */
+    rayNum,                  /* rays cast */
+    rayStopNum,              /* rays that sample() ended (by returning
+                                0.0), as with early ray termination,
+                                rather than leaving the near-far range */
+    sampleNum,               /* samples passed to sample() (or to
+                                packetSample()) */
+    skipNum;                 /* samples stepped over as empty space */
+  double time,               /* from the start to the end of the thread */
+    sampleTime,              /* spent in sample(), for the samples inside
+                                the volume (the ones outside are many,
+                                cheap, and not worth timing), and in
+                                packetSample(), for packets with a sample
+                                inside the volume */
+    probeTime,               /* not set by hoover: the part of sampleTime
+                                that the callbacks spent probing the volume
+                                (as with gage), if they record it (in
+                                threadEnd()); the rest is shading */
+    waitTime,                /* waiting to get work assignments */
+    idleTime;                /* done, waiting for the slowest thread */
+} hooverThreadStats;
+
+/*
+******** hooverStats struct
+**
+** Where hooverRender() puts the per-thread statistics, and their sums,
+** so that one can see where the time went, and how evenly the work was
+** spread across threads.
+*/
+typedef struct {
+  unsigned int threadNum;    /* number of threads used (of thread[]) */
+  double time;               /* of the whole hooverRender() */
+  hooverThreadStats total,   /* sums over all threads */
+    thread[HOOVER_THREAD_MAX];
+} hooverStats;
+
 /*
 ******** hooverContext struct
 **
 ** Everything that hooverRender() needs to do its thing, and no more.
 ** This is all read-only information.
 ** 1) camera information
-** 3) volume information
-** 4) image information
-** 5) opaque "user information" pointer
-** 6) stuff about multi-threading
-** 7) the callbacks
+** 2) volume information
+** 3) image information
+** 4) opaque "user information" pointer
+** 5) stuff about multi-threading
+** 6) empty-space skipping
+** 7) statistics
+** 8) the callbacks
 */
 typedef struct {
 
@@ -115,20 +204,62 @@ typedef struct {
                                 NOT own), which over-rides
                                 volSize, volSpacing, volCentering */
 
-  /******** 3) image information: dimensions + centering */
+  /******** 3) image information: dimensions + centering, which rays */
   int imgSize[2],            /* # samples of image along U and V axes */
     imgCentering;            /* either nrrdCenterNode or nrrdCenterCell */
+  const unsigned char *rayMask; /* if non-NULL (which we do NOT own): an
+                                imgSize[0]-by-imgSize[1] array (U faster)
+                                of flags saying which rays to cast; the
+                                others are skipped entirely (no rayBegin()
+                                or rayEnd()), as for progressive rendering
+                                of some subset of the image */
 
   /******** 4) opaque "user information" pointer */
   void *user;                /* passed to all callbacks */
 
   /******** 5) stuff about multi-threading */
   unsigned int numThreads;   /* number of threads to spawn per rendering */
-  int workIdx;               /* next work assignment (such as a scanline) */
+  unsigned int tileSize[2];  /* the image is rendered in tiles of (at most)
+                                tileSize[0] by tileSize[1] rays, and each
+                                tile is one work assignment: rays within
+                                a tile are cast one next to the other, so
+                                they probe nearby parts of the volume.
+                                Using imgSize[0] by 1 gives the old
+                                assignment of one scanline at a time */
+  unsigned int packetSize;   /* if greater than 1 (at most
+                                HOOVER_PACKET_MAX), and packetSample is
+                                set: once sample() has asked for a step,
+                                the next (up to) packetSize samples along
+                                the ray, that far apart, are passed
+                                together to packetSample() */
+  int workIdx;               /* next work assignment (such as a tile) */
   airThreadMutex *workMutex; /* mutex around work assignment */
 
+  /******** 6) empty-space skipping */
+  const hooverSkip *skip;    /* if non-NULL (which we do NOT own): the
+                                samples that are inside the volume but in
+                                a block that this marks as empty are not
+                                passed to sample(); the ray just steps over
+                                them (with whatever step sample() last
+                                returned).  The sample numbers and ray
+                                positions of the other samples are the
+                                same as without skipping.  The sample()
+                                callback has to agree that nothing happens
+                                at samples in empty blocks.  The first
+                                sample of each run of empty space is still
+                                passed to sample(), so that (as with mite's
+                                early ray termination) it can end the ray
+                                at the sample after one that did
+                                something */
+
+  /******** 7) statistics */
+  hooverStats *stats;        /* if non-NULL (which we do NOT own): where
+                                hooverRender() puts per-thread counts and
+                                times (see hooverStats).  NULL means that
+                                nothing is timed */
+
   /*
-  ******* 6) the callbacks
+  ******* 8) the callbacks
   **
   ** The conceptual ordering of these callbacks is as they are listed
   ** below.  For example, rayBegin and rayEnd are called multiple
@@ -211,6 +342,33 @@ typedef struct {
   */
   hooverSample_t *sample;
 
+  /*
+  ** packetSample()
+  **
+  ** optional (NULL by default): used in place of sample() when
+  ** packetSize > 1, for a "packet" of packNum (at most packetSize)
+  ** consecutive samples along the ray, taken with the step that
+  ** sample() or packetSample() last returned.  The rayT and inside
+  ** arrays have packNum values, and the sample positions are
+  ** structure-of-arrays: samplePosWorld[ii + HOOVER_PACKET_MAX*ai] is
+  ** coordinate ai of sample ii.  The samples have to be handled in
+  ** order, just as by sample(), and *doneNumP set to how many of them
+  ** were.  As soon as one of them asks for a different step (or 0.0,
+  ** or NaN) than the packet was made with, that step is returned, and
+  ** the samples after it are not done.  Otherwise, the return is the
+  ** same step again.  The first sample of each ray, and (with
+  ** ctx->skip) samples in empty blocks, still go one at a time to
+  ** sample(), and end the packet before them.
+  **
+  ** double (*packetSample)(void *thread, void *render, void *user,
+  **                        unsigned int packNum, int num,
+  **                        const double *rayT, const int *inside,
+  **                        const double *samplePosWorld,
+  **                        const double *samplePosIndex,
+  **                        unsigned int *doneNumP);
+  */
+  hooverPacketSample_t *packetSample;
+
   /*
   ** rayEnd()
   **
@@ -271,6 +429,7 @@ HOOVER_EXPORT const int hooverPresent;
 HOOVER_EXPORT const char *hooverBiffKey;
 HOOVER_EXPORT int hooverDefVolCentering;
 HOOVER_EXPORT int hooverDefImgCentering;
+HOOVER_EXPORT unsigned int hooverDefTileSize;
 HOOVER_EXPORT const airEnum *const hooverErr;
 
 /* methodsHoover.c */
@@ -282,6 +441,21 @@ HOOVER_EXPORT void hooverContextNix(hooverContext *ctx);
 HOOVER_EXPORT int hooverRender(hooverContext *ctx,
                                int *errCodeP, int *errThreadP);
 
+/* skip.c */
+HOOVER_EXPORT hooverSkip *hooverSkipNew(void);
+HOOVER_EXPORT hooverSkip *hooverSkipNix(hooverSkip *skip);
+HOOVER_EXPORT int hooverSkipRangeSet(hooverSkip *skip, const Nrrd *nvol,
+                                     unsigned int blockSize,
+                                     const NrrdKernelSpec *ksp);
+HOOVER_EXPORT int hooverSkipEmptySet(hooverSkip *skip,
+                                     const double *visible,
+                                     unsigned int visibleNum);
+
+/* stats.c */
+HOOVER_EXPORT hooverStats *hooverStatsNew(void);
+HOOVER_EXPORT hooverStats *hooverStatsNix(hooverStats *stats);
+HOOVER_EXPORT void hooverStatsPrint(FILE *file, const hooverStats *stats);
+
 /* stub.c */
 HOOVER_EXPORT hooverRenderBegin_t hooverStubRenderBegin;
 HOOVER_EXPORT hooverThreadBegin_t hooverStubThreadBegin;
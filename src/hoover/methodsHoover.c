@@ -36,14 +36,20 @@ hooverContextNew() {
     ctx->shape = NULL;
     ctx->imgSize[0] = ctx->imgSize[1] = 0;
     ctx->imgCentering = hooverDefImgCentering;
+    ctx->rayMask = NULL;
     ctx->user = NULL;
     ctx->numThreads = 1;
+    ctx->tileSize[0] = ctx->tileSize[1] = hooverDefTileSize;
+    ctx->packetSize = 1;
     ctx->workIdx = 0;
     ctx->workMutex = NULL;
+    ctx->skip = NULL;
+    ctx->stats = NULL;
     ctx->renderBegin = hooverStubRenderBegin;
     ctx->threadBegin = hooverStubThreadBegin;
     ctx->rayBegin = hooverStubRayBegin;
     ctx->sample = hooverStubSample;
+    ctx->packetSample = NULL;
     ctx->rayEnd = hooverStubRayEnd;
     ctx->threadEnd = hooverStubThreadEnd;
     ctx->renderEnd = hooverStubRenderEnd;
@@ -133,6 +139,16 @@ hooverContextCheck(hooverContext *ctx) {
              ctx->numThreads, HOOVER_THREAD_MAX);
     return 1;
   }
+  if (!(ctx->tileSize[0] >= 1 && ctx->tileSize[1] >= 1)) {
+    biffAddf(HOOVER, "%s: tile size (%ux%u) invalid", me,
+             ctx->tileSize[0], ctx->tileSize[1]);
+    return 1;
+  }
+  if (!(ctx->packetSize >= 1 && ctx->packetSize <= HOOVER_PACKET_MAX)) {
+    biffAddf(HOOVER, "%s: packet size (%u) not in [1,%d]", me,
+             ctx->packetSize, HOOVER_PACKET_MAX);
+    return 1;
+  }
   if (!ctx->renderBegin) {
     biffAddf(HOOVER, "%s: need a non-NULL begin rendering callback", me);
     return 1;
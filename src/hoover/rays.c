@@ -134,11 +134,63 @@ typedef struct {
   _hooverExtraContext *ec;
   void *render;
   int whichThread;
+  hooverThreadStats *stats;  /* where to count things, or NULL */
   /* ----------------------- output */
   int whichErr;
   int errCode;
+  double endTime;            /* when the thread finished, if stats */
 } _hooverThreadArg;
 
+/*
+** _hooverSkipLeap
+**
+** if index-space position posI is in a block that skip says is empty,
+** returns the number of positions, starting with posI and going in
+** steps of length step along dirI, that come before the ray leaves the
+** block (or the volume, if the block is at its boundary).  A position
+** exactly on the block's boundary is not counted, so it is sampled.
+** The positions counted are also in the empty block (or within the
+** kernel support of it, which is accounted for in the block's range).
+** Returns 0 if the block isn't empty, or if posI is on its boundary.  mm and MM[] are the lowest and
+** highest index-space positions inside the volume.
+*/
+static unsigned int
+_hooverSkipLeap(const hooverSkip *skip, const double posI[3],
+                const double dirI[3], double step,
+                double mm, const double MM[3], double rayLen) {
+  unsigned int ai, bi[3];
+  double ff, lo, hi, tt, tExit;
+
+  for (ai=0; ai<3; ai++) {
+    ff = floor(posI[ai]);
+    ff = AIR_CLAMP(0, ff, skip->volSize[ai]-1);
+    bi[ai] = AIR_UINT(ff)/skip->blockSize;
+  }
+  if (!skip->empty[bi[0] + skip->size[0]*(bi[1] + skip->size[1]*bi[2])]) {
+    return 0;
+  }
+  /* the ray exits the block at the first of its exits from the block's
+     slabs along each axis */
+  tExit = rayLen;
+  for (ai=0; ai<3; ai++) {
+    lo = (bi[ai] ? bi[ai]*skip->blockSize : mm);
+    hi = (bi[ai] < skip->size[ai]-1
+          ? (bi[ai]+1)*skip->blockSize
+          : MM[ai]);
+    if (dirI[ai] > 0) {
+      tt = (hi - posI[ai])/dirI[ai];
+    } else if (dirI[ai] < 0) {
+      tt = (lo - posI[ai])/dirI[ai];
+    } else {
+      continue;
+    }
+    tExit = AIR_MIN(tExit, tt);
+  }
+  tExit = AIR_MAX(0, tExit);
+  /* the positions strictly before the exit */
+  return AIR_UINT(ceil(tExit/step));
+}
+
 void *
 _hooverThreadBody(void *_arg) {
   _hooverThreadArg *arg;
@@ -146,7 +198,13 @@ _hooverThreadBody(void *_arg) {
   int ret,               /* to catch return values from callbacks */
     sampleI,             /* which sample we're on */
     inside,              /* we're inside the volume */
-    vI, uI;              /* integral coords in image */
+    empty,               /* the last position was in empty space */
+    vI, uI,              /* integral coords in image */
+    tileIdx,             /* which tile we're on */
+    tileNum[2],          /* number of tiles along U and V */
+    tileMin[2],          /* lowest image coords in tile */
+    tileLen[2],          /* number of rays along U and V in tile */
+    rayIdx;              /* which ray in the tile we're on */
   double tmp,
     mm,                  /* lowest position in index space, for all axes */
     Mx, My, Mz,          /* highest position in index space on each axis */
@@ -167,10 +225,26 @@ _hooverThreadBody(void *_arg) {
     rayStartW[3],        /* ray start on near plane (world-space) */
     rayStartI[3],        /* ray start on near plane (index-space) */
     rayStep,             /* distance between samples (world-space) */
+    MM[3],               /* Mx, My, Mz */
     vOff[3], uOff[3];    /* offsets in arg->ec->wU and arg->ec->wV
                             directions towards start of ray */
+  unsigned int leap,     /* number of steps to leap over empty space */
+    packNum,             /* number of samples in the packet */
+    packDone,            /* number of them packetSample() did */
+    ii;
+  int packIn[HOOVER_PACKET_MAX],   /* per-sample "inside" for packet */
+    packAnyIn;           /* some sample of the packet is inside */
+  double packT[HOOVER_PACKET_MAX], /* per-sample rayT for packet */
+    packW[3*HOOVER_PACKET_MAX],    /* packet positions (world-space), */
+    packI[3*HOOVER_PACKET_MAX],    /* and (index-space), as SoA */
+    xx, yy, zz, ww;
+  const double *WtoI;    /* arg->ctx->shape->WtoI */
+  hooverThreadStats *st; /* arg->stats */
+  double time0, tt;      /* for timing, with st */
 
   arg = (_hooverThreadArg *)_arg;
+  st = arg->stats;
+  time0 = st ? airTime() : 0;
   if ( (ret = (arg->ctx->threadBegin)(&thread,
                                       arg->render,
                                       arg->ctx->user,
@@ -209,6 +283,8 @@ _hooverThreadBody(void *_arg) {
     }
   }
 
+  ELL_3V_SET(MM, Mx, My, Mz);
+
   if (arg->ctx->cam->orthographic) {
     ELL_3V_COPY(rayDirW, arg->ctx->cam->N);
     if (arg->ctx->shape) {
@@ -228,35 +304,69 @@ _hooverThreadBody(void *_arg) {
     uvScale = arg->ctx->cam->vspNeer/arg->ctx->cam->vspDist;
   }
 
+  tileNum[0] = (arg->ctx->imgSize[0] + arg->ctx->tileSize[0] - 1)
+    /arg->ctx->tileSize[0];
+  tileNum[1] = (arg->ctx->imgSize[1] + arg->ctx->tileSize[1] - 1)
+    /arg->ctx->tileSize[1];
   while (1) {
-    /* the work assignment is simply the next scanline to be rendered:
-       the result of all this is setting vI */
+    /* the work assignment is the next tile of the image to be rendered
+       (tiles are ordered along U, then V): the result of all this is
+       setting tileIdx */
+    tt = st ? airTime() : 0;
     if (arg->ctx->workMutex) {
       airThreadMutexLock(arg->ctx->workMutex);
     }
-    vI = arg->ctx->workIdx;
-    if (arg->ctx->workIdx < arg->ctx->imgSize[1]) {
+    tileIdx = arg->ctx->workIdx;
+    if (arg->ctx->workIdx < tileNum[0]*tileNum[1]) {
       arg->ctx->workIdx += 1;
     }
     if (arg->ctx->workMutex) {
       airThreadMutexUnlock(arg->ctx->workMutex);
     }
-    if (vI == arg->ctx->imgSize[1]) {
+    if (st) {
+      st->waitTime += airTime() - tt;
+    }
+    if (tileIdx == tileNum[0]*tileNum[1]) {
       /* we're done! */
       break;
     }
-
-    if (nrrdCenterCell == arg->ctx->imgCentering) {
-      v = uvScale*AIR_AFFINE(-0.5, vI, arg->ctx->imgSize[1]-0.5,
-                             arg->ctx->cam->vRange[0],
-                             arg->ctx->cam->vRange[1]);
-    } else {
-      v = uvScale*AIR_AFFINE(0.0, vI, arg->ctx->imgSize[1]-1.0,
-                             arg->ctx->cam->vRange[0],
-                             arg->ctx->cam->vRange[1]);
+    if (st) {
+      st->tileNum++;
     }
-    ELL_3V_SCALE(vOff, v, arg->ctx->cam->V);
-    for (uI=0; uI<arg->ctx->imgSize[0]; uI++) {
+    tileMin[0] = (tileIdx % tileNum[0])*arg->ctx->tileSize[0];
+    tileMin[1] = (tileIdx / tileNum[0])*arg->ctx->tileSize[1];
+    tileLen[0] = AIR_MIN(AIR_CAST(int, arg->ctx->tileSize[0]),
+                         arg->ctx->imgSize[0] - tileMin[0]);
+    tileLen[1] = AIR_MIN(AIR_CAST(int, arg->ctx->tileSize[1]),
+                         arg->ctx->imgSize[1] - tileMin[1]);
+
+    /* the rays of the tile go back and forth along the scanlines, so
+       that each ray is next to the previous one (and probes the volume
+       near where it did) */
+    for (rayIdx=0; rayIdx<tileLen[0]*tileLen[1]; rayIdx++) {
+      vI = tileMin[1] + rayIdx/tileLen[0];
+      uI = rayIdx % tileLen[0];
+      if ((vI - tileMin[1]) % 2) {
+        uI = tileLen[0] - 1 - uI;
+      }
+      uI += tileMin[0];
+      if (!(rayIdx % tileLen[0])) {
+        /* starting a new scanline */
+        if (nrrdCenterCell == arg->ctx->imgCentering) {
+          v = uvScale*AIR_AFFINE(-0.5, vI, arg->ctx->imgSize[1]-0.5,
+                                 arg->ctx->cam->vRange[0],
+                                 arg->ctx->cam->vRange[1]);
+        } else {
+          v = uvScale*AIR_AFFINE(0.0, vI, arg->ctx->imgSize[1]-1.0,
+                                 arg->ctx->cam->vRange[0],
+                                 arg->ctx->cam->vRange[1]);
+        }
+        ELL_3V_SCALE(vOff, v, arg->ctx->cam->V);
+      }
+      if (arg->ctx->rayMask
+          && !arg->ctx->rayMask[uI + arg->ctx->imgSize[0]*vI]) {
+        continue;
+      }
       if (nrrdCenterCell == arg->ctx->imgCentering) {
         u = uvScale*AIR_AFFINE(-0.5, uI, arg->ctx->imgSize[0]-0.5,
                                arg->ctx->cam->uRange[0],
@@ -302,10 +412,118 @@ _hooverThreadBody(void *_arg) {
         arg->whichErr = hooverErrRayBegin;
         return arg;
       }
+      if (st) {
+        st->rayNum++;
+      }
 
       sampleI = 0;
       rayT = 0;
+      rayStep = 0;
+      empty = AIR_FALSE;
       while (1) {
+        if (arg->ctx->packetSample && arg->ctx->packetSize > 1
+            && rayStep > 0) {
+          /* the next samples that are rayStep apart (as many as fit
+             before the far plane) go together as a packet */
+          packT[0] = rayT;
+          for (packNum=1; packNum<arg->ctx->packetSize; packNum++) {
+            packT[packNum] = packT[packNum-1] + rayStep;
+            if (!AIR_IN_CL(0, packT[packNum], rayLen)) {
+              break;
+            }
+          }
+          /* their positions, computed the same way as for one sample,
+             but a coordinate at a time over the whole packet */
+          for (ii=0; ii<packNum; ii++) {
+            packW[ii] = 1.0*rayStartW[0] + packT[ii]*rayDirW[0];
+            packW[ii + HOOVER_PACKET_MAX] = (1.0*rayStartW[1]
+                                             + packT[ii]*rayDirW[1]);
+            packW[ii + 2*HOOVER_PACKET_MAX] = (1.0*rayStartW[2]
+                                               + packT[ii]*rayDirW[2]);
+          }
+          if (arg->ctx->shape) {
+            /* as in gageShapeWtoI */
+            WtoI = arg->ctx->shape->WtoI;
+            for (ii=0; ii<packNum; ii++) {
+              xx = packW[ii];
+              yy = packW[ii + HOOVER_PACKET_MAX];
+              zz = packW[ii + 2*HOOVER_PACKET_MAX];
+              ww = 1.0/(WtoI[12]*xx + WtoI[13]*yy + WtoI[14]*zz
+                        + WtoI[15]*1.0);
+              packI[ii] = ww*(WtoI[0]*xx + WtoI[1]*yy + WtoI[2]*zz
+                              + WtoI[3]*1.0);
+              packI[ii + HOOVER_PACKET_MAX] = ww*(WtoI[4]*xx + WtoI[5]*yy
+                                                  + WtoI[6]*zz
+                                                  + WtoI[7]*1.0);
+              packI[ii + 2*HOOVER_PACKET_MAX] = ww*(WtoI[8]*xx
+                                                    + WtoI[9]*yy
+                                                    + WtoI[10]*zz
+                                                    + WtoI[11]*1.0);
+            }
+          } else {
+            for (ii=0; ii<packNum; ii++) {
+              packI[ii] = 1.0*rayStartI[0] + packT[ii]*rayDirI[0];
+              packI[ii + HOOVER_PACKET_MAX] = (1.0*rayStartI[1]
+                                               + packT[ii]*rayDirI[1]);
+              packI[ii + 2*HOOVER_PACKET_MAX] = (1.0*rayStartI[2]
+                                                 + packT[ii]*rayDirI[2]);
+            }
+          }
+          packAnyIn = AIR_FALSE;
+          for (ii=0; ii<packNum; ii++) {
+            packIn[ii] = (AIR_IN_CL(mm, packI[ii], Mx)
+                          && AIR_IN_CL(mm, packI[ii + HOOVER_PACKET_MAX], My)
+                          && AIR_IN_CL(mm, packI[ii + 2*HOOVER_PACKET_MAX],
+                                       Mz));
+            if (arg->ctx->skip && packIn[ii]) {
+              ELL_3V_SET(rayPosI, packI[ii], packI[ii + HOOVER_PACKET_MAX],
+                         packI[ii + 2*HOOVER_PACKET_MAX]);
+              if (_hooverSkipLeap(arg->ctx->skip, rayPosI, rayDirI,
+                                  rayStep, mm, MM, rayLen)) {
+                /* this sample, and the ones after, diverge from the
+                   packet: they go one at a time to see about skipping */
+                packNum = ii;
+                break;
+              }
+            }
+            packAnyIn |= packIn[ii];
+          }
+        } else {
+          packNum = 0;
+        }
+        if (packNum) {
+          tt = st && packAnyIn ? airTime() : 0;
+          rayStep = (arg->ctx->packetSample)(thread,
+                                             arg->render,
+                                             arg->ctx->user,
+                                             packNum, sampleI, packT,
+                                             packIn, packW, packI,
+                                             &packDone);
+          if (!( AIR_EXISTS(rayStep) && packDone >= 1
+                 && packDone <= packNum )) {
+            /* sampling failed */
+            arg->errCode = 0;
+            arg->whichErr = hooverErrSample;
+            return arg;
+          }
+          if (st) {
+            st->sampleTime += packAnyIn ? airTime() - tt : 0;
+            st->sampleNum += packDone;
+          }
+          empty = AIR_FALSE;
+          if (!rayStep) {
+            if (st) {
+              st->rayStopNum++;
+            }
+            break;
+          }
+          rayT = packT[packDone-1] + rayStep;
+          if (!AIR_IN_CL(0, rayT, rayLen)) {
+            break;
+          }
+          sampleI += packDone;
+          continue;
+        }
         ELL_3V_SCALE_ADD2(rayPosW, 1.0, rayStartW, rayT, rayDirW);
         if (arg->ctx->shape) {
           gageShapeWtoI(arg->ctx->shape, rayPosI, rayPosW);
@@ -315,12 +533,47 @@ _hooverThreadBody(void *_arg) {
         inside = (AIR_IN_CL(mm, rayPosI[0], Mx) &&
                   AIR_IN_CL(mm, rayPosI[1], My) &&
                   AIR_IN_CL(mm, rayPosI[2], Mz));
+        if (arg->ctx->skip && inside && rayStep > 0
+            && (leap = _hooverSkipLeap(arg->ctx->skip, rayPosI, rayDirI,
+                                       rayStep, mm, MM, rayLen))) {
+          if (empty) {
+            /* in empty space: take the same steps as sample() would
+               have asked for, without calling it */
+            for (; leap; leap--) {
+              rayT += rayStep;
+              if (!AIR_IN_CL(0, rayT, rayLen)) {
+                break;
+              }
+              sampleI++;
+              if (st) {
+                st->skipNum++;
+              }
+            }
+            if (leap) {
+              /* ray stepped outside near-far clipping region */
+              break;
+            }
+            continue;
+          }
+          /* else this is the first position of a run of empty space,
+             which still goes to sample(), so that sample() sees every
+             position right after one that did something, and can end
+             the ray there */
+          empty = AIR_TRUE;
+        } else {
+          empty = AIR_FALSE;
+        }
+        tt = st && inside ? airTime() : 0;
         rayStep = (arg->ctx->sample)(thread,
                                      arg->render,
                                      arg->ctx->user,
                                      sampleI, rayT,
                                      inside,
                                      rayPosW, rayPosI);
+        if (st) {
+          st->sampleTime += inside ? airTime() - tt : 0;
+          st->sampleNum++;
+        }
         if (!AIR_EXISTS(rayStep)) {
           /* sampling failed */
           arg->errCode = 0;
@@ -329,6 +582,9 @@ _hooverThreadBody(void *_arg) {
         }
         if (!rayStep) {
           /* ray decided to finish itself */
+          if (st) {
+            st->rayStopNum++;
+          }
           break;
         }
         /* else we moved to a new location along the ray */
@@ -347,8 +603,8 @@ _hooverThreadBody(void *_arg) {
         arg->whichErr = hooverErrRayEnd;
         return arg;
       }
-    }  /* end this scanline */
-  } /* end while(1) assignment of scanlines */
+    }  /* end this tile */
+  } /* end while(1) assignment of tiles */
 
   if ( (ret = (arg->ctx->threadEnd)(thread,
                                     arg->render,
@@ -357,6 +613,10 @@ _hooverThreadBody(void *_arg) {
     arg->whichErr = hooverErrThreadEnd;
     return arg;
   }
+  if (st) {
+    arg->endTime = airTime();
+    st->time = arg->endTime - time0;
+  }
 
   /* returning NULL actually indicates that there was NOT an error */
   return NULL;
@@ -386,6 +646,7 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
   int ret;
   airArray *mop;
   unsigned int threadIdx;
+  double time0, endTime;
 
   if (!( errCodeP && errThreadP )) {
     biffAddf(HOOVER, "%s: got NULL int return pointer", me);
@@ -408,6 +669,11 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
   }
   mop = airMopNew();
   airMopAdd(mop, ec, (airMopper)_hooverExtraContextNix, airMopAlways);
+  time0 = airTime();
+  if (ctx->stats) {
+    memset(ctx->stats, 0, sizeof(hooverStats));
+    ctx->stats->threadNum = ctx->numThreads;
+  }
   if ( (ret = (ctx->renderBegin)(&render, ctx->user)) ) {
     *errCodeP = ret;
     *errCodeP = 0;
@@ -415,12 +681,41 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
     airMopError(mop);
     return hooverErrRenderBegin;
   }
+  /* this is checked after renderBegin(), which may be what sets it */
+  if (ctx->skip) {
+    unsigned int volSize[3];
+    if (ctx->shape) {
+      ELL_3V_COPY(volSize, ctx->shape->size);
+    } else {
+      ELL_3V_COPY_TT(volSize, unsigned int, ctx->volSize);
+    }
+    if (!ELL_3V_EQUAL(ctx->skip->volSize, volSize)) {
+      biffAddf(HOOVER, "%s: skip blocks made for %ux%ux%u volume, "
+               "but rendering %ux%ux%u", me, ctx->skip->volSize[0],
+               ctx->skip->volSize[1], ctx->skip->volSize[2],
+               volSize[0], volSize[1], volSize[2]);
+      *errCodeP = 0;
+      *errThreadP = 0;
+      airMopError(mop);
+      return hooverErrInit;
+    }
+    if (!ctx->skip->empty) {
+      biffAddf(HOOVER, "%s: skip blocks' emptiness hasn't been set", me);
+      *errCodeP = 0;
+      *errThreadP = 0;
+      airMopError(mop);
+      return hooverErrInit;
+    }
+  }
 
   for (threadIdx=0; threadIdx<ctx->numThreads; threadIdx++) {
     args[threadIdx].ctx = ctx;
     args[threadIdx].ec = ec;
     args[threadIdx].render = render;
     args[threadIdx].whichThread = threadIdx;
+    args[threadIdx].stats = (ctx->stats
+                             ? ctx->stats->thread + threadIdx
+                             : NULL);
     args[threadIdx].whichErr = hooverErrNone;
     args[threadIdx].errCode = 0;
     thread[threadIdx] = airThreadNew();
@@ -480,11 +775,37 @@ hooverRender(hooverContext *ctx, int *errCodeP, int *errThreadP) {
     ctx->workMutex = airThreadMutexNix(ctx->workMutex);
   }
 
+  if (ctx->stats) {
+    hooverThreadStats *st, *tot;
+    endTime = args[0].endTime;
+    for (threadIdx=1; threadIdx<ctx->numThreads; threadIdx++) {
+      endTime = AIR_MAX(endTime, args[threadIdx].endTime);
+    }
+    tot = &(ctx->stats->total);
+    for (threadIdx=0; threadIdx<ctx->numThreads; threadIdx++) {
+      st = ctx->stats->thread + threadIdx;
+      st->idleTime = endTime - args[threadIdx].endTime;
+      tot->tileNum += st->tileNum;
+      tot->rayNum += st->rayNum;
+      tot->rayStopNum += st->rayStopNum;
+      tot->sampleNum += st->sampleNum;
+      tot->skipNum += st->skipNum;
+      tot->time += st->time;
+      tot->sampleTime += st->sampleTime;
+      tot->probeTime += st->probeTime;
+      tot->waitTime += st->waitTime;
+      tot->idleTime += st->idleTime;
+    }
+  }
+
   if ( (ret = (ctx->renderEnd)(render, ctx->user)) ) {
     *errCodeP = ret;
     *errThreadP = -1;
     return hooverErrRenderEnd;
   }
+  if (ctx->stats) {
+    ctx->stats->time = airTime() - time0;
+  }
   render = NULL;
   airMopOkay(mop);
 
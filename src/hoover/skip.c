@@ -0,0 +1,280 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "hoover.h"
+
+/* number of positions (between voxels) at which the kernel weights
+   are evaluated to bound them */
+#define HOOVER_SKIP_KERNEL_SAMPLES 1024
+
+hooverSkip *
+hooverSkipNew(void) {
+  hooverSkip *skip;
+
+  skip = AIR_CALLOC(1, hooverSkip);
+  if (skip) {
+    skip->blockSize = 0;
+    ELL_3V_SET(skip->volSize, 0, 0, 0);
+    ELL_3V_SET(skip->size, 0, 0, 0);
+    skip->range = NULL;
+    skip->empty = NULL;
+    skip->emptyNum = 0;
+  }
+  return skip;
+}
+
+hooverSkip *
+hooverSkipNix(hooverSkip *skip) {
+
+  if (skip) {
+    airFree(skip->range);
+    airFree(skip->empty);
+    airFree(skip);
+  }
+  return NULL;
+}
+
+/*
+** _hooverSkipKernelBound
+**
+** learns how far (in terms of the range of the voxel values) a value
+** reconstructed with the given kernel can be from the voxel values:
+** for any 3D position, the sum of the (separable) weights is in
+** [*sumMinP, *sumMaxP], and the sum of their absolute values is at
+** most *absMaxP.  These are found by evaluating the kernel at many
+** positions, and then loosened a little.
+*/
+static void
+_hooverSkipKernelBound(double *sumMinP, double *sumMaxP, double *absMaxP,
+                       const NrrdKernelSpec *ksp, int fr) {
+  double sum, asum, ww, smin, smax, amax, ss[2], prod;
+  unsigned int ai, ci;
+  int jj;
+
+  smin = AIR_POS_INF;
+  smax = AIR_NEG_INF;
+  amax = 0;
+  for (ai=0; ai<=HOOVER_SKIP_KERNEL_SAMPLES; ai++) {
+    double alpha;
+    alpha = AIR_CAST(double, ai)/HOOVER_SKIP_KERNEL_SAMPLES;
+    sum = asum = 0;
+    for (jj=-fr; jj<=fr+1; jj++) {
+      ww = ksp->kernel->eval1_d(alpha - jj, ksp->parm);
+      sum += ww;
+      asum += AIR_ABS(ww);
+    }
+    smin = AIR_MIN(smin, sum);
+    smax = AIR_MAX(smax, sum);
+    amax = AIR_MAX(amax, asum);
+  }
+  /* the 3D weights are products of three 1D weights; the extremes of
+     the product of the three sums are at the extremes of each */
+  ss[0] = smin;
+  ss[1] = smax;
+  *sumMinP = AIR_POS_INF;
+  *sumMaxP = AIR_NEG_INF;
+  for (ci=0; ci<8; ci++) {
+    prod = ss[ci & 1]*ss[(ci >> 1) & 1]*ss[(ci >> 2) & 1];
+    *sumMinP = AIR_MIN(*sumMinP, prod);
+    *sumMaxP = AIR_MAX(*sumMaxP, prod);
+  }
+  *absMaxP = 1.001*amax*amax*amax;
+  return;
+}
+
+/*
+******** hooverSkipRangeSet
+**
+** (re-)computes the per-block intervals of values that can be
+** reconstructed from the given 3D scalar volume by the given kernel,
+** with blocks of blockSize^3 voxels.  Voxels outside the volume are
+** taken to be copies of the nearest voxel inside (as in gage).  This
+** forgets any previously set emptiness.
+*/
+int
+hooverSkipRangeSet(hooverSkip *skip, const Nrrd *nvol,
+                   unsigned int blockSize, const NrrdKernelSpec *ksp) {
+  static const char me[]="hooverSkipRangeSet";
+  double (*lup)(const void *, size_t), *raw, val, cc, rr, lo, hi, pad,
+    sumMin, sumMax, absMax;
+  unsigned int sx, sy, sz, bx, by, bz, xi, yi, zi, nb, bnum;
+  int fr, ox, oy, oz;
+  size_t bi;
+  airArray *mop;
+
+  if (!( skip && nvol && ksp )) {
+    biffAddf(HOOVER, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!ksp->kernel) {
+    biffAddf(HOOVER, "%s: got NULL kernel", me);
+    return 1;
+  }
+  if (nrrdCheck(nvol)) {
+    biffMovef(HOOVER, NRRD, "%s: problem with volume", me);
+    return 1;
+  }
+  if (!( 3 == nvol->dim && nrrdTypeBlock != nvol->type )) {
+    biffAddf(HOOVER, "%s: need a 3D scalar volume (not %u-D %s)", me,
+             nvol->dim, airEnumStr(nrrdType, nvol->type));
+    return 1;
+  }
+  if (!( blockSize >= 1 )) {
+    biffAddf(HOOVER, "%s: need a non-zero block size", me);
+    return 1;
+  }
+  sx = AIR_UINT(nvol->axis[0].size);
+  sy = AIR_UINT(nvol->axis[1].size);
+  sz = AIR_UINT(nvol->axis[2].size);
+  skip->blockSize = blockSize;
+  ELL_3V_SET(skip->volSize, sx, sy, sz);
+  ELL_3V_SET(skip->size, (sx + blockSize - 1)/blockSize,
+             (sy + blockSize - 1)/blockSize,
+             (sz + blockSize - 1)/blockSize);
+  bnum = skip->size[0]*skip->size[1]*skip->size[2];
+  airFree(skip->range);
+  skip->empty = (unsigned char *)airFree(skip->empty);
+  skip->emptyNum = 0;
+  skip->range = AIR_CALLOC(2*bnum, double);
+  mop = airMopNew();
+  raw = AIR_CALLOC(2*bnum, double);
+  airMopAdd(mop, raw, airFree, airMopAlways);
+  if (!( skip->range && raw )) {
+    biffAddf(HOOVER, "%s: couldn't allocate %u block ranges", me, bnum);
+    airMopError(mop); return 1;
+  }
+
+  /* the min and max of the voxels in each block */
+  for (bi=0; bi<bnum; bi++) {
+    raw[0 + 2*bi] = AIR_POS_INF;
+    raw[1 + 2*bi] = AIR_NEG_INF;
+  }
+  lup = nrrdDLookup[nvol->type];
+  for (zi=0; zi<sz; zi++) {
+    bz = zi/blockSize;
+    for (yi=0; yi<sy; yi++) {
+      by = yi/blockSize;
+      for (xi=0; xi<sx; xi++) {
+        bx = xi/blockSize;
+        val = lup(nvol->data, xi + AIR_CAST(size_t, sx)*(yi + sy*zi));
+        bi = bx + skip->size[0]*(by + skip->size[1]*bz);
+        raw[0 + 2*bi] = AIR_MIN(raw[0 + 2*bi], val);
+        raw[1 + 2*bi] = AIR_MAX(raw[1 + 2*bi], val);
+      }
+    }
+  }
+
+  /* the samples anywhere in a block can depend on voxels up to fr
+     voxels away, which are in the nb nearest blocks on each side */
+  fr = AIR_CAST(int, ceil(ksp->kernel->support(ksp->parm)));
+  nb = (fr + blockSize - 1)/blockSize;
+  _hooverSkipKernelBound(&sumMin, &sumMax, &absMax, ksp, fr);
+  for (bz=0; bz<skip->size[2]; bz++) {
+    for (by=0; by<skip->size[1]; by++) {
+      for (bx=0; bx<skip->size[0]; bx++) {
+        lo = AIR_POS_INF;
+        hi = AIR_NEG_INF;
+        for (oz=-AIR_CAST(int, nb); oz<=AIR_CAST(int, nb); oz++) {
+          if (!AIR_IN_CL(0, AIR_CAST(int, bz) + oz,
+                         AIR_CAST(int, skip->size[2]) - 1)) {
+            continue;
+          }
+          for (oy=-AIR_CAST(int, nb); oy<=AIR_CAST(int, nb); oy++) {
+            if (!AIR_IN_CL(0, AIR_CAST(int, by) + oy,
+                           AIR_CAST(int, skip->size[1]) - 1)) {
+              continue;
+            }
+            for (ox=-AIR_CAST(int, nb); ox<=AIR_CAST(int, nb); ox++) {
+              if (!AIR_IN_CL(0, AIR_CAST(int, bx) + ox,
+                             AIR_CAST(int, skip->size[0]) - 1)) {
+                continue;
+              }
+              bi = (bx + ox) + skip->size[0]*((by + oy)
+                                               + skip->size[1]*(bz + oz));
+              lo = AIR_MIN(lo, raw[0 + 2*bi]);
+              hi = AIR_MAX(hi, raw[1 + 2*bi]);
+            }
+          }
+        }
+        /* with weights w_i summing to S, the reconstructed
+           sum_i w_i v_i = S*cc + sum_i w_i (v_i - cc), and the
+           second term is at most absMax*rr in magnitude */
+        cc = (lo + hi)/2;
+        rr = (hi - lo)/2;
+        lo = AIR_MIN(sumMin*cc, sumMax*cc) - absMax*rr;
+        hi = AIR_MAX(sumMin*cc, sumMax*cc) + absMax*rr;
+        pad = 0.001*(hi - lo) + 0.000001*(AIR_ABS(lo) + AIR_ABS(hi));
+        bi = bx + skip->size[0]*(by + skip->size[1]*bz);
+        skip->range[0 + 2*bi] = lo - pad;
+        skip->range[1 + 2*bi] = hi + pad;
+      }
+    }
+  }
+
+  airMopOkay(mop);
+  return 0;
+}
+
+/*
+******** hooverSkipEmptySet
+**
+** (re-)sets which blocks are empty: those whose interval of values
+** doesn't overlap any of the visibleNum intervals of visible values,
+** given as (min,max) pairs in visible[].  With visibleNum == 0, all
+** blocks are empty.
+*/
+int
+hooverSkipEmptySet(hooverSkip *skip, const double *visible,
+                   unsigned int visibleNum) {
+  static const char me[]="hooverSkipEmptySet";
+  unsigned int bi, bnum, ii;
+  int vis;
+
+  if (!( skip && (visible || !visibleNum) )) {
+    biffAddf(HOOVER, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!skip->range) {
+    biffAddf(HOOVER, "%s: block ranges haven't been set", me);
+    return 1;
+  }
+  bnum = skip->size[0]*skip->size[1]*skip->size[2];
+  if (!skip->empty) {
+    skip->empty = AIR_CALLOC(bnum, unsigned char);
+    if (!skip->empty) {
+      biffAddf(HOOVER, "%s: couldn't allocate %u flags", me, bnum);
+      return 1;
+    }
+  }
+  skip->emptyNum = 0;
+  for (bi=0; bi<bnum; bi++) {
+    vis = AIR_FALSE;
+    for (ii=0; ii<visibleNum && !vis; ii++) {
+      vis = (skip->range[1 + 2*bi] >= visible[0 + 2*ii]
+             && skip->range[0 + 2*bi] <= visible[1 + 2*ii]);
+    }
+    skip->empty[bi] = !vis;
+    skip->emptyNum += !vis;
+  }
+  return 0;
+}
@@ -5,6 +5,8 @@ set(HOOVER_SOURCES
   hoover.h
   methodsHoover.c
   rays.c
+  skip.c
+  stats.c
   stub.c
   )
 
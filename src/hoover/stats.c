@@ -0,0 +1,100 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "hoover.h"
+
+hooverStats *
+hooverStatsNew(void) {
+  hooverStats *stats;
+
+  /* calloc sets all the counts and times to zero */
+  stats = AIR_CALLOC(1, hooverStats);
+  if (stats) {
+    stats->threadNum = 0;
+  }
+  return stats;
+}
+
+hooverStats *
+hooverStatsNix(hooverStats *stats) {
+
+  airFree(stats);
+  return NULL;
+}
+
+static void
+_hooverStatsLine(FILE *file, const char *name,
+                 const hooverThreadStats *ts) {
+  char buff[5][AIR_STRLEN_SMALL];
+
+  fprintf(file, "%6s %6s %9s %8s %11s %11s %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+          name,
+          airSprintSize_t(buff[0], ts->tileNum),
+          airSprintSize_t(buff[1], ts->rayNum),
+          airSprintSize_t(buff[2], ts->rayStopNum),
+          airSprintSize_t(buff[3], ts->sampleNum),
+          airSprintSize_t(buff[4], ts->skipNum),
+          ts->time, ts->probeTime, ts->sampleTime - ts->probeTime,
+          ts->waitTime, ts->idleTime);
+  return;
+}
+
+/*
+******** hooverStatsPrint
+**
+** prints a table of the per-thread statistics, and their sums, followed
+** by the overall rate and the spread of the busy times across threads
+*/
+void
+hooverStatsPrint(FILE *file, const hooverStats *stats) {
+  char name[AIR_STRLEN_SMALL];
+  double busy, busyMin, busyMax;
+  unsigned int ti;
+
+  if (!( file && stats )) {
+    return;
+  }
+  fprintf(file, "%6s %6s %9s %8s %11s %11s %8s %8s %8s %8s %8s\n",
+          "thread", "tiles", "rays", "stopped", "samples", "skipped",
+          "time", "probe", "shade", "wait", "idle");
+  busyMin = AIR_POS_INF;
+  busyMax = AIR_NEG_INF;
+  for (ti=0; ti<stats->threadNum; ti++) {
+    sprintf(name, "%u", ti);
+    _hooverStatsLine(file, name, stats->thread + ti);
+    busy = stats->thread[ti].time - stats->thread[ti].waitTime;
+    busyMin = AIR_MIN(busyMin, busy);
+    busyMax = AIR_MAX(busyMax, busy);
+  }
+  _hooverStatsLine(file, "total", &(stats->total));
+  fprintf(file, "render time %g secs; %g K sample() calls/sec",
+          stats->time, (stats->time
+                        ? stats->total.sampleNum/(1000.0*stats->time)
+                        : 0.0));
+  if (1 < stats->threadNum && busyMax > 0) {
+    /* how much longer the busiest thread worked than the least busy */
+    fprintf(file, "; busy time spread %g%%", 100*(busyMax - busyMin)/busyMax);
+  }
+  fprintf(file, "\n");
+  return;
+}
@@ -165,6 +165,11 @@ typedef struct {
                             ray */
     opacNear1;           /* opacity close enough to unity for the sake of
                             doing early ray termination */
+  unsigned int skipBlock; /* if non-zero, try to skip empty space (with a
+                            hooverSkip, when opacity is set by
+                            multiplying with a transfer function of the
+                            scalar value) with blocks of this many voxels
+                            on edge; if zero, don't try */
   hooverContext *hctx;   /* context and input for all hoover-related things,
                             including camera and image parameters */
   double fakeFrom[3],    /* if non-NaN, then the "V"-dependent miteVal's will
@@ -262,6 +267,14 @@ typedef struct {
   gageQuery queryMite;        /* record of the miteVal quantities which
                                  we'll need to compute per-sample */
   int queryMiteNonzero;       /* shortcut miteVal computation if possible */
+  hooverSkip *skip;           /* if non-NULL, the empty-space skipping
+                                 blocks given to hoover for this rendering
+                                 (because of muu->skipBlock) */
+  mite_t *rangeLut;           /* if non-NULL (when all txfs are 1-D over
+                                 the same scalar variable), for each index
+                                 into the txfs, the MITE_RANGE_NUM range
+                                 values that all the txfs together set,
+                                 starting from muu->rangeInit */
 
   /* as long as there's no mutex around how the miteThreads are
      airMopAdded to the miteUser's mop, these have to be _allocated_ in
@@ -273,6 +286,19 @@ typedef struct {
                                  are not thread-specific */
 } miteRender;
 
+/*
+******** miteProgress_t
+**
+** callback for miteRenderProgressive, called after each level of
+** refinement with the image so far (in the same format as muu->nout,
+** with the pixels that haven't been rendered yet interpolated from
+** those that have), the spacing (in pixels) between the rays rendered
+** so far, and how many rays were cast at this level.  A non-zero
+** return stops the refinement (which isn't an error).
+*/
+typedef int (miteProgress_t)(const Nrrd *nimg, unsigned int stride,
+                             unsigned int rayNum, void *data);
+
 /*
 ******** miteStageOp* enum
 **
@@ -380,6 +406,8 @@ enum {
 */
 typedef struct miteThread_t {
   gageContext *gctx;            /* per-thread context */
+  gageProbeState *gps;          /* if non-NULL, the probe state of
+                                   muu->gctx0 that gctx belongs to */
   double *ansScl,               /* pointer to gageKindScl answer vector */
     *nPerp, *geomTens,          /* convenience pointers into ansScl */
     *ansVec,                    /* pointer to gageKindVec answer vector */
@@ -411,6 +439,8 @@ typedef struct miteThread_t {
     raySample,                  /* number of samples finished in this ray */
     samples;                    /* number of samples handled so far by
                                    this thread */
+  double probeTime;             /* time spent in gageProbe(), only measured
+                                   when muu->hctx->stats is non-NULL */
   miteStage *stage;             /* array of stages for txf computation */
   int stageNum;                 /* number of stages == length of stage[] */
   mite_t range[MITE_RANGE_NUM], /* rendering variables, which are either
@@ -419,6 +449,8 @@ typedef struct miteThread_t {
     rayStep,                    /* per-ray step (may need to be different for
                                    each ray to enable sampling on planes) */
     V[3],                       /* per-ray view direction */
+    H[3],                       /* half-way vector between V and the
+                                   light direction, for specular shading */
     RR, GG, BB, TT,             /* per-ray composited values */
     ZZ;                         /* for storing ray-depth when opacity passed
                                    muu->opacMatters */
@@ -446,6 +478,8 @@ MITE_EXPORT char miteRangeChar[MITE_RANGE_NUM+1];
 MITE_EXPORT int miteVariableParse(gageItemSpec *isp, const char *label);
 MITE_EXPORT void miteVariablePrint(char *buff, const gageItemSpec *isp);
 MITE_EXPORT int miteNtxfCheck(const Nrrd *ntxf);
+MITE_EXPORT int miteNtxfVisible(double **visibleP, unsigned int *visibleNumP,
+                                Nrrd *const *ntxf, unsigned int ntxfNum);
 MITE_EXPORT void miteQueryAdd(gageQuery queryScl, gageQuery queryVec,
                               gageQuery queryTen, gageQuery queryMite,
                               gageItemSpec *isp);
@@ -467,6 +501,11 @@ MITE_EXPORT void miteShadeSpecQueryAdd(gageQuery queryScl, gageQuery queryVec,
 MITE_EXPORT int miteRenderBegin(miteRender **mrrP, miteUser *muu);
 MITE_EXPORT int miteRenderEnd(miteRender *mrr, miteUser *muu);
 
+/* progressive.c */
+MITE_EXPORT int miteRenderProgressive(miteUser *muu, unsigned int stride,
+                                      double thresh, miteProgress_t *progress,
+                                      void *data);
+
 /* thread.c */
 MITE_EXPORT miteThread *miteThreadNew(void);
 MITE_EXPORT miteThread *miteThreadNix(miteThread *mtt);
@@ -484,6 +523,13 @@ MITE_EXPORT double miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
                               int num, double rayT, int inside,
                               double samplePosWorld[3],
                               double samplePosIndex[3]);
+MITE_EXPORT double miteSamplePacket(miteThread *mtt, miteRender *mrr,
+                                    miteUser *muu,
+                                    unsigned int packNum, int num,
+                                    const double *rayT, const int *inside,
+                                    const double *samplePosWorld,
+                                    const double *samplePosIndex,
+                                    unsigned int *doneNumP);
 MITE_EXPORT int miteRayEnd(miteThread *mtt, miteRender *mrr,
                            miteUser *muu);
 
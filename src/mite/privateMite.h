@@ -39,9 +39,13 @@ extern "C" {
 /* txf.c */
 extern double *_miteAnswerPointer(miteThread *mtt, gageItemSpec *isp);
 extern int _miteNtxfAlphaAdjust(miteRender *mrr, miteUser *muu);
+extern int _miteRangeLutSet(miteRender *mrr, miteUser *muu);
 extern int _miteStageSet(miteThread *mtt, miteRender *mrr);
 extern void _miteStageRun(miteThread *mtt, miteUser *muu);
 
+/* renderMite.c */
+extern int _miteSkipSet(miteRender *mrr, miteUser *muu);
+
 /* user.c */
 extern int _miteUserCheck(miteUser *muu);
 
@@ -0,0 +1,260 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "mite.h"
+#include "privateMite.h"
+
+/*
+** _miteProgCell
+**
+** finds the interval [*loP,*hiP] between grid points (spaced every ss
+** pixels, among size pixels) that contains pixel ii; past the last
+** grid point, the interval is just that grid point
+*/
+static void
+_miteProgCell(unsigned int *loP, unsigned int *hiP,
+              unsigned int ii, unsigned int ss, unsigned int size) {
+  unsigned int last;
+
+  last = (size-1) - (size-1) % ss;
+  *loP = ii - ii % ss;
+  *hiP = AIR_MIN(*loP + ss, last);
+  return;
+}
+
+/*
+** _miteProgInterp
+**
+** sets pixel (ui,vi) of the RGBAZ image img (sx pixels wide) by
+** bilinear interpolation of RGBA at the corners of [u0,u1]x[v0,v1];
+** Z is copied from the nearest corner, since it isn't always defined
+*/
+static void
+_miteProgInterp(mite_t *img, unsigned int sx,
+                unsigned int ui, unsigned int vi,
+                unsigned int u0, unsigned int u1,
+                unsigned int v0, unsigned int v1) {
+  const mite_t *c00, *c10, *c01, *c11, *cn;
+  double fu, fv, aa, bb;
+  unsigned int ci;
+
+  fu = u1 > u0 ? AIR_CAST(double, ui - u0)/(u1 - u0) : 0;
+  fv = v1 > v0 ? AIR_CAST(double, vi - v0)/(v1 - v0) : 0;
+  c00 = img + 5*(u0 + sx*v0);
+  c10 = img + 5*(u1 + sx*v0);
+  c01 = img + 5*(u0 + sx*v1);
+  c11 = img + 5*(u1 + sx*v1);
+  for (ci=0; ci<4; ci++) {
+    aa = AIR_LERP(fu, c00[ci], c10[ci]);
+    bb = AIR_LERP(fu, c01[ci], c11[ci]);
+    img[ci + 5*(ui + sx*vi)] = AIR_CAST(mite_t, AIR_LERP(fv, aa, bb));
+  }
+  cn = (fv < 0.5
+          ? (fu < 0.5 ? c00 : c10)
+          : (fu < 0.5 ? c01 : c11));
+  img[4 + 5*(ui + sx*vi)] = cn[4];
+  return;
+}
+
+/*
+** _miteProgDiff
+**
+** the biggest difference in R, G, B, or A between the corners of
+** [u0,u1]x[v0,v1] in img
+*/
+static double
+_miteProgDiff(const mite_t *img, unsigned int sx,
+              unsigned int u0, unsigned int u1,
+              unsigned int v0, unsigned int v1) {
+  const mite_t *cc[4];
+  double mn, mx, diff;
+  unsigned int ci, ki;
+
+  cc[0] = img + 5*(u0 + sx*v0);
+  cc[1] = img + 5*(u1 + sx*v0);
+  cc[2] = img + 5*(u0 + sx*v1);
+  cc[3] = img + 5*(u1 + sx*v1);
+  diff = 0;
+  for (ci=0; ci<4; ci++) {
+    mn = mx = cc[0][ci];
+    for (ki=1; ki<4; ki++) {
+      mn = AIR_MIN(mn, cc[ki][ci]);
+      mx = AIR_MAX(mx, cc[ki][ci]);
+    }
+    diff = AIR_MAX(diff, mx - mn);
+  }
+  return diff;
+}
+
+/*
+******** miteRenderProgressive
+**
+** renders into muu->nout (as hooverRender(muu->hctx) would, with the
+** mite callbacks set by the caller), but coarse to fine: first the
+** rays at every stride-th pixel (along U and V), then those at every
+** stride/2-th pixel that haven't been rendered, and so on, down to
+** every pixel.  stride has to be a power of two.  After each level,
+** progress (if non-NULL) is called with the image so far; its non-zero
+** return stops the refinement, leaving the current (interpolated)
+** image in muu->nout.
+**
+** If thresh is non-negative, the refinement is adaptive: a ray in
+** between the rays of the previous level isn't cast if R, G, B, and A
+** at the 4 surrounding rays of the previous level differ by at most
+** thresh; its RGBA is then bilinearly interpolated from them.
+**
+** muu->rendTime and muu->sampRate are for all the levels together.
+*/
+int
+miteRenderProgressive(miteUser *muu, unsigned int stride, double thresh,
+                      miteProgress_t *progress, void *data) {
+  static const char me[]="miteRenderProgressive";
+  const unsigned char *oldMask;
+  unsigned char *mask, *done;
+  Nrrd *nimg;
+  mite_t *img, *out;
+  unsigned int sx, sy, ss, ui, vi, u0, u1, v0, v1, ci, pix, rayNum;
+  int E, Ecode, Ethread, stop;
+  double rendTime, samples;
+  airArray *mop;
+
+  if (!( muu && muu->nout )) {
+    biffAddf(MITE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  if (!( stride >= 1 && !(stride & (stride-1)) )) {
+    biffAddf(MITE, "%s: stride %u not a power of two", me, stride);
+    return 1;
+  }
+  if (!( muu->hctx->imgSize[0] > 0 && muu->hctx->imgSize[1] > 0 )) {
+    biffAddf(MITE, "%s: image dimensions (%dx%d) invalid", me,
+             muu->hctx->imgSize[0], muu->hctx->imgSize[1]);
+    return 1;
+  }
+  sx = AIR_UINT(muu->hctx->imgSize[0]);
+  sy = AIR_UINT(muu->hctx->imgSize[1]);
+  mop = airMopNew();
+  mask = AIR_CALLOC(sx*sy, unsigned char);
+  airMopAdd(mop, mask, airFree, airMopAlways);
+  done = AIR_CALLOC(sx*sy, unsigned char);
+  airMopAdd(mop, done, airFree, airMopAlways);
+  nimg = nrrdNew();
+  airMopAdd(mop, nimg, (airMopper)nrrdNuke, airMopAlways);
+  if (!( mask && done )) {
+    biffAddf(MITE, "%s: couldn't allocate %ux%u flags", me, sx, sy);
+    airMopError(mop); return 1;
+  }
+  if (nrrdMaybeAlloc_va(nimg, mite_nt, 3, AIR_CAST(size_t, 5),
+                        AIR_CAST(size_t, sx), AIR_CAST(size_t, sy))) {
+    biffMovef(MITE, NRRD, "%s: couldn't allocate image", me);
+    airMopError(mop); return 1;
+  }
+  img = AIR_CAST(mite_t *, nimg->data);
+
+  oldMask = muu->hctx->rayMask;
+  muu->hctx->rayMask = mask;
+  rendTime = samples = 0;
+  stop = AIR_FALSE;
+  for (ss=stride; ss && !stop; ss /= 2) {
+    /* decide which rays to cast at this level */
+    rayNum = 0;
+    for (vi=0; vi<sy; vi+=ss) {
+      for (ui=0; ui<sx; ui+=ss) {
+        pix = ui + sx*vi;
+        mask[pix] = 0;
+        if (done[pix]) {
+          continue;
+        }
+        if (ss < stride && thresh >= 0) {
+          _miteProgCell(&u0, &u1, ui, 2*ss, sx);
+          _miteProgCell(&v0, &v1, vi, 2*ss, sy);
+          /* if beyond the last rays of the previous level, there's
+             nothing to interpolate between */
+          if ((ui == u0 || u1 > u0) && (vi == v0 || v1 > v0)
+              && _miteProgDiff(img, sx, u0, u1, v0, v1) <= thresh) {
+            _miteProgInterp(img, sx, ui, vi, u0, u1, v0, v1);
+            done[pix] = AIR_TRUE;
+            continue;
+          }
+        }
+        mask[pix] = AIR_TRUE;
+        rayNum++;
+      }
+    }
+    if (rayNum) {
+      E = hooverRender(muu->hctx, &Ecode, &Ethread);
+      if (E) {
+        if (hooverErrInit == E) {
+          biffMovef(MITE, HOOVER, "%s: trouble starting stride %u",
+                    me, ss);
+        } else {
+          biffAddf(MITE, "%s: stride %u: %s error (code %d, thread %d)",
+                   me, ss, airEnumStr(hooverErr, E), Ecode, Ethread);
+        }
+        muu->hctx->rayMask = oldMask;
+        airMopError(mop); return 1;
+      }
+      rendTime += muu->rendTime;
+      samples += muu->sampRate*muu->rendTime;
+      out = AIR_CAST(mite_t *, muu->nout->data);
+      for (vi=0; vi<sy; vi+=ss) {
+        for (ui=0; ui<sx; ui+=ss) {
+          pix = ui + sx*vi;
+          if (mask[pix]) {
+            for (ci=0; ci<5; ci++) {
+              img[ci + 5*pix] = out[ci + 5*pix];
+            }
+            done[pix] = AIR_TRUE;
+          }
+        }
+      }
+    }
+    if (progress) {
+      if (ss > 1) {
+        /* fill in the pixels not rendered so far */
+        for (vi=0; vi<sy; vi++) {
+          _miteProgCell(&v0, &v1, vi, ss, sy);
+          for (ui=0; ui<sx; ui++) {
+            if (!done[ui + sx*vi]) {
+              _miteProgCell(&u0, &u1, ui, ss, sx);
+              _miteProgInterp(img, sx, ui, vi, u0, u1, v0, v1);
+            }
+          }
+        }
+      }
+      if (nrrdAxisInfoCopy(nimg, muu->nout, NULL, NRRD_AXIS_INFO_NONE)) {
+        biffMovef(MITE, NRRD, "%s: trouble copying axis info", me);
+        muu->hctx->rayMask = oldMask;
+        airMopError(mop); return 1;
+      }
+      stop = progress(nimg, ss, rayNum, data);
+    }
+  }
+  muu->hctx->rayMask = oldMask;
+
+  memcpy(muu->nout->data, img, 5*sx*sy*sizeof(mite_t));
+  muu->rendTime = rendTime;
+  muu->sampRate = rendTime ? samples/rendTime : 0;
+  airMopOkay(mop);
+  return 0;
+}
@@ -31,6 +31,7 @@ miteRayBegin(miteThread *mtt, miteRender *mrr, miteUser *muu,
              double rayStartWorld[3], double rayStartIndex[3],
              double rayDirWorld[3], double rayDirIndex[3]) {
   airPtrPtrUnion appu;
+  mite_t len;
   AIR_UNUSED(mrr);
   AIR_UNUSED(rayStartWorld);
   AIR_UNUSED(rayStartIndex);
@@ -66,27 +67,30 @@ miteRayBegin(miteThread *mtt, miteRender *mrr, miteUser *muu,
   mtt->TT = 1.0;
   mtt->ZZ = AIR_NAN;
   ELL_3V_SCALE(mtt->V, -1, rayDirWorld);
+  ELL_3V_ADD2(mtt->H, muu->lit->dir[0], mtt->V);
+  ELL_3V_NORM(mtt->H, mtt->H, len);
 
   return 0;
 }
 
 void
 _miteRGBACalc(mite_t *R, mite_t *G, mite_t *B, mite_t *A,
+              const mite_t *range,
               miteThread *mtt, miteRender *mrr, miteUser *muu) {
   static const char me[]="_miteRGBACalc";
   mite_t tmp,
     ad[3],                          /* ambient+diffuse light contribution */
     s[3] = {0,0,0},                 /* specular light contribution */
     col[3], E, ka, kd, ks, sp,      /* txf-determined rendering variables */
-    LdotN=0, HdotN, H[3], N[3];     /* for lighting calculation */
+    LdotN=0, HdotN, N[3];     /* for lighting calculation */
 
-  col[0] = mtt->range[miteRangeRed];
-  col[1] = mtt->range[miteRangeGreen];
-  col[2] = mtt->range[miteRangeBlue];
-  E = mtt->range[miteRangeEmissivity];
-  ka = mtt->range[miteRangeKa];
-  kd = mtt->range[miteRangeKd];
-  ks = mtt->range[miteRangeKs];
+  col[0] = range[miteRangeRed];
+  col[1] = range[miteRangeGreen];
+  col[2] = range[miteRangeBlue];
+  E = range[miteRangeEmissivity];
+  ka = range[miteRangeKa];
+  kd = range[miteRangeKd];
+  ks = range[miteRangeKs];
   ELL_3V_SCALE(ad, ka, muu->lit->amb);
   switch (mrr->shadeSpec->method) {
   case miteShadeMethodNone:
@@ -110,10 +114,8 @@ _miteRGBACalc(mite_t *R, mite_t *G, mite_t *B, mite_t *A,
         }
       }
       if (ks) {
-        sp = mtt->range[miteRangeSP];
-        ELL_3V_ADD2(H, muu->lit->dir[0], mtt->V);
-        ELL_3V_NORM(H, H, tmp);
-        HdotN = ELL_3V_DOT(H, N);
+        sp = range[miteRangeSP];
+        HdotN = ELL_3V_DOT(mtt->H, N);
         if (!muu->normalSide) {
           HdotN = AIR_ABS(HdotN);
         }
@@ -136,12 +138,12 @@ _miteRGBACalc(mite_t *R, mite_t *G, mite_t *B, mite_t *A,
   *R = (E - 1 + ad[0])*col[0] + s[0];
   *G = (E - 1 + ad[1])*col[1] + s[1];
   *B = (E - 1 + ad[2])*col[2] + s[2];
-  *A = mtt->range[miteRangeAlpha];
+  *A = range[miteRangeAlpha];
   *A = AIR_CLAMP(0.0, *A, 1.0);
   /*
   if (mtt->verbose) {
     fprintf(stderr, "%s: col[] = %g,%g,%g; A,E = %g,%g; Kads = %g,%g,%g\n", me,
-            col[0], col[1], col[2], mtt->range[miteRangeAlpha], E, ka, kd, ks);
+            col[0], col[1], col[2], range[miteRangeAlpha], E, ka, kd, ks);
     fprintf(stderr, "%s: N = (%g,%g,%g), L = (%g,%g,%g) ---> LdotN = %g\n",
             me, N[0], N[1], N[2], muu->lit->dir[0][0], muu->lit->dir[0][1],
             muu->lit->dir[0][2], LdotN);
@@ -158,9 +160,11 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
            double samplePosWorld[3],
            double samplePosIndex[3]) {
   static const char me[]="miteSample";
-  mite_t R, G, B, A;
+  mite_t R, G, B, A, hlen;
   double *NN;
-  double NdotV, kn[3], knd[3], ref[3], len, *dbg=NULL;
+  double NdotV, kn[3], knd[3], ref[3], len, *dbg=NULL, probeTime;
+  const mite_t *range;
+  const miteStage *stage;
 
   if (!inside) {
     return mtt->rayStep;
@@ -181,10 +185,13 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
   if (AIR_EXISTS(muu->fakeFrom[0])) {
     ELL_3V_SUB(mtt->V, samplePosWorld, muu->fakeFrom);
     ELL_3V_NORM(mtt->V, mtt->V, len);
+    ELL_3V_ADD2(mtt->H, muu->lit->dir[0], mtt->V);
+    ELL_3V_NORM(mtt->H, mtt->H, hlen);
   }
 
   /* do probing at this location to determine values of everything
      that might appear in the txf domain */
+  probeTime = muu->hctx->stats ? airTime() : 0;
   if (gageProbe(mtt->gctx,
                 samplePosIndex[0],
                 samplePosIndex[1],
@@ -193,6 +200,9 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
              mtt->gctx->errStr, mtt->gctx->errNum);
     return AIR_NAN;
   }
+  if (muu->hctx->stats) {
+    mtt->probeTime += airTime() - probeTime;
+  }
 
   if (mrr->queryMiteNonzero) {
     /* There is some optimal trade-off between slowing things down
@@ -250,11 +260,22 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
     muu->debugIdx = airArrayLenIncr(muu->debugArr, muu->ndebug->axis[0].size);
   }
 
-  memcpy(mtt->range, muu->rangeInit, MITE_RANGE_NUM*sizeof(mite_t));
-  _miteStageRun(mtt, muu);
+  if (mrr->rangeLut && !mtt->verbose) {
+    /* all the txfs at once (the verbose pixel needs _miteStageRun to
+       record the txf indices) */
+    stage = mtt->stage;
+    range = mrr->rangeLut + MITE_RANGE_NUM*airIndexClamp(stage->min,
+                                                         *(stage->val),
+                                                         stage->max,
+                                                         stage->size);
+  } else {
+    memcpy(mtt->range, muu->rangeInit, MITE_RANGE_NUM*sizeof(mite_t));
+    _miteStageRun(mtt, muu);
+    range = mtt->range;
+  }
 
   /* if there's opacity, do shading and compositing */
-  if (mtt->range[miteRangeAlpha]) {
+  if (range[miteRangeAlpha]) {
     /* fprintf(stderr, "%s: mtt->TT = %g\n", me, mtt->TT); */
     /*
     if (mtt->verbose) {
@@ -262,7 +283,7 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
               me, mtt->RR, mtt->GG, mtt->BB, mtt->TT);
     }
     */
-    _miteRGBACalc(&R, &G, &B, &A, mtt, mrr, muu);
+    _miteRGBACalc(&R, &G, &B, &A, range, mtt, mrr, muu);
     mtt->RR += mtt->TT*A*R;
     mtt->GG += mtt->TT*A*G;
     mtt->BB += mtt->TT*A*B;
@@ -297,6 +318,43 @@ miteSample(miteThread *mtt, miteRender *mrr, miteUser *muu,
   return mtt->rayStep;
 }
 
+/*
+** the hoover packetSample() callback: the samples inside the volume
+** go to miteSample(), in order, and the ones outside are passed over
+** here (miteSample() would just return mtt->rayStep for them)
+*/
+double
+miteSamplePacket(miteThread *mtt, miteRender *mrr, miteUser *muu,
+                 unsigned int packNum, int num,
+                 const double *rayT, const int *inside,
+                 const double *samplePosWorld,
+                 const double *samplePosIndex,
+                 unsigned int *doneNumP) {
+  double step, posW[3], posI[3];
+  unsigned int ii;
+
+  for (ii=0; ii<packNum; ii++) {
+    if (!inside[ii]) {
+      continue;
+    }
+    ELL_3V_SET(posW, samplePosWorld[ii],
+               samplePosWorld[ii + HOOVER_PACKET_MAX],
+               samplePosWorld[ii + 2*HOOVER_PACKET_MAX]);
+    ELL_3V_SET(posI, samplePosIndex[ii],
+               samplePosIndex[ii + HOOVER_PACKET_MAX],
+               samplePosIndex[ii + 2*HOOVER_PACKET_MAX]);
+    step = miteSample(mtt, mrr, muu, num + AIR_CAST(int, ii), rayT[ii],
+                      AIR_TRUE, posW, posI);
+    if (step != mtt->rayStep) {
+      /* the ray ended, or there was an error */
+      *doneNumP = ii + 1;
+      return step;
+    }
+  }
+  *doneNumP = packNum;
+  return mtt->rayStep;
+}
+
 int
 miteRayEnd(miteThread *mtt, miteRender *mrr, miteUser *muu) {
   int idx, slen, stageIdx;
@@ -49,6 +49,8 @@ _miteRenderNew(void) {
     mrr->time0 = AIR_NAN;
     GAGE_QUERY_RESET(mrr->queryMite);
     mrr->queryMiteNonzero = AIR_FALSE;
+    mrr->skip = NULL;
+    mrr->rangeLut = NULL;
   }
   return mrr;
 }
@@ -63,6 +65,61 @@ _miteRenderNix(miteRender *mrr) {
   return NULL;
 }
 
+/*
+** _miteSkipSet
+**
+** if muu->skipBlock asks for it and it's possible, sets up empty-space
+** skipping by hoover, based on where opacity is zero.  Skipped samples
+** have to be ones at which miteSample wouldn't do anything, hence the
+** conditions on the verbose pixel (which records every sample),
+** opacMatters (when zero, Z is set at the first sample), and the kernel
+** weights (hooverSkip bounds the values reconstructed with them)
+*/
+int
+_miteSkipSet(miteRender *mrr, miteUser *muu) {
+  static const char me[]="_miteSkipSet";
+  double *visible=NULL;
+  unsigned int visibleNum;
+  const char *why;
+
+  why = NULL;
+  if (!muu->nsin) {
+    why = "no scalar volume";
+  } else if (muu->verbUi >= 0 && muu->verbVi >= 0) {
+    why = "have a verbose pixel";
+  } else if (!( muu->opacMatters > 0 )) {
+    why = "opacMatters not > 0";
+  } else if (muu->gctx0->parm.renormalize) {
+    why = "kernel weights are renormalized";
+  } else {
+    if (miteNtxfVisible(&visible, &visibleNum,
+                        mrr->ntxf, AIR_UINT(mrr->ntxfNum))) {
+      biffAddf(MITE, "%s: trouble learning visible values", me);
+      return 1;
+    }
+    if (!visible) {
+      why = "opacity isn't only multiplied by a txf of scalar value";
+    }
+  }
+  if (why) {
+    fprintf(stderr, "!%s: not skipping empty space: %s\n", me, why);
+    return 0;
+  }
+  airMopAdd(mrr->rmop, visible, airFree, airMopAlways);
+  mrr->skip = hooverSkipNew();
+  airMopAdd(mrr->rmop, mrr->skip, (airMopper)hooverSkipNix, airMopAlways);
+  if (hooverSkipRangeSet(mrr->skip, muu->nsin, muu->skipBlock,
+                         muu->ksp[gageKernel00])
+      || hooverSkipEmptySet(mrr->skip, visible, visibleNum)) {
+    biffMovef(MITE, HOOVER, "%s: trouble setting up skipping", me);
+    return 1;
+  }
+  fprintf(stderr, "!%s: %u of %u blocks empty\n", me, mrr->skip->emptyNum,
+          mrr->skip->size[0]*mrr->skip->size[1]*mrr->skip->size[2]);
+  muu->hctx->skip = mrr->skip;
+  return 0;
+}
+
 int
 miteRenderBegin(miteRender **mrrP, miteUser *muu) {
   static const char me[]="miteRenderBegin";
@@ -88,6 +145,10 @@ miteRenderBegin(miteRender **mrrP, miteUser *muu) {
     biffAddf(MITE, "%s: trouble copying and alpha-adjusting txfs", me);
     return 1;
   }
+  if (_miteRangeLutSet(*mrrP, muu)) {
+    biffAddf(MITE, "%s: trouble making txf lookup table", me);
+    return 1;
+  }
 
   GAGE_QUERY_RESET(queryScl);
   GAGE_QUERY_RESET(queryVec);
@@ -143,6 +204,10 @@ miteRenderBegin(miteRender **mrrP, miteUser *muu) {
   }
   fprintf(stderr, "!%s: kernel support = %d^3 samples\n",
           me, 2*muu->gctx0->radius);
+  if (muu->skipBlock && _miteSkipSet(*mrrP, muu)) {
+    biffAddf(MITE, "%s: trouble with empty-space skipping", me);
+    return 1;
+  }
 
   if (nrrdMaybeAlloc_va(muu->nout, mite_nt, 3,
                         AIR_CAST(size_t, 5) /* RGBAZ */ ,
@@ -183,6 +248,10 @@ miteRenderEnd(miteRender *mrr, miteUser *muu) {
     samples += mrr->tt[thr]->samples;
   }
   muu->sampRate = samples/(1000.0*muu->rendTime);
+  if (mrr->skip) {
+    /* it's about to be freed */
+    muu->hctx->skip = NULL;
+  }
   _miteRenderNix(mrr);
   return 0;
 }
@@ -5,6 +5,7 @@ set(MITE_SOURCES
   kindnot.c
   mite.h
   privateMite.h
+  progressive.c
   ray.c
   renderMite.c
   shade.c
@@ -42,6 +42,7 @@ miteThreadNew() {
     airFree(mtt); return NULL;
   }
   mtt->gctx = NULL;
+  mtt->gps = NULL;
   mtt->ansScl = mtt->ansVec = mtt->ansTen = NULL;
   mtt->_normal = NULL;
   mtt->shadeVec0 = NULL;
@@ -68,6 +69,7 @@ miteThreadNew() {
   mtt->ui = mtt->vi = -1;
   mtt->raySample = 0;
   mtt->samples = 0;
+  mtt->probeTime = 0;
   mtt->stage = NULL;
   /* mtt->range[], rayStep, V, RR, GG, BB, TT  initialized in
      miteRayBegin or in miteSample */
@@ -101,15 +103,17 @@ miteThreadBegin(miteThread **mttP, miteRender *mrr,
 
   if (!whichThread) {
     /* this is the first thread- it just points to the parent gageContext */
+    (*mttP)->gps = NULL;
     (*mttP)->gctx = muu->gctx0;
   } else {
-    /* we have to generate a new gageContext */
-    (*mttP)->gctx = gageContextCopy(muu->gctx0);
-    if (!(*mttP)->gctx) {
+    /* we need per-thread probe state for the shared gageContext */
+    (*mttP)->gps = gageProbeStateNew(muu->gctx0);
+    if (!(*mttP)->gps) {
       biffMovef(MITE, GAGE,
                 "%s: couldn't set up thread %d", me, whichThread);
       return 1;
     }
+    (*mttP)->gctx = (*mttP)->gps->ctx;
   }
 
   if (-1 != mrr->sclPvlIdx) {
@@ -132,6 +136,7 @@ miteThreadBegin(miteThread **mttP, miteRender *mrr,
   (*mttP)->thrid = whichThread;
   (*mttP)->raySample = 0;
   (*mttP)->samples = 0;
+  (*mttP)->probeTime = 0;
   (*mttP)->verbose = 0;
   (*mttP)->skip = 0;
   (*mttP)->_normal = _miteAnswerPointer(*mttP, mrr->normalSpec);
@@ -168,9 +173,15 @@ int
 miteThreadEnd(miteThread *mtt, miteRender *mrr,
               miteUser *muu) {
 
-  AIR_UNUSED(mtt);
   AIR_UNUSED(mrr);
-  AIR_UNUSED(muu);
+  if (muu->hctx->stats) {
+    /* this is only ever called by hoover thread thrid */
+    muu->hctx->stats->thread[mtt->thrid].probeTime += mtt->probeTime;
+  }
+  if (mtt->gps) {
+    mtt->gps = gageProbeStateNix(mtt->gps);
+    mtt->gctx = NULL;
+  }
   return 0;
 }
 
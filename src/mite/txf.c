@@ -324,6 +324,141 @@ miteNtxfCheck(const Nrrd *ntxf) {
   return 0;
 }
 
+/*
+** _miteStageOpGet
+**
+** returns the miteStageOp with which the given txf is applied: from its
+** "miteStageOp" key/value pair, or miteStageOpMultiply if there is no
+** such pair, or it isn't recognized
+*/
+static int
+_miteStageOpGet(const Nrrd *ntxf) {
+  char *value;
+  int op;
+
+  op = miteStageOpMultiply;
+  value = nrrdKeyValueGet(ntxf, "miteStageOp");
+  if (value) {
+    op = airEnumVal(miteStageOp, value);
+    if (miteStageOpUnknown == op) {
+      op = miteStageOpMultiply;
+    }
+    airFree(value);
+  }
+  return op;
+}
+
+/*
+******** miteNtxfVisible()
+**
+** For empty-space skipping (see hooverSkip): learns from the given
+** transfer functions (which have passed miteNtxfCheck) the intervals of
+** scalar value (gageSclValue) outside of which opacity is zero, and
+** sets *visibleP to a new array of (min,max) pairs for the
+** *visibleNumP intervals (which may be zero).  This is possible when
+** every transfer function that sets opacity does so by multiplication
+** (the default miteStageOp), and at least one of them is a 1-D
+** function of the scalar value: where that one is zero, so is opacity.
+** If there is more than one, the one with fewest non-zero entries is
+** used.  If it isn't possible, *visibleP is set to NULL.
+**
+** Note that these are the txfs as used for rendering: after alpha
+** adjustment and unquantization (of which only the first preserves
+** zero-ness).
+*/
+int
+miteNtxfVisible(double **visibleP, unsigned int *visibleNumP,
+                Nrrd *const *ntxf, unsigned int ntxfNum) {
+  static const char me[]="miteNtxfVisible";
+  double (*lup)(const void *, size_t), *vis, ww, min, max;
+  unsigned int ni, best, bestNum, num, rnum, ai, ii, size, vi;
+  char *aa;
+  int on;
+  gageItemSpec isp;
+
+  if (!( visibleP && visibleNumP && ntxf )) {
+    biffAddf(MITE, "%s: got NULL pointer", me);
+    return 1;
+  }
+  *visibleP = NULL;
+  *visibleNumP = 0;
+  best = ntxfNum;
+  bestNum = 0;
+  for (ni=0; ni<ntxfNum; ni++) {
+    aa = strchr(ntxf[ni]->axis[0].label, miteRangeChar[miteRangeAlpha]);
+    if (!aa) {
+      continue;
+    }
+    /* else this txf sets opacity */
+    if (miteStageOpMultiply != _miteStageOpGet(ntxf[ni])) {
+      /* opacity can be non-zero where this txf is zero */
+      return 0;
+    }
+    if (2 != ntxf[ni]->dim) {
+      continue;
+    }
+    miteVariableParse(&isp, ntxf[ni]->axis[1].label);
+    if (!( gageKindScl == isp.kind && gageSclValue == isp.item )) {
+      continue;
+    }
+    lup = nrrdDLookup[ntxf[ni]->type];
+    rnum = AIR_UINT(ntxf[ni]->axis[0].size);
+    ai = AIR_UINT(aa - ntxf[ni]->axis[0].label);
+    size = AIR_UINT(ntxf[ni]->axis[1].size);
+    num = 0;
+    for (ii=0; ii<size; ii++) {
+      num += !!lup(ntxf[ni]->data, ai + rnum*ii);
+    }
+    if (ntxfNum == best || num < bestNum) {
+      best = ni;
+      bestNum = num;
+    }
+  }
+  if (ntxfNum == best) {
+    return 0;
+  }
+
+  /* intervals are maximal runs of non-zero entries.  As in
+     _miteStageRun, values below min and above max go to the first and
+     last entries, and the intervals are padded a little in case of
+     different rounding in airIndexClamp */
+  lup = nrrdDLookup[ntxf[best]->type];
+  rnum = AIR_UINT(ntxf[best]->axis[0].size);
+  ai = AIR_UINT(strchr(ntxf[best]->axis[0].label,
+                       miteRangeChar[miteRangeAlpha])
+                - ntxf[best]->axis[0].label);
+  size = AIR_UINT(ntxf[best]->axis[1].size);
+  min = ntxf[best]->axis[1].min;
+  max = ntxf[best]->axis[1].max;
+  ww = (max - min)/size;
+  vis = AIR_CALLOC(2*AIR_MAX(1, bestNum), double);
+  if (!vis) {
+    biffAddf(MITE, "%s: couldn't allocate intervals", me);
+    return 1;
+  }
+  vi = 0;
+  on = AIR_FALSE;
+  for (ii=0; ii<size; ii++) {
+    if (lup(ntxf[best]->data, ai + rnum*ii)) {
+      if (!on) {
+        vis[0 + 2*vi] = (ii ? min + (ii - 0.01)*ww : AIR_NEG_INF);
+        on = AIR_TRUE;
+      }
+    } else if (on) {
+      vis[1 + 2*vi] = min + (ii + 0.01)*ww;
+      vi++;
+      on = AIR_FALSE;
+    }
+  }
+  if (on) {
+    vis[1 + 2*vi] = AIR_POS_INF;
+    vi++;
+  }
+  *visibleP = vis;
+  *visibleNumP = vi;
+  return 0;
+}
+
 /*
 ******** miteQueryAdd()
 **
@@ -477,6 +612,90 @@ _miteNtxfAlphaAdjust(miteRender *mrr, miteUser *muu) {
   return 0;
 }
 
+/*
+** _miteRangeLutSet
+**
+** if all the txfs are 1-D, over the same scalar variable with the same
+** quantization, then the range values set at a sample by all of them
+** (from muu->rangeInit, as done by _miteStageRun) only depend on the
+** one txf index.  In that case, this computes them all, to be looked
+** up in miteSample; otherwise mrr->rangeLut is left NULL.
+*/
+int
+_miteRangeLutSet(miteRender *mrr, miteUser *muu) {
+  static const char me[]="_miteRangeLutSet";
+  gageItemSpec isp0, isp;
+  const Nrrd *ntxf, *ntxf0;
+  const mite_t *data;
+  mite_t *range;
+  char *value;
+  unsigned int size, ii, rii, rnum;
+  int ni, ri, op;
+
+  mrr->rangeLut = NULL;
+  ntxf0 = mrr->ntxf[0];
+  miteVariableParse(&isp0, ntxf0->axis[1].label);
+  if (!( isp0.kind && 1 == isp0.kind->table[isp0.item].answerLength )) {
+    return 0;
+  }
+  for (ni=0; ni<mrr->ntxfNum; ni++) {
+    ntxf = mrr->ntxf[ni];
+    if (2 != ntxf->dim) {
+      return 0;
+    }
+    miteVariableParse(&isp, ntxf->axis[1].label);
+    if (!( isp.kind == isp0.kind && isp.item == isp0.item
+           && ntxf->axis[1].size == ntxf0->axis[1].size
+           && ntxf->axis[1].min == ntxf0->axis[1].min
+           && ntxf->axis[1].max == ntxf0->axis[1].max )) {
+      return 0;
+    }
+  }
+  size = AIR_UINT(ntxf0->axis[1].size);
+  mrr->rangeLut = AIR_CALLOC(MITE_RANGE_NUM*size, mite_t);
+  if (!mrr->rangeLut) {
+    biffAddf(MITE, "%s: couldn't allocate %u-entry lookup table", me, size);
+    return 1;
+  }
+  airMopAdd(mrr->rmop, mrr->rangeLut, airFree, airMopAlways);
+  for (ii=0; ii<size; ii++) {
+    range = mrr->rangeLut + MITE_RANGE_NUM*ii;
+    memcpy(range, muu->rangeInit, MITE_RANGE_NUM*sizeof(mite_t));
+    for (ni=0; ni<mrr->ntxfNum; ni++) {
+      ntxf = mrr->ntxf[ni];
+      /* same as in _miteStageSet */
+      value = nrrdKeyValueGet(ntxf, "miteStageOp");
+      op = value ? airEnumVal(miteStageOp, value) : miteStageOpMultiply;
+      op = miteStageOpUnknown == op ? miteStageOpMultiply : op;
+      free(value);
+      rnum = AIR_UINT(ntxf->axis[0].size);
+      data = AIR_CAST(const mite_t *, ntxf->data) + rnum*ii;
+      /* same as in _miteStageRun */
+      for (rii=0; rii<rnum; rii++) {
+        ri = AIR_CAST(int, strchr(miteRangeChar, ntxf->axis[0].label[rii])
+                      - miteRangeChar);
+        switch(op) {
+        case miteStageOpMin:
+          range[ri] = AIR_MIN(range[ri], data[rii]);
+          break;
+        case miteStageOpMax:
+          range[ri] = AIR_MAX(range[ri], data[rii]);
+          break;
+        case miteStageOpAdd:
+          range[ri] += data[rii];
+          break;
+        case miteStageOpMultiply:
+        default:
+          range[ri] *= data[rii];
+          break;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+
 int
 _miteStageNum(miteRender *mrr) {
   int num, ni;
@@ -542,7 +761,6 @@ _miteAnswerPointer(miteThread *mtt, gageItemSpec *isp) {
 int
 _miteStageSet(miteThread *mtt, miteRender *mrr) {
   static const char me[]="_miteStageSet";
-  char *value;
   int ni, di, stageIdx, rii, stageNum, ilog2;
   Nrrd *ntxf;
   miteStage *stage;
@@ -578,15 +796,7 @@ _miteStageSet(miteThread *mtt, miteRender *mrr) {
         stage->data = NULL;
       } else {
         stage->data = (mite_t *)ntxf->data;
-        value = nrrdKeyValueGet(ntxf, "miteStageOp");
-        if (value) {
-          stage->op = airEnumVal(miteStageOp, value);
-          if (miteStageOpUnknown == stage->op) {
-            stage->op = miteStageOpMultiply;
-          }
-        } else {
-          stage->op = miteStageOpMultiply;
-        }
+        stage->op = _miteStageOpGet(ntxf);
         if (1 == isp.kind->table[isp.item].answerLength) {
           stage->qn = NULL;
         } else if (3 == isp.kind->table[isp.item].answerLength) {
@@ -54,6 +54,7 @@ miteUserNew() {
   muu->rayStep = AIR_NAN;
   muu->opacMatters = miteDefOpacMatters;
   muu->opacNear1 = miteDefOpacNear1;
+  muu->skipBlock = 0;
   muu->hctx = hooverContextNew();
   ELL_3V_SET(muu->fakeFrom, AIR_NAN, AIR_NAN, AIR_NAN);
   ELL_3V_SET(muu->vectorD, 0, 0, 0);
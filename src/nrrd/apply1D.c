@@ -273,13 +273,373 @@ _nrrdApply1DSetUp(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
   return 0;
 }
 
+/*
+** _nrrdApply1DTask
+**
+** everything needed to map some contiguous range of values from the
+** input into the output, so that the work can be split between threads
+** by _nrrdThreadRun.  This is shared by the luts, regular maps, and
+** irregular maps.
+*/
+typedef struct {
+  int kind,                   /* kindLut, kindRmap, or kindImap */
+    rescale, multi;
+  const NrrdRange *range;
+  double domMin, domMax;      /* domain of map */
+  unsigned int mapLen,        /* number of entries (control points) in map */
+    entLen,                   /* number of values in one output entry */
+    mapEntLen;                /* number of values in one map entry (for
+                                 irregular maps, one more than entLen) */
+  const char *mapData;        /* map data, as char* */
+  size_t mapSize;             /* size of a whole map (when multi) */
+  double (*mapLup)(const void *v, size_t I);
+  const double *mapD;         /* if non-NULL: the map values, as doubles */
+  /* irregular maps only */
+  const double *pos;          /* existent control point locations */
+  int posLen, baseI;
+  const unsigned short *acl;
+  unsigned int aclLen;
+  /* input and output */
+  const char *inData;
+  size_t inSize, outSize;     /* size of one input value, output entry */
+  double (*inLoad)(const void *v);
+  int inType;
+  char *outData;
+  int outType;
+  double (*outInsert)(void *v, size_t I, double d);
+  const char *vtable;         /* if non-NULL: output entries for all
+                                 possible input values */
+  double vmin;                /* lowest possible input value */
+} _nrrdApply1DTask;
+
+static void
+_nrrdApply1DInsert(const _nrrdApply1DTask *task, char *out,
+                   unsigned int ii, double val) {
+
+  switch (task->outType) {
+  case nrrdTypeFloat:
+    AIR_CAST(float *, out)[ii] = AIR_CAST(float, val);
+    break;
+  case nrrdTypeDouble:
+    AIR_CAST(double *, out)[ii] = val;
+    break;
+  default:
+    task->outInsert(out, ii, val);
+    break;
+  }
+  return;
+}
+
+/* value ii of map entry ei, for the map at mapData */
+#define MAPVAL(task, mapData, ei, ii)                                   \
+  ((task)->mapD                                                         \
+   ? (task)->mapD[(ei)*(task)->mapEntLen + (ii)]                        \
+   : (task)->mapLup((mapData), (ei)*(task)->mapEntLen + (ii)))
+
+/*
+** _nrrdApply1DValue()
+**
+** maps one value "val" through the map at mapData, and puts the
+** resulting entry in "out"
+*/
+static void
+_nrrdApply1DValue(const _nrrdApply1DTask *task, char *out,
+                  const char *mapData, double val) {
+  static const char me[]="_nrrdApply1DValue";
+  const NrrdRange *range;
+  double mapIdxFrac, domMin, domMax;
+  unsigned int ii, mapIdx, entLen, mapLen;
+  int lo, hi, mapIdxI, aclIdx;
+
+  range = task->range;
+  domMin = task->domMin;
+  domMax = task->domMax;
+  entLen = task->entLen;
+  mapLen = task->mapLen;
+  if (kindImap == task->kind) {
+    if (!AIR_EXISTS(val)) {
+      /* got a non-existent value */
+      if (task->baseI) {
+        /* and we know how to deal with them */
+        switch (airFPClass_d(val)) {
+        case airFP_NEG_INF:
+          mapIdxI = 0;
+          break;
+        case airFP_SNAN:
+        case airFP_QNAN:
+          mapIdxI = 1;
+          break;
+        case airFP_POS_INF:
+          mapIdxI = 2;
+          break;
+        default:
+          mapIdxI = 0;
+          fprintf(stderr, "%s: PANIC: non-existent value/class %g/%d "
+                  "not handled\n",
+                  me, val, airFPClass_d(val));
+          exit(1);
+        }
+        for (ii=0; ii<entLen; ii++) {
+          _nrrdApply1DInsert(task, out, ii,
+                             MAPVAL(task, mapData, mapIdxI, ii+1));
+        }
+        return;  /* we're done! (with this value) */
+      } else {
+        /* we don't know how to properly deal with this non-existent value:
+           we use the first entry, and then fall through to code below */
+        mapIdxI = 0;
+      }
+    } else {
+      /* we have an existent value */
+      if (task->rescale) {
+        val = (range->min != range->max
+               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
+               : domMin);
+      }
+      val = AIR_CLAMP(domMin, val, domMax);
+      if (task->acl) {
+        aclIdx = airIndex(domMin, val, domMax, task->aclLen);
+        lo = task->acl[0 + 2*aclIdx];
+        hi = task->acl[1 + 2*aclIdx];
+      } else {
+        lo = 0;
+        hi = task->posLen-2;
+      }
+      if (lo < hi) {
+        mapIdxI = _nrrd1DIrregFindInterval(task->pos, val, lo, hi);
+      } else {
+        /* acl did its job ==> lo == hi */
+        mapIdxI = lo;
+      }
+    }
+    mapIdxFrac = AIR_AFFINE(task->pos[mapIdxI], val,
+                            task->pos[mapIdxI+1], 0.0, 1.0);
+    mapIdxI += task->baseI;
+    for (ii=0; ii<entLen; ii++) {
+      _nrrdApply1DInsert(task, out, ii,
+                         ((1-mapIdxFrac)*MAPVAL(task, mapData, mapIdxI, ii+1)
+                          + mapIdxFrac*MAPVAL(task, mapData,
+                                              mapIdxI+1, ii+1)));
+    }
+    return;
+  }
+
+  /* else its a lut or regular map */
+  if (task->rescale) {
+    val = (range->min != range->max
+           ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
+           : domMin);
+  }
+  if (!AIR_EXISTS(val)) {
+    /* copy non-existent values from input to output */
+    for (ii=0; ii<entLen; ii++) {
+      _nrrdApply1DInsert(task, out, ii, val);
+    }
+    return;
+  }
+  if (kindRmap == task->kind) {
+    if (1 == mapLen) {
+      for (ii=0; ii<entLen; ii++) {
+        _nrrdApply1DInsert(task, out, ii, MAPVAL(task, mapData, 0, ii));
+      }
+      return;
+    }
+    val = AIR_CLAMP(domMin, val, domMax);
+    mapIdxFrac = AIR_AFFINE(domMin, val, domMax, 0, mapLen-1);
+    mapIdx = (unsigned int)mapIdxFrac;
+    mapIdx -= mapIdx == mapLen-1;
+    mapIdxFrac -= mapIdx;
+    for (ii=0; ii<entLen; ii++) {
+      _nrrdApply1DInsert(task, out, ii,
+                         ((1-mapIdxFrac)*MAPVAL(task, mapData, mapIdx, ii)
+                          + mapIdxFrac*MAPVAL(task, mapData, mapIdx+1, ii)));
+    }
+  } else {
+    mapIdx = airIndexClamp(domMin, val, domMax, mapLen);
+    for (ii=0; ii<entLen; ii++) {
+      _nrrdApply1DInsert(task, out, ii, MAPVAL(task, mapData, mapIdx, ii));
+    }
+  }
+  return;
+}
+
+#undef MAPVAL
+
+/*
+** _nrrdApply1DWork()
+**
+** maps values [lo,hi) of the input; this is what _nrrdThreadRun calls
+*/
+static void
+_nrrdApply1DWork(void *_task, size_t lo, size_t hi, unsigned int tidx) {
+  const _nrrdApply1DTask *task;
+  const char *inData, *mapData;
+  char *outData;
+  size_t II, outSize;
+
+  AIR_UNUSED(tidx);
+  task = AIR_CAST(const _nrrdApply1DTask *, _task);
+  outSize = task->outSize;
+  outData = task->outData + lo*outSize;
+  if (task->vtable) {
+    /* the input is 8- or 16-bit integral, and every possible result has
+       already been computed: mapping is just copying */
+    const char *vtable;
+    vtable = task->vtable;
+    switch (task->inType) {
+    case nrrdTypeChar:
+      {
+        const signed char *in;
+        in = AIR_CAST(const signed char *, task->inData);
+        for (II=lo; II<hi; II++, outData += outSize) {
+          memcpy(outData, vtable + (in[II] + 128)*outSize, outSize);
+        }
+      }
+      break;
+    case nrrdTypeUChar:
+      {
+        const unsigned char *in;
+        in = AIR_CAST(const unsigned char *, task->inData);
+        for (II=lo; II<hi; II++, outData += outSize) {
+          memcpy(outData, vtable + in[II]*outSize, outSize);
+        }
+      }
+      break;
+    case nrrdTypeShort:
+      {
+        const signed short *in;
+        in = AIR_CAST(const signed short *, task->inData);
+        for (II=lo; II<hi; II++, outData += outSize) {
+          memcpy(outData, vtable + (in[II] + 32768)*outSize, outSize);
+        }
+      }
+      break;
+    case nrrdTypeUShort:
+      {
+        const unsigned short *in;
+        in = AIR_CAST(const unsigned short *, task->inData);
+        for (II=lo; II<hi; II++, outData += outSize) {
+          memcpy(outData, vtable + in[II]*outSize, outSize);
+        }
+      }
+      break;
+    }
+    return;
+  }
+  mapData = task->mapData;
+  if (task->multi) {
+    mapData += lo*task->mapSize;
+  }
+  switch (task->inType) {
+  case nrrdTypeFloat:
+    {
+      const float *in;
+      in = AIR_CAST(const float *, task->inData);
+      for (II=lo; II<hi; II++, outData += outSize) {
+        _nrrdApply1DValue(task, outData, mapData, in[II]);
+        if (task->multi) {
+          mapData += task->mapSize;
+        }
+      }
+    }
+    break;
+  default:
+    inData = task->inData + lo*task->inSize;
+    for (II=lo; II<hi; II++, outData += outSize) {
+      _nrrdApply1DValue(task, outData, mapData, task->inLoad(inData));
+      inData += task->inSize;
+      if (task->multi) {
+        mapData += task->mapSize;
+      }
+    }
+    break;
+  }
+  return;
+}
+
+/*
+** _nrrdApply1DRun()
+**
+** given a task with everything except the acceleration structures
+** set, sets those up (converting the map to doubles, and for 8- and
+** 16-bit integral input, computing the output for every possible
+** input value) and runs the task in nrrdStateThreadNum threads.
+*/
+static int
+_nrrdApply1DRun(_nrrdApply1DTask *task, const Nrrd *nin, const Nrrd *nmap) {
+  static const char me[]="_nrrdApply1DRun";
+  double *mapD;
+  char *vtable;
+  size_t N, II, mapNum, valNum;
+  airArray *mop;
+
+  mop = airMopNew();
+  N = nrrdElementNumber(nin);
+  task->mapD = NULL;
+  if (!task->multi && nrrdTypeDouble != nmap->type) {
+    mapNum = nrrdElementNumber(nmap);
+    mapD = AIR_CALLOC(mapNum, double);
+    if (!mapD) {
+      biffAddf(NRRD, "%s: couldn't allocate map copy", me);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, mapD, airFree, airMopAlways);
+    for (II=0; II<mapNum; II++) {
+      mapD[II] = task->mapLup(nmap->data, II);
+    }
+    task->mapD = mapD;
+  } else if (!task->multi) {
+    task->mapD = AIR_CAST(const double *, nmap->data);
+  }
+  task->vtable = NULL;
+  switch (nin->type) {
+  case nrrdTypeChar:
+  case nrrdTypeUChar:
+    valNum = 1 << 8;
+    break;
+  case nrrdTypeShort:
+  case nrrdTypeUShort:
+    valNum = 1 << 16;
+    break;
+  default:
+    valNum = 0;
+    break;
+  }
+  /* the value table is only worth it when it is smaller than the output */
+  if (valNum && !task->multi && valNum < N) {
+    task->vmin = (nrrdTypeChar == nin->type
+                  ? -128
+                  : (nrrdTypeShort == nin->type
+                     ? -32768
+                     : 0));
+    vtable = AIR_CALLOC(valNum*task->outSize, char);
+    if (!vtable) {
+      biffAddf(NRRD, "%s: couldn't allocate value table", me);
+      airMopError(mop); return 1;
+    }
+    airMopAdd(mop, vtable, airFree, airMopAlways);
+    for (II=0; II<valNum; II++) {
+      _nrrdApply1DValue(task, vtable + II*task->outSize, task->mapData,
+                        task->vmin + AIR_CAST(double, II));
+    }
+    task->vtable = vtable;
+  }
+  if (_nrrdThreadRun(nrrdStateThreadNum, N, 2048 /* grain */,
+                     _nrrdApply1DWork, task)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
+  return 0;
+}
+
 /*
 ** _nrrdApply1DLutOrRegMap()
 **
 ** the guts of nrrdApply1DLut and nrrdApply1DRegMap
 **
-** yikes, does NOT use biff, since we're only supposed to be called
-** after copious error checking.
+** This does use biff, but only for allocation errors, since we're
+** only supposed to be called after copious error checking.
 **
 ** FOR INSTANCE, this allows nout == nin, which could be a big
 ** problem if mapAxis == 1.
@@ -292,130 +652,55 @@ _nrrdApply1DSetUp(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
 ** are probaby undefined.  HEY: there is currently no warning message
 ** or error handling based on nrrdStateDisallowIntegerNonExist, but
 ** there really should be.
+**
+** The work is split across nrrdStateThreadNum threads; the output
+** does not depend on the number of threads.
 */
 int
 _nrrdApply1DLutOrRegMap(Nrrd *nout, const Nrrd *nin, const NrrdRange *range,
                         const Nrrd *nmap, int ramps, int rescale, int multi) {
-  /* static const char me[]="_nrrdApply1DLutOrRegMap"; */
-  char *inData, *outData, *mapData, *entData0, *entData1;
-  size_t N, I;
-  double (*inLoad)(const void *v), (*mapLup)(const void *v, size_t I),
-    (*outInsert)(void *v, size_t I, double d),
-    val, mapIdxFrac, domMin, domMax;
-  unsigned int i, mapAxis, mapLen, mapIdx, entSize, entLen, inSize, outSize;
+  static const char me[]="_nrrdApply1DLutOrRegMap";
+  _nrrdApply1DTask task;
+  unsigned int mapAxis;
 
   if (!multi) {
     mapAxis = nmap->dim - 1;           /* axis of nmap containing entries */
   } else {
     mapAxis = nmap->dim - nin->dim - 1;
   }
-  mapData = (char *)nmap->data;        /* map data, as char* */
+  task.kind = ramps ? kindRmap : kindLut;
+  task.rescale = rescale;
+  task.multi = multi;
+  task.range = range;
                                        /* low end of map domain */
-  domMin = _nrrdApplyDomainMin(nmap, ramps, mapAxis);
+  task.domMin = _nrrdApplyDomainMin(nmap, ramps, mapAxis);
                                        /* high end of map domain */
-  domMax = _nrrdApplyDomainMax(nmap, ramps, mapAxis);
-  mapLen = AIR_CAST(unsigned int, nmap->axis[mapAxis].size);   /* number of entries in map */
-  mapLup = nrrdDLookup[nmap->type];    /* how to get doubles out of map */
-  inData = (char *)nin->data;          /* input data, as char* */
-  inLoad = nrrdDLoad[nin->type];       /* how to get doubles out of nin */
-  inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));       /* size of one input value */
-  outData = (char *)nout->data;        /* output data, as char* */
-  outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
-  entLen = (mapAxis                    /* number of elements in one entry */
-            ? AIR_CAST(unsigned int, nmap->axis[0].size)
-            : 1);
-  outSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nout)); /* size of entry in output */
-  entSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nmap)); /* size of entry in map */
-
-  N = nrrdElementNumber(nin);       /* the number of values to be mapped */
-  if (ramps) {
-    /* regular map */
-    for (I=0; I<N; I++) {
-      /* ...
-      if (!(I % 100)) fprintf(stderr, "I = %d\n", (int)I);
-      ... */
-      val = inLoad(inData);
-      /* ...
-      fprintf(stderr, "##%s: val = \na% 31.15f --> ", me, val);
-      ... */
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-        /* ...
-        fprintf(stderr, "\nb% 31.15f (min,max = %g,%g)--> ", val,
-                range->min, range->max);
-        ... */
-      }
-      /* ...
-      fprintf(stderr, "\nc% 31.15f --> clamp(%g,%g), %d --> ",
-              val, domMin, domMax, mapLen);
-      ... */
-      if (AIR_EXISTS(val)) {
-        val = AIR_CLAMP(domMin, val, domMax);
-        mapIdxFrac = AIR_AFFINE(domMin, val, domMax, 0, mapLen-1);
-        /* ...
-        fprintf(stderr, "mapIdxFrac = \nd% 31.15f --> ",
-                mapIdxFrac);
-        ... */
-        mapIdx = (unsigned int)mapIdxFrac;
-        mapIdx -= mapIdx == mapLen-1;
-        mapIdxFrac -= mapIdx;
-        /* ...
-        fprintf(stderr, "%s: (%d,\ne% 31.15f) --> \n",
-                me, mapIdx, mapIdxFrac);
-        ... */
-        entData0 = mapData + mapIdx*entSize;
-        entData1 = mapData + (mapIdx+1)*entSize;
-        for (i=0; i<entLen; i++) {
-          val = ((1-mapIdxFrac)*mapLup(entData0, i) +
-                 mapIdxFrac*mapLup(entData1, i));
-          outInsert(outData, i, val);
-          /* ...
-          fprintf(stderr, "f% 31.15f\n", val);
-          ... */
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val);
-        }
-      }
-      inData += inSize;
-      outData += outSize;
-      if (multi) {
-        mapData += mapLen*entSize;
-      }
-    }
-  } else {
-    /* lookup table */
-    for (I=0; I<N; I++) {
-      val = inLoad(inData);
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-      }
-      if (AIR_EXISTS(val)) {
-        mapIdx = airIndexClamp(domMin, val, domMax, mapLen);
-        entData0 = mapData + mapIdx*entSize;
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, mapLup(entData0, i));
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val);
-        }
-      }
-      inData += inSize;
-      outData += outSize;
-      if (multi) {
-        mapData += mapLen*entSize;
-      }
-    }
+  task.domMax = _nrrdApplyDomainMax(nmap, ramps, mapAxis);
+                                       /* number of entries in map */
+  task.mapLen = AIR_CAST(unsigned int, nmap->axis[mapAxis].size);
+  task.entLen = (mapAxis               /* number of elements in one entry */
+                 ? AIR_CAST(unsigned int, nmap->axis[0].size)
+                 : 1);
+  task.mapEntLen = task.entLen;
+  task.mapData = (const char *)nmap->data;
+  task.mapSize = task.mapLen*task.entLen*nrrdElementSize(nmap);
+  task.mapLup = nrrdDLookup[nmap->type];    /* how to get doubles out of map */
+  task.pos = NULL;
+  task.posLen = task.baseI = 0;
+  task.acl = NULL;
+  task.aclLen = 0;
+  task.inData = (const char *)nin->data;
+  task.inSize = nrrdElementSize(nin);
+  task.inLoad = nrrdDLoad[nin->type];       /* how to get doubles out of nin */
+  task.inType = nin->type;
+  task.outData = (char *)nout->data;
+  task.outSize = task.entLen*nrrdElementSize(nout);
+  task.outType = nout->type;
+  task.outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
+  if (_nrrdApply1DRun(&task, nin, nmap)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    return 1;
   }
-
   return 0;
 }
 
@@ -878,19 +1163,19 @@ nrrd1DIrregAclGenerate(Nrrd *nacl, const Nrrd *nmap, size_t aclLen) {
 ** This assumes that nrrd1DIrregMapCheck has been called on "nmap",
 ** and that nrrd1DIrregAclCheck has been called on "nacl" (if it is
 ** non-NULL).
+**
+** As with luts and regular maps, 8- and 16-bit integral input is
+** handled by first mapping every possible input value (so there is
+** no interval search per value), and the work is split across
+** nrrdStateThreadNum threads.
 */
 int
 nrrdApply1DIrregMap(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
                     const Nrrd *nmap, const Nrrd *nacl,
                     int typeOut, int rescale) {
   static const char me[]="nrrdApply1DIrregMap";
-  size_t N, I;
-  int i, *acl, entLen, posLen, aclLen, mapIdx, aclIdx,
-    entSize, colSize, inSize, lo, hi, baseI;
-  double val, *pos, domMin, domMax, mapIdxFrac,
-    (*mapLup)(const void *v, size_t I),
-    (*inLoad)(const void *v), (*outInsert)(void *v, size_t I, double d);
-  char *inData, *outData, *entData0, *entData1;
+  _nrrdApply1DTask task;
+  double *pos;
   NrrdRange *range;
   airArray *mop;
 
@@ -920,119 +1205,48 @@ nrrdApply1DIrregMap(Nrrd *nout, const Nrrd *nin, const NrrdRange *_range,
   }
 
   if (nacl) {
-    acl = (int *)nacl->data;
-    aclLen = AIR_CAST(unsigned int,nacl->axis[1].size);
+    task.acl = (const unsigned short *)nacl->data;
+    task.aclLen = AIR_CAST(unsigned int, nacl->axis[1].size);
   } else {
-    acl = NULL;
-    aclLen = 0;
+    task.acl = NULL;
+    task.aclLen = 0;
   }
-  pos = _nrrd1DIrregMapDomain(&posLen, &baseI, nmap);
+  pos = _nrrd1DIrregMapDomain(&(task.posLen), &(task.baseI), nmap);
   if (!pos) {
     biffAddf(NRRD, "%s: couldn't determine domain", me);
     airMopError(mop); return 1;
   }
   airMopAdd(mop, pos, airFree, airMopAlways);
-  mapLup = nrrdDLookup[nmap->type];
-
-  inData = (char *)nin->data;
-  inLoad = nrrdDLoad[nin->type];
-  inSize = AIR_CAST(unsigned int,nrrdElementSize(nin));
-  mapLup = nrrdDLookup[nmap->type];
-  entLen = AIR_CAST(unsigned int,nmap->axis[0].size);    /* entLen is really 1 + entry length */
-  entSize = entLen*AIR_CAST(unsigned int,nrrdElementSize(nmap));
-  colSize = (entLen-1)*AIR_CAST(unsigned int,nrrdTypeSize[typeOut]);
-  outData = (char *)nout->data;
-  outInsert = nrrdDInsert[nout->type];
-  domMin = pos[0];
-  domMax = pos[posLen-1];
+  task.pos = pos;
+  task.kind = kindImap;
+  task.rescale = rescale;
+  task.multi = AIR_FALSE;
+  task.range = range;
+  task.domMin = pos[0];
+  task.domMax = pos[task.posLen-1];
+  task.mapLen = AIR_CAST(unsigned int, nmap->axis[1].size);
+  /* map entries are one longer than output entries, because of the
+     control point position at the start of each */
+  task.mapEntLen = AIR_CAST(unsigned int, nmap->axis[0].size);
+  task.entLen = task.mapEntLen - 1;
+  task.mapData = (const char *)nmap->data;
+  task.mapSize = 0;
+  task.mapLup = nrrdDLookup[nmap->type];
+  task.inData = (const char *)nin->data;
+  task.inSize = nrrdElementSize(nin);
+  task.inLoad = nrrdDLoad[nin->type];
+  task.inType = nin->type;
+  task.outData = (char *)nout->data;
+  task.outSize = task.entLen*nrrdElementSize(nout);
+  task.outType = nout->type;
+  task.outInsert = nrrdDInsert[nout->type];
   /*
-  fprintf(stderr, "!%s: domMin, domMax = %g, %g\n", me, domMin, domMax);
+  fprintf(stderr, "!%s: domMin, domMax = %g, %g\n", me,
+          task.domMin, task.domMax);
   */
-
-  N = nrrdElementNumber(nin);
-  for (I=0;
-       I<N;
-       I++, inData += inSize, outData += colSize) {
-    val = inLoad(inData);
-    /*
-    fprintf(stderr, "!%s: (%d) val = % 31.15f\n", me, (int)I, val);
-    */
-    if (!AIR_EXISTS(val)) {
-      /* got a non-existent value */
-      if (baseI) {
-        /* and we know how to deal with them */
-        switch (airFPClass_d(val)) {
-        case airFP_NEG_INF:
-          mapIdx = 0;
-          break;
-        case airFP_SNAN:
-        case airFP_QNAN:
-          mapIdx = 1;
-          break;
-        case airFP_POS_INF:
-          mapIdx = 2;
-          break;
-        default:
-          mapIdx = 0;
-          fprintf(stderr, "%s: PANIC: non-existent value/class %g/%d "
-                  "not handled\n",
-                  me, val, airFPClass_d(val));
-          exit(1);
-        }
-        entData0 = (char*)(nmap->data) + mapIdx*entSize;
-        for (i=1; i<entLen; i++) {
-          outInsert(outData, i-1, mapLup(entData0, i));
-        }
-        continue;  /* we're done! (with this value) */
-      } else {
-        /* we don't know how to properly deal with this non-existent value:
-           we use the first entry, and then fall through to code below */
-        mapIdx = 0;
-        mapIdxFrac = 0.0;
-      }
-    } else {
-      /* we have an existent value */
-      if (rescale) {
-        val = (range->min != range->max
-               ? AIR_AFFINE(range->min, val, range->max, domMin, domMax)
-               : domMin);
-      }
-      val = AIR_CLAMP(domMin, val, domMax);
-      if (acl) {
-        aclIdx = airIndex(domMin, val, domMax, aclLen);
-        lo = acl[0 + 2*aclIdx];
-        hi = acl[1 + 2*aclIdx];
-      } else {
-        lo = 0;
-        hi = posLen-2;
-      }
-      if (lo < hi) {
-        mapIdx = _nrrd1DIrregFindInterval(pos, val, lo, hi);
-      } else {
-        /* acl did its job ==> lo == hi */
-        mapIdx = lo;
-      }
-      /*
-      fprintf(stderr, "!%s:   --> val = %g; lo,hi = %d,%d, mapIdx = %d\n",
-              me, val, lo, hi, mapIdx);
-      */
-    }
-    mapIdxFrac = AIR_AFFINE(pos[mapIdx], val, pos[mapIdx+1], 0.0, 1.0);
-    /*
-    fprintf(stderr, "!%s:    mapIdxFrac = %g\n", me, mapIdxFrac);
-    */
-    entData0 = (char*)(nmap->data) + (baseI+mapIdx)*entSize;
-    entData1 = (char*)(nmap->data) + (baseI+mapIdx+1)*entSize;
-    for (i=1; i<entLen; i++) {
-      val = ((1-mapIdxFrac)*mapLup(entData0, i) +
-             mapIdxFrac*mapLup(entData1, i));
-      /*
-      fprintf(stderr, "!%s: %g * %g   +   %g * %g = %g\n", me,
-              1-mapIdxFrac, mapLup(entData0, i),
-              mapIdxFrac, mapLup(entData1, i), val);
-      */
-      outInsert(outData, i-1, val);
-    }
+  if (_nrrdApply1DRun(&task, nin, nmap)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
   }
   airMopOkay(mop);
   return 0;
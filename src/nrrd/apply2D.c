@@ -185,13 +185,79 @@ _nrrdApply2DSetUp(Nrrd *nout, const Nrrd *nin,
   return 0;
 }
 
+/*
+** _nrrdApply2DTask
+**
+** what's needed to map a range of input value pairs through a 2D lut,
+** so that _nrrdThreadRun can split the work between threads
+*/
+typedef struct {
+  const NrrdRange *range0, *range1;
+  int rescale0, rescale1;
+  double domMin0, domMax0, domMin1, domMax1;
+  unsigned int mapLen0, mapLen1, entLen;
+  const double *mapD;         /* the map values, as doubles */
+  const char *inData;
+  size_t inSize, outSize;
+  double (*inLoad)(const void *v);
+  char *outData;
+  double (*outInsert)(void *v, size_t I, double d);
+} _nrrdApply2DTask;
+
+static void
+_nrrdApply2DWork(void *_task, size_t lo, size_t hi, unsigned int tidx) {
+  const _nrrdApply2DTask *task;
+  const char *inData;
+  const double *entD;
+  char *outData;
+  double val0, val1;
+  unsigned int i, mapIdx0, mapIdx1, entLen;
+  size_t I;
+
+  AIR_UNUSED(tidx);
+  task = AIR_CAST(const _nrrdApply2DTask *, _task);
+  entLen = task->entLen;
+  inData = task->inData + 2*lo*task->inSize;
+  outData = task->outData + lo*task->outSize;
+  for (I=lo; I<hi; I++) {
+    val0 = task->inLoad(inData + 0*task->inSize);
+    val1 = task->inLoad(inData + 1*task->inSize);
+    if (task->rescale0) {
+      val0 = AIR_AFFINE(task->range0->min, val0, task->range0->max,
+                        task->domMin0, task->domMax0);
+    }
+    if (task->rescale1) {
+      val1 = AIR_AFFINE(task->range1->min, val1, task->range1->max,
+                        task->domMin1, task->domMax1);
+    }
+    if (AIR_EXISTS(val0) && AIR_EXISTS(val1)) {
+      mapIdx0 = airIndexClamp(task->domMin0, val0, task->domMax0,
+                              task->mapLen0);
+      mapIdx1 = airIndexClamp(task->domMin1, val1, task->domMax1,
+                              task->mapLen1);
+      entD = task->mapD + entLen*(mapIdx0 + task->mapLen0*mapIdx1);
+      for (i=0; i<entLen; i++) {
+        task->outInsert(outData, i, entD[i]);
+      }
+    } else {
+      /* copy non-existent values from input to output */
+      for (i=0; i<entLen; i++) {
+        task->outInsert(outData, i, val0 + val1);  /* HEY this is weird */
+      }
+    }
+    inData += 2*task->inSize;
+    outData += task->outSize;
+  }
+  return;
+}
+
 /*
 ** _nrrdApply2DLutOrRegMap()
 **
 ** the guts of nrrdApply2DLut and nrrdApply2DRegMap
 **
-** yikes, does NOT use biff, since we're only supposed to be called
-** after copious error checking.
+** This does use biff, but only for allocation errors, since we're
+** only supposed to be called after copious error checking.
 **
 ** FOR INSTANCE, this allows nout == nin, which could be a big
 ** problem if mapAxis == 1.
@@ -204,6 +270,9 @@ _nrrdApply2DSetUp(Nrrd *nout, const Nrrd *nin,
 ** are probaby undefined.  HEY: there is currently no warning message
 ** or error handling based on nrrdStateDisallowIntegerNonExist, but
 ** there really should be.
+**
+** The work is split across nrrdStateThreadNum threads; the output
+** does not depend on the number of threads.
 */
 int
 _nrrdApply2DLutOrRegMap(Nrrd *nout, const Nrrd *nin,
@@ -211,75 +280,70 @@ _nrrdApply2DLutOrRegMap(Nrrd *nout, const Nrrd *nin,
                         const Nrrd *nmap, int ramps,
                         int rescale0, int rescale1) {
   static const char me[]="_nrrdApply2DLutOrRegMap";
-  char *inData, *outData, *mapData, *entData;
-  size_t N, I;
-  double (*inLoad)(const void *v), (*mapLup)(const void *v, size_t I),
-    (*outInsert)(void *v, size_t I, double d),
-    val0, val1, domMin0, domMax0, domMin1, domMax1;
-  unsigned int i, mapAxis, mapLen0, mapLen1, mapIdx0, mapIdx1,
-    entSize, entLen, inSize, outSize;
+  _nrrdApply2DTask task;
+  double *mapD, (*mapLup)(const void *v, size_t I);
+  unsigned int mapAxis;
+  size_t N, II, mapNum;
+  airArray *mop;
 
+  if (ramps) {
+    fprintf(stderr, "%s: PANIC: unimplemented\n", me);
+    exit(1);
+  }
   mapAxis = nmap->dim - 2;             /* axis of nmap containing entries */
-  mapData = (char *)nmap->data;        /* map data, as char* */
                                        /* low end of map domain */
-  domMin0 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 0);
-  domMin1 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 1);
+  task.domMin0 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 0);
+  task.domMin1 = _nrrdApplyDomainMin(nmap, ramps, mapAxis + 1);
                                        /* high end of map domain */
-  domMax0 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 0);
-  domMax1 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 1);
-  mapLen0 = AIR_CAST(unsigned int, nmap->axis[mapAxis+0].size);   /* number of entries in map axis 0 */
-  mapLen1 = AIR_CAST(unsigned int, nmap->axis[mapAxis+1].size);   /* number of entries in map axis 1 */
-  mapLup = nrrdDLookup[nmap->type];    /* how to get doubles out of map */
-  inData = (char *)nin->data;          /* input data, as char* */
-  inLoad = nrrdDLoad[nin->type];       /* how to get doubles out of nin */
-  inSize = AIR_CAST(unsigned int, nrrdElementSize(nin));       /* size of one input value */
-  outData = (char *)nout->data;        /* output data, as char* */
-  outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
-  entLen = (mapAxis                    /* number of elements in one entry */
-            ? AIR_CAST(unsigned int, nmap->axis[0].size)
-            : 1);
-  outSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nout)); /* size of entry in output */
-  entSize = entLen*AIR_CAST(unsigned int, nrrdElementSize(nmap)); /* size of entry in map */
+  task.domMax0 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 0);
+  task.domMax1 = _nrrdApplyDomainMax(nmap, ramps, mapAxis + 1);
+                                       /* number of entries in map axes */
+  task.mapLen0 = AIR_CAST(unsigned int, nmap->axis[mapAxis+0].size);
+  task.mapLen1 = AIR_CAST(unsigned int, nmap->axis[mapAxis+1].size);
+  task.range0 = range0;
+  task.range1 = range1;
+  task.rescale0 = rescale0;
+  task.rescale1 = rescale1;
+  task.inData = (const char *)nin->data;    /* input data, as char* */
+  task.inLoad = nrrdDLoad[nin->type];       /* how to get doubles out of nin */
+  task.inSize = nrrdElementSize(nin);       /* size of one input value */
+  task.outData = (char *)nout->data;        /* output data, as char* */
+  task.outInsert = nrrdDInsert[nout->type]; /* putting doubles into output */
+  task.entLen = (mapAxis                    /* number of elements in entry */
+                 ? AIR_CAST(unsigned int, nmap->axis[0].size)
+                 : 1);
+  task.outSize = task.entLen*nrrdElementSize(nout); /* size of output entry */
 
   /*
   fprintf(stderr, "!%s: entLen = %u, mapLen = %u,%u\n", me,
-          entLen, mapLen0, mapLen1);
+          task.entLen, task.mapLen0, task.mapLen1);
   */
 
-  N = nrrdElementNumber(nin)/2;       /* number of value pairs to be mapped */
-  /* _VV = 1; */
-  if (ramps) {
-    fprintf(stderr, "%s: PANIC: unimplemented\n", me);
-    exit(1);
+  mop = airMopNew();
+  /* get the map values as doubles once, rather than per lookup */
+  if (nrrdTypeDouble == nmap->type) {
+    task.mapD = AIR_CAST(const double *, nmap->data);
   } else {
-    /* lookup table */
-    for (I=0; I<N; I++) {
-      val0 = inLoad(inData + 0*inSize);
-      val1 = inLoad(inData + 1*inSize);
-      if (rescale0) {
-        val0 = AIR_AFFINE(range0->min, val0, range0->max, domMin0, domMax0);
-      }
-      if (rescale1) {
-        val1 = AIR_AFFINE(range1->min, val1, range1->max, domMin1, domMax1);
-      }
-      if (AIR_EXISTS(val0) && AIR_EXISTS(val1)) {
-        mapIdx0 = airIndexClamp(domMin0, val0, domMax0, mapLen0);
-        mapIdx1 = airIndexClamp(domMin1, val1, domMax1, mapLen1);
-        entData = mapData + entSize*(mapIdx0 + mapLen0*mapIdx1);
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, mapLup(entData, i));
-        }
-      } else {
-        /* copy non-existent values from input to output */
-        for (i=0; i<entLen; i++) {
-          outInsert(outData, i, val0 + val1);  /* HEY this is weird */
-        }
-      }
-      inData += 2*inSize;
-      outData += outSize;
+    mapNum = nrrdElementNumber(nmap);
+    mapD = AIR_CALLOC(mapNum, double);
+    if (!mapD) {
+      biffAddf(NRRD, "%s: couldn't allocate map copy", me);
+      airMopError(mop); return 1;
     }
+    airMopAdd(mop, mapD, airFree, airMopAlways);
+    mapLup = nrrdDLookup[nmap->type];
+    for (II=0; II<mapNum; II++) {
+      mapD[II] = mapLup(nmap->data, II);
+    }
+    task.mapD = mapD;
   }
-
+  N = nrrdElementNumber(nin)/2;       /* number of value pairs to be mapped */
+  if (_nrrdThreadRun(nrrdStateThreadNum, N, 2048 /* grain */,
+                     _nrrdApply2DWork, &task)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
+  }
+  airMopOkay(mop);
   return 0;
 }
 
@@ -953,9 +953,44 @@ nrrdArithIterAffine(Nrrd *nout, NrrdIter *minIn,
   return 0;
 }
 
+/* at least this many bytes per thread when computing CRCs, and no more
+   than this many threads; it is a memory-bound pass over the data */
+#define _NRRD_CRC32_GRAIN (1 << 20)
+#define _NRRD_CRC32_THREAD_MAX 64
+
+typedef struct {
+  const unsigned char *data;
+  size_t unit;              /* element size */
+  int swap;
+  unsigned int *crc;        /* per-piece airCRC32Update results */
+  size_t *len;              /* per-piece byte counts */
+} _nrrdCRC32Task;
+
+static void
+_nrrdCRC32Work(void *_task, size_t lo, size_t hi, unsigned int tidx) {
+  _nrrdCRC32Task *task;
+
+  task = AIR_CAST(_nrrdCRC32Task *, _task);
+  task->len[tidx] = (hi - lo)*task->unit;
+  task->crc[tidx] = airCRC32Update(0, task->data + lo*task->unit,
+                                   task->len[tidx], task->unit, task->swap);
+  return;
+}
+
+/*
+******** nrrdCRC32
+**
+** the same CRC of the data as computed by "cksum", as if the data had
+** the given endianness.  The data is divided (on element boundaries)
+** into as many as nrrdStateThreadNum pieces, the CRCs of which are
+** computed in parallel and then combined, so the result doesn't depend
+** on the number of threads.  Returns 0 for a NULL nrrd or data.
+*/
 unsigned int
 nrrdCRC32(const Nrrd *nin, int endian) {
-  size_t nn;
+  _nrrdCRC32Task task;
+  unsigned int crc[_NRRD_CRC32_THREAD_MAX], pi, pieceNum;
+  size_t nn, len[_NRRD_CRC32_THREAD_MAX], elNum;
 
   /* NULL nrrd or data */
   if (!nin
@@ -965,8 +1000,56 @@ nrrdCRC32(const Nrrd *nin, int endian) {
     return 0;
   }
 
-  return airCRC32(AIR_CAST(const unsigned char *, nin->data),
+  task.data = AIR_CAST(const unsigned char *, nin->data);
+  task.unit = nrrdElementSize(nin);
+  task.swap = endian == airMyEndian() ? AIR_FALSE : AIR_TRUE;
+  task.crc = crc;
+  task.len = len;
+  elNum = nrrdElementNumber(nin);
+  pieceNum = _nrrdThreadNumber(AIR_MIN(nrrdStateThreadNum,
+                                       _NRRD_CRC32_THREAD_MAX),
+                               elNum, _NRRD_CRC32_GRAIN/task.unit + 1);
+  if (1 == pieceNum) {
+    _nrrdCRC32Work(&task, 0, elNum, 0);
+  } else {
+    /* sets up lookup tables before threads start */
+    airCRC32Update(0, NULL, 0, 0, AIR_FALSE);
+    if (_nrrdThreadRun(pieceNum, elNum, _NRRD_CRC32_GRAIN/task.unit + 1,
+                       _nrrdCRC32Work, &task)) {
+      /* couldn't allocate for threads; do it all here */
+      airFree(biffGetDone(NRRD));
+      pieceNum = 1;
+      _nrrdCRC32Work(&task, 0, elNum, 0);
+    }
+  }
+  for (pi=1; pi<pieceNum; pi++) {
+    crc[0] = airCRC32Combine(crc[0], crc[pi], len[pi]);
+  }
+  return airCRC32Finish(crc[0], nn);
+}
+
+/*
+******** nrrdXXH64
+**
+** 64-bit xxHash (seed 0) of the data, as if the data had the given
+** endianness; this is the same as "xxhsum -H64" of the raw data.
+** xxHash is not divisible like a CRC, but it is fast enough to be
+** limited by memory bandwidth, so it is computed in a single thread.
+** Returns 0 for a NULL nrrd or data.
+*/
+airULLong
+nrrdXXH64(const Nrrd *nin, int endian) {
+  size_t nn;
+
+  if (!nin
+      || !(nin->data)
+      || !(nn = nrrdElementSize(nin)*nrrdElementNumber(nin))
+      || airEnumValCheck(airEndian, endian)) {
+    return 0;
+  }
+
+  return airXXH64(AIR_CAST(const unsigned char *, nin->data),
                   nn, nrrdElementSize(nin),
-                  endian == airMyEndian() ? AIR_FALSE : AIR_TRUE);
+                  endian == airMyEndian() ? AIR_FALSE : AIR_TRUE, 0);
 }
 
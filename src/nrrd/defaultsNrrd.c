@@ -52,6 +52,7 @@ int nrrdDefaultResampleCheap = AIR_FALSE;
 double nrrdDefaultResamplePadValue = 0.0;
 int nrrdDefaultResampleNonExistent = nrrdResampleNonExistentNoop;
 double nrrdDefaultKernelParm0 = 1.0;
+int nrrdDefaultWriteChecksumType = nrrdChecksumTypeUnknown;
 /* ---- END non-NrrdIO */
 int nrrdDefaultCenter = nrrdCenterCell;
 double nrrdDefaultSpacing = 1.0;
@@ -68,6 +69,9 @@ int nrrdStateMeasureType = nrrdTypeFloat;
 int nrrdStateMeasureModeBins = 1024;
 int nrrdStateMeasureHistoType = nrrdTypeFloat;
 int nrrdStateDisallowIntegerNonExist = AIR_TRUE;
+/* how many threads to use in those nrrd functions that can split their
+   work across threads (e.g. nrrdApply1DLut); 1 means no threading */
+unsigned int nrrdStateThreadNum = 1;
 /* ---- END non-NrrdIO */
 int nrrdStateAlwaysSetContent = AIR_TRUE;
 int nrrdStateDisableContent = AIR_FALSE;
@@ -117,6 +121,8 @@ const char *const nrrdEnvVarDefaultWriteCharsPerLine
   = "NRRD_DEFAULT_WRITE_CHARS_PER_LINE";
 const char *const nrrdEnvVarDefaultWriteValsPerLine
   = "NRRD_DEFAULT_WRITE_VALS_PER_LINE";
+const char *const nrrdEnvVarDefaultWriteChecksumType
+  = "NRRD_DEFAULT_WRITE_CHECKSUM_TYPE";
 const char *const nrrdEnvVarDefaultKernelParm0
   = "NRRD_DEFAULT_KERNEL_PARM0";
 const char *const nrrdEnvVarDefaultSpacing
@@ -142,6 +148,8 @@ const char *const nrrdEnvVarStateMeasureHistoType
   = "NRRD_STATE_MEASURE_HISTO_TYPE";
 const char *const nrrdEnvVarStateGrayscaleImage3D
   = "NRRD_STATE_GRAYSCALE_IMAGE_3D";
+const char *const nrrdEnvVarStateThreadNum
+  = "NRRD_STATE_THREAD_NUM";
 
 /*
 **    return
@@ -315,6 +323,8 @@ nrrdDefaultGetenv(void) {
                  nrrdEnvVarDefaultWriteCharsPerLine);
   nrrdGetenvUInt(/**/ &nrrdDefaultWriteValsPerLine, NULL,
                  nrrdEnvVarDefaultWriteValsPerLine);
+  nrrdGetenvEnum(/**/ &nrrdDefaultWriteChecksumType, NULL, nrrdChecksumType,
+                 nrrdEnvVarDefaultWriteChecksumType);
   nrrdGetenvDouble(/**/ &nrrdDefaultKernelParm0, NULL,
                    nrrdEnvVarDefaultKernelParm0);
   nrrdGetenvDouble(/**/ &nrrdDefaultSpacing, NULL,
@@ -346,6 +356,8 @@ nrrdStateGetenv(void) {
                  nrrdEnvVarStateMeasureHistoType);
   nrrdGetenvBool(/**/ &nrrdStateGrayscaleImage3D, NULL,
                  nrrdEnvVarStateGrayscaleImage3D);
+  nrrdGetenvUInt(/**/ &nrrdStateThreadNum, NULL,
+                 nrrdEnvVarStateThreadNum);
 
   return;
 }
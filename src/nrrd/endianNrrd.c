@@ -22,66 +22,66 @@
 */
 
 #include "nrrd.h"
+#include "privateNrrd.h"
+
+/*
+** The byte swaps are written as independent shifts and masks of each
+** value (rather than as a chain of dependent steps), which compilers
+** recognize as byte-reversal, and can vectorize over the loop.
+*/
 
 static void
 _nrrdSwap16Endian(void *_data, size_t N) {
-  unsigned short *data, dd, fix, mask;
+  unsigned short *data, dd;
   size_t I;
 
   if (!_data) {
     return;
   }
   data = AIR_CAST(unsigned short *, _data);
-  mask = AIR_CAST(unsigned short, 0x00FFu);
   for (I=0; I<N; I++) {
     dd = data[I];
-    fix = (dd & mask); dd >>= 0x08;
-    fix = (dd & mask) | AIR_CAST(unsigned short, fix << 0x08);
-    data[I] = fix;
+    data[I] = AIR_CAST(unsigned short, (dd >> 8) | (dd << 8));
   }
 }
 
 static void
 _nrrdSwap32Endian(void *_data, size_t N) {
-  unsigned int *data, dd, fix, mask;
+  unsigned int *data, dd;
   size_t I;
 
   if (!_data) {
     return;
   }
   data = AIR_CAST(unsigned int *, _data);
-  mask = 0x000000FFu;
   for (I=0; I<N; I++) {
     dd = data[I];
-    fix = (dd & mask);                 dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08);
-    data[I] = fix;
+    data[I] = ((dd >> 24)
+               | ((dd >> 8) & 0x0000FF00u)
+               | ((dd << 8) & 0x00FF0000u)
+               | (dd << 24));
   }
 }
 
 static void
 _nrrdSwap64Endian(void *_data, size_t N) {
-  airULLong *data, dd, fix, mask;
+  airULLong *data, dd;
   size_t I;
 
   if (!_data) {
     return;
   }
   data = AIR_CAST(airULLong *, _data);
-  mask = AIR_ULLONG(0x00000000000000FF);
   for (I=0; I<N; I++) {
     dd = data[I];
-    fix = (dd & mask);                 dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08); dd >>= 0x08;
-    fix = (dd & mask) | (fix << 0x08);
-    data[I] = fix;
+    data[I] = ((dd >> 56)
+               | ((dd >> 40) & AIR_ULLONG(0x000000000000FF00))
+               | ((dd >> 24) & AIR_ULLONG(0x0000000000FF0000))
+               | ((dd >> 8)  & AIR_ULLONG(0x00000000FF000000))
+               | ((dd << 8)  & AIR_ULLONG(0x000000FF00000000))
+               | ((dd << 24) & AIR_ULLONG(0x0000FF0000000000))
+               | ((dd << 40) & AIR_ULLONG(0x00FF000000000000))
+               | (dd << 56));
   }
 }
 
@@ -128,3 +128,19 @@ nrrdSwapEndian(Nrrd *nrrd) {
   }
   return;
 }
+
+/*
+** _nrrdSwapEndianArray
+**
+** like nrrdSwapEndian, but for an array of N values of the given type,
+** for when the data isn't (all) in a nrrd, as when a piece of a nrrd
+** is swapped on its way to being written
+*/
+void
+_nrrdSwapEndianArray(void *data, size_t N, int type) {
+
+  if (data && !airEnumValCheck(nrrdType, type)) {
+    _nrrdSwapEndian[type](data, N);
+  }
+  return;
+}
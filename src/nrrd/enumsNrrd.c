@@ -1602,4 +1602,32 @@ _nrrdResampleNonExistent_enum = {
 const airEnum *const
 nrrdResampleNonExistent = &_nrrdResampleNonExistent_enum;
 
+/* ------------------------ nrrdChecksumType ------------------------- */
+
+static const char *
+_nrrdChecksumTypeStr[NRRD_CHECKSUM_TYPE_MAX+1] = {
+  "(unknown_checksum)",
+  "crc32",
+  "xxh64"
+};
+
+static const char *
+_nrrdChecksumTypeDesc[NRRD_CHECKSUM_TYPE_MAX+1] = {
+  "unknown (or no) checksum",
+  "32-bit CRC, same as computed by cksum",
+  "64-bit xxHash, same as computed by \"xxhsum -H64\""
+};
+
+static const airEnum
+_nrrdChecksumType = {
+  "checksum type",
+  NRRD_CHECKSUM_TYPE_MAX,
+  _nrrdChecksumTypeStr, NULL,
+  _nrrdChecksumTypeDesc,
+  NULL, NULL,
+  AIR_FALSE
+};
+const airEnum *const
+nrrdChecksumType = &_nrrdChecksumType;
+
 /* ---- END non-NrrdIO */
@@ -310,7 +310,11 @@ _nrrdFormatNRRD_whichVersion(const Nrrd *nrrd, NrrdIoState *nio) {
     ret = 4;
   } else if (_nrrdFieldInteresting(nrrd, nio, nrrdField_kinds)) {
     ret = 3;
-  } else if (nrrdKeyValueSize(nrrd)) {
+  } else if (nrrdKeyValueSize(nrrd)
+             /* ---- BEGIN non-NrrdIO */
+             || nrrdChecksumTypeUnknown != nio->checksumType
+             /* ---- END non-NrrdIO */
+             ) {
     ret = 2;
   } else {
     ret = 1;
@@ -499,6 +503,14 @@ _nrrdFormatNRRD_read(FILE *file, Nrrd *nrrd, NrrdIoState *nio) {
     return 1;
   }
 
+  if (nio->skipData && !nio->keepNrrdDataFileOpen) {
+    /* only the header was wanted, and nothing needs to be left open
+       for the caller, so there's no reason to open, seek through, or
+       even check the existence of the data files */
+    nrrd->data = NULL;
+    return 0;
+  }
+
   /* we seemed to have read in a valid header; now allocate the memory.
      For directIO-compatible allocation we need to get the first datafile */
   nrrdIoStateDataFileIterBegin(nio);
@@ -606,10 +618,73 @@ _nrrdFormatNRRD_read(FILE *file, Nrrd *nrrd, NrrdIoState *nio) {
   return 0;
 }
 
+/*
+** writes one key/value pair of the header to file, or to
+** nio->headerStringWrite, or just adds its length to nio->headerStrlen
+*/
+static void
+_nrrdFormatNRRD_keyValueWrite(FILE *file, NrrdIoState *nio,
+                              const char *key, const char *value) {
+  char *strptr=NULL;
+
+  if (file) {
+    _nrrdKeyValueWrite(file, NULL, NULL, key, value);
+  } else {
+    _nrrdKeyValueWrite(NULL, &strptr, NULL, key, value);
+    if (strptr) {
+      if (nio->headerStringWrite) {
+        strcat(nio->headerStringWrite, strptr);
+      } else {
+        nio->headerStrlen += AIR_CAST(unsigned int, strlen(strptr));
+      }
+      free(strptr);
+    }
+  }
+  return;
+}
+
+/* ---- BEGIN non-NrrdIO */
+/*
+** sets cksum to the value of the NRRD_CHECKSUM_KEY key/value pair to
+** write, or to the empty string if there is to be no such pair.  The
+** checksum is always computed as if the data were little-endian, so that
+** it doesn't depend on the endianness of the platform or the encoding.
+*/
+static void
+_nrrdFormatNRRD_checksum(char cksum[AIR_STRLEN_SMALL], const Nrrd *nrrd,
+                         const NrrdIoState *nio) {
+  airULLong xxh;
+
+  strcpy(cksum, "");
+  if (!nrrd->data) {
+    return;
+  }
+  switch (nio->checksumType) {
+  case nrrdChecksumTypeCRC32:
+    sprintf(cksum, "%s %s %u", airEnumStr(nrrdChecksumType, nio->checksumType),
+            airEnumStr(airEndian, airEndianLittle),
+            nrrdCRC32(nrrd, airEndianLittle));
+    break;
+  case nrrdChecksumTypeXXH64:
+    xxh = nrrdXXH64(nrrd, airEndianLittle);
+    sprintf(cksum, "%s %s %08x%08x",
+            airEnumStr(nrrdChecksumType, nio->checksumType),
+            airEnumStr(airEndian, airEndianLittle),
+            AIR_CAST(unsigned int, xxh >> 32),
+            AIR_CAST(unsigned int, xxh & 0xffffffff));
+    break;
+  }
+  return;
+}
+/* ---- END non-NrrdIO */
+
 static int
 _nrrdFormatNRRD_write(FILE *file, const Nrrd *nrrd, NrrdIoState *nio) {
   static const char me[]="_nrrdFormatNRRD_write";
   char strbuf[AIR_STRLEN_MED], *strptr, *tmp;
+  /* ---- BEGIN non-NrrdIO */
+  char cksum[AIR_STRLEN_SMALL];
+  /* ---- END non-NrrdIO */
   int ii;
   unsigned int jj;
   airArray *mop;
@@ -747,28 +822,24 @@ _nrrdFormatNRRD_write(FILE *file, const Nrrd *nrrd, NrrdIoState *nio) {
     }
     airFree(strtmp);
   }
+  /* ---- BEGIN non-NrrdIO */
+  _nrrdFormatNRRD_checksum(cksum, nrrd, nio);
+  /* ---- END non-NrrdIO */
   for (jj=0; jj<nrrd->kvpArr->len; jj++) {
-    if (file) {
-      _nrrdKeyValueWrite(file, NULL,
-                         NULL, nrrd->kvp[0 + 2*jj], nrrd->kvp[1 + 2*jj]);
-    } else if (nio->headerStringWrite) {
-      _nrrdKeyValueWrite(NULL, &strptr,
-                         NULL, nrrd->kvp[0 + 2*jj], nrrd->kvp[1 + 2*jj]);
-      if (strptr) {
-        strcat(nio->headerStringWrite, strptr);
-        free(strptr);
-        strptr = NULL;
-      }
-    } else {
-      _nrrdKeyValueWrite(NULL, &strptr,
-                         NULL, nrrd->kvp[0 + 2*jj], nrrd->kvp[1 + 2*jj]);
-      if (strptr) {
-        nio->headerStrlen += AIR_CAST(unsigned int, strlen(strptr));
-        free(strptr);
-        strptr = NULL;
-      }
+    /* ---- BEGIN non-NrrdIO */
+    if (airStrlen(cksum) && !strcmp(NRRD_CHECKSUM_KEY, nrrd->kvp[0 + 2*jj])) {
+      /* this is replaced by the new checksum below */
+      continue;
     }
+    /* ---- END non-NrrdIO */
+    _nrrdFormatNRRD_keyValueWrite(file, nio,
+                                  nrrd->kvp[0 + 2*jj], nrrd->kvp[1 + 2*jj]);
+  }
+  /* ---- BEGIN non-NrrdIO */
+  if (airStrlen(cksum)) {
+    _nrrdFormatNRRD_keyValueWrite(file, nio, NRRD_CHECKSUM_KEY, cksum);
   }
+  /* ---- END non-NrrdIO */
 
   if (file) {
     if (!( nio->detachedHeader || _nrrdDataFNNumber(nio) > 1 )) {
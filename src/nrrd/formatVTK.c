@@ -40,10 +40,51 @@ _nrrdFormatVTK_nameLooksLike(const char *fname) {
   return airEndsWith(fname, NRRD_EXT_VTK);
 }
 
+/*
+** _nrrdFormatVTK_attribute
+**
+** decides how a nrrd is laid out as VTK point data: 2-D and 3-D arrays
+** are SCALARS (a 2-D array is a single slice of a volume), and 4-D
+** arrays are VECTORS (3 values), TENSORS (9 values), or multi-component
+** SCALARS (1, 2, or 4 values) along the fastest axis.  Sets *compNum to
+** the number of values per point and returns the attribute name, or
+** NULL if the nrrd doesn't fit any of these.
+*/
+static const char *
+_nrrdFormatVTK_attribute(unsigned int *compNum, const Nrrd *nrrd) {
+  const char *ret;
+
+  ret = NULL;
+  *compNum = 0;
+  if (2 == nrrd->dim || 3 == nrrd->dim) {
+    *compNum = 1;
+    ret = "SCALARS";
+  } else if (4 == nrrd->dim) {
+    switch (nrrd->axis[0].size) {
+    case 1:
+    case 2:
+    case 4:
+      *compNum = AIR_CAST(unsigned int, nrrd->axis[0].size);
+      ret = "SCALARS";
+      break;
+    case 3:
+      *compNum = 3;
+      ret = "VECTORS";
+      break;
+    case 9:
+      *compNum = 9;
+      ret = "TENSORS";
+      break;
+    }
+  }
+  return ret;
+}
+
 int
 _nrrdFormatVTK_fitsInto(const Nrrd *nrrd, const NrrdEncoding *encoding,
                         int useBiff) {
   static const char me[]="_nrrdFormatVTK_fitsInto";
+  unsigned int compNum;
 
   if (!( nrrd && encoding )) {
     biffMaybeAddf(useBiff, NRRD, "%s: got NULL nrrd (%p) or encoding (%p)",
@@ -68,11 +109,9 @@ _nrrdFormatVTK_fitsInto(const Nrrd *nrrd, const NrrdEncoding *encoding,
                   me, airEnumStr(nrrdType, nrrd->type));
     return AIR_FALSE;
   }
-  if (!( 3 == nrrd->dim
-         || (4 == nrrd->dim && 3 == nrrd->axis[0].size)
-         || (4 == nrrd->dim && 9 == nrrd->axis[0].size) )) {
-    biffMaybeAddf(useBiff, NRRD, "%s: nrrd didn't look like a volume of "
-                  "scalars, vectors, or matrices", me);
+  if (!_nrrdFormatVTK_attribute(&compNum, nrrd)) {
+    biffMaybeAddf(useBiff, NRRD, "%s: nrrd didn't look like a slice or "
+                  "volume of scalars, vectors, or matrices", me);
     return AIR_FALSE;
   }
   return AIR_TRUE;
@@ -89,11 +128,12 @@ _nrrdFormatVTK_contentStartsLike(NrrdIoState *nio) {
 int
 _nrrdFormatVTK_read(FILE *file, Nrrd *nrrd, NrrdIoState *nio) {
   static const char me[]="_nrrdReadVTK";
-  char *three[3];
-  int sx, sy, sz, ret, N;
+  char *word[4], stmp[2][AIR_STRLEN_SMALL];
+  int sx, sy, sz, ret, kind;
+  size_t N, num;
   double xm=0.0, ym=0.0, zm=0.0, xs=1.0, ys=1.0, zs=1.0;
   airArray *mop;
-  unsigned int llen;
+  unsigned int llen, wordNum, wi, compNum;
 
   if (!_nrrdFormatVTK_contentStartsLike(nio)) {
     biffAddf(NRRD, "%s: this doesn't look like a %s file", me,
@@ -166,69 +206,131 @@ _nrrdFormatVTK_read(FILE *file, Nrrd *nrrd, NrrdIoState *nio) {
     }
     GETLINE(next); airToUpper(nio->line);
   }
-  if (1 != sscanf(nio->line, "POINT_DATA %d", &N)) {
+  if (1 != airParseStrZ(&N, nio->line + strlen("POINT_DATA"),
+                        AIR_WHITESPACE, 1)) {
     biffAddf(NRRD, "%s: couldn't parse POINT_DATA line (\"%s\")",
              me, nio->line);
     return 1;
   }
-  if (N != sx*sy*sz) {
+  if (!( 0 < sx && 0 < sy && 0 < sz )) {
+    biffAddf(NRRD, "%s: got non-positive DIMENSIONS %d %d %d",
+             me, sx, sy, sz);
+    return 1;
+  }
+  num = AIR_CAST(size_t, sx)*AIR_CAST(size_t, sy)*AIR_CAST(size_t, sz);
+  if (N != num) {
     biffAddf(NRRD,
-             "%s: product of sizes (%d*%d*%d == %d) != # elements (%d)",
-             me, sx, sy, sz, sx*sy*sz, N);
+             "%s: product of sizes (%d*%d*%d == %s) != # elements (%s)",
+             me, sx, sy, sz, airSprintSize_t(stmp[0], num),
+             airSprintSize_t(stmp[1], N));
     return 1;
   }
   GETLINE(attribute declaration);
-  mop = airMopNew();
-  if (3 != airParseStrS(three, nio->line, AIR_WHITESPACE, 3, AIR_FALSE)) {
-    biffAddf(NRRD,
-             "%s: didn't see three words in attribute declaration \"%s\"",
-             me, nio->line);
+  wordNum = airStrntok(nio->line, AIR_WHITESPACE);
+  if (!( 3 == wordNum || 4 == wordNum )) {
+    biffAddf(NRRD, "%s: didn't see three or four words in attribute "
+             "declaration \"%s\"", me, nio->line);
     return 1;
   }
-  airMopAdd(mop, three[0], airFree, airMopAlways);
-  airMopAdd(mop, three[1], airFree, airMopAlways);
-  airMopAdd(mop, three[2], airFree, airMopAlways);
-  airToLower(three[2]);
-  if (!strcmp(three[2], "bit")) {
-    if (nrrdEncodingAscii == nio->encoding) {
-      fprintf(stderr, "%s: WARNING: \"bit\"-type data will be read in as "
-              "unsigned char\n", me);
+  mop = airMopNew();
+  if (wordNum != airParseStrS(word, nio->line, AIR_WHITESPACE,
+                              wordNum, AIR_FALSE)) {
+    biffAddf(NRRD, "%s: couldn't parse %u words in attribute declaration "
+             "\"%s\"", me, wordNum, nio->line);
+    airMopError(mop); return 1;
+  }
+  for (wi=0; wi<wordNum; wi++) {
+    airMopAdd(mop, word[wi], airFree, airMopAlways);
+  }
+  airToUpper(word[0]);
+  compNum = 1;
+  kind = nrrdKindUnknown;
+  if (!strcmp("COLOR_SCALARS", word[0])) {
+    /* "COLOR_SCALARS name nValues": no type given; VTK stores these as
+       unsigned char when binary, and floats in [0,1] when ascii */
+    if (!( 3 == wordNum
+           && 1 == airSingleSscanf(word[2], "%u", &compNum)
+           && 1 <= compNum && compNum <= 4 )) {
+      biffAddf(NRRD, "%s: couldn't parse 1 to 4 values in COLOR_SCALARS "
+               "declaration \"%s\"", me, nio->line);
+      airMopError(mop); return 1;
+    }
+    nrrd->type = (nrrdEncodingRaw == nio->encoding
+                  ? nrrdTypeUChar
+                  : nrrdTypeFloat);
+    kind = (3 == compNum
+            ? nrrdKindRGBColor
+            : (4 == compNum
+               ? nrrdKindRGBAColor
+               : nrrdKindUnknown));
+  } else {
+    airToLower(word[2]);
+    if (!strcmp(word[2], "bit")) {
+      if (nrrdEncodingAscii == nio->encoding) {
+        fprintf(stderr, "%s: WARNING: \"bit\"-type data will be read in as "
+                "unsigned char\n", me);
+        nrrd->type = nrrdTypeUChar;
+      } else {
+        biffAddf(NRRD, "%s: can't read in \"bit\"-type data as BINARY", me);
+        airMopError(mop); return 1;
+      }
+    } else if (!strcmp(word[2], "unsigned_char")) {
       nrrd->type = nrrdTypeUChar;
+    } else if (!strcmp(word[2], "char")) {
+      nrrd->type = nrrdTypeChar;
+    } else if (!strcmp(word[2], "unsigned_short")) {
+      nrrd->type = nrrdTypeUShort;
+    } else if (!strcmp(word[2], "short")) {
+      nrrd->type = nrrdTypeShort;
+    } else if (!strcmp(word[2], "unsigned_int")) {
+      nrrd->type = nrrdTypeUInt;
+    } else if (!strcmp(word[2], "int")) {
+      nrrd->type = nrrdTypeInt;
+    } else if (!strcmp(word[2], "float")) {
+      nrrd->type = nrrdTypeFloat;
+    } else if (!strcmp(word[2], "double")) {
+      nrrd->type = nrrdTypeDouble;
     } else {
-      biffAddf(NRRD, "%s: can't read in \"bit\"-type data as BINARY", me);
-      return 1;
+      /* "unsigned_long" and "long" fall in here- I don't know what
+         the VTK people mean by these types, since always mean different
+         things on 32-bit versus 64-bit architectures */
+      biffAddf(NRRD, "%s: type \"%s\" not recognized", me, word[2]);
+      airMopError(mop); return 1;
     }
-  } else if (!strcmp(three[2], "unsigned_char")) {
-    nrrd->type = nrrdTypeUChar;
-  } else if (!strcmp(three[2], "char")) {
-    nrrd->type = nrrdTypeChar;
-  } else if (!strcmp(three[2], "unsigned_short")) {
-    nrrd->type = nrrdTypeUShort;
-  } else if (!strcmp(three[2], "short")) {
-    nrrd->type = nrrdTypeShort;
-  } else if (!strcmp(three[2], "unsigned_int")) {
-    nrrd->type = nrrdTypeUInt;
-  } else if (!strcmp(three[2], "int")) {
-    nrrd->type = nrrdTypeInt;
-  } else if (!strcmp(three[2], "float")) {
-    nrrd->type = nrrdTypeFloat;
-  } else if (!strcmp(three[2], "double")) {
-    nrrd->type = nrrdTypeDouble;
-  } else {
-    /* "unsigned_long" and "long" fall in here- I don't know what
-       the VTK people mean by these types, since always mean different
-       things on 32-bit versus 64-bit architectures */
-    biffAddf(NRRD, "%s: type \"%s\" not recognized", me, three[2]);
-    airMopError(mop); return 1;
-  }
-  airToUpper(three[0]);
-  if (!strncmp("SCALARS", three[0], strlen("SCALARS"))) {
-    GETLINE(LOOKUP_TABLE); airToUpper(nio->line);
-    if (strcmp(nio->line, "LOOKUP_TABLE DEFAULT")) {
+    if (!strcmp("SCALARS", word[0])) {
+      /* "SCALARS name type [numComp]" */
+      if (4 == wordNum
+          && !( 1 == airSingleSscanf(word[3], "%u", &compNum)
+                && 1 <= compNum && compNum <= 4 )) {
+        biffAddf(NRRD, "%s: couldn't parse 1 to 4 components in SCALARS "
+                 "declaration \"%s\"", me, nio->line);
+        airMopError(mop); return 1;
+      }
+      GETLINE(LOOKUP_TABLE); airToUpper(nio->line);
+      if (strcmp(nio->line, "LOOKUP_TABLE DEFAULT")) {
+        biffAddf(NRRD,
+                 "%s: sorry, can only deal with default LOOKUP_TABLE", me);
+        airMopError(mop); return 1;
+      }
+      kind = 1 < compNum ? nrrdKindVector : nrrdKindUnknown;
+    } else if (!strcmp("VECTORS", word[0])) {
+      compNum = 3;
+      kind = nrrdKind3Vector;
+    } else if (!strcmp("NORMALS", word[0])) {
+      compNum = 3;
+      kind = nrrdKind3Normal;
+    } else if (!strcmp("TENSORS", word[0])) {
+      compNum = 9;
+      kind = nrrdKind3DMatrix;
+    } else {
       biffAddf(NRRD,
-               "%s: sorry, can only deal with default LOOKUP_TABLE", me);
+               "%s: sorry, can only deal with SCALARS, COLOR_SCALARS, "
+               "VECTORS, NORMALS, and TENSORS currently, so couldn't parse "
+               "attribute declaration \"%s\"", me, nio->line);
       airMopError(mop); return 1;
     }
+  }
+  if (1 == compNum && nrrdKindUnknown == kind) {
     nrrd->dim = 3;
     nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSize,
                        AIR_CAST(size_t, sx),
@@ -236,42 +338,26 @@ _nrrdFormatVTK_read(FILE *file, Nrrd *nrrd, NrrdIoState *nio) {
                        AIR_CAST(size_t, sz));
     nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSpacing, xs, ys, zs);
     nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoMin, xm, ym, zm);
-  } else if (!strncmp("VECTORS", three[0], strlen("VECTORS"))) {
-    nrrd->dim = 4;
-    nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSize,
-                       AIR_CAST(size_t, 3),
-                       AIR_CAST(size_t, sx),
-                       AIR_CAST(size_t, sy),
-                       AIR_CAST(size_t, sz));
-    nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSpacing, AIR_NAN, xs, ys, zs);
-    nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoMin, AIR_NAN, xm, ym, zm);
-    nrrd->axis[0].kind = nrrdKind3Vector;
-  } else if (!strncmp("TENSORS", three[0], strlen("TENSORS"))) {
+  } else {
     nrrd->dim = 4;
     nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSize,
-                       AIR_CAST(size_t, 9),
+                       AIR_CAST(size_t, compNum),
                        AIR_CAST(size_t, sx),
                        AIR_CAST(size_t, sy),
                        AIR_CAST(size_t, sz));
     nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoSpacing, AIR_NAN, xs, ys, zs);
     nrrdAxisInfoSet_va(nrrd, nrrdAxisInfoMin, AIR_NAN, xm, ym, zm);
-    nrrd->axis[0].kind = nrrdKind3DMatrix;
-  } else {
-    biffAddf(NRRD,
-             "%s: sorry, can only deal with SCALARS, VECTORS, and TENSORS "
-             "currently, so couldn't parse attribute declaration \"%s\"",
-             me, nio->line);
-    airMopError(mop); return 1;
+    nrrd->axis[0].kind = kind;
   }
   if (!nio->skipData) {
     if (_nrrdCalloc(nrrd, nio, file)) {
       biffAddf(NRRD, "%s: couldn't allocate memory for data", me);
-      return 1;
+      airMopError(mop); return 1;
     }
     if (nio->encoding->read(file, nrrd->data, nrrdElementNumber(nrrd),
                             nrrd, nio)) {
       biffAddf(NRRD, "%s:", me);
-      return 1;
+      airMopError(mop); return 1;
     }
     if (1 < nrrdElementSize(nrrd)
         && nio->encoding->endianMatters
@@ -287,45 +373,49 @@ _nrrdFormatVTK_read(FILE *file, Nrrd *nrrd, NrrdIoState *nio) {
   return 0;
 }
 
+/*
+** the raw data in VTK files is big-endian; on little-endian machines
+** the data is swapped into a buffer of this many bytes at a time and
+** written from there, rather than swapping a copy of the whole array
+*/
+#define _NRRD_VTK_SWAP_BYTES (1024*1024)
+
 /* this strongly assumes that nrrdFitsInFormat() was true */
 int
-_nrrdFormatVTK_write(FILE *file, const Nrrd *_nrrd, NrrdIoState *nio) {
+_nrrdFormatVTK_write(FILE *file, const Nrrd *nrrd, NrrdIoState *nio) {
   static const char me[]="_nrrdFormatVTK_write";
-  int i, sx, sy, sz, sax;
+  int i;
+  unsigned int sax, compNum;
+  size_t sx, sy, sz, elSize, elNum, pieceNum, ei, nn;
   double xs, ys, zs, xm, ym, zm;
-  char type[AIR_STRLEN_MED], name[AIR_STRLEN_SMALL];
-  Nrrd *nrrd;
+  char type[AIR_STRLEN_MED], name[AIR_STRLEN_SMALL],
+    stmp[3][AIR_STRLEN_SMALL];
+  const char *attr;
+  const char *data;
+  char *buff;
   airArray *mop;
 
-  /* HEY: should this copy be done more conservatively */
-  mop = airMopNew();
-  airMopAdd(mop, nrrd=nrrdNew(), (airMopper)nrrdNuke, airMopAlways);
-  if (nrrdCopy(nrrd, _nrrd)) {
-    biffAddf(NRRD, "%s: couldn't make private copy", me);
-    airMopError(mop); return 1;
-  }
-  if (!( 3 == nrrd->dim ||
-         (4 == nrrd->dim && (3 == nrrd->axis[0].size ||
-                             9 == nrrd->axis[0].size)) )) {
+  attr = _nrrdFormatVTK_attribute(&compNum, nrrd);
+  if (!attr) {
     biffAddf(NRRD, "%s: doesn't seem to be scalar, vector, or matrix", me);
-    airMopError(mop); return 1;
+    return 1;
   }
-  sax = nrrd->dim - 3;
+  sax = 4 == nrrd->dim ? 1 : 0;
   xs = nrrd->axis[sax+0].spacing;
   ys = nrrd->axis[sax+1].spacing;
-  zs = nrrd->axis[sax+2].spacing;
+  zs = 2 == nrrd->dim ? 1.0 : nrrd->axis[sax+2].spacing;
   if (!( AIR_EXISTS(xs) && AIR_EXISTS(ys) && AIR_EXISTS(zs) )) {
     xs = ys = zs = 1.0;
   }
   xm = nrrd->axis[sax+0].min;
   ym = nrrd->axis[sax+1].min;
-  zm = nrrd->axis[sax+2].min;
+  zm = 2 == nrrd->dim ? 0.0 : nrrd->axis[sax+2].min;
   if (!( AIR_EXISTS(xm) && AIR_EXISTS(ym) && AIR_EXISTS(zm) )) {
     xm = ym = zm = 0.0;
   }
-  sx = AIR_CAST(int, nrrd->axis[sax+0].size);
-  sy = AIR_CAST(int, nrrd->axis[sax+1].size);
-  sz = AIR_CAST(int, nrrd->axis[sax+2].size);
+  sx = nrrd->axis[sax+0].size;
+  sy = nrrd->axis[sax+1].size;
+  sz = 2 == nrrd->dim ? 1 : nrrd->axis[sax+2].size;
 
   switch(nrrd->type) {
   case nrrdTypeUChar:
@@ -355,7 +445,7 @@ _nrrdFormatVTK_write(FILE *file, const Nrrd *_nrrd, NrrdIoState *nio) {
   default:
     biffAddf(NRRD, "%s: can't put %s-type nrrd into VTK", me,
              airEnumStr(nrrdType, nrrd->type));
-    airMopError(mop); return 1;
+    return 1;
   }
   fprintf(file, "%s\n", MAGIC3);
   /* there is a file-format-imposed limit on the length of the "content" */
@@ -374,36 +464,56 @@ _nrrdFormatVTK_write(FILE *file, const Nrrd *_nrrd, NrrdIoState *nio) {
     fprintf(file, "ASCII\n");
   }
   fprintf(file, "DATASET STRUCTURED_POINTS\n");
-  fprintf(file, "DIMENSIONS %d %d %d\n", sx, sy, sz);
+  fprintf(file, "DIMENSIONS %s %s %s\n", airSprintSize_t(stmp[0], sx),
+          airSprintSize_t(stmp[1], sy), airSprintSize_t(stmp[2], sz));
   fprintf(file, "ORIGIN %g %g %g\n", xm, ym, zm);
   fprintf(file, "SPACING %g %g %g\n", xs, ys, zs);
-  fprintf(file, "POINT_DATA %d\n", sx*sy*sz);
+  fprintf(file, "POINT_DATA %s\n", airSprintSize_t(stmp[0], sx*sy*sz));
   airSrandMT(AIR_CAST(unsigned int, airTime()));
   sprintf(name, "nrrd%05d", airRandInt(100000));
-  if (3 == nrrd->dim) {
-    fprintf(file, "SCALARS %s %s\n", name, type);
-    fprintf(file, "LOOKUP_TABLE default\n");
-  } else {
-    /* 4 == nrrd->dim */
-    if (3 == nrrd->axis[0].size) {
-      fprintf(file, "VECTORS %s %s\n", name, type);
+  if (!strcmp("SCALARS", attr)) {
+    if (1 == compNum) {
+      fprintf(file, "SCALARS %s %s\n", name, type);
     } else {
-      fprintf(file, "TENSORS %s %s\n", name, type);
+      fprintf(file, "SCALARS %s %s %u\n", name, type, compNum);
     }
+    fprintf(file, "LOOKUP_TABLE default\n");
+  } else {
+    fprintf(file, "%s %s %s\n", attr, name, type);
   }
-  if (1 < nrrdElementSize(nrrd)
+  elSize = nrrdElementSize(nrrd);
+  elNum = nrrdElementNumber(nrrd);
+  data = AIR_CAST(const char *, nrrd->data);
+  if (1 < elSize
       && nio->encoding->endianMatters
       && airMyEndian() != airEndianBig) {
     /* encoding exposes endianness, and we're not big, as req.d by VTK */
-    nrrdSwapEndian(nrrd);
-  }
-  if (nio->encoding->write(file, nrrd->data, nrrdElementNumber(nrrd),
-                           nrrd, nio)) {
-    biffAddf(NRRD, "%s:", me);
-    airMopError(mop); return 1;
+    pieceNum = AIR_MIN(elNum, _NRRD_VTK_SWAP_BYTES/elSize);
+    buff = AIR_CAST(char *, malloc(pieceNum*elSize));
+    if (!buff) {
+      biffAddf(NRRD, "%s: couldn't allocate %s-byte swap buffer", me,
+               airSprintSize_t(stmp[0], pieceNum*elSize));
+      return 1;
+    }
+    mop = airMopNew();
+    airMopAdd(mop, buff, airFree, airMopAlways);
+    for (ei=0; ei<elNum; ei+=nn) {
+      nn = AIR_MIN(pieceNum, elNum - ei);
+      memcpy(buff, data + ei*elSize, nn*elSize);
+      _nrrdSwapEndianArray(buff, nn, nrrd->type);
+      if (nio->encoding->write(file, buff, nn, nrrd, nio)) {
+        biffAddf(NRRD, "%s:", me);
+        airMopError(mop); return 1;
+      }
+    }
+    airMopOkay(mop);
+  } else {
+    if (nio->encoding->write(file, data, elNum, nrrd, nio)) {
+      biffAddf(NRRD, "%s:", me);
+      return 1;
+    }
   }
 
-  airMopOkay(mop);
   return 0;
 }
 
@@ -78,14 +78,95 @@ nrrdKeyValueIndex(const Nrrd *nrrd, char **keyP, char **valueP,
   return;
 }
 
+/*
+** With only a few key/value pairs, a linear search through the keys is
+** as fast as anything.  With more, nrrd->kvpHash indexes them by key,
+** so that reading a header with N pairs (each added via nrrdKeyValueAdd,
+** which has to first see if the key is already there) takes O(N) time,
+** instead of O(N^2).  The table is kept at most half full, and is
+** rebuilt (at double the size) when that would be exceeded, or when
+** nrrdKeyValueErase shifts the indices of pairs.
+*/
+#define _NRRD_KVP_HASH_MIN 16
+
 static unsigned int
-_kvpIdxFind(const Nrrd *nrrd, const char *key, int *found) {
-  unsigned int nk, ki, ret;
+_kvpHashStr(const char *key) {
+  unsigned int hh;
+
+  /* FNV-1a */
+  hh = 2166136261u;
+  for (; *key; key++) {
+    hh ^= AIR_CAST(unsigned char, *key);
+    hh *= 16777619u;
+  }
+  return hh;
+}
+
+static void
+_kvpHashInsert(Nrrd *nrrd, unsigned int ki) {
+  unsigned int mask, hi;
+
+  mask = nrrd->kvpHashLen - 1;
+  hi = _kvpHashStr(nrrd->kvp[0 + 2*ki]) & mask;
+  while (nrrd->kvpHash[hi]) {
+    hi = (hi + 1) & mask;
+  }
+  nrrd->kvpHash[hi] = ki + 1;
+  return;
+}
 
+/*
+** (re-)builds nrrd->kvpHash for the current key/value pairs, or frees
+** it if there are too few to bother.  If allocation fails, the hash is
+** simply not used (it is only an index).
+*/
+static void
+_kvpHashRebuild(Nrrd *nrrd) {
+  unsigned int nk, ki, hlen;
+
+  nrrd->kvpHash = AIR_CAST(unsigned int *, airFree(nrrd->kvpHash));
+  nrrd->kvpHashLen = 0;
   nk = nrrd->kvpArr->len;
+  if (nk < _NRRD_KVP_HASH_MIN) {
+    return;
+  }
+  /* room for the current pairs to double before the next rebuild */
+  hlen = 4*_NRRD_KVP_HASH_MIN;
+  while (hlen < 4*nk) {
+    hlen *= 2;
+  }
+  nrrd->kvpHash = AIR_CALLOC(hlen, unsigned int);
+  if (!nrrd->kvpHash) {
+    return;
+  }
+  nrrd->kvpHashLen = hlen;
   for (ki=0; ki<nk; ki++) {
-    if (!strcmp(nrrd->kvp[0 + 2*ki], key)) {
-      break;
+    _kvpHashInsert(nrrd, ki);
+  }
+  return;
+}
+
+static unsigned int
+_kvpIdxFind(const Nrrd *nrrd, const char *key, int *found) {
+  unsigned int nk, ki, hi, mask, ret;
+
+  nk = nrrd->kvpArr->len;
+  if (nrrd->kvpHash) {
+    mask = nrrd->kvpHashLen - 1;
+    ki = nk;
+    for (hi = _kvpHashStr(key) & mask;
+         nrrd->kvpHash[hi];
+         hi = (hi + 1) & mask) {
+      if (!strcmp(nrrd->kvp[0 + 2*(nrrd->kvpHash[hi] - 1)], key)) {
+        ki = nrrd->kvpHash[hi] - 1;
+        break;
+      }
+    }
+  } else {
+    for (ki=0; ki<nk; ki++) {
+      if (!strcmp(nrrd->kvp[0 + 2*ki], key)) {
+        break;
+      }
     }
   }
   if (ki<nk) {
@@ -112,6 +193,8 @@ nrrdKeyValueClear(Nrrd *nrrd) {
     nrrd->kvp[1 + 2*ki] = (char *)airFree(nrrd->kvp[1 + 2*ki]);
   }
   airArrayLenSet(nrrd->kvpArr, 0);
+  nrrd->kvpHash = AIR_CAST(unsigned int *, airFree(nrrd->kvpHash));
+  nrrd->kvpHashLen = 0;
 
   return;
 }
@@ -137,6 +220,10 @@ nrrdKeyValueErase(Nrrd *nrrd, const char *key) {
     nrrd->kvp[1 + 2*ki] = nrrd->kvp[1 + 2*(ki+1)];
   }
   airArrayLenIncr(nrrd->kvpArr, -1);
+  if (nrrd->kvpHash) {
+    /* indices of subsequent pairs have changed */
+    _kvpHashRebuild(nrrd);
+  }
 
   return 0;
 }
@@ -176,6 +263,11 @@ nrrdKeyValueAdd(Nrrd *nrrd, const char *key, const char *value) {
     ki = airArrayLenIncr(nrrd->kvpArr, 1);
     nrrd->kvp[0 + 2*ki] = airStrdup(key);
     nrrd->kvp[1 + 2*ki] = airStrdup(value);
+    if (nrrd->kvpHash && 2*(ki + 1) <= nrrd->kvpHashLen) {
+      _kvpHashInsert(nrrd, ki);
+    } else if (ki + 1 >= _NRRD_KVP_HASH_MIN) {
+      _kvpHashRebuild(nrrd);
+    }
   }
   return 0;
 }
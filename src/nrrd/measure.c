@@ -453,58 +453,55 @@ _nrrdMeasureLinf(void *ans, int ansType,
   nrrdDStore[ansType](ans, M);
 }
 
+/*
+** _nrrdMeasureVarianceD()
+**
+** variance of the existent values in the line, computed in a single
+** pass with Welford's method, rather than with the sum and sum of
+** squares (which can lose all precision to cancellation, and even go
+** negative).  Returns NaN if there are no existent values.
+**
+** The same update is used by the streaming path in nrrdProject, so
+** that the two agree exactly.
+*/
+static double
+_nrrdMeasureVarianceD(const void *line, int lineType, size_t len) {
+  double val, mean, diff, M2, (*lup)(const void*, size_t);
+  size_t ii, count;
+
+  lup = nrrdDLookup[lineType];
+  mean = M2 = 0.0;
+  count = 0;
+  for (ii=0; ii<len; ii++) {
+    val = lup(line, ii);
+    if (AIR_EXISTS(val)) {
+      count++;
+      diff = val - mean;
+      mean += diff/count;
+      M2 += diff*(val - mean);
+    }
+  }
+  return count ? M2/count : AIR_NAN;
+}
+
 void
 _nrrdMeasureVariance(void *ans, int ansType,
                      const void *line, int lineType, size_t len,
                      double axmin, double axmax) {
-  double val, S, SS, (*lup)(const void*, size_t);
-  size_t ii, count;
 
   AIR_UNUSED(axmin);
   AIR_UNUSED(axmax);
-  SS = S = 0.0;
-  lup = nrrdDLookup[lineType];
-  if (nrrdTypeIsIntegral[lineType]) {
-    for (ii=0; ii<len; ii++) {
-      val = lup(line, ii);
-      S += val;
-      SS += val*val;
-    }
-    S /= len;
-    SS /= len;
-  } else {
-    count = 0;
-    for (ii=0; ii<len; ii++) {
-      val = lup(line, ii);
-      if (AIR_EXISTS(val)) {
-        count++;
-        S += val;
-        SS += val*val;
-      }
-    }
-    if (count) {
-      S /= count;
-      SS /= count;
-    } else {
-      S = SS = AIR_NAN;
-    }
-  }
-  /* HEY: the AIR_MAX is needed because precision errors
-     can produce a negative value for SS - S*S;
-     this may be a sign of the false economy of doing
-     the variance calculation in a single pass */
-  nrrdDStore[ansType](ans, AIR_MAX(0.0, SS - S*S));
+  nrrdDStore[ansType](ans, _nrrdMeasureVarianceD(line, lineType, len));
 }
 
 void
 _nrrdMeasureSD(void *ans, int ansType,
                const void *line, int lineType, size_t len,
                double axmin, double axmax) {
-  double var;
 
-  _nrrdMeasureVariance(ans, ansType, line, lineType, len, axmin, axmax);
-  var = nrrdDLoad[ansType](ans);
-  nrrdDStore[ansType](ans, sqrt(var));
+  AIR_UNUSED(axmin);
+  AIR_UNUSED(axmax);
+  nrrdDStore[ansType](ans, sqrt(_nrrdMeasureVarianceD(line, lineType, len)));
 }
 
 void
@@ -1110,17 +1107,260 @@ _nrrdMeasureType(const Nrrd *nin, int measr) {
   return type;
 }
 
+/*
+** The measures that nrrdProject can compute by streaming through the
+** input in memory order, keeping a little running state for each of a
+** block of output values, instead of gathering (with a strided copy)
+** each line along the projection axis and calling nrrdMeasureLine on
+** it.  This is what makes projections along slow axes (like MIPs or
+** means along time) fast.  The running state per output value is in
+** three doubles S, A, and C (C is the count of existent values), and
+** the results are exactly the same as from the nrrdMeasureLine
+** functions (notably, variance is by Welford's method in both).
+*/
+static int
+_nrrdProjectStreamable(int measr) {
+  int ret;
+
+  switch (measr) {
+  case nrrdMeasureMin:
+  case nrrdMeasureMax:
+  case nrrdMeasureMean:
+  case nrrdMeasureSum:
+  case nrrdMeasureL2:
+  case nrrdMeasureVariance:
+  case nrrdMeasureSD:
+    ret = AIR_TRUE;
+    break;
+  default:
+    ret = AIR_FALSE;
+    break;
+  }
+  return ret;
+}
+
+/* number of output values handled together in the streaming path */
+#define _NRRD_PROJECT_BLOCK 1024
+
+#define _PROJ_MIN(s, a, c, v)  if (AIR_EXISTS(v)) { \
+    s = (c) ? AIR_MIN(s, v) : v; c += 1; }
+#define _PROJ_MAX(s, a, c, v)  if (AIR_EXISTS(v)) { \
+    s = (c) ? AIR_MAX(s, v) : v; c += 1; }
+#define _PROJ_SUM(s, a, c, v)  if (AIR_EXISTS(v)) { \
+    s = (c) ? s + v : v; c += 1; }
+#define _PROJ_SSQ(s, a, c, v)  if (AIR_EXISTS(v)) { \
+    s = (c) ? s + v*v : v*v; c += 1; }
+#define _PROJ_VAR(s, a, c, v)  if (AIR_EXISTS(v)) { \
+    double _dd; c += 1; _dd = v - s; s += _dd/c; a += _dd*(v - s); }
+
+#define _PROJ_LOOP(UPD)                                  \
+  if (col) {                                             \
+    for (ii=0; ii<num; ii++) {                           \
+      UPD(S[ii], A[ii], C[ii], val[ii]);                 \
+    }                                                    \
+  } else {                                               \
+    double ss, aa, cc;                                   \
+    ss = S[0]; aa = A[0]; cc = C[0];                     \
+    for (ii=0; ii<num; ii++) {                           \
+      UPD(ss, aa, cc, val[ii]);                          \
+    }                                                    \
+    S[0] = ss; A[0] = aa; C[0] = cc;                     \
+  }
+
+/*
+** _nrrdProjectUpdate()
+**
+** folds "num" values "val" into the running state.  If "col" is
+** non-zero, val[ii] is folded into the state of output value ii;
+** otherwise all the values are folded into the state of output value 0
+*/
+static void
+_nrrdProjectUpdate(int measr, double *S, double *A, double *C,
+                   const double *val, size_t num, int col) {
+  size_t ii;
+
+  switch (measr) {
+  case nrrdMeasureMin:
+    _PROJ_LOOP(_PROJ_MIN);
+    break;
+  case nrrdMeasureMax:
+    _PROJ_LOOP(_PROJ_MAX);
+    break;
+  case nrrdMeasureMean:
+  case nrrdMeasureSum:
+    _PROJ_LOOP(_PROJ_SUM);
+    break;
+  case nrrdMeasureL2:
+    _PROJ_LOOP(_PROJ_SSQ);
+    break;
+  case nrrdMeasureVariance:
+  case nrrdMeasureSD:
+    _PROJ_LOOP(_PROJ_VAR);
+    break;
+  }
+  return;
+}
+
+static double
+_nrrdProjectFinish(int measr, double S, double A, double C) {
+  double ret;
+
+  if (!C) {
+    /* there were NO existent values */
+    return AIR_NAN;
+  }
+  switch (measr) {
+  case nrrdMeasureMean:
+    ret = S/C;
+    break;
+  case nrrdMeasureL2:
+    ret = sqrt(S);
+    break;
+  case nrrdMeasureVariance:
+    ret = A/C;
+    break;
+  case nrrdMeasureSD:
+    ret = sqrt(A/C);
+    break;
+  default:
+    ret = S;
+    break;
+  }
+  return ret;
+}
+
+#undef _PROJ_MIN
+#undef _PROJ_MAX
+#undef _PROJ_SUM
+#undef _PROJ_SSQ
+#undef _PROJ_VAR
+#undef _PROJ_LOOP
+
+/*
+** _nrrdProjectTask
+**
+** what the threads doing nrrdProject need to know.  With the input
+** viewed as a colNum x linLen x rowNum array (linLen being the size of
+** the projected axis), the output is colNum x rowNum.
+*/
+typedef struct {
+  int measr, iType, oType, stream;
+  size_t iElSz, oElSz, linLen, rowNum, colNum, blockNum;
+  double axmin, axmax;
+  const char *iData;
+  char *oData;
+  char **line;                  /* per-thread scanline buffers */
+  double **buff;                /* per-thread streaming state */
+} _nrrdProjectTask;
+
+/*
+** _nrrdProjectWork()
+**
+** in the streaming path, work item "wi" is one block of (at most)
+** _NRRD_PROJECT_BLOCK output values along one row; otherwise its just
+** output value "wi"
+*/
+static void
+_nrrdProjectWork(void *_task, size_t lo, size_t hi, unsigned int tidx) {
+  const _nrrdProjectTask *task;
+  const char *ptr;
+  char *line;
+  size_t wi, ei, ci, rowIdx, colIdx, iElSz, colNum, linLen, num;
+
+  task = AIR_CAST(const _nrrdProjectTask *, _task);
+  iElSz = task->iElSz;
+  colNum = task->colNum;
+  linLen = task->linLen;
+  if (task->stream) {
+    double *val, *S, *A, *C;
+    const double *vv;
+    val = task->buff[tidx];
+    S = val + 1*_NRRD_PROJECT_BLOCK;
+    A = val + 2*_NRRD_PROJECT_BLOCK;
+    C = val + 3*_NRRD_PROJECT_BLOCK;
+    for (wi=lo; wi<hi; wi++) {
+      rowIdx = wi/task->blockNum;
+      colIdx = (wi % task->blockNum)*_NRRD_PROJECT_BLOCK;
+      num = AIR_MIN(_NRRD_PROJECT_BLOCK, colNum - colIdx);
+      for (ci=0; ci<num; ci++) {
+        S[ci] = A[ci] = C[ci] = 0.0;
+      }
+      if (1 == colNum) {
+        /* projecting along axis 0: the line is contiguous in memory,
+           and is processed in pieces of _NRRD_PROJECT_BLOCK values */
+        ptr = task->iData + iElSz*linLen*rowIdx;
+        for (ei=0; ei<linLen; ei += _NRRD_PROJECT_BLOCK) {
+          num = AIR_MIN(_NRRD_PROJECT_BLOCK, linLen - ei);
+          if (nrrdTypeDouble == task->iType) {
+            vv = AIR_CAST(const double *, ptr) + ei;
+          } else {
+            _nrrdConv[nrrdTypeDouble][task->iType](val, ptr + iElSz*ei, num);
+            vv = val;
+          }
+          _nrrdProjectUpdate(task->measr, S, A, C, vv, num, AIR_FALSE);
+        }
+        num = 1;
+      } else {
+        /* each successive position along the projected axis is a
+           contiguous run of num values, one for each output value */
+        for (ei=0; ei<linLen; ei++) {
+          ptr = task->iData + iElSz*(colIdx + colNum*(ei + linLen*rowIdx));
+          if (nrrdTypeDouble == task->iType) {
+            vv = AIR_CAST(const double *, ptr);
+          } else {
+            _nrrdConv[nrrdTypeDouble][task->iType](val, ptr, num);
+            vv = val;
+          }
+          _nrrdProjectUpdate(task->measr, S, A, C, vv, num, AIR_TRUE);
+        }
+      }
+      for (ci=0; ci<num; ci++) {
+        nrrdDStore[task->oType](task->oData
+                                + task->oElSz*(colIdx + colNum*rowIdx + ci),
+                                _nrrdProjectFinish(task->measr,
+                                                   S[ci], A[ci], C[ci]));
+      }
+    }
+  } else {
+    line = task->line ? task->line[tidx] : NULL;
+    for (wi=lo; wi<hi; wi++) {
+      rowIdx = wi/colNum;
+      colIdx = wi % colNum;
+      ptr = task->iData + iElSz*(colIdx + rowIdx*linLen*colNum);
+      if (1 != colNum) {
+        for (ei=0; ei<linLen; ei++) {
+          memcpy(line + ei*iElSz, ptr + ei*iElSz*colNum, iElSz);
+        }
+        ptr = line;
+      } /* else the line is already contiguous; no copy needed */
+      nrrdMeasureLine[task->measr](task->oData + task->oElSz*wi, task->oType,
+                                   ptr, task->iType, linLen,
+                                   task->axmin, task->axmax);
+    }
+  }
+  return;
+}
+
+/*
+******** nrrdProject()
+**
+** measures each line along the given axis, to produce an output with
+** one fewer axis.  The work is split across nrrdStateThreadNum threads
+** (except for nrrdMeasureMode, which uses biff internally); the output
+** does not depend on the number of threads.  Min, max, mean, sum, L2,
+** variance, and SD are computed by streaming through the input rather
+** than by gathering each line, and when projecting along axis 0, the
+** other measures work directly on the input lines, without copying.
+*/
 int
 nrrdProject(Nrrd *nout, const Nrrd *cnin, unsigned int axis,
             int measr, int type) {
   static const char me[]="nrrdProject", func[]="project";
   int iType, oType, axmap[NRRD_DIM_MAX];
-  unsigned int ai, ei;
+  unsigned int ai, ti, threadNum;
   size_t iElSz, oElSz, iSize[NRRD_DIM_MAX], oSize[NRRD_DIM_MAX], linLen,
-    rowIdx, rowNum, colIdx, colNum, colStep;
-  const char *ptr, *iData;
-  char *oData, *line;
-  double axmin, axmax;
+    rowNum, colNum, workNum;
+  _nrrdProjectTask task;
   Nrrd *nin;
   airArray *mop;
 
@@ -1192,7 +1432,6 @@ nrrdProject(Nrrd *nout, const Nrrd *cnin, unsigned int axis,
     }
   }
   linLen = iSize[axis];
-  colStep = linLen*colNum;
   for (ai=0; ai<=(nin ? nin : cnin)->dim-2; ai++) {
     axmap[ai] = ai + (ai >= axis);
   }
@@ -1204,31 +1443,66 @@ nrrdProject(Nrrd *nout, const Nrrd *cnin, unsigned int axis,
     airMopError(mop); return 1;
   }
 
-  /* allocate a scanline buffer */
-  if (!(line = AIR_CALLOC(linLen*iElSz, char))) {
-    char stmp1[AIR_STRLEN_SMALL], stmp2[AIR_STRLEN_SMALL];
-    biffAddf(NRRD, "%s: couldn't calloc(%s,%s) scanline buffer", me,
-             airSprintSize_t(stmp1, linLen),
-             airSprintSize_t(stmp2, iElSz));
-    airMopError(mop); return 1;
+  /* set up the task */
+  task.measr = measr;
+  task.iType = iType;
+  task.oType = oType;
+  task.stream = _nrrdProjectStreamable(measr);
+  task.iElSz = iElSz;
+  task.oElSz = oElSz;
+  task.linLen = linLen;
+  task.rowNum = rowNum;
+  task.colNum = colNum;
+  task.blockNum = (colNum + _NRRD_PROJECT_BLOCK - 1)/_NRRD_PROJECT_BLOCK;
+  task.axmin = (nin ? nin : cnin)->axis[axis].min;
+  task.axmax = (nin ? nin : cnin)->axis[axis].max;
+  task.iData = AIR_CAST(const char *, (nin ? nin : cnin)->data);
+  task.oData = AIR_CAST(char *, nout->data);
+  task.line = NULL;
+  task.buff = NULL;
+  workNum = task.stream ? rowNum*task.blockNum : rowNum*colNum;
+  threadNum = (nrrdMeasureMode == measr
+               ? 1
+               : _nrrdThreadNumber(nrrdStateThreadNum, workNum, 1));
+
+  /* allocate per-thread buffers */
+  if (task.stream) {
+    task.buff = AIR_CALLOC(threadNum, double *);
+    airMopAdd(mop, task.buff, airFree, airMopAlways);
+    for (ti=0; task.buff && ti<threadNum; ti++) {
+      task.buff[ti] = AIR_CALLOC(4*_NRRD_PROJECT_BLOCK, double);
+      airMopAdd(mop, task.buff[ti], airFree, airMopAlways);
+      if (!task.buff[ti]) {
+        break;
+      }
+    }
+    if (!( task.buff && ti == threadNum )) {
+      biffAddf(NRRD, "%s: couldn't allocate streaming buffers", me);
+      airMopError(mop); return 1;
+    }
+  } else if (1 != colNum) {
+    task.line = AIR_CALLOC(threadNum, char *);
+    airMopAdd(mop, task.line, airFree, airMopAlways);
+    for (ti=0; task.line && ti<threadNum; ti++) {
+      task.line[ti] = AIR_CALLOC(linLen*iElSz, char);
+      airMopAdd(mop, task.line[ti], airFree, airMopAlways);
+      if (!task.line[ti]) {
+        break;
+      }
+    }
+    if (!( task.line && ti == threadNum )) {
+      char stmp1[AIR_STRLEN_SMALL], stmp2[AIR_STRLEN_SMALL];
+      biffAddf(NRRD, "%s: couldn't calloc(%s,%s) scanline buffers", me,
+               airSprintSize_t(stmp1, linLen),
+               airSprintSize_t(stmp2, iElSz));
+      airMopError(mop); return 1;
+    }
   }
-  airMopAdd(mop, line, airFree, airMopAlways);
 
   /* the skinny */
-  axmin = (nin ? nin : cnin)->axis[axis].min;
-  axmax = (nin ? nin : cnin)->axis[axis].max;
-  iData = AIR_CAST(char *, (nin ? nin : cnin)->data);
-  oData = AIR_CAST(char *, nout->data);
-  for (rowIdx=0; rowIdx<rowNum; rowIdx++) {
-    for (colIdx=0; colIdx<colNum; colIdx++) {
-      ptr = iData + iElSz*(colIdx + rowIdx*colStep);
-      for (ei=0; ei<linLen; ei++) {
-        memcpy(line + ei*iElSz, ptr + ei*iElSz*colNum, iElSz);
-      }
-      nrrdMeasureLine[measr](oData, oType, line, iType, linLen,
-                             axmin, axmax);
-      oData += oElSz;
-    }
+  if (_nrrdThreadRun(threadNum, workNum, 1, _nrrdProjectWork, &task)) {
+    biffAddf(NRRD, "%s: trouble", me);
+    airMopError(mop); return 1;
   }
 
   /* copy the peripheral information */
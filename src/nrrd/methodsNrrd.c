@@ -282,6 +282,9 @@ nrrdIoStateInit(NrrdIoState *nio) {
     nio->zlibLevel = -1;
     nio->zlibStrategy = nrrdZlibStrategyDefault;
     nio->bzip2BlockSize = -1;
+    /* ---- BEGIN non-NrrdIO */
+    nio->checksumType = nrrdDefaultWriteChecksumType;
+    /* ---- END non-NrrdIO */
     nio->learningHeaderStrlen = AIR_FALSE;
     nio->oldData = NULL;
     nio->oldDataSize = 0;
@@ -703,6 +706,8 @@ nrrdNew(void) {
     return NULL;
   }
   /* key/value airArray uses no callbacks for now */
+  nrrd->kvpHash = NULL;
+  nrrd->kvpHashLen = 0;
 
   /* finish initializations */
   nrrdInit(nrrd);
@@ -205,6 +205,14 @@ typedef struct {
   */
   char **kvp;
   airArray *kvpArr;
+  unsigned int *kvpHash,    /* index into kvp by key: an open-addressed hash
+                               table of (key/value pair index + 1), with 0
+                               for empty slots, or NULL when there are too
+                               few pairs to bother.  Managed entirely by the
+                               nrrdKeyValue functions, so that lookups stay
+                               fast with thousands of pairs (as in DWI
+                               headers); don't touch */
+    kvpHashLen;             /* allocated length of kvpHash (power of 2) */
 } Nrrd;
 
 struct NrrdIoState_t;
@@ -396,9 +404,10 @@ typedef struct NrrdIoState_t {
                                info in the text file */
     skipData,               /* if non-zero (all formats):
                                ON READ: don't allocate memory for, and don't
-                               read in, the data portion of the file (but we
-                               do verify that for nrrds, detached datafiles
-                               can be opened).  Note: Does NOT imply
+                               read in, the data portion of the file. For
+                               nrrds, unless keepNrrdDataFileOpen is also
+                               set, the data files aren't even opened, so
+                               only the header is read.  Note: Does NOT imply
                                keepNrrdDataFileOpen.  Warning: resulting
                                nrrd struct will have "data" pointer NULL.
                                ON WRITE: don't write data portion of file
@@ -423,6 +432,12 @@ typedef struct NrrdIoState_t {
     bzip2BlockSize,         /* block size used for compression,
                                roughly equivalent to better but slower
                                (1-9, -1 for default[9]). */
+    checksumType,           /* ON WRITE, for NRRD format: if not
+                               nrrdChecksumTypeUnknown, the kind of checksum
+                               (from the nrrdChecksumType enum) of the data
+                               to record in the NRRD_CHECKSUM_KEY key/value
+                               pair in the header. Initialized from
+                               nrrdDefaultWriteChecksumType */
     learningHeaderStrlen;   /* ON WRITE, for nrrds, learn and save the total
                                length of header into headerStrlen. This is
                                used to allocate a buffer for header */
@@ -686,6 +701,7 @@ NRRD_EXPORT int nrrdDefaultResampleCheap;
 NRRD_EXPORT double nrrdDefaultResamplePadValue;
 NRRD_EXPORT int nrrdDefaultResampleNonExistent;
 NRRD_EXPORT double nrrdDefaultKernelParm0;
+NRRD_EXPORT int nrrdDefaultWriteChecksumType;
 /* ---- END non-NrrdIO */
 NRRD_EXPORT int nrrdDefaultCenter;
 NRRD_EXPORT double nrrdDefaultSpacing;
@@ -697,6 +713,7 @@ NRRD_EXPORT int nrrdStateMeasureType;
 NRRD_EXPORT int nrrdStateMeasureModeBins;
 NRRD_EXPORT int nrrdStateMeasureHistoType;
 NRRD_EXPORT int nrrdStateDisallowIntegerNonExist;
+NRRD_EXPORT unsigned int nrrdStateThreadNum;
 /* ---- END non-NrrdIO */
 NRRD_EXPORT int nrrdStateAlwaysSetContent;
 NRRD_EXPORT int nrrdStateDisableContent;
@@ -712,6 +729,7 @@ NRRD_EXPORT const char *const nrrdEnvVarDefaultCenter;
 NRRD_EXPORT const char *const nrrdEnvVarDefaultCenterOld;
 NRRD_EXPORT const char *const nrrdEnvVarDefaultWriteCharsPerLine;
 NRRD_EXPORT const char *const nrrdEnvVarDefaultWriteValsPerLine;
+NRRD_EXPORT const char *const nrrdEnvVarDefaultWriteChecksumType;
 NRRD_EXPORT const char *const nrrdEnvVarDefaultKernelParm0;
 NRRD_EXPORT const char *const nrrdEnvVarDefaultSpacing;
 NRRD_EXPORT const char *const nrrdEnvVarStateKindNoop;
@@ -724,6 +742,7 @@ NRRD_EXPORT const char *const nrrdEnvVarStateMeasureType;
 NRRD_EXPORT const char *const nrrdEnvVarStateMeasureModeBins;
 NRRD_EXPORT const char *const nrrdEnvVarStateMeasureHistoType;
 NRRD_EXPORT const char *const nrrdEnvVarStateGrayscaleImage3D;
+NRRD_EXPORT const char *const nrrdEnvVarStateThreadNum;
 NRRD_EXPORT int nrrdGetenvBool(int *val, char **envStr,
                                const char *envVar);
 NRRD_EXPORT int nrrdGetenvEnum(int *val, char **envStr, const airEnum *enm,
@@ -763,6 +782,7 @@ NRRD_EXPORT const airEnum *const nrrdBinaryOp;
 NRRD_EXPORT const airEnum *const nrrdTernaryOp;
 NRRD_EXPORT const airEnum *const nrrdFFTWPlanRigor;
 NRRD_EXPORT const airEnum *const nrrdResampleNonExistent;
+NRRD_EXPORT const airEnum *const nrrdChecksumType;
 /* ---- END non-NrrdIO */
 
 /******** arrays of things (poor-man's functions/predicates) */
@@ -1291,6 +1311,7 @@ NRRD_EXPORT int nrrdArithIterAffine(Nrrd *nout, NrrdIter *minIn,
                                     NrrdIter *minOut, NrrdIter *maxOut,
                                     int clamp);
 NRRD_EXPORT unsigned int nrrdCRC32(const Nrrd *nin, int endian);
+NRRD_EXPORT airULLong nrrdXXH64(const Nrrd *nin, int endian);
 
 /******** filtering and re-sampling */
 /* filt.c */
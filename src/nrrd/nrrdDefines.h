@@ -78,6 +78,12 @@ extern "C" {
 /* ---- BEGIN non-NrrdIO */
 /* suffix string that indicates percentile-based min/max */
 #define NRRD_MINMAX_PERC_SUFF "%"
+/* key of the key/value pair in which a checksum of the data is recorded
+   (according to NrrdIoState->checksumType) when writing NRRD files. The
+   value is "<type> <endian> <checksum>", e.g. "crc32 little 3361747981".
+   When a checksum is written, it replaces any existing pair with this
+   key, which may describe data that has since changed */
+#define NRRD_CHECKSUM_KEY "checksum"
 /* ---- END non-NrrdIO */
 #define NRRD_COMMENT_CHAR '#'
 #define NRRD_FILENAME_INCR 32
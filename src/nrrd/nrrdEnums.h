@@ -53,6 +53,7 @@ enum {
   nrrdIoStateZlibLevel,
   nrrdIoStateZlibStrategy,
   nrrdIoStateBzip2BlockSize,
+  nrrdIoStateChecksumType,
   nrrdIoStateLast
 };
 
@@ -750,6 +751,21 @@ enum {
 };
 #define NRRD_RESAMPLE_NON_EXISTENT_MAX    3
 
+/*
+******** nrrdChecksumType* enum
+**
+** the kinds of checksums of nrrd data that can be computed (by unu cksum)
+** or recorded on write (via NrrdIoState->checksumType).  Unknown means
+** no checksum.
+*/
+enum {
+  nrrdChecksumTypeUnknown,
+  nrrdChecksumTypeCRC32,     /* 1: 32-bit CRC of cksum, via nrrdCRC32 */
+  nrrdChecksumTypeXXH64,     /* 2: 64-bit xxHash, via nrrdXXH64 */
+  nrrdChecksumTypeLast
+};
+#define NRRD_CHECKSUM_TYPE_MAX    2
+
 /* ---- END non-NrrdIO */
 
 #ifdef __cplusplus
@@ -105,6 +105,9 @@ extern const NrrdFormat _nrrdFormatEPS;
 extern int _nrrdHeaderCheck(Nrrd *nrrd, NrrdIoState *nio, int checkSeen);
 extern int _nrrdFormatNRRD_whichVersion(const Nrrd *nrrd, NrrdIoState *nio);
 
+/* endianNrrd.c */
+extern void _nrrdSwapEndianArray(void *data, size_t N, int type);
+
 /* encodingXXX.c */
 extern const NrrdEncoding _nrrdEncodingRaw;
 extern const NrrdEncoding _nrrdEncodingAscii;
@@ -209,6 +212,18 @@ extern int _nrrdGzWrite(gzFile file, const void* buf, unsigned int len,
 /* apply1D.c */
 extern double _nrrdApplyDomainMin(const Nrrd *nmap, int ramps, int mapAxis);
 extern double _nrrdApplyDomainMax(const Nrrd *nmap, int ramps, int mapAxis);
+extern double *_nrrd1DIrregMapDomain(int *posLenP, int *baseIP,
+                                     const Nrrd *nmap);
+extern int _nrrd1DIrregFindInterval(const double *pos, double p,
+                                    int loI, int hiI);
+
+/* threadNrrd.c */
+extern unsigned int _nrrdThreadNumber(unsigned int threadNum, size_t num,
+                                      size_t grain);
+extern int _nrrdThreadRun(unsigned int threadNum, size_t num, size_t grain,
+                          void (*work)(void *data, size_t lo, size_t hi,
+                                       unsigned int tidx),
+                          void *data);
 
 /* superset.c */
 extern size_t _nrrdMirror_64(size_t N, ptrdiff_t I);
@@ -1367,6 +1367,9 @@ _nrrdCheckEnums(void) {
   if (nrrdTernaryOpLast-1 != NRRD_TERNARY_OP_MAX) {
     strcpy(which, "nrrdTernaryOp"); goto err;
   }
+  if (nrrdChecksumTypeLast-1 != NRRD_CHECKSUM_TYPE_MAX) {
+    strcpy(which, "nrrdChecksumType"); goto err;
+  }
   /* ---- END non-NrrdIO */
 
   /* no errors so far */
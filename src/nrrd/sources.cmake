@@ -54,6 +54,7 @@ set(NRRD_SOURCES
   simple.c
   subset.c
   superset.c
+  threadNrrd.c
   tmfKernel.c
   winKernel.c
   bsplKernel.c
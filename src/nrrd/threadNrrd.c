@@ -0,0 +1,125 @@
+/*
+  Teem: Tools to process and visualize scientific data and images             .
+  Copyright (C) 2013, 2012, 2011, 2010, 2009  University of Chicago
+  Copyright (C) 2008, 2007, 2006, 2005  Gordon Kindlmann
+  Copyright (C) 2004, 2003, 2002, 2001, 2000, 1999, 1998  University of Utah
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public License
+  (LGPL) as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+  The terms of redistributing and/or modifying this software also
+  include exceptions to the LGPL that facilitate static linking.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to Free Software Foundation, Inc.,
+  51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "nrrd.h"
+#include "privateNrrd.h"
+
+/*
+** The little bit of infrastructure needed for nrrd functions that
+** can split their work over multiple threads.  The work is always a
+** set of "num" independent items (values to map, output samples to
+** measure, blocks to checksum), so the only thing to decide is how to
+** divide [0,num) into contiguous pieces.  Because the pieces are a
+** deterministic function of num and the number of threads, and each
+** item is computed the same way regardless of which piece it lands
+** in, the results are identical with any number of threads.
+*/
+
+typedef struct {
+  void (*work)(void *data, size_t lo, size_t hi, unsigned int tidx);
+  void *data;
+  size_t lo, hi;
+  unsigned int tidx;
+} _nrrdThreadPiece;
+
+static void *
+_nrrdThreadBody(void *_piece) {
+  _nrrdThreadPiece *piece;
+
+  piece = AIR_CAST(_nrrdThreadPiece *, _piece);
+  piece->work(piece->data, piece->lo, piece->hi, piece->tidx);
+  return _piece;
+}
+
+/*
+** _nrrdThreadNumber()
+**
+** how many pieces _nrrdThreadRun will split "num" items into, given
+** that we want at most "threadNum" threads, each doing at least
+** "grain" items.  Callers that need per-thread scratch space can use
+** this to learn how much to allocate.
+*/
+unsigned int
+_nrrdThreadNumber(unsigned int threadNum, size_t num, size_t grain) {
+  size_t maxNum;
+
+  threadNum = AIR_MAX(1, threadNum);
+  grain = AIR_MAX(1, grain);
+  maxNum = num/grain;
+  if (maxNum < threadNum) {
+    threadNum = AIR_CAST(unsigned int, AIR_MAX(1, maxNum));
+  }
+  return threadNum;
+}
+
+/*
+** _nrrdThreadRun()
+**
+** calls work(data, lo, hi, tidx) on contiguous pieces [lo,hi) of
+** [0,num), with tidx in [0,_nrrdThreadNumber(threadNum, num, grain)).
+** With only one piece, the work is done in the calling thread; with
+** more, each piece gets its own thread (or rather, all but the first,
+** which is done by the calling thread).  The "work" function can't
+** use biff, and must not touch anything outside its [lo,hi) piece
+** other than what is indexed by tidx.
+**
+** Returns non-zero (with biff) only if allocation failed, in which
+** case no work was done.
+*/
+int
+_nrrdThreadRun(unsigned int threadNum, size_t num, size_t grain,
+               void (*work)(void *data, size_t lo, size_t hi,
+                            unsigned int tidx),
+               void *data) {
+  static const char me[]="_nrrdThreadRun";
+  _nrrdThreadPiece *piece;
+  unsigned int ti;
+
+  if (!num) {
+    return 0;
+  }
+  threadNum = _nrrdThreadNumber(threadNum, num, grain);
+  if (1 == threadNum) {
+    work(data, 0, num, 0);
+    return 0;
+  }
+  piece = AIR_CALLOC(threadNum, _nrrdThreadPiece);
+  if (!piece) {
+    biffAddf(NRRD, "%s: couldn't allocate %u thread pieces", me, threadNum);
+    return 1;
+  }
+  for (ti=0; ti<threadNum; ti++) {
+    piece[ti].work = work;
+    piece[ti].data = data;
+    piece[ti].lo = num*ti/threadNum;
+    piece[ti].hi = num*(ti+1)/threadNum;
+    piece[ti].tidx = ti;
+  }
+  if (airThreadRun(threadNum, _nrrdThreadBody, piece,
+                   sizeof(_nrrdThreadPiece), NULL)) {
+    biffAddf(NRRD, "%s: couldn't start %u threads", me, threadNum);
+    airFree(piece); return 1;
+  }
+  airFree(piece);
+  return 0;
+}
@@ -92,6 +92,16 @@ nrrdIoStateSet(NrrdIoState *nio, int parm, int value) {
     }
     nio->bzip2BlockSize = value;
     break;
+    /* ---- BEGIN non-NrrdIO */
+  case nrrdIoStateChecksumType:
+    if (!( AIR_IN_CL(nrrdChecksumTypeUnknown, value,
+                     nrrdChecksumTypeLast-1) )) {
+      biffAddf(NRRD, "%s: checksumType %d invalid", me, value);
+      return 1;
+    }
+    nio->checksumType = value;
+    break;
+    /* ---- END non-NrrdIO */
   default:
     fprintf(stderr, "!%s: PANIC: didn't recognize parm %d\n", me, parm);
     return 1;
@@ -187,6 +197,11 @@ nrrdIoStateGet(NrrdIoState *nio, int parm) {
   case nrrdIoStateBzip2BlockSize:
     value = nio->bzip2BlockSize;
     break;
+    /* ---- BEGIN non-NrrdIO */
+  case nrrdIoStateChecksumType:
+    value = nio->checksumType;
+    break;
+    /* ---- END non-NrrdIO */
   default:
     fprintf(stderr, "!%s: PANIC: didn't recognize parm %d\n", me, parm);
     return -1;
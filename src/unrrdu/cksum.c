@@ -28,16 +28,19 @@
 static const char *_unrrdu_cksumInfoL =
 (INFO ". Unlike other commands, this doesn't produce a nrrd.  It only "
  "prints to standard out the CRC and byte counts for the input nrrd(s), "
- "seeking to emulate the formatting of cksum output.\n "
- "* Uses nrrdCRC32");
+ "seeking to emulate the formatting of cksum output. With \"-t xxh64\", "
+ "the much faster 64-bit xxHash (as from \"xxhsum -H64\") is printed in "
+ "hex instead of the CRC.\n "
+ "* Uses nrrdCRC32, nrrdXXH64");
 
 int
-unrrdu_cksumDoit(const char *me, char *inS, int endian,
+unrrdu_cksumDoit(const char *me, char *inS, int type, int endian,
                  int printendian, FILE *fout) {
   Nrrd *nrrd;
   airArray *mop;
-  unsigned int crc;
-  char stmp[AIR_STRLEN_SMALL], ends[AIR_STRLEN_SMALL];
+  airULLong xxh;
+  char stmp[AIR_STRLEN_SMALL], ends[AIR_STRLEN_SMALL],
+    sums[AIR_STRLEN_SMALL];
   size_t nn;
 
   mop = airMopNew();
@@ -46,10 +49,16 @@ unrrdu_cksumDoit(const char *me, char *inS, int endian,
     biffMovef(me, NRRD, "%s: trouble loading \"%s\"", me, inS);
     airMopError(mop); return 1;
   }
-  crc = nrrdCRC32(nrrd, endian);
+  if (nrrdChecksumTypeXXH64 == type) {
+    xxh = nrrdXXH64(nrrd, endian);
+    sprintf(sums, "%08x%08x", AIR_CAST(unsigned int, xxh >> 32),
+            AIR_CAST(unsigned int, xxh & 0xffffffff));
+  } else {
+    sprintf(sums, "%u", nrrdCRC32(nrrd, endian));
+  }
   nn = nrrdElementNumber(nrrd)*nrrdElementSize(nrrd);
   sprintf(ends, "(%s)", airEnumStr(airEndian, endian));
-  fprintf(fout, "%u%s %s%s%s\n", crc,
+  fprintf(fout, "%s%s %s%s%s\n", sums,
           printendian ? ends : "",
           airSprintSize_t(stmp, nn),
           strcmp("-", inS) ? " " : "",
@@ -65,10 +74,14 @@ unrrdu_cksumMain(int argc, const char **argv, const char *me,
   hestOpt *opt = NULL;
   char *err, **inS;
   airArray *mop;
-  int pret, endian, printend;
+  int pret, type, endian, printend;
   unsigned int ni, ninLen;
 
   mop = airMopNew();
+  hestOptAdd(&opt, "t,type", "type", airTypeEnum, 1, 1, &type, "crc32",
+             "type of checksum to compute: \"crc32\" for the CRC of cksum, "
+             "or \"xxh64\" for 64-bit xxHash",
+             NULL, nrrdChecksumType);
   hestOptAdd(&opt, "en,endian", "end", airTypeEnum, 1, 1, &endian,
              airEnumStr(airEndian, airMyEndian()),
              "Endianness in which to compute CRC; \"little\" for Intel and "
@@ -91,7 +104,7 @@ unrrdu_cksumMain(int argc, const char **argv, const char *me,
   airMopAdd(mop, opt, (airMopper)hestParseFree, airMopAlways);
 
   for (ni=0; ni<ninLen; ni++) {
-    if (unrrdu_cksumDoit(me, inS[ni], endian, printend, stdout)) {
+    if (unrrdu_cksumDoit(me, inS[ni], type, endian, printend, stdout)) {
       airMopAdd(mop, err = biffGetDone(me), airFree, airMopAlways);
       fprintf(stderr, "%s: trouble with \"%s\":\n%s",
               me, inS[ni], err);
@@ -336,6 +336,14 @@ unrrdu_envMain(int argc, const char **argv, const char *me,
                   "When using text encoding, maximum # values allowed "
                   "per line",
                   hparm->columns);
+  _unrrdu_envEnum(out,
+                  nrrdChecksumType, nrrdEnvVarDefaultWriteChecksumType,
+                  nrrdDefaultWriteChecksumType,
+                  "nrrdDefaultWriteChecksumType",
+                  "When writing NRRD files, what kind of checksum of the "
+                  "data to record in the \"" NRRD_CHECKSUM_KEY "\" "
+                  "key/value pair; leave unset for none.",
+                  hparm->columns);
   _unrrdu_envBool(out,
                   nrrdEnvVarStateGrayscaleImage3D,
                   nrrdStateGrayscaleImage3D,
@@ -344,6 +352,14 @@ unrrdu_envMain(int argc, const char **argv, const char *me,
                   "3-D image with a single sample (size=1) on the first "
                   "(fastest) axis.",
                   hparm->columns);
+  _unrrdu_envUInt(out,
+                  nrrdEnvVarStateThreadNum,
+                  nrrdStateThreadNum,
+                  "nrrdStateThreadNum",
+                  "Number of threads to use in those operations (like "
+                  "\"unu lut\" and \"unu rmap\") that can split their work "
+                  "across threads.",
+                  hparm->columns);
 
 #if 0
   /* GLK is ambivalent about the continued existence of these ... */